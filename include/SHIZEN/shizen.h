@@ -20,6 +20,7 @@
 #include "zinput.h"
 #include "zdraw.h"
 #include "zsound.h"
+#include "zparticle.h"
 
 /**
  * @brief Provides settings and flags for the creation of a window.
@@ -39,6 +40,9 @@ typedef struct SHIZWindowSettings {
     bool fullscreen;
     /** Determines whether v-sync should be enabled */
     bool vsync;
+    /** The device that sound is played on; defaults to the default device
+     * of the system */
+    SHIZSoundDevice sound_device;
 } SHIZWindowSettings;
 
 /**
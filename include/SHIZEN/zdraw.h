@@ -29,6 +29,13 @@ typedef struct SHIZSpriteFontParameters {
     SHIZLayer layer;
 } SHIZSpriteFontParameters;
 
+typedef struct SHIZPathParameters {
+    float width; // in pixels
+    SHIZPathJoin join;
+    SHIZPathCap cap;
+    SHIZLayer layer;
+} SHIZPathParameters;
+
 /**
  * @brief Begin drawing to the screen.
  *
@@ -64,6 +71,27 @@ void z_draw_path(SHIZVector2 const points[], uint16_t count,
 void z_draw_path_ex(SHIZVector2 const points[], uint16_t count,
                     SHIZColor color,
                     SHIZLayer layer);
+
+/**
+ * @brief Draw a path with a stroke width.
+ *
+ * The path is tessellated into triangles and drawn in a single draw call,
+ * regardless of the number of points.
+ *
+ * @param points
+ *        The points of the path
+ * @param count
+ *        The number of points
+ * @param color
+ *        The color of the stroke
+ * @param params
+ *        A SHIZPathParameters defining the width of the stroke and how
+ *        segments are joined and capped (use `SHIZPathParametersDefault()`
+ *        for a 1 pixel wide, mitered stroke)
+ */
+void z_draw_path_stroked(SHIZVector2 const points[], uint32_t count,
+                         SHIZColor color,
+                         SHIZPathParameters params);
 /**
  * @brief Draw a point.
  */
@@ -346,6 +374,186 @@ SHIZSize z_draw_text_ex(SHIZSpriteFont font,
                         SHIZColor tint,
                         SHIZLayer layer);
 
+/**
+ * @brief Measure the size of TrueType text before rendering it.
+ *
+ * @param font
+ *        A SHIZTrueTypeFont defining the font and size that would be used to
+ *        draw the text with
+ * @param text
+ *        The string of text (UTF-8) to measure
+ *
+ * @return a SHIZSize with the bounding width and height
+ */
+SHIZSize z_measure_truetype_text(SHIZTrueTypeFont font, char const * text);
+
+/**
+ * @brief Draw TrueType text at a location.
+ *
+ * Draw text at a location, aligned as specified. Lines are broken only at
+ * newlines.
+ *
+ * @remark Glyphs are rasterized into a shared atlas the first time they are
+ *         drawn at a size, so text of any font and size is batched together;
+ *         once every glyph on screen has been drawn, no further glyphs are
+ *         rasterized.
+ *
+ * @param font
+ *        A SHIZTrueTypeFont defining the font and size to draw the text with
+ * @param text
+ *        The string of text (UTF-8) to draw
+ * @param origin
+ *        The location where the text will be drawn
+ *
+ * @return a SHIZSize with the bounding width and height of the drawn text
+ */
+SHIZSize z_draw_truetype_text(SHIZTrueTypeFont font,
+                              char const * text,
+                              SHIZVector2 origin,
+                              SHIZSpriteFontParameters params);
+
+/**
+ * The max number of baked texts that can exist at the same time.
+ */
+#define SHIZBakedTextMax 512
+
+extern uint16_t const SHIZBakedTextInvalid;
+
+/**
+ * @brief Bake text for repeated drawing.
+ *
+ * Lay out text once and keep a quad for each of its characters, so that it
+ * can be drawn again and again without being laid out every frame.
+ *
+ * This is well-suited for text that rarely (or never) changes; e.g. labels
+ * in a menu.
+ *
+ * @param font
+ *        The font to draw text with
+ * @param text
+ *        The string of text to bake
+ * @param bounds
+ *        A SHIZSize with bounds that the text must not exceed
+ * @param attributes
+ *        A SHIZSpriteFontAttributes containing any additional attributes to
+ *        lay out the text with
+ * @param alignment
+ *        A SHIZSpriteFontAlignment defining the orientation of the text
+ *
+ * @return An id for the baked text, or `SHIZBakedTextInvalid` if the text
+ *         could not be baked
+ */
+uint16_t z_text_bake(SHIZSpriteFont font,
+                     char const * text,
+                     SHIZSize bounds,
+                     SHIZSpriteFontAttributes attributes,
+                     SHIZSpriteFontAlignment alignment);
+
+/**
+ * @brief Change the string of a baked text.
+ *
+ * Lay out the new string using the same font and attributes that the text
+ * was baked with. Only the characters of this baked text are replaced.
+ *
+ * @return `true` if the text was baked successfully, `false` otherwise
+ */
+bool z_text_rebake(uint16_t text_id, char const * text);
+
+/**
+ * @brief Release a baked text.
+ */
+bool z_text_unbake(uint16_t text_id);
+
+/**
+ * @brief Release all baked texts.
+ */
+void z_text_unbake_all(void);
+
+/**
+ * @brief Draw a baked text.
+ *
+ * Draw a previously baked text at any origin, tint and layer.
+ *
+ * @remark The characters are sorted and batched along with any other sprite;
+ *         every baked text of the same font and layer shares the same
+ *         draw calls.
+ *
+ * @remark The tint is multiplied with any tint specified in the text.
+ *
+ * @return a SHIZSize with the bounding width and height of the drawn text
+ */
+SHIZSize z_draw_text_baked(uint16_t text_id,
+                           SHIZVector2 origin,
+                           SHIZColor tint,
+                           SHIZLayer layer);
+
+/**
+ * The max number of paginated texts that can exist at the same time.
+ */
+#define SHIZPagedTextMax 64
+
+extern uint16_t const SHIZPagedTextInvalid;
+
+/**
+ * @brief Paginate text for drawing a range of lines at a time.
+ *
+ * Lay out every line of a text once, so that any range of its lines can
+ * later be drawn without going through the lines before it.
+ *
+ * This is well-suited for long texts that are only partially visible at any
+ * time; e.g. a log in a scrolling view.
+ *
+ * @param font
+ *        The font to draw text with
+ * @param text
+ *        The string of text to paginate; the string is copied
+ * @param width
+ *        The width that lines must not exceed, or 0 to only break lines
+ *        explicitly
+ * @param attributes
+ *        A SHIZSpriteFontAttributes containing any additional attributes to
+ *        lay out the text with
+ *
+ * @return An id for the paginated text, or `SHIZPagedTextInvalid` if the text
+ *         could not be paginated
+ */
+uint16_t z_text_paginate(SHIZSpriteFont font,
+                         char const * text,
+                         float width,
+                         SHIZSpriteFontAttributes attributes);
+
+/**
+ * @brief Release a paginated text.
+ */
+bool z_text_unpaginate(uint16_t text_id);
+
+/**
+ * @brief Release all paginated texts.
+ */
+void z_text_unpaginate_all(void);
+
+/**
+ * @brief Determine the number of lines in a paginated text.
+ */
+uint32_t z_text_line_count(uint16_t text_id);
+
+/**
+ * @brief Draw a range of lines of a paginated text.
+ *
+ * Draw the lines starting from `first_line`, with the first line positioned
+ * at the origin.
+ *
+ * @remark Only the lines in the range are laid out and drawn, so the cost
+ *         does not depend on the length of the text.
+ *
+ * @return a SHIZSize with the bounding width and height of the drawn lines
+ */
+SHIZSize z_draw_text_lines(uint16_t text_id,
+                           SHIZVector2 origin,
+                           uint32_t first_line,
+                           uint32_t line_count,
+                           SHIZSpriteFontParameters params);
+
 static inline
 SHIZSpriteParameters const
 SHIZSpriteParametersMake(SHIZVector2 const anchor,
@@ -472,3 +680,50 @@ SHIZSpriteFontParametersColored(SHIZSpriteFontParameters params,
     
     return params;
 }
+
+static inline
+SHIZPathParameters const
+SHIZPathParametersMake(float const width,
+                       SHIZPathJoin const join,
+                       SHIZPathCap const cap,
+                       SHIZLayer const layer)
+{
+    SHIZPathParameters const params = {
+        .width = width,
+        .join = join,
+        .cap = cap,
+        .layer = layer
+    };
+    
+    return params;
+}
+
+static inline
+SHIZPathParameters const
+SHIZPathParametersDefault(void)
+{
+    return SHIZPathParametersMake(1,
+                                  SHIZPathJoinMiter,
+                                  SHIZPathCapButt,
+                                  SHIZLayerDefault);
+}
+
+static inline
+SHIZPathParameters const
+SHIZPathParametersWidened(SHIZPathParameters params,
+                          float const width)
+{
+    params.width = width;
+    
+    return params;
+}
+
+static inline
+SHIZPathParameters const
+SHIZPathParametersLayered(SHIZPathParameters params,
+                          SHIZLayer const layer)
+{
+    params.layer = layer;
+    
+    return params;
+}
@@ -14,26 +14,173 @@
 #include <stdbool.h> // bool
 #include <stdint.h> // uint8_t, uint16_t, uint32_t
 
-#include "ztype.h" // SHIZSprite, SHIZSpriteSheet, SHIZSpriteFont
+#include "ztype.h" // SHIZSprite, SHIZSpriteSheet, SHIZSpriteFont, SHIZTrueTypeFont
+
+/**
+ * @brief Provides the amount of texture memory in use, and how textures have
+ *        been kept in memory (see `z_set_texture_budget`).
+ */
+typedef struct SHIZTextureUsage {
+    /** The size (in bytes) of every texture in memory */
+    uint32_t bytes;
+    /** The max size (in bytes) of every texture in memory; 0 if unlimited */
+    uint32_t budget;
+    /** The number of times a texture was drawn while in memory */
+    uint32_t hits;
+    /** The number of times a texture had to be loaded before being drawn */
+    uint32_t misses;
+    /** The number of times a texture was evicted to stay within budget */
+    uint32_t evictions;
+} SHIZTextureUsage;
 
 /**
  * @brief Load a resource.
  *
+ * Images are loaded from either PNG (`.png`) or texture (`.tex`) files; a
+ * texture is already decoded, and is loaded much faster (see `tools/texture`).
+ *
+ * A resource that is already loaded (from the same file, regardless of the
+ * path it was loaded by) is not loaded again; the same id is returned and the
+ * resource must be unloaded as many times as it was loaded.
+ *
+ * The filename is copied; it does not have to outlive the call, even though
+ * the file may be read again later (see `z_set_texture_budget`).
+ *
  * @return A resource id if the resource was loaded successfully, `0` otherwise
  */
-uint8_t z_load(char const * filename);
+uint32_t z_load(char const * filename);
+
+/**
+ * @brief Load many resources at once.
+ *
+ * Unlike loading each resource by `z_load`, the resources are decoded in
+ * parallel (on every processor), and their textures are then created all at
+ * once; e.g. when loading a level. Anything else still loading in the
+ * background (see `z_load_async`) is finished as well.
+ *
+ * @param resource_ids
+ *        Receives a resource id for each file, in the same order; `0` for
+ *        each resource that failed to load
+ *
+ * @return The number of resources that were loaded successfully
+ */
+uint32_t z_load_many(char const * const * filenames, uint32_t count, uint32_t * resource_ids);
+
+/**
+ * @brief Load a sound that is streamed; i.e. decoded a little at a time while
+ *        it plays, rather than all at once when loaded.
+ *
+ * A stream uses the same, small amount of memory regardless of its length,
+ * and loads without decoding anything but its headers; e.g. for music.
+ * Unlike other resources, each load opens a stream of its own; a stream can
+ * only play once at a time.
+ *
+ * @return A resource id if the stream was opened successfully, `0` otherwise
+ */
+uint32_t z_load_stream(char const * filename);
 
 /**
  * @brief Unload a resource.
  *
+ * The resource is only released once it has been unloaded as many times as
+ * it was loaded.
+ *
  * @return `true` if the resource was unloaded successfully, `false` otherwise
  */
-bool z_unload(uint8_t resource_id);
+bool z_unload(uint32_t resource_id);
+
+/**
+ * @brief Load a pack of resources (see `tools/pack`).
+ *
+ * The pack is mapped into memory rather than read, and any resource that is
+ * loaded afterwards is loaded from the pack if found in it; by the same name
+ * that it was packed as. Packs loaded later take precedence.
+ *
+ * @return `true` if the pack was loaded successfully, `false` otherwise
+ */
+bool z_load_pack(char const * filename);
+/**
+ * @brief Unload a pack.
+ *
+ * Resources already loaded from the pack stay loaded, and any resource still
+ * loading from it in the background is finished first. A stream is decoded
+ * straight out of the pack, so the pack can not be unloaded until every
+ * stream opened from it has been unloaded.
+ *
+ * @return `true` if the pack was unloaded, `false` if it was not loaded, or
+ *         is still being streamed from
+ */
+bool z_unload_pack(char const * filename);
+
+/**
+ * @brief Reload images when their files change; e.g. while editing art.
+ *
+ * Only images loaded from files (not from packs) while watching are
+ * reloaded, and they keep their ids; anything drawing them simply draws
+ * the new image. Watching is only supported on Linux.
+ *
+ * @return `true` if watching was enabled (or disabled), `false` otherwise
+ */
+bool z_watch(bool enabled);
+
+/**
+ * @brief Limit the amount of texture memory in use.
+ *
+ * With a budget, images loaded from files are only loaded into texture
+ * memory the first time they are drawn, and the textures least recently
+ * drawn are evicted whenever the budget would be exceeded. An evicted
+ * texture is simply loaded again the next time it is drawn (from the same
+ * file, or pack, that it was first loaded from), so resource ids and sprites
+ * stay valid throughout.
+ *
+ * Textures drawn during the current frame are never evicted, nor are images
+ * that were not loaded from files (e.g. loaded from memory); so the budget
+ * may be exceeded temporarily.
+ *
+ * @param bytes
+ *        The max size (in bytes) of every texture in memory; 0 if unlimited
+ *        (the default)
+ */
+void z_set_texture_budget(uint32_t bytes);
+SHIZTextureUsage z_get_texture_usage(void);
+
+/**
+ * @brief Load a resource in the background.
+ *
+ * The resource is decoded on another thread, and is ready for use once it
+ * has been finished at the beginning of a frame (see `z_drawing_begin`).
+ * Images are then uploaded within a budget per frame, so a large image may
+ * take a few more frames before it is ready.
+ * The id can be used right away; e.g. drawing a sprite from an image that is
+ * not yet loaded simply draws nothing.
+ *
+ * @return A resource id if the resource could be queued for loading, `0`
+ *         otherwise
+ */
+uint32_t z_load_async(char const * filename);
+
+/**
+ * @brief Determine whether a resource is loaded and ready for use.
+ */
+bool z_is_loaded(uint32_t resource_id);
+/**
+ * @brief Determine whether a resource is still loading in the background.
+ *
+ * A resource that failed to load is neither loaded nor loading.
+ */
+bool z_is_loading(uint32_t resource_id);
 
 SHIZSprite z_load_sprite(char const * filename);
 SHIZSprite z_load_sprite_src(char const * filename, SHIZRect source);
-SHIZSprite z_load_sprite_from(uint8_t resource_id);
-SHIZSprite z_load_sprite_from_src(uint8_t resource_id, SHIZRect source);
+SHIZSprite z_load_sprite_from(uint32_t resource_id);
+SHIZSprite z_load_sprite_from_src(uint32_t resource_id, SHIZRect source);
+/**
+ * @brief Load a sprite in the background.
+ *
+ * Because the size of the image is not known until it has loaded, the
+ * source frame must be specified.
+ */
+SHIZSprite z_load_sprite_async(char const * filename, SHIZRect source);
 
 SHIZSpriteSheet z_load_spritesheet(char const * filename, SHIZSize sprite_size);
 SHIZSpriteSheet z_load_spritesheet_src(char const * filename, SHIZSize sprite_size, SHIZRect source);
@@ -48,3 +195,15 @@ SHIZSpriteFont z_load_spritefont(char const * filename, SHIZSize character_size)
 SHIZSpriteFont z_load_spritefont_ex(char const * filename, SHIZSize character_size, SHIZSpriteFontTable);
 SHIZSpriteFont z_load_spritefont_from(SHIZSprite sprite, SHIZSize character_size);
 SHIZSpriteFont z_load_spritefont_from_ex(SHIZSprite sprite, SHIZSize character_size, SHIZSpriteFontTable);
+
+/**
+ * @brief Load a TrueType font.
+ *
+ * The font can be drawn at any size; glyphs are rasterized on demand.
+ *
+ * @param size
+ *        The height of each line of text (in pixels); this is rounded to
+ *        whole pixels when text is drawn
+ */
+SHIZTrueTypeFont z_load_truetype_font(char const * filename, float size);
+SHIZTrueTypeFont z_load_truetype_font_from(uint32_t resource_id, float size);
@@ -0,0 +1,152 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdint.h> // uint8_t, uint32_t
+#include <stdbool.h> // bool
+
+#include "ztype.h" // SHIZSprite, SHIZVector2, SHIZColor
+#include "zlayer.h" // SHIZLayer
+
+/**
+ * The max number of emitters that can exist at the same time.
+ */
+#define SHIZParticleEmitterMax 16
+
+extern uint8_t const SHIZParticleEmitterInvalid;
+
+/**
+ * @brief Provides settings that determine how an emitter spawns and
+ *        simulates its particles.
+ */
+typedef struct SHIZParticleEmitterParameters {
+    /** The constant acceleration applied to every particle (in pixels per
+      * second squared) */
+    SHIZVector2 gravity;
+    /** The tint applied to every particle */
+    SHIZColor tint;
+    /** The layer that every particle is drawn at */
+    SHIZLayer layer;
+    /** The max number of particles alive at the same time; any particle
+      * emitted beyond this is discarded */
+    uint32_t capacity;
+    /** The number of particles emitted continuously per second; 0 to only
+      * emit particles in bursts */
+    float rate;
+    /** The number of seconds that each particle lives */
+    float lifetime;
+    /** The lower bound of the initial speed of each particle (in pixels per
+      * second) */
+    float speed_min;
+    /** The upper bound of the initial speed of each particle */
+    float speed_max;
+    /** The direction that particles are emitted towards (in radians) */
+    float angle;
+    /** The spread around the direction that particles are emitted
+      * within (in radians) */
+    float spread;
+    /** Determines whether particles fade out over their lifetime */
+    bool fade;
+} SHIZParticleEmitterParameters;
+
+/**
+ * @brief Add a particle emitter.
+ *
+ * Add an emitter that spawns particles drawn with the specified sprite.
+ *
+ * Particles are stored in pools sized to the capacity of the emitter, so
+ * no allocations occur while emitting or simulating.
+ *
+ * @return An emitter id, or `SHIZParticleEmitterInvalid` if the emitter could
+ *         not be added
+ */
+uint8_t z_particles_add(SHIZSprite sprite,
+                        SHIZVector2 origin,
+                        SHIZParticleEmitterParameters params);
+
+/**
+ * @brief Remove a particle emitter and all of its particles.
+ */
+bool z_particles_remove(uint8_t emitter_id);
+
+/**
+ * @brief Remove all particle emitters.
+ */
+void z_particles_remove_all(void);
+
+/**
+ * @brief Move the point that an emitter spawns particles from.
+ *
+ * @remark Particles that were already emitted are not affected.
+ */
+void z_particles_set_origin(uint8_t emitter_id, SHIZVector2 origin);
+
+/**
+ * @brief Determine whether an emitter emits particles continuously.
+ */
+void z_particles_set_emitting(uint8_t emitter_id, bool emitting);
+
+/**
+ * @brief Emit a burst of particles.
+ */
+void z_particles_emit(uint8_t emitter_id, uint32_t count);
+
+/**
+ * @brief Determine the number of particles alive in an emitter.
+ */
+uint32_t z_particles_count(uint8_t emitter_id);
+
+/**
+ * @brief Advance the simulation of all particles by a single step.
+ *
+ * This function should be called once for every `z_time_tick`, so that the
+ * simulation progresses at a fixed rate.
+ */
+void z_particles_tick(void);
+
+/**
+ * @brief Draw all particles.
+ *
+ * Draw all particles at positions blended between the two latest ticks.
+ *
+ * @remark Particles are drawn once the frame is flushed, sorted by layer;
+ *         all particles sharing a texture (across emitters) are drawn with
+ *         a single draw call.
+ *
+ * @param interpolation
+ *        The interpolation factor returned by `z_timing_end`
+ */
+void z_particles_draw(double interpolation);
+
+static inline
+SHIZParticleEmitterParameters const
+SHIZParticleEmitterParametersMake(uint32_t const capacity,
+                                  float const rate,
+                                  float const lifetime,
+                                  float const speed)
+{
+    SHIZParticleEmitterParameters params;
+
+    params.gravity = SHIZVector2Zero;
+    params.tint = SHIZSpriteNoTint;
+    params.layer = SHIZLayerDefault;
+    params.capacity = capacity;
+    params.rate = rate;
+    params.lifetime = lifetime;
+    params.speed_min = speed;
+    params.speed_max = speed;
+    params.angle = 0;
+    params.spread = 0;
+    params.fade = true;
+
+    return params;
+}
@@ -11,7 +11,144 @@
 
 #pragma once
 
-#include <stdint.h> // uint8_t
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t, uint32_t, uint64_t
 
-void z_sound_play(uint8_t sound_resource_id);
-void z_sound_stop(uint8_t sound_resource_id);
+/**
+ * @brief Represents the device that sound is played on.
+ */
+typedef enum SHIZSoundDevice {
+    /** The default device of the system; e.g. speakers. If it can not be
+        opened (e.g. on a machine without sound hardware), sound is rendered
+        into memory instead */
+    SHIZSoundDeviceDefault,
+    /** No device; sound is mixed into memory as the clock ticks (see
+        `z_time_tick`), rather than played (`ALC_SOFT_loopback`). Useful for
+        running without sound hardware, and for measuring what sound costs */
+    SHIZSoundDeviceLoopback
+} SHIZSoundDevice;
+
+/**
+ * @brief Provides the number of voices that sounds are played by, and how
+ *        they have been shared (see `z_sound_play_ex`).
+ */
+typedef struct SHIZSoundUsage {
+    /** The number of sounds that can play at the same time */
+    uint32_t voices;
+    /** The number of voices currently playing */
+    uint32_t playing;
+    /** The number of times a sound began playing */
+    uint32_t plays;
+    /** The number of times a playing sound was cut off to play another */
+    uint32_t steals;
+    /** The number of times a sound was already playing from the same frame */
+    uint32_t merges;
+    /** The number of times a sound was not played; all voices were busy with
+        sounds of higher priority, or too many sounds were played at once */
+    uint32_t drops;
+    /** The size (in bytes) of the samples of every loaded sound, however
+        kept (see `z_sound_compress`); streams aside */
+    uint64_t bytes;
+    /** The time (in seconds) spent mixing the most recent block of sound;
+        0 unless mixing in software (see `z_sound_mix`) */
+    double mix_time;
+    /** The duration (in seconds) of sound rendered into memory so far; 0
+        unless rendering (see `SHIZSoundDeviceLoopback`) */
+    double audio_time;
+    /** The time (in seconds) spent rendering `audio_time` worth of sound;
+        including mixing and decoding compressed sounds */
+    double render_time;
+    /** The time (in seconds) spent decoding streamed sounds so far */
+    double decode_time;
+} SHIZSoundUsage;
+
+/**
+ * @brief Play a sound.
+ *
+ * Sounds are played on an audio thread; playing (or stopping) a sound only
+ * tells that thread to do so, and never waits on it.
+ *
+ * A sound can play any number of times at once; e.g. rapid gunfire. Each
+ * play is layered on top of those still playing rather than restarting them.
+ * A streamed sound is the exception; it restarts if already playing.
+ */
+void z_sound_play(uint32_t sound_resource_id);
+/**
+ * @brief Play a sound at a gain, pitch and position.
+ *
+ * A sound played more than once during the same frame is only played once
+ * (as loud as the loudest). Once every voice is busy, the voice playing the
+ * sound of least priority (and of those, the oldest) is stolen.
+ *
+ * @param gain
+ *        The volume of the sound; 1 is unchanged
+ * @param pitch
+ *        The pitch of the sound; 1 is unchanged, 2 is an octave higher
+ * @param pan
+ *        The position of the sound between the left (-1) and right (1)
+ *        speaker; 0 is centered. A streamed sound is always centered
+ * @param priority
+ *        The priority of the sound; a sound is never cut off to play a sound
+ *        of lower priority
+ *
+ * @return `true` if the sound is about to play, `false` otherwise
+ */
+bool z_sound_play_ex(uint32_t sound_resource_id, float gain, float pitch, float pan, uint8_t priority);
+/**
+ * @brief Play a sound at a point in time; e.g. in a tick.
+ *
+ * Sounds played during the ticks of a frame would otherwise all play at
+ * once, as the frame begins; scheduled by the time of each tick instead,
+ * they play as far apart as the ticks are, however long the frame.
+ *
+ * Scheduling is only accurate while mixing in software (see `z_sound_mix`),
+ * and plays the sound a little later (50ms); otherwise, the sound simply
+ * plays right away. Time is expected to pass at normal speed.
+ *
+ * @param time
+ *        The time that the sound plays at; e.g. `z_time_passed()`
+ *
+ * @return `true` if the sound is about to play, `false` otherwise
+ */
+bool z_sound_play_at(uint32_t sound_resource_id, double time, float gain, float pitch, float pan, uint8_t priority);
+/**
+ * @brief Stop every play of a sound.
+ */
+void z_sound_stop(uint32_t sound_resource_id);
+/**
+ * @brief Set whether a streamed sound starts over, without a gap, once it
+ *        ends (see `z_load_stream`).
+ *
+ * @return `true` if the sound is streamed, `false` otherwise
+ */
+bool z_sound_loop(uint32_t sound_resource_id, bool loop);
+
+/**
+ * @brief Mix sounds in software, rather than playing each through a source
+ *        of its own.
+ *
+ * Every playing sound is mixed into a single bus on a background thread, and
+ * the bus is played through a single source; so many more sounds can play
+ * at the same time (see `SHIZSoundUsage`), and hundreds of short sounds at
+ * once cost little.
+ *
+ * Mixing can only be enabled (or disabled) while no sounds are loaded; e.g.
+ * right after startup.
+ *
+ * @return `true` if mixing was enabled (or disabled), `false` otherwise
+ */
+bool z_sound_mix(bool enabled);
+/**
+ * @brief Keep sounds loaded from now on compressed in memory, rather than
+ *        fully decoded.
+ *
+ * A compressed sound takes about a quarter of the memory (IMA-ADPCM) at a
+ * slight loss of quality, and is decoded a little at a time just ahead of
+ * playing; this suits a large library of short sounds.
+ *
+ * While mixing in software, this always applies. Otherwise, it only applies
+ * if OpenAL supports IMA-ADPCM; if not, sounds are fully decoded as usual.
+ */
+void z_sound_compress(bool enabled);
+
+SHIZSoundUsage z_get_sound_usage(void);
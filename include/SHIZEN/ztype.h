@@ -40,6 +40,27 @@ typedef enum SHIZDrawMode {
     SHIZDrawModeOutline
 } SHIZDrawMode;
 
+/**
+ * @brief Determines how two connected segments of a stroked path are joined.
+ */
+typedef enum SHIZPathJoin {
+    /** Extend the outer edges until they meet; falls back to a bevel
+      * for very sharp corners */
+    SHIZPathJoinMiter,
+    /** Connect the outer edges with a straight cut */
+    SHIZPathJoinBevel
+} SHIZPathJoin;
+
+/**
+ * @brief Determines how the open ends of a stroked path are drawn.
+ */
+typedef enum SHIZPathCap {
+    /** End exactly at the first and last point */
+    SHIZPathCapButt,
+    /** Extend beyond the first and last point by half the stroke width */
+    SHIZPathCapSquare
+} SHIZPathCap;
+
 /**
  * @brief Represents a 2-dimensional frame of an image resource.
  *
@@ -49,7 +70,7 @@ typedef struct SHIZSprite {
     /* The frame that specifies which part of the image to draw */
     SHIZRect source;
     /** The image resource */
-    uint8_t resource_id;
+    uint32_t resource_id;
 } SHIZSprite;
 
 typedef enum SHIZSpriteFlipMode {
@@ -124,8 +145,22 @@ typedef struct SHIZSpriteFont {
     /** Determines whether the font resource includes a sprite for the
       * whitespace character */
     bool includes_whitespace;
+    /** An identifier for the lookup table built from the codepage when the
+      * font was loaded (and released when its image is unloaded); 0 if the
+      * font has no codepage */
+    uint8_t table_lookup_id;
 } SHIZSpriteFont;
 
+/**
+ * @brief Represents a TrueType font at a specific size.
+ */
+typedef struct SHIZTrueTypeFont {
+    /** The resource id of the loaded font */
+    uint32_t resource_id;
+    /** The height of each line of text (in pixels) */
+    float size;
+} SHIZTrueTypeFont;
+
 /**
  * @brief Default font attributes.
  * 
@@ -153,6 +188,7 @@ extern SHIZSprite const SHIZSpriteEmpty;
 extern SHIZSpriteSheet const SHIZSpriteSheetEmpty;
 extern SHIZSpriteFont const SHIZSpriteFontEmpty;
 extern SHIZSpriteFontTable const SHIZSpriteFontTableEmpty;
+extern SHIZTrueTypeFont const SHIZTrueTypeFontEmpty;
 
 /**
  * @brief Size a sprite to its intrinsic (or natural) size.
@@ -273,7 +309,7 @@ SHIZRectFromPoints(SHIZVector2 const points[], uint16_t const count)
     SHIZVector2 min = points[0];
     SHIZVector2 max = points[0];
     
-    for (uint8_t i = 1; i < count; i++) {
+    for (uint16_t i = 1; i < count; i++) {
         SHIZVector2 const point = points[i];
         
         if (point.x < min.x) {
@@ -308,7 +344,7 @@ SHIZVector2CenterFromPoints(SHIZVector2 const points[],
 {
     SHIZVector2 sum = SHIZVector2Zero;
     
-    for (uint8_t i = 0; i < count; i++) {
+    for (uint16_t i = 0; i < count; i++) {
         SHIZVector2 const point = points[i];
         
         sum.x += point.x;
@@ -0,0 +1,214 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#include "adpcm.h"
+
+/**
+ * @brief Represents the state of a channel; the encoder keeps the same state
+ *        as the decoder, so that neither drifts from the other.
+ */
+typedef struct SHIZADPCMChannel {
+    int32_t predictor;
+    int32_t index;
+} SHIZADPCMChannel;
+
+static int16_t z_adpcm__expand(SHIZADPCMChannel *, uint8_t nibble);
+static uint8_t z_adpcm__compress(SHIZADPCMChannel *, int16_t sample);
+
+/**
+ * The number of bytes of each channel that are interleaved at a time.
+ */
+#define SHIZADPCMChunkSize 4
+
+/**
+ * The difference that each code makes, in eighths of a step; the same as
+ * OpenAL decodes with, so that sounds decode alike either way.
+ */
+static int8_t const SHIZADPCMCodeTable[16] = {
+    1, 3, 5, 7, 9, 11, 13, 15,
+    -1, -3, -5, -7, -9, -11, -13, -15
+};
+
+static int8_t const SHIZADPCMIndexTable[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static int16_t const SHIZADPCMStepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+    230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+    963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+    3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+    9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385,
+    24623, 27086, 29794, 32767
+};
+
+uint32_t
+z_adpcm__blocks(uint32_t const frames)
+{
+    return (frames + SHIZADPCMBlockFrames - 1) / SHIZADPCMBlockFrames;
+}
+
+void
+z_adpcm__encode(int16_t const * const samples,
+                uint32_t const frames,
+                uint8_t const channels,
+                uint8_t * const blocks)
+{
+    SHIZADPCMChannel state[2] = { { 0, 0 }, { 0, 0 } };
+    
+    uint32_t const count = z_adpcm__blocks(frames);
+    
+    for (uint32_t b = 0; b < count; b++) {
+        uint8_t * const block = blocks + b * SHIZADPCMBlockSize * channels;
+        uint32_t const first = b * SHIZADPCMBlockFrames;
+        
+        for (uint8_t c = 0; c < channels; c++) {
+            // the first sample is kept as is; the step carries on from the
+            // previous block
+            int16_t const sample = samples[first * channels + c];
+            
+            state[c].predictor = sample;
+            
+            block[c * 4] = (uint8_t)((uint16_t)sample & 0xff);
+            block[c * 4 + 1] = (uint8_t)((uint16_t)sample >> 8);
+            block[c * 4 + 2] = (uint8_t)state[c].index;
+            block[c * 4 + 3] = 0;
+        }
+        
+        uint8_t * chunk = block + channels * 4;
+        
+        for (uint32_t i = 1; i < SHIZADPCMBlockFrames; i += SHIZADPCMChunkSize * 2) {
+            for (uint8_t c = 0; c < channels; c++) {
+                for (uint32_t k = 0; k < SHIZADPCMChunkSize * 2; k++) {
+                    uint32_t const frame = first + i + k;
+                    
+                    // pad the last block with silence
+                    int16_t const sample = frame < frames ?
+                        samples[frame * channels + c] : 0;
+                    
+                    uint8_t const nibble = z_adpcm__compress(&state[c], sample);
+                    
+                    if (k % 2 == 0) {
+                        chunk[k / 2] = nibble;
+                    } else {
+                        chunk[k / 2] |= (uint8_t)(nibble << 4);
+                    }
+                }
+                
+                chunk += SHIZADPCMChunkSize;
+            }
+        }
+    }
+}
+
+void
+z_adpcm__decode(uint8_t const * const blocks,
+                uint32_t const count,
+                uint8_t const channels,
+                int16_t * const samples)
+{
+    for (uint32_t b = 0; b < count; b++) {
+        uint8_t const * const block = blocks + b * SHIZADPCMBlockSize * channels;
+        int16_t * const decoded = samples + b * SHIZADPCMBlockFrames * channels;
+        
+        SHIZADPCMChannel state[2];
+        
+        for (uint8_t c = 0; c < channels; c++) {
+            int16_t const sample =
+                (int16_t)(uint16_t)(block[c * 4] | (block[c * 4 + 1] << 8));
+            
+            state[c].predictor = sample;
+            state[c].index = block[c * 4 + 2] > 88 ? 88 : block[c * 4 + 2];
+            
+            decoded[c] = sample;
+        }
+        
+        uint8_t const * chunk = block + channels * 4;
+        
+        for (uint32_t i = 1; i < SHIZADPCMBlockFrames; i += SHIZADPCMChunkSize * 2) {
+            for (uint8_t c = 0; c < channels; c++) {
+                int16_t * sample = decoded + i * channels + c;
+                
+                // the lower half of each byte comes first
+                for (uint32_t k = 0; k < SHIZADPCMChunkSize; k++) {
+                    *sample = z_adpcm__expand(&state[c], chunk[k] & 0x0f);
+                    sample += channels;
+                    *sample = z_adpcm__expand(&state[c], chunk[k] >> 4);
+                    sample += channels;
+                }
+                
+                chunk += SHIZADPCMChunkSize;
+            }
+        }
+    }
+}
+
+static
+int16_t
+z_adpcm__expand(SHIZADPCMChannel * const channel,
+                uint8_t const nibble)
+{
+    int32_t const difference =
+        SHIZADPCMStepTable[channel->index] * SHIZADPCMCodeTable[nibble] / 8;
+    
+    int32_t predictor = channel->predictor + difference;
+    
+    if (predictor > INT16_MAX) {
+        predictor = INT16_MAX;
+    } else if (predictor < INT16_MIN) {
+        predictor = INT16_MIN;
+    }
+    
+    int32_t index = channel->index + SHIZADPCMIndexTable[nibble];
+    
+    if (index < 0) {
+        index = 0;
+    } else if (index > 88) {
+        index = 88;
+    }
+    
+    channel->predictor = predictor;
+    channel->index = index;
+    
+    return (int16_t)predictor;
+}
+
+static
+uint8_t
+z_adpcm__compress(SHIZADPCMChannel * const channel,
+                  int16_t const sample)
+{
+    int32_t step = SHIZADPCMStepTable[channel->index];
+    int32_t difference = sample - channel->predictor;
+    
+    uint8_t nibble = 0;
+    
+    if (difference < 0) {
+        nibble = 8;
+        difference = -difference;
+    }
+    
+    for (uint8_t bit = 4; bit > 0; bit >>= 1) {
+        if (difference >= step) {
+            nibble |= bit;
+            difference -= step;
+        }
+        
+        step >>= 1;
+    }
+    
+    // step as the decoder would
+    z_adpcm__expand(channel, nibble);
+    
+    return nibble;
+}
@@ -0,0 +1,49 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdint.h> // uint8_t, int16_t, uint32_t
+
+/**
+ * The number of samples (of every channel) in each block; the first is kept
+ * as is, the rest take 4 bits each.
+ */
+#define SHIZADPCMBlockFrames 65
+/**
+ * The size (in bytes) of each block, for each channel.
+ */
+#define SHIZADPCMBlockSize 36
+
+/**
+ * @brief Determine the number of blocks needed to hold a number of samples.
+ */
+uint32_t z_adpcm__blocks(uint32_t frames);
+
+/**
+ * @brief Compress 16-bit samples to IMA-ADPCM; 4:1.
+ *
+ * The blocks are laid out as expected by OpenAL (`AL_EXT_IMA4`); each block
+ * begins with the first sample of every channel, followed by the rest
+ * interleaved 8 at a time. Every block can be decoded by itself.
+ *
+ * @param blocks
+ *        Must hold `z_adpcm__blocks(frames)` blocks of every channel; the
+ *        last block is padded with silence
+ */
+void z_adpcm__encode(int16_t const * samples, uint32_t frames, uint8_t channels, uint8_t * blocks);
+/**
+ * @brief Decode a run of blocks to 16-bit samples.
+ *
+ * @param samples
+ *        Must hold `count * SHIZADPCMBlockFrames` samples of every channel
+ */
+void z_adpcm__decode(uint8_t const * blocks, uint32_t count, uint8_t channels, int16_t * samples);
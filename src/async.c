@@ -0,0 +1,447 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#if defined(__linux__) && !defined(_XOPEN_SOURCE)
+ #define _XOPEN_SOURCE 700 // sysconf
+#endif
+
+#include "async.h"
+
+#include <stdlib.h> // NULL, calloc, malloc, free
+#include <string.h> // memcpy, strlen
+#include <pthread.h> // pthread_*
+#include <unistd.h> // sysconf
+
+#include "internal.h" // glfwGetTime
+#include "io.h" // z_io__decode_*, z_io__read_file
+
+/**
+ * @brief Represents a file to be decoded, and the result once decoded.
+ */
+typedef struct SHIZAsyncJob {
+    struct SHIZAsyncJob * next;
+    /** A copy of the filename, allocated along with the job */
+    char const * filename;
+    /** The contents of the file, if already in memory */
+    uint8_t const * source;
+    uint32_t source_length;
+    /** Whether the file may be changing while it is decoded */
+    bool is_changing;
+    /** The decoded pixels, samples or file contents; `NULL` if failed */
+    void * data;
+    uint32_t resource_id;
+    SHIZResourceType type;
+    /** The width of an image, or the number of channels of a sound */
+    int32_t width;
+    /** The height of an image, or the sample rate of a sound */
+    int32_t height;
+    int32_t components;
+    /** The size (in bytes) of the samples of a sound, or the contents of a font */
+    uint32_t length;
+} SHIZAsyncJob;
+
+typedef struct SHIZAsyncQueue {
+    SHIZAsyncJob * first;
+    SHIZAsyncJob * last;
+} SHIZAsyncQueue;
+
+static uint8_t z_async__worker_count(void);
+
+static bool z_async__request(uint32_t resource_id, SHIZResourceType, char const * filename, uint8_t const * data, uint32_t length, bool is_changing);
+
+static void * z_async__work(void * argument);
+static void z_async__decode(SHIZAsyncJob *);
+static void z_async__finish(SHIZAsyncJob *);
+static void z_async__discard(SHIZAsyncQueue *);
+
+static void z_async__push(SHIZAsyncQueue *, SHIZAsyncJob *);
+static SHIZAsyncJob * z_async__pop(SHIZAsyncQueue *);
+
+static pthread_t _workers[SHIZAsyncWorkerMax];
+static uint8_t _worker_count = 0;
+
+// guards both queues, the decoding count and the stopping flag
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _requested = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t _decoded = PTHREAD_COND_INITIALIZER;
+
+static SHIZAsyncQueue _requests; // files waiting to be decoded
+static SHIZAsyncQueue _results; // files decoded, waiting to be finished
+
+static uint32_t _decoding = 0; // files being decoded by workers
+
+static bool _is_stopping = false;
+
+bool
+z_async__queue(uint32_t const resource_id,
+               SHIZResourceType const type,
+               char const * const filename,
+               uint8_t const * const data,
+               uint32_t const length)
+{
+    return z_async__request(resource_id, type, filename, data, length, false);
+}
+
+bool
+z_async__queue_reload(uint32_t const resource_id,
+                      SHIZResourceType const type,
+                      char const * const filename)
+{
+    return z_async__request(resource_id, type, filename, NULL, 0, true);
+}
+
+static
+bool
+z_async__request(uint32_t const resource_id,
+                 SHIZResourceType const type,
+                 char const * const filename,
+                 uint8_t const * const data,
+                 uint32_t const length,
+                 bool const is_changing)
+{
+    if (_worker_count == 0) {
+        uint8_t const count = z_async__worker_count();
+        
+        while (_worker_count < count) {
+            if (pthread_create(&_workers[_worker_count], NULL,
+                               z_async__work, NULL) != 0) {
+                break;
+            }
+            
+            _worker_count += 1;
+        }
+        
+        if (_worker_count == 0) {
+            return false;
+        }
+    }
+    
+    size_t const filename_length = strlen(filename);
+    
+    // the job is decoded on another thread, possibly after the resource it
+    // was queued for is gone; so it keeps its own copy of the filename
+    SHIZAsyncJob * const job = calloc(1, sizeof(SHIZAsyncJob) +
+                                         filename_length + 1);
+    
+    if (job == NULL) {
+        return false;
+    }
+    
+    char * const filename_copy = (char *)(job + 1);
+    
+    memcpy(filename_copy, filename, filename_length + 1);
+    
+    job->resource_id = resource_id;
+    job->type = type;
+    job->filename = filename_copy;
+    job->source = data;
+    job->source_length = length;
+    job->is_changing = is_changing;
+    
+    pthread_mutex_lock(&_mutex);
+    
+    z_async__push(&_requests, job);
+    
+    pthread_cond_signal(&_requested);
+    pthread_mutex_unlock(&_mutex);
+    
+    return true;
+}
+
+void
+z_async__process(double const budget)
+{
+    if (_worker_count == 0) {
+        // nothing has ever been queued
+        return;
+    }
+    
+    double const start = glfwGetTime();
+    
+    do {
+        pthread_mutex_lock(&_mutex);
+        
+        SHIZAsyncJob * const job = z_async__pop(&_results);
+        
+        pthread_mutex_unlock(&_mutex);
+        
+        if (job == NULL) {
+            break;
+        }
+        
+        z_async__finish(job);
+    } while (glfwGetTime() - start < budget);
+}
+
+void
+z_async__wait()
+{
+    if (_worker_count == 0) {
+        return;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    while (true) {
+        SHIZAsyncJob * job = z_async__pop(&_results);
+        
+        if (job == NULL) {
+            job = z_async__pop(&_requests);
+            
+            if (job != NULL) {
+                // help decoding instead of idling; note that the job is
+                // finished right after, without going through the results
+                pthread_mutex_unlock(&_mutex);
+                
+                z_async__decode(job);
+                
+                pthread_mutex_lock(&_mutex);
+            }
+        }
+        
+        if (job != NULL) {
+            pthread_mutex_unlock(&_mutex);
+            
+            z_async__finish(job);
+            
+            pthread_mutex_lock(&_mutex);
+        } else if (_decoding > 0) {
+            pthread_cond_wait(&_decoded, &_mutex);
+        } else {
+            break;
+        }
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+void
+z_async__kill()
+{
+    if (_worker_count == 0) {
+        return;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    _is_stopping = true;
+    
+    pthread_cond_broadcast(&_requested);
+    pthread_mutex_unlock(&_mutex);
+    
+    for (uint8_t i = 0; i < _worker_count; i++) {
+        pthread_join(_workers[i], NULL);
+    }
+    
+    _worker_count = 0;
+    _is_stopping = false;
+    
+    z_async__discard(&_requests);
+    z_async__discard(&_results);
+}
+
+static
+uint8_t
+z_async__worker_count()
+{
+    long processors = -1;
+    
+#ifdef _SC_NPROCESSORS_ONLN
+    processors = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    
+    if (processors < 1) {
+        // the number of processors is not known; assume at least two
+        processors = 2;
+    }
+    
+    // leave a processor for the main thread; it keeps drawing frames
+    long count = processors - 1;
+    
+    if (count < 1) {
+        count = 1;
+    } else if (count > SHIZAsyncWorkerMax) {
+        count = SHIZAsyncWorkerMax;
+    }
+    
+    return (uint8_t)count;
+}
+
+static
+void *
+z_async__work(void * const argument)
+{
+    (void)argument;
+    
+    pthread_mutex_lock(&_mutex);
+    
+    while (true) {
+        while (!_is_stopping && _requests.first == NULL) {
+            pthread_cond_wait(&_requested, &_mutex);
+        }
+        
+        if (_is_stopping) {
+            break;
+        }
+        
+        SHIZAsyncJob * const job = z_async__pop(&_requests);
+        
+        _decoding += 1;
+        
+        pthread_mutex_unlock(&_mutex);
+        
+        z_async__decode(job);
+        
+        pthread_mutex_lock(&_mutex);
+        
+        z_async__push(&_results, job);
+        
+        _decoding -= 1;
+        
+        pthread_cond_signal(&_decoded);
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return NULL;
+}
+
+static
+void
+z_async__decode(SHIZAsyncJob * const job)
+{
+    // note that nothing is reported from here; failures are reported once
+    // the job is finished on the main thread
+    if (job->type == SHIZResourceTypeImage && job->is_changing) {
+        // the file may still be written to; mapping it would fault if it was
+        // truncated mid-decode, so read it into memory first instead
+        uint32_t source_length = 0;
+        uint8_t * const source = z_io__read_file(job->filename, &source_length);
+        
+        if (source != NULL) {
+            job->data = z_io__decode_image_data(source, source_length,
+                                                &job->width, &job->height,
+                                                &job->components);
+            
+            free(source);
+        }
+    } else if (job->type == SHIZResourceTypeImage) {
+        job->data = job->source != NULL ?
+            z_io__decode_image_data(job->source, job->source_length,
+                                    &job->width, &job->height,
+                                    &job->components) :
+            z_io__decode_image(job->filename,
+                               &job->width, &job->height,
+                               &job->components);
+    } else if (job->type == SHIZResourceTypeSound) {
+        int32_t length = 0;
+        
+        job->data = job->source != NULL ?
+            z_io__decode_sound_data(job->source, job->source_length,
+                                    &job->width, &job->height,
+                                    &length) :
+            z_io__decode_sound(job->filename,
+                               &job->width, &job->height,
+                               &length);
+        job->length = (uint32_t)length;
+    } else if (job->type == SHIZResourceTypeFont) {
+        if (job->source != NULL) {
+            // the font is read from for as long as it is loaded; keep a copy
+            job->data = malloc(job->source_length);
+            
+            if (job->data != NULL) {
+                memcpy(job->data, job->source, job->source_length);
+                
+                job->length = job->source_length;
+            }
+        } else {
+            job->data = z_io__read_file(job->filename, &job->length);
+        }
+    }
+}
+
+static
+void
+z_async__finish(SHIZAsyncJob * const job)
+{
+    if (job->type == SHIZResourceTypeImage) {
+        z_res__finish_image(job->resource_id,
+                            job->width, job->height, job->components,
+                            job->data);
+        
+        if (job->data != NULL) {
+            z_io__free_image(job->data);
+        }
+    } else if (job->type == SHIZResourceTypeSound) {
+        z_res__finish_sound(job->resource_id,
+                            job->width, job->height,
+                            job->data, (int32_t)job->length);
+        
+        // the samples have been copied into the buffer of the sound
+        free(job->data);
+    } else if (job->type == SHIZResourceTypeFont) {
+        if (!z_res__finish_font(job->resource_id, job->data, job->length)) {
+            free(job->data);
+        }
+    }
+    
+    free(job);
+}
+
+static
+void
+z_async__discard(SHIZAsyncQueue * const queue)
+{
+    SHIZAsyncJob * job;
+    
+    while ((job = z_async__pop(queue)) != NULL) {
+        if (job->type == SHIZResourceTypeImage && job->data != NULL) {
+            z_io__free_image(job->data);
+        } else {
+            free(job->data);
+        }
+        
+        free(job);
+    }
+}
+
+static
+void
+z_async__push(SHIZAsyncQueue * const queue,
+              SHIZAsyncJob * const job)
+{
+    job->next = NULL;
+    
+    if (queue->last != NULL) {
+        queue->last->next = job;
+    } else {
+        queue->first = job;
+    }
+    
+    queue->last = job;
+}
+
+static
+SHIZAsyncJob *
+z_async__pop(SHIZAsyncQueue * const queue)
+{
+    SHIZAsyncJob * const job = queue->first;
+    
+    if (job != NULL) {
+        queue->first = job->next;
+        
+        if (queue->first == NULL) {
+            queue->last = NULL;
+        }
+    }
+    
+    return job;
+}
@@ -0,0 +1,76 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint32_t
+
+#include "res.h" // SHIZResourceType
+
+/**
+ * The max number of threads that resources are decoded on; otherwise, there
+ * is one for every processor but the one of the main thread.
+ */
+#define SHIZAsyncWorkerMax 16
+
+/**
+ * The time (in seconds) that may be spent each frame on creating the textures,
+ * sounds and fonts of resources that have finished decoding.
+ */
+#define SHIZAsyncFrameBudget (1.0 / 500)
+
+/**
+ * @brief Queue a file to be decoded in the background.
+ *
+ * The worker threads are started the first time anything is queued.
+ *
+ * @param filename
+ *        Copied; it does not have to outlive the call
+ * @param data
+ *        The contents of the file, if already in memory (e.g. in a pack);
+ *        otherwise `NULL` to read the file. The contents must stay in memory
+ *        until the file has been decoded
+ */
+bool z_async__queue(uint32_t resource_id, SHIZResourceType, char const * filename, uint8_t const * data, uint32_t length);
+
+/**
+ * @brief Queue a file that has changed on disk to be decoded again.
+ *
+ * Unlike z_async__queue, the file is read into memory before it is decoded,
+ * as it may still be changing (e.g. truncated by an editor saving it).
+ *
+ * @param filename
+ *        Copied; it does not have to outlive the call
+ */
+bool z_async__queue_reload(uint32_t resource_id, SHIZResourceType, char const * filename);
+
+/**
+ * @brief Finish resources that have been decoded, for as long as the budget
+ *        allows.
+ *
+ * At least one resource is finished per call (if any are decoded), so that
+ * loading always makes progress regardless of the budget.
+ */
+void z_async__process(double budget);
+
+/**
+ * @brief Finish everything queued, waiting for it to be decoded.
+ *
+ * Rather than only waiting, the calling thread decodes files alongside the
+ * worker threads until nothing is left to decode.
+ */
+void z_async__wait(void);
+
+/**
+ * @brief Stop the worker threads and discard anything not yet finished.
+ */
+void z_async__kill(void);
@@ -0,0 +1,897 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#if defined(__linux__) && !defined(_XOPEN_SOURCE)
+ #define _XOPEN_SOURCE 700 // clock_gettime, M_PI
+#endif
+
+#include "bus.h"
+
+#include <string.h> // memset
+#include <math.h> // M_PI, cosf, sinf
+#include <time.h> // timespec, clock_gettime
+#include <pthread.h> // pthread_*
+
+#if defined(__SSE2__) || defined(_M_X64)
+ #define SHIZ_SSE2
+ #include <emmintrin.h> // _mm_*
+#endif
+
+#include "internal.h" // ALuint, al*, glfwGetTime
+#include "io.h" // z_io__error
+#include "adpcm.h" // z_adpcm__*, SHIZADPCM*
+
+/**
+ * @brief Represents samples being mixed into the bus.
+ */
+typedef struct SHIZBusVoice {
+    int16_t const * samples;
+    /** The compressed samples, if not `samples` */
+    uint8_t const * blocks;
+    uint32_t frames;
+    /** The position in the samples (32.32 fixed point) */
+    uint64_t position;
+    /** The distance that the position advances for every sample of the bus */
+    uint64_t step;
+    /** The sample of the bus that the voice starts at (see
+        `z_bus__mixed_frames`); if already mixed, the voice starts right
+        away */
+    uint64_t start;
+    /** The gain of the left channel; including the panning */
+    float left;
+    /** The gain of the right channel; including the panning */
+    float right;
+    float pan;
+    uint8_t channels;
+    bool is_playing;
+} SHIZBusVoice;
+
+static void * z_bus__work(void * argument);
+static void z_bus__refill(void);
+
+static void z_bus__start(uint16_t voice, int16_t const * samples, uint8_t const * blocks, uint32_t frames, uint8_t channels, int32_t sample_rate, float gain, float pitch, float pan, uint64_t start);
+static void z_bus__pan(SHIZBusVoice *, float gain, float pan);
+
+static void z_bus__mix_voice(SHIZBusVoice *, float * bus, uint32_t frames);
+static void z_bus__mix_blocks(SHIZBusVoice const *, float * bus, uint32_t count);
+static void z_bus__mix_mono(SHIZBusVoice const *, float * bus, uint32_t count);
+static void z_bus__mix_stereo(SHIZBusVoice const *, float * bus, uint32_t count);
+static void z_bus__saturate(float const * bus, int16_t * samples, uint32_t frames);
+
+#ifdef SHIZ_SSE2
+static __m128i z_bus__offsets(uint64_t position, uint64_t step);
+static __m128 z_bus__fractions(__m128i offset);
+static void z_bus__mix_pairs(float * bus, __m128 left, __m128 right);
+#endif
+
+static pthread_t _worker;
+static bool _is_mixing = false;
+static bool _is_threaded = false;
+
+// guards every voice and the stopping flag
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _stopped = PTHREAD_COND_INITIALIZER;
+
+static bool _is_stopping = false;
+
+static SHIZBusVoice _voices[SHIZBusVoiceCount];
+
+static ALuint _source_id;
+static ALuint _buffer_ids[SHIZBusBufferCount];
+
+// only mixed into by one thread at a time (see z_bus__mix)
+static float _bus[SHIZBusBlockFrames * 2];
+static int16_t _block[SHIZBusBlockFrames * 2];
+static int16_t _decoded[SHIZBusDecodeBlocks * SHIZADPCMBlockFrames * 2];
+
+// in nanoseconds; along with the number of voices playing, published by
+// the mixing thread for any thread to read without waiting on it
+static uint64_t _mix_time = 0;
+static uint32_t _playing_count = 0;
+// the number of samples mixed so far
+static uint64_t _mixed_frames = 0;
+
+/**
+ * The factor that converts a sample to the range of -1 to 1.
+ */
+static float const SHIZBusSampleScale = 1.0f / 32768;
+/**
+ * The factor that converts a fixed point fraction to the range of 0 to 1.
+ */
+static float const SHIZBusFractionScale = 1.0f / 4294967296.0f;
+/**
+ * The step of a voice played at the rate of the bus; i.e. one sample for
+ * every sample of the bus.
+ */
+static uint64_t const SHIZBusStepUnit = (uint64_t)1 << 32;
+/**
+ * The largest step that is mixed 4 samples at a time; any larger and the
+ * positions within a block could overflow 16.16 fixed point.
+ */
+static uint64_t const SHIZBusVectorStepMax = (uint64_t)64 << 32;
+
+bool
+z_bus__init(bool const threaded)
+{
+    if (_is_mixing) {
+        return true;
+    }
+    
+    memset(_voices, 0, sizeof(_voices));
+    
+    alGetError();
+    alGenSources(1, &_source_id);
+    
+    if (alGetError() != AL_NO_ERROR) {
+        z_io__error("could not mix sounds; no source");
+        
+        return false;
+    }
+    
+    alGenBuffers(SHIZBusBufferCount, _buffer_ids);
+    
+    alSource3f(_source_id, AL_POSITION, 0, 0, 0);
+    alSource3f(_source_id, AL_VELOCITY, 0, 0, 0);
+    alSourcei(_source_id, AL_SOURCE_RELATIVE, AL_TRUE);
+    alSourcei(_source_id, AL_LOOPING, AL_FALSE);
+    
+    // begin with silence in every buffer; the voices are mixed in as the
+    // buffers are played and refilled
+    for (uint8_t i = 0; i < SHIZBusBufferCount; i++) {
+        z_bus__mix(_block, SHIZBusBlockFrames);
+        
+        alBufferData(_buffer_ids[i], AL_FORMAT_STEREO16, _block,
+                     (ALsizei)sizeof(_block), SHIZBusSampleRate);
+    }
+    
+    alSourceQueueBuffers(_source_id, SHIZBusBufferCount, _buffer_ids);
+    alSourcePlay(_source_id);
+    
+    if (threaded && pthread_create(&_worker, NULL, z_bus__work, NULL) != 0) {
+        z_io__error("could not mix sounds; no thread");
+        
+        alSourceStop(_source_id);
+        alSourcei(_source_id, AL_BUFFER, 0);
+        
+        alDeleteSources(1, &_source_id);
+        alDeleteBuffers(SHIZBusBufferCount, _buffer_ids);
+        
+        return false;
+    }
+    
+    _is_mixing = true;
+    _is_threaded = threaded;
+    
+    return true;
+}
+
+void
+z_bus__kill()
+{
+    if (!_is_mixing) {
+        return;
+    }
+    
+    if (_is_threaded) {
+        pthread_mutex_lock(&_mutex);
+        
+        _is_stopping = true;
+        
+        pthread_cond_signal(&_stopped);
+        pthread_mutex_unlock(&_mutex);
+        
+        pthread_join(_worker, NULL);
+    }
+    
+    _is_stopping = false;
+    _is_mixing = false;
+    _is_threaded = false;
+    
+    _mixed_frames = 0;
+    
+    alSourceStop(_source_id);
+    alSourcei(_source_id, AL_BUFFER, 0);
+    
+    alDeleteSources(1, &_source_id);
+    alDeleteBuffers(SHIZBusBufferCount, _buffer_ids);
+    
+    memset(_voices, 0, sizeof(_voices));
+    
+    __atomic_store_n(&_playing_count, 0, __ATOMIC_RELAXED);
+}
+
+void
+z_bus__update()
+{
+    if (!_is_mixing || _is_threaded) {
+        return;
+    }
+    
+    z_bus__refill();
+}
+
+void
+z_bus__play(uint16_t const voice_index,
+            int16_t const * const samples,
+            uint32_t const frames,
+            uint8_t const channels,
+            int32_t const sample_rate,
+            float const gain,
+            float const pitch,
+            float const pan,
+            uint64_t const start)
+{
+    z_bus__start(voice_index, samples, NULL, frames, channels, sample_rate,
+                 gain, pitch, pan, start);
+}
+
+void
+z_bus__play_compressed(uint16_t const voice_index,
+                       uint8_t const * const blocks,
+                       uint32_t const frames,
+                       uint8_t const channels,
+                       int32_t const sample_rate,
+                       float const gain,
+                       float const pitch,
+                       float const pan,
+                       uint64_t const start)
+{
+    z_bus__start(voice_index, NULL, blocks, frames, channels, sample_rate,
+                 gain, pitch, pan, start);
+}
+
+void
+z_bus__stop(uint16_t const voice_index)
+{
+    if (voice_index >= SHIZBusVoiceCount) {
+        return;
+    }
+    
+    // once unlocked, the samples are no longer read
+    pthread_mutex_lock(&_mutex);
+    
+    _voices[voice_index].is_playing = false;
+    _voices[voice_index].samples = NULL;
+    _voices[voice_index].blocks = NULL;
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+void
+z_bus__set_gain(uint16_t const voice_index,
+                float const gain)
+{
+    if (voice_index >= SHIZBusVoiceCount) {
+        return;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    SHIZBusVoice * const voice = &_voices[voice_index];
+    
+    z_bus__pan(voice, gain, voice->pan);
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+bool
+z_bus__is_playing(uint16_t const voice_index)
+{
+    if (voice_index >= SHIZBusVoiceCount) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    bool const is_playing = _voices[voice_index].is_playing;
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return is_playing;
+}
+
+void
+z_bus__get_playing(bool * const playing,
+                   uint16_t const count)
+{
+    pthread_mutex_lock(&_mutex);
+    
+    for (uint16_t i = 0; i < count && i < SHIZBusVoiceCount; i++) {
+        playing[i] = _voices[i].is_playing;
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+uint64_t
+z_bus__mixed_frames()
+{
+    pthread_mutex_lock(&_mutex);
+    
+    uint64_t const mixed_frames = _mixed_frames;
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return mixed_frames;
+}
+
+uint32_t
+z_bus__playing_count()
+{
+    return __atomic_load_n(&_playing_count, __ATOMIC_RELAXED);
+}
+
+double
+z_bus__mix_time()
+{
+    uint64_t const mix_time = __atomic_load_n(&_mix_time, __ATOMIC_RELAXED);
+    
+    return (double)mix_time / 1000000000.0;
+}
+
+void
+z_bus__mix(int16_t * const samples,
+           uint32_t const frames)
+{
+    pthread_mutex_lock(&_mutex);
+    
+    double const start = glfwGetTime();
+    
+    for (uint32_t offset = 0; offset < frames; offset += SHIZBusBlockFrames) {
+        uint32_t const block_frames = frames - offset < SHIZBusBlockFrames ?
+            frames - offset : SHIZBusBlockFrames;
+        
+        memset(_bus, 0, sizeof(_bus));
+        
+        for (uint16_t i = 0; i < SHIZBusVoiceCount; i++) {
+            SHIZBusVoice * const voice = &_voices[i];
+            
+            if (!voice->is_playing ||
+                voice->start >= _mixed_frames + block_frames) {
+                continue;
+            }
+            
+            // a voice that starts within the block begins partway through it
+            uint32_t const delay = voice->start > _mixed_frames ?
+                (uint32_t)(voice->start - _mixed_frames) : 0;
+            
+            z_bus__mix_voice(voice, _bus + delay * 2, block_frames - delay);
+        }
+        
+        z_bus__saturate(_bus, samples + offset * 2, block_frames);
+        
+        _mixed_frames += block_frames;
+    }
+    
+    uint32_t playing_count = 0;
+    
+    for (uint16_t i = 0; i < SHIZBusVoiceCount; i++) {
+        if (_voices[i].is_playing) {
+            playing_count += 1;
+        }
+    }
+    
+    __atomic_store_n(&_playing_count, playing_count, __ATOMIC_RELAXED);
+    __atomic_store_n(&_mix_time,
+                     (uint64_t)((glfwGetTime() - start) * 1000000000.0),
+                     __ATOMIC_RELAXED);
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+static
+void *
+z_bus__work(void * const argument)
+{
+    (void)argument;
+    
+    pthread_mutex_lock(&_mutex);
+    
+    while (!_is_stopping) {
+        pthread_mutex_unlock(&_mutex);
+        
+        z_bus__refill();
+        
+        pthread_mutex_lock(&_mutex);
+        
+        if (_is_stopping) {
+            break;
+        }
+        
+        // check back twice per block, so that a played buffer is never left
+        // empty for long
+        struct timespec deadline;
+        
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        
+        deadline.tv_nsec += (long)(1000000000.0 / 2 *
+                                   SHIZBusBlockFrames / SHIZBusSampleRate);
+        
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        
+        pthread_cond_timedwait(&_stopped, &_mutex, &deadline);
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return NULL;
+}
+
+static
+void
+z_bus__refill()
+{
+    ALint processed = 0;
+    
+    alGetSourcei(_source_id, AL_BUFFERS_PROCESSED, &processed);
+    
+    while (processed > 0) {
+        ALuint buffer_id;
+        
+        alSourceUnqueueBuffers(_source_id, 1, &buffer_id);
+        
+        z_bus__mix(_block, SHIZBusBlockFrames);
+        
+        alBufferData(buffer_id, AL_FORMAT_STEREO16, _block,
+                     (ALsizei)sizeof(_block), SHIZBusSampleRate);
+        alSourceQueueBuffers(_source_id, 1, &buffer_id);
+        
+        processed -= 1;
+    }
+    
+    ALint state = AL_STOPPED;
+    
+    alGetSourcei(_source_id, AL_SOURCE_STATE, &state);
+    
+    if (state != AL_PLAYING) {
+        // every buffer played before it could be refilled; carry on
+        alSourcePlay(_source_id);
+    }
+}
+
+static
+void
+z_bus__start(uint16_t const voice_index,
+             int16_t const * const samples,
+             uint8_t const * const blocks,
+             uint32_t const frames,
+             uint8_t const channels,
+             int32_t const sample_rate,
+             float const gain,
+             float const pitch,
+             float const pan,
+             uint64_t const start)
+{
+    if (voice_index >= SHIZBusVoiceCount) {
+        return;
+    }
+    
+    // the step is unsigned; converting a negative (or NaN) pitch to it would
+    // be undefined, as would converting one too large to fit
+    float const clamped_pitch = !(pitch >= SHIZBusPitchMin) ? SHIZBusPitchMin :
+        (pitch > SHIZBusPitchMax ? SHIZBusPitchMax : pitch);
+    
+    uint64_t step = (uint64_t)((double)sample_rate * clamped_pitch /
+                               SHIZBusSampleRate * 4294967296.0);
+    
+    if (step == 0) {
+        step = 1;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    SHIZBusVoice * const voice = &_voices[voice_index];
+    
+    voice->samples = samples;
+    voice->blocks = blocks;
+    voice->frames = frames;
+    voice->position = 0;
+    voice->step = step;
+    voice->start = start;
+    voice->channels = channels > 1 ? 2 : 1;
+    voice->is_playing = (samples != NULL || blocks != NULL) && frames > 1;
+    
+    z_bus__pan(voice, gain, pan);
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+static
+void
+z_bus__pan(SHIZBusVoice * const voice,
+           float const gain,
+           float const pan)
+{
+    voice->pan = pan;
+    
+    if (voice->channels > 1) {
+        // a stereo sound is balanced; the opposite channel is faded out
+        voice->left = gain * (pan > 0 ? 1 - pan : 1);
+        voice->right = gain * (pan < 0 ? 1 + pan : 1);
+    } else {
+        // a mono sound is panned at constant power; i.e. equally loud at
+        // any position
+        float const angle = (pan + 1) * (float)M_PI / 4;
+        
+        voice->left = gain * cosf(angle);
+        voice->right = gain * sinf(angle);
+    }
+}
+
+static
+void
+z_bus__mix_voice(SHIZBusVoice * const voice,
+                 float * const bus,
+                 uint32_t const frames)
+{
+    // every sample is interpolated between two samples of the voice, so the
+    // voice ends once the position reaches its last sample
+    uint64_t const end = (uint64_t)(voice->frames - 1) << 32;
+    
+    if (voice->position >= end) {
+        voice->is_playing = false;
+        
+        return;
+    }
+    
+    uint64_t const remaining =
+        (end - voice->position + voice->step - 1) / voice->step;
+    
+    uint32_t const count = remaining < frames ?
+        (uint32_t)remaining : frames;
+    
+    if (voice->blocks != NULL) {
+        z_bus__mix_blocks(voice, bus, count);
+    } else if (voice->channels > 1) {
+        z_bus__mix_stereo(voice, bus, count);
+    } else {
+        z_bus__mix_mono(voice, bus, count);
+    }
+    
+    voice->position += voice->step * count;
+    
+    if (count < frames) {
+        voice->is_playing = false;
+    }
+}
+
+static
+void
+z_bus__mix_blocks(SHIZBusVoice const * const voice,
+                  float * const bus,
+                  uint32_t const count)
+{
+    uint32_t const block_count = z_adpcm__blocks(voice->frames);
+    uint32_t const block_size = SHIZADPCMBlockSize * voice->channels;
+    
+    // the decoded samples are mixed as if they were all of the samples
+    SHIZBusVoice decoded = *voice;
+    
+    decoded.samples = _decoded;
+    
+    uint64_t position = voice->position;
+    uint32_t mixed = 0;
+    
+    while (mixed < count) {
+        uint32_t const block = (uint32_t)(position >> 32) / SHIZADPCMBlockFrames;
+        uint32_t const blocks = block_count - block < SHIZBusDecodeBlocks ?
+            block_count - block : SHIZBusDecodeBlocks;
+        
+        uint64_t const first = (uint64_t)(block * SHIZADPCMBlockFrames) << 32;
+        // every sample is interpolated with the next, so stop before the
+        // last sample decoded
+        uint64_t const last = first +
+            ((uint64_t)(blocks * SHIZADPCMBlockFrames - 1) << 32);
+        
+        uint64_t const available =
+            (last - position + voice->step - 1) / voice->step;
+        
+        uint32_t const frames = available < count - mixed ?
+            (uint32_t)available : count - mixed;
+        
+        if (frames == 0) {
+            break;
+        }
+        
+        // only decode as far as the last sample interpolated with
+        uint32_t const end = (uint32_t)((position +
+                                         voice->step * (frames - 1)) >> 32) + 1;
+        uint32_t const needed = end / SHIZADPCMBlockFrames - block + 1;
+        
+        z_adpcm__decode(voice->blocks + block * block_size,
+                        needed < blocks ? needed : blocks,
+                        voice->channels, _decoded);
+        
+        decoded.position = position - first;
+        
+        if (voice->channels > 1) {
+            z_bus__mix_stereo(&decoded, bus + mixed * 2, frames);
+        } else {
+            z_bus__mix_mono(&decoded, bus + mixed * 2, frames);
+        }
+        
+        position += voice->step * frames;
+        mixed += frames;
+    }
+}
+
+static
+void
+z_bus__mix_mono(SHIZBusVoice const * const voice,
+                float * const bus,
+                uint32_t const count)
+{
+    int16_t const * const samples = voice->samples;
+    
+    uint64_t position = voice->position;
+    uint64_t const step = voice->step;
+    
+    uint32_t i = 0;
+
+#ifdef SHIZ_SSE2
+    int16_t const * const first = samples + (position >> 32);
+    
+    __m128 const left = _mm_set1_ps(voice->left * SHIZBusSampleScale);
+    __m128 const right = _mm_set1_ps(voice->right * SHIZBusSampleScale);
+    
+    if (step == SHIZBusStepUnit && (uint32_t)position == 0) {
+        // nothing to resample; every sample is read as is
+        for (; i + 4 <= count; i += 4) {
+            __m128i const packed =
+                _mm_loadl_epi64((__m128i const *)(first + i));
+            __m128 const sample =
+                _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed,
+                                                                  packed), 16));
+            
+            z_bus__mix_pairs(bus + i * 2,
+                             _mm_mul_ps(sample, left),
+                             _mm_mul_ps(sample, right));
+        }
+    } else if (step < SHIZBusVectorStepMax) {
+        __m128i offset = z_bus__offsets(position, step);
+        
+        __m128i const advance =
+            _mm_set1_epi32((int32_t)((uint32_t)(step >> 16) * 4));
+        
+        for (; i + 4 <= count; i += 4) {
+            int32_t index[4];
+            
+            _mm_storeu_si128((__m128i *)index, _mm_srli_epi32(offset, 16));
+            
+            __m128 const from = _mm_setr_ps(first[index[0]],
+                                            first[index[1]],
+                                            first[index[2]],
+                                            first[index[3]]);
+            __m128 const to = _mm_setr_ps(first[index[0] + 1],
+                                          first[index[1] + 1],
+                                          first[index[2] + 1],
+                                          first[index[3] + 1]);
+            
+            __m128 const sample =
+                _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from),
+                                            z_bus__fractions(offset)));
+            
+            z_bus__mix_pairs(bus + i * 2,
+                             _mm_mul_ps(sample, left),
+                             _mm_mul_ps(sample, right));
+            
+            offset = _mm_add_epi32(offset, advance);
+        }
+    }
+    
+    position += step * i;
+#endif
+
+    for (; i < count; i++) {
+        uint32_t const index = (uint32_t)(position >> 32);
+        
+        float const from = samples[index];
+        float const to = samples[index + 1];
+        float const fraction = (float)(uint32_t)position * SHIZBusFractionScale;
+        
+        float const sample = (from + (to - from) * fraction) * SHIZBusSampleScale;
+        
+        bus[i * 2] += sample * voice->left;
+        bus[i * 2 + 1] += sample * voice->right;
+        
+        position += step;
+    }
+}
+
+static
+void
+z_bus__mix_stereo(SHIZBusVoice const * const voice,
+                  float * const bus,
+                  uint32_t const count)
+{
+    int16_t const * const samples = voice->samples;
+    
+    uint64_t position = voice->position;
+    uint64_t const step = voice->step;
+    
+    uint32_t i = 0;
+
+#ifdef SHIZ_SSE2
+    int16_t const * const first = samples + (position >> 32) * 2;
+    
+    __m128 const gain = _mm_setr_ps(voice->left * SHIZBusSampleScale,
+                                    voice->right * SHIZBusSampleScale,
+                                    voice->left * SHIZBusSampleScale,
+                                    voice->right * SHIZBusSampleScale);
+    
+    if (step == SHIZBusStepUnit && (uint32_t)position == 0) {
+        for (; i + 4 <= count; i += 4) {
+            __m128i const packed =
+                _mm_loadu_si128((__m128i const *)(first + i * 2));
+            
+            __m128 const low =
+                _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed,
+                                                                  packed), 16));
+            __m128 const high =
+                _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(packed,
+                                                                  packed), 16));
+            
+            float * const out = bus + i * 2;
+            
+            _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out),
+                                          _mm_mul_ps(low, gain)));
+            _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4),
+                                              _mm_mul_ps(high, gain)));
+        }
+    } else if (step < SHIZBusVectorStepMax) {
+        __m128i offset = z_bus__offsets(position, step);
+        
+        __m128i const advance =
+            _mm_set1_epi32((int32_t)((uint32_t)(step >> 16) * 4));
+        
+        for (; i + 4 <= count; i += 4) {
+            int32_t index[4];
+            
+            _mm_storeu_si128((__m128i *)index,
+                             _mm_slli_epi32(_mm_srli_epi32(offset, 16), 1));
+            
+            __m128 const fraction = z_bus__fractions(offset);
+            
+            // the first two samples (of both channels), then the last two
+            for (uint8_t k = 0; k < 4; k += 2) {
+                int16_t const * const a = first + index[k];
+                int16_t const * const b = first + index[k + 1];
+                
+                __m128 const from = _mm_setr_ps(a[0], a[1], b[0], b[1]);
+                __m128 const to = _mm_setr_ps(a[2], a[3], b[2], b[3]);
+                
+                __m128 const t = k == 0 ?
+                    _mm_unpacklo_ps(fraction, fraction) :
+                    _mm_unpackhi_ps(fraction, fraction);
+                
+                __m128 const sample =
+                    _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), t));
+                
+                float * const out = bus + (i + k) * 2;
+                
+                _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out),
+                                              _mm_mul_ps(sample, gain)));
+            }
+            
+            offset = _mm_add_epi32(offset, advance);
+        }
+    }
+    
+    position += step * i;
+#endif
+
+    for (; i < count; i++) {
+        uint32_t const index = (uint32_t)(position >> 32) * 2;
+        
+        float const fraction = (float)(uint32_t)position * SHIZBusFractionScale;
+        
+        for (uint8_t channel = 0; channel < 2; channel++) {
+            float const from = samples[index + channel];
+            float const to = samples[index + 2 + channel];
+            
+            float const sample =
+                (from + (to - from) * fraction) * SHIZBusSampleScale;
+            
+            bus[i * 2 + channel] += sample *
+                (channel == 0 ? voice->left : voice->right);
+        }
+        
+        position += step;
+    }
+}
+
+#ifdef SHIZ_SSE2
+static
+__m128i
+z_bus__offsets(uint64_t const position,
+               uint64_t const step)
+{
+    // the positions of the next 4 samples, relative to the current sample, in
+    // 16.16 fixed point; truncating to 16 bits only ever lands on an earlier
+    // sample, so never past the end
+    uint32_t const offset = (uint32_t)position >> 16;
+    uint32_t const offset_step = (uint32_t)(step >> 16);
+    
+    return _mm_setr_epi32((int32_t)offset,
+                          (int32_t)(offset + offset_step),
+                          (int32_t)(offset + offset_step * 2),
+                          (int32_t)(offset + offset_step * 3));
+}
+
+static
+__m128
+z_bus__fractions(__m128i const offset)
+{
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(offset,
+                                                    _mm_set1_epi32(0xffff))),
+                      _mm_set1_ps(1.0f / 65536));
+}
+
+static
+void
+z_bus__mix_pairs(float * const bus,
+                 __m128 const left,
+                 __m128 const right)
+{
+    // interleave into left and right pairs
+    _mm_storeu_ps(bus, _mm_add_ps(_mm_loadu_ps(bus),
+                                  _mm_unpacklo_ps(left, right)));
+    _mm_storeu_ps(bus + 4, _mm_add_ps(_mm_loadu_ps(bus + 4),
+                                      _mm_unpackhi_ps(left, right)));
+}
+#endif
+
+static
+void
+z_bus__saturate(float const * const bus,
+                int16_t * const samples,
+                uint32_t const frames)
+{
+    uint32_t const count = frames * 2;
+    
+    uint32_t i = 0;
+
+#ifdef SHIZ_SSE2
+    __m128 const scale = _mm_set1_ps(32767);
+    __m128 const min = _mm_set1_ps(-32768);
+    __m128 const max = _mm_set1_ps(32767);
+    
+    for (; i + 8 <= count; i += 8) {
+        // clamp before converting; anything out of range would otherwise
+        // convert to the lowest value, however loud
+        __m128 const first =
+            _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(bus + i), scale),
+                                  min), max);
+        __m128 const second =
+            _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(bus + i + 4), scale),
+                                  min), max);
+        
+        _mm_storeu_si128((__m128i *)(samples + i),
+                         _mm_packs_epi32(_mm_cvtps_epi32(first),
+                                         _mm_cvtps_epi32(second)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        float sample = bus[i] * 32767;
+        
+        if (sample > 32767) {
+            sample = 32767;
+        } else if (sample < -32768) {
+            sample = -32768;
+        }
+        
+        samples[i] = (int16_t)sample;
+    }
+}
@@ -0,0 +1,127 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t, uint16_t, int16_t, uint32_t, int32_t
+
+/**
+ * The max number of voices mixed at the same time.
+ */
+#define SHIZBusVoiceCount 512
+/**
+ * The sample rate of the bus; every voice is resampled to this rate.
+ */
+#define SHIZBusSampleRate 48000
+/**
+ * The number of samples mixed at a time (10ms); a multiple of 4, so that
+ * every block is mixed 4 samples at a time.
+ */
+#define SHIZBusBlockFrames 480
+/**
+ * The number of blocks queued for playback at any time; i.e. the latency of
+ * the bus, in blocks.
+ */
+#define SHIZBusBufferCount 4
+/**
+ * The number of compressed blocks (see `z_adpcm`) decoded at a time while
+ * mixing a voice; a block is 65 samples.
+ */
+#define SHIZBusDecodeBlocks 16
+/**
+ * The range of pitch that a voice plays at; any pitch outside (including
+ * zero or negative) is clamped to it.
+ */
+#define SHIZBusPitchMin (1.0f / 64)
+#define SHIZBusPitchMax 64.0f
+
+/**
+ * @brief Begin mixing voices in software.
+ *
+ * Voices are mixed into a single bus, and the bus is played through a single
+ * OpenAL source; so the number of voices is not limited by the number of
+ * sources available.
+ *
+ * @param threaded
+ *        Whether the bus is mixed on a thread of its own, as its buffers are
+ *        played; otherwise `z_bus__update` must be called instead
+ *
+ * @return `true` if mixing, `false` otherwise
+ */
+bool z_bus__init(bool threaded);
+void z_bus__kill(void);
+
+/**
+ * @brief Mix into every buffer that has been played, and queue it again.
+ *
+ * Only needed when not mixing on a thread of its own; e.g. when sound is
+ * rendered into memory, so that the mixing is in step with the rendering.
+ */
+void z_bus__update(void);
+
+/**
+ * @brief Play samples on a voice, replacing anything it was playing.
+ *
+ * The samples are read while mixing, and must stay in memory until the
+ * voice has been stopped, or has finished playing.
+ *
+ * @param pan
+ *        The position of the sound between the left (-1) and right (1)
+ *        speaker; 0 is centered
+ * @param start
+ *        The sample of the bus that the voice starts playing at (see
+ *        `z_bus__mixed_frames`); e.g. 0 to start right away
+ */
+void z_bus__play(uint16_t voice, int16_t const * samples, uint32_t frames, uint8_t channels, int32_t sample_rate, float gain, float pitch, float pan, uint64_t start);
+/**
+ * @brief Play compressed samples on a voice (see `z_adpcm`).
+ *
+ * Only the blocks about to be mixed are decoded, into a buffer shared by
+ * every voice; so the samples stay compressed in memory while playing.
+ */
+void z_bus__play_compressed(uint16_t voice, uint8_t const * blocks, uint32_t frames, uint8_t channels, int32_t sample_rate, float gain, float pitch, float pan, uint64_t start);
+void z_bus__stop(uint16_t voice);
+void z_bus__set_gain(uint16_t voice, float gain);
+
+bool z_bus__is_playing(uint16_t voice);
+/**
+ * @brief Determine which of the first voices are playing, all at once.
+ */
+void z_bus__get_playing(bool * playing, uint16_t count);
+
+/**
+ * @brief Determine the number of samples mixed so far; i.e. the sample that
+ *        the next block begins at.
+ *
+ * The bus is mixed ahead of playing, so the sample is heard a little later.
+ */
+uint64_t z_bus__mixed_frames(void);
+
+/**
+ * @brief Determine the number of voices playing as of the most recent block.
+ *
+ * Like `z_bus__mix_time`, this never waits on the bus; so it can be called
+ * from any thread, however busy mixing.
+ */
+uint32_t z_bus__playing_count(void);
+/**
+ * @brief Determine the time (in seconds) spent mixing the most recent block.
+ */
+double z_bus__mix_time(void);
+
+/**
+ * @brief Mix every playing voice into a block of samples.
+ *
+ * This is what the thread does for every block; the samples are stereo,
+ * and saturated to 16 bits.
+ */
+void z_bus__mix(int16_t * samples, uint32_t frames);
@@ -26,6 +26,7 @@ char const * const SHIZDebugEventNamePrimitive = "◘";
 char const * const SHIZDebugEventNameFlush = "fls";
 char const * const SHIZDebugEventNameFlushByCapacity = "fls|cap";
 char const * const SHIZDebugEventNameFlushByTextureSwitch = "fls|tex";
+char const * const SHIZDebugEventNameInstanced = "ins";
 
 typedef struct SHIZDebugContext {
     SHIZSpriteFont font;
@@ -32,6 +32,7 @@ extern char const * const SHIZDebugEventNamePrimitive;
 extern char const * const SHIZDebugEventNameFlush;
 extern char const * const SHIZDebugEventNameFlushByCapacity;
 extern char const * const SHIZDebugEventNameFlushByTextureSwitch;
+extern char const * const SHIZDebugEventNameInstanced;
 
 bool z_debug__init(void);
 bool z_debug__kill(void);
@@ -71,6 +72,6 @@ bool z_debug__load_font(uint8_t const * buffer, uint32_t length);
 bool z_debug__unload_font(void);
 
 SHIZSpriteFont z_debug__get_font(void);
-uint8_t z_debug__get_font_resource(void);
+uint32_t z_debug__get_font_resource(void);
 
 #endif
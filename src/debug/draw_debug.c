@@ -15,6 +15,7 @@
 
 #include <SHIZEN/ztime.h>
 #include <SHIZEN/zdraw.h>
+#include <SHIZEN/zsound.h>
 
 #include "debug.h"
 #include "profiler.h"
@@ -43,7 +44,7 @@ z_debug__draw_rect_bounds_ex(SHIZRect rect,
 
 extern SHIZGraphicsContext const _graphics_context;
 
-static char _stats_buffer[256] = { 0 };
+static char _stats_buffer[384] = { 0 };
 
 void
 z_debug__build_stats()
@@ -69,6 +70,17 @@ z_debug__build_stats()
     
     SHIZProfilerStats const frame_stats = z_profiler__get_stats();
     
+    SHIZSoundUsage const sound_usage = z_get_sound_usage();
+    
+    char sound_buffer[64] = { 0 };
+    
+    if (sound_usage.audio_time > 0) {
+        // while rendering sound into memory, its cost per second of sound
+        sprintf(sound_buffer, "\n\2%0.2fms mix/s\1 (\4%0.2fms decode/s\1)",
+                sound_usage.render_time / sound_usage.audio_time * 1000,
+                sound_usage.decode_time / sound_usage.audio_time * 1000);
+    }
+    
     bool const is_vsync_enabled = _graphics_context.swap_interval > 0;
     
     if (z_debug__is_expanded()) {
@@ -78,9 +90,10 @@ z_debug__build_stats()
                 "\2%0.2fms/frame\1 (\4%0.2fms\1)\n"
                 "\2%d fps\1 (\3%d↓\1 \4%d↕\1 \5%d↑\1%s)\n\n"
                 "%c%d/%d sprites/frame\1\n"
-                "\2%d draws/frame\1\n\n"
+                "\2%d draws/frame\1\n"
+                "\2%d/%d text hits/frame\1\n\n"
                 "\4%0.2fms\1/\2%0.2fms/tick\1\n"
-                "\2%.1fx time\1",
+                "\2%.1fx time\1%s",
                 display_size_buffer,
                 frame_stats.frame_time,
                 frame_stats.frame_time_avg,
@@ -91,9 +104,12 @@ z_debug__build_stats()
                 is_vsync_enabled ? " \2V\1" : "",
                 sprite_count_tint_specifier, sprite_count, SHIZSpriteMax,
                 frame_stats.draw_count,
+                frame_stats.text_cache_hits,
+                frame_stats.text_cache_hits + frame_stats.text_cache_misses,
                 z_time__get_lag() * 1000,
                 z_time_get_tick_rate() * 1000,
-                z_time_get_scale());
+                z_time_get_scale(),
+                sound_buffer);
     } else {
         sprintf(_stats_buffer,
                 "\2%d fps%s\1",
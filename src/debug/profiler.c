@@ -39,6 +39,8 @@ bool
 z_profiler__init()
 {
     _stats.draw_count = 0;
+    _stats.text_cache_hits = 0;
+    _stats.text_cache_misses = 0;
     _stats.frame_time = 0;
     _stats.frame_time_avg = 0;
     _stats.frames_per_second = 0;
@@ -59,6 +61,8 @@ void
 z_profiler__begin()
 {
     _stats.draw_count = 0;
+    _stats.text_cache_hits = 0;
+    _stats.text_cache_misses = 0;
 }
 
 void
@@ -69,6 +73,22 @@ z_profiler__increment_draw_count(uint8_t const amount)
     }
 }
 
+void
+z_profiler__increment_text_cache_hits()
+{
+    if (_is_profiling) {
+        _stats.text_cache_hits += 1;
+    }
+}
+
+void
+z_profiler__increment_text_cache_misses()
+{
+    if (_is_profiling) {
+        _stats.text_cache_misses += 1;
+    }
+}
+
 void
 z_profiler__end()
 {
@@ -24,6 +24,8 @@ typedef struct SHIZProfilerStats {
     uint16_t frames_per_second_max;
     uint16_t frames_per_second_avg;
     uint16_t draw_count;
+    uint16_t text_cache_hits;
+    uint16_t text_cache_misses;
 } SHIZProfilerStats;
 
 bool
@@ -41,6 +43,12 @@ z_profiler__end(void);
 void
 z_profiler__increment_draw_count(uint8_t amount);
 
+void
+z_profiler__increment_text_cache_hits(void);
+
+void
+z_profiler__increment_text_cache_misses(void);
+
 void
 z_profiler__set_is_profiling(bool enabled);
 
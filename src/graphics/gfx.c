@@ -19,6 +19,7 @@
 #include "shader.h"
 #include "spritebatch.h"
 #include "immediate.h"
+#include "instanced.h"
 
 #ifdef SHIZ_DEBUG
  #include "../debug/debug.h"
@@ -26,6 +27,8 @@
 #endif
 
 #include <stdbool.h>
+#include <stdlib.h> // calloc, free
+#include <string.h> // memcpy
 
 #include <SHIZEN/zloader.h>
 
@@ -42,9 +45,41 @@ static bool z_gfx__kill_post(void);
 static void z_gfx__render_post(void);
 
 static bool z_gfx__load_default_texture(void);
+static void z_gfx__specify_texture(int32_t width, int32_t height, int32_t components, uint8_t const * data);
+static void z_gfx__parameterize_texture(int32_t components);
+
+static void z_gfx__upload_textures(uint32_t budget);
+static void z_gfx__kill_uploads(void);
 
 #define VERTEX_COUNT_PER_FRAME 4
 
+/**
+ * The max number of idle pixel buffers kept around for upcoming uploads.
+ */
+#define SHIZGFXUploadBufferMax 4
+
+/**
+ * @brief Represents the pixels of a texture staged in a pixel buffer.
+ */
+typedef struct SHIZGFXUpload {
+    struct SHIZGFXUpload * next;
+    /** The image that the texture is created for; `NULL` once uploaded */
+    SHIZResourceImage * resource;
+    /** Signaled once the pixel buffer is no longer read from */
+    GLsync fence;
+    GLuint buffer;
+    /** The size (in bytes) of the pixel buffer */
+    uint32_t capacity;
+    int32_t width;
+    int32_t height;
+    int32_t components;
+} SHIZGFXUpload;
+
+typedef struct SHIZGFXUploadQueue {
+    SHIZGFXUpload * first;
+    SHIZGFXUpload * last;
+} SHIZGFXUploadQueue;
+
 typedef struct SHIZGFXPost {
     SHIZRenderObject render;
     GLuint texture_id;
@@ -54,6 +89,11 @@ typedef struct SHIZGFXPost {
 
 static SHIZGFXPost _post;
 
+static SHIZGFXUploadQueue _staged; // waiting to be uploaded, in order
+static SHIZGFXUpload * _uploading = NULL; // uploaded, waiting on fences
+static SHIZGFXUpload * _idle = NULL; // buffers ready to be staged into
+static uint8_t _idle_count = 0;
+
 bool
 z_gfx__init(SHIZViewport const viewport)
 {
@@ -71,6 +111,12 @@ z_gfx__init(SHIZViewport const viewport)
         return false;
     }
 
+    if (!z_gfx__init_instanced()) {
+        z_io__error_context("GFX", "Could not initialize instanced renderer");
+        
+        return false;
+    }
+
     if (!z_gfx__init_post()) {
         z_io__error_context("GFX", "Could not initialize post renderer");
         
@@ -95,7 +141,9 @@ z_gfx__init(SHIZViewport const viewport)
 bool
 z_gfx__kill()
 {
-    if (!z_unload(_spr_white_1x1.resource_id)) {
+    // the texture may already have been unloaded along with every other resource
+    if (z_res__image(_spr_white_1x1.resource_id) != NULL &&
+        !z_unload(_spr_white_1x1.resource_id)) {
         return false;
     }
     
@@ -110,10 +158,16 @@ z_gfx__kill()
         return false;
     }
 
+    if (!z_gfx__kill_instanced()) {
+        return false;
+    }
+
     if (!z_gfx__kill_post()) {
         return false;
     }
     
+    z_gfx__kill_uploads();
+    
 #ifdef SHIZ_DEBUG
     if (!z_profiler__kill()) {
         return false;
@@ -131,6 +185,8 @@ z_gfx__begin(SHIZColor const clear)
 #endif
 
     z_gfx__spritebatch_reset();
+    
+    z_gfx__upload_textures(SHIZGFXUploadBudget);
 
     SHIZViewport const viewport = z_viewport__get();
     
@@ -182,7 +238,9 @@ z_gfx__end()
 void
 z_gfx__flush()
 {
+    z_gfx__flush_immediate();
     z_gfx__spritebatch_flush();
+    z_gfx__flush_instanced();
 }
 
 void
@@ -203,6 +261,38 @@ z_gfx__render_ex(GLenum const mode,
     z_gfx__render_immediate(mode, vertices, count, origin, angle);
 }
 
+SHIZVertexPositionColor *
+z_gfx__reserve(uint32_t const count)
+{
+    return z_gfx__reserve_immediate(count);
+}
+
+SHIZVertexPositionColor *
+z_gfx__reserve_triangles(uint32_t const count)
+{
+    return z_gfx__reserve_triangles_immediate(count);
+}
+
+void
+z_gfx__queue_triangles(uint32_t const count)
+{
+    z_gfx__queue_triangles_immediate(count);
+}
+
+SHIZInstance *
+z_gfx__reserve_instances(uint32_t const count)
+{
+    return z_gfx__reserve_instanced(count);
+}
+
+void
+z_gfx__queue_instances(uint32_t const count,
+                       float const z,
+                       GLuint const texture_id)
+{
+    z_gfx__queue_instanced(count, z, texture_id);
+}
+
 void
 z_gfx__render_sprite(SHIZVertexPositionColorTexture const * restrict const vertices,
                      SHIZVector3 const origin,
@@ -217,7 +307,7 @@ z_gfx__create_texture(SHIZResourceImage * const resource,
                       int32_t const width,
                       int32_t const height,
                       int32_t const components,
-                      uint8_t * const data)
+                      uint8_t const * const data)
 {
     if (resource == NULL) {
         return false;
@@ -225,19 +315,146 @@ z_gfx__create_texture(SHIZResourceImage * const resource,
     
     glGenTextures(1, &resource->texture_id);
     glBindTexture(GL_TEXTURE_2D, resource->texture_id); {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        z_gfx__parameterize_texture(components);
+        z_gfx__specify_texture(width, height, components, data);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    return true;
+}
+
+bool
+z_gfx__queue_texture(SHIZResourceImage * const resource,
+                     int32_t const width,
+                     int32_t const height,
+                     int32_t const components,
+                     uint8_t const * const data)
+{
+    if (resource == NULL || data == NULL) {
+        return false;
+    }
+    
+    uint32_t const size = (uint32_t)width * (uint32_t)height *
+        (uint32_t)components;
+    
+    SHIZGFXUpload * upload = _idle;
+    
+    if (upload != NULL) {
+        _idle = upload->next;
+        _idle_count -= 1;
+    } else {
+        upload = calloc(1, sizeof(SHIZGFXUpload));
         
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (upload == NULL) {
+            return false;
+        }
         
-        if (components == 3) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB,
-                         width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        } else if (components == 4) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-                         width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenBuffers(1, &upload->buffer);
+    }
+    
+    void * pixels = NULL;
+    
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->buffer); {
+        if (upload->capacity < size) {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+            
+            upload->capacity = size;
         }
+        
+        // the buffer is never mapped while an upload still reads from it
+        // (see z_gfx__upload_textures), so nothing has to be waited on
+        pixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                  GL_MAP_WRITE_BIT |
+                                  GL_MAP_INVALIDATE_BUFFER_BIT |
+                                  GL_MAP_UNSYNCHRONIZED_BIT);
+        
+        if (pixels != NULL) {
+            memcpy(pixels, data, size);
+            
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+                // the contents were lost (rare); try again some other time
+                pixels = NULL;
+            }
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    
+    if (pixels == NULL) {
+        glDeleteBuffers(1, &upload->buffer);
+        
+        free(upload);
+        
+        return false;
+    }
+    
+    upload->resource = resource;
+    upload->width = width;
+    upload->height = height;
+    upload->components = components;
+    upload->next = NULL;
+    
+    if (_staged.last != NULL) {
+        _staged.last->next = upload;
+    } else {
+        _staged.first = upload;
+    }
+    
+    _staged.last = upload;
+    
+    return true;
+}
+
+bool
+z_gfx__resize_texture(SHIZResourceImage const * const resource,
+                      int32_t const width,
+                      int32_t const height,
+                      int32_t const components,
+                      uint8_t const * const data)
+{
+    if (resource == NULL || resource->texture_id == 0) {
+        return false;
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, resource->texture_id); {
+        // the texture keeps its id and parameters; only its storage changes
+        z_gfx__specify_texture(width, height, components, data);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    return true;
+}
+
+bool
+z_gfx__update_texture(SHIZResourceImage const * const resource,
+                      int32_t const x,
+                      int32_t const y,
+                      int32_t const width,
+                      int32_t const height,
+                      int32_t const components,
+                      uint8_t const * const data)
+{
+    if (resource == NULL || resource->texture_id == 0) {
+        return false;
+    }
+    
+    GLenum format;
+    
+    if (components == 1) {
+        format = GL_RED;
+    } else if (components == 3) {
+        format = GL_RGB;
+    } else if (components == 4) {
+        format = GL_RGBA;
+    } else {
+        return false;
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, resource->texture_id); {
+        // rows of a sub-region are tightly packed; not necessarily 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+                        format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     }
     glBindTexture(GL_TEXTURE_2D, 0);
     
@@ -251,11 +468,203 @@ z_gfx__destroy_texture(SHIZResourceImage const * const resource)
         return false;
     }
     
-    glDeleteTextures(1, &resource->texture_id);
+    SHIZGFXUpload * previous = NULL;
+    SHIZGFXUpload * upload = _staged.first;
+    
+    while (upload != NULL && upload->resource != resource) {
+        previous = upload;
+        upload = upload->next;
+    }
+    
+    if (upload != NULL) {
+        // not uploaded yet; the buffer can be staged into right away
+        if (previous != NULL) {
+            previous->next = upload->next;
+        } else {
+            _staged.first = upload->next;
+        }
+        
+        if (_staged.last == upload) {
+            _staged.last = previous;
+        }
+        
+        upload->next = _idle;
+        
+        _idle = upload;
+        _idle_count += 1;
+    }
+    
+    if (resource->texture_id != 0) {
+        glDeleteTextures(1, &resource->texture_id);
+    }
     
     return true;
 }
 
+void
+z_gfx__finish_uploads()
+{
+    z_gfx__upload_textures(UINT32_MAX);
+}
+
+static
+void
+z_gfx__upload_textures(uint32_t const budget)
+{
+    // release the buffers of uploads that have finished
+    SHIZGFXUpload * * link = &_uploading;
+    
+    while (*link != NULL) {
+        SHIZGFXUpload * const upload = *link;
+        
+        GLenum const status = glClientWaitSync(upload->fence, 0, 0);
+        
+        if (status != GL_ALREADY_SIGNALED &&
+            status != GL_CONDITION_SATISFIED) {
+            link = &upload->next;
+            
+            continue;
+        }
+        
+        *link = upload->next;
+        
+        glDeleteSync(upload->fence);
+        
+        upload->fence = NULL;
+        
+        if (_idle_count < SHIZGFXUploadBufferMax) {
+            upload->next = _idle;
+            
+            _idle = upload;
+            _idle_count += 1;
+        } else {
+            glDeleteBuffers(1, &upload->buffer);
+            
+            free(upload);
+        }
+    }
+    
+    // then upload staged textures, within budget; the driver copies from
+    // each buffer without stalling, and the fence tells when it is done
+    uint64_t uploaded_size = 0;
+    
+    while (_staged.first != NULL) {
+        SHIZGFXUpload * const upload = _staged.first;
+        
+        uint32_t const size = (uint32_t)upload->width *
+            (uint32_t)upload->height * (uint32_t)upload->components;
+        
+        if (uploaded_size > 0 && uploaded_size + size > budget) {
+            // always upload at least one texture, however large
+            break;
+        }
+        
+        uploaded_size += size;
+        
+        _staged.first = upload->next;
+        
+        if (_staged.first == NULL) {
+            _staged.last = NULL;
+        }
+        
+        SHIZResourceImage * const resource = upload->resource;
+        
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->buffer); {
+            glGenTextures(1, &resource->texture_id);
+            glBindTexture(GL_TEXTURE_2D, resource->texture_id); {
+                z_gfx__parameterize_texture(upload->components);
+                // with a bound pixel buffer, data is an offset into it
+                z_gfx__specify_texture(upload->width, upload->height,
+                                       upload->components, NULL);
+            }
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        
+        upload->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        upload->resource = NULL;
+        upload->next = _uploading;
+        
+        _uploading = upload;
+        
+        z_res__finish_texture(resource->resource_id);
+    }
+}
+
+static
+void
+z_gfx__kill_uploads()
+{
+    SHIZGFXUpload * const lists[] = {
+        _staged.first, _uploading, _idle
+    };
+    
+    for (uint8_t i = 0; i < 3; i++) {
+        SHIZGFXUpload * upload = lists[i];
+        
+        while (upload != NULL) {
+            SHIZGFXUpload * const next = upload->next;
+            
+            if (upload->fence != NULL) {
+                glDeleteSync(upload->fence);
+            }
+            
+            glDeleteBuffers(1, &upload->buffer);
+            
+            free(upload);
+            
+            upload = next;
+        }
+    }
+    
+    _staged.first = NULL;
+    _staged.last = NULL;
+    
+    _uploading = NULL;
+    _idle = NULL;
+    _idle_count = 0;
+}
+
+static
+void
+z_gfx__parameterize_texture(int32_t const components)
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    if (components == 1) {
+        // single-channel images (e.g. rasterized glyphs) are coverage
+        // only; sample them as white, with the coverage as alpha
+        GLint const swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+        
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+}
+
+static
+void
+z_gfx__specify_texture(int32_t const width,
+                       int32_t const height,
+                       int32_t const components,
+                       uint8_t const * const data)
+{
+    if (components == 1) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8,
+                     width, height, 0, GL_RED, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    } else if (components == 3) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB,
+                     width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+    } else if (components == 4) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+                     width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    }
+}
+
 static
 bool
 z_gfx__init_post()
@@ -412,7 +821,7 @@ static
 bool
 z_gfx__load_default_texture()
 {
-    uint8_t const white_resource_id = z_res__load_data(SHIZResourceTypeImage,
+    uint32_t const white_resource_id = z_res__load_data(SHIZResourceTypeImage,
                                                   WHITE_1x1,
                                                   WHITE_1x1_SIZE);
     
@@ -18,6 +18,12 @@
 
 #include "../res.h"
 
+/**
+ * The max number of bytes of texture data uploaded each frame; streaming
+ * large images is spread across frames rather than stalling one.
+ */
+#define SHIZGFXUploadBudget (4 * 1024 * 1024)
+
 /**
  * @brief Initialize the SHIZEN graphics module.
  *
@@ -59,6 +65,54 @@ bool z_gfx__kill(void);
 void z_gfx__render(GLenum mode, SHIZVertexPositionColor const * restrict vertices, uint32_t count);
 void z_gfx__render_ex(GLenum const mode, SHIZVertexPositionColor const * restrict vertices, uint32_t count, SHIZVector3 origin, float angle);
 
+/**
+ * @brief Reserve space for vertex data.
+ *
+ * Provide a buffer with room for at least `count` vertices that can be filled
+ * and then passed to `z_gfx__render`.
+ *
+ * @remark The buffer is reused by every call; its contents are only valid
+ *         until the next call to this function.
+ *
+ * @return A pointer to the buffer, or `NULL` if the space could not be reserved
+ */
+SHIZVertexPositionColor * z_gfx__reserve(uint32_t count);
+/**
+ * @brief Reserve space for triangles drawn later in the frame.
+ *
+ * Provide room for at least `count` vertices (3 for each triangle), directly
+ * after any triangles already queued; fill them, then pass the number filled
+ * to `z_gfx__queue_triangles`. Every queued triangle is drawn in a single
+ * draw call, once flushed (see `z_gfx__flush`).
+ *
+ * @remark The vertices must already be transformed; i.e. in place.
+ *
+ * @return A pointer to the space, or `NULL` if the space could not be reserved
+ */
+SHIZVertexPositionColor * z_gfx__reserve_triangles(uint32_t count);
+void z_gfx__queue_triangles(uint32_t count);
+
+/**
+ * @brief Reserve space for instances of textured quads.
+ *
+ * Provide room for at least `count` instances at the end of the instance
+ * queue. The instances are only queued (see `z_gfx__queue_instances`) once
+ * filled in.
+ *
+ * @return A pointer to the space, or `NULL` if the space could not be reserved
+ */
+SHIZInstance * z_gfx__reserve_instances(uint32_t count);
+
+/**
+ * @brief Queue instances previously filled in.
+ *
+ * Queue `count` instances, filled in since the latest reservation, to be
+ * drawn with the specified texture when flushed. Queued instances are sorted
+ * by layer and then texture, and any instances sharing a texture are drawn
+ * with a single draw call.
+ */
+void z_gfx__queue_instances(uint32_t count, float z, GLuint texture_id);
+
 /**
  * @brief Render a sprite; a textured quad.
  *
@@ -74,5 +128,33 @@ void z_gfx__begin(SHIZColor clear);
 void z_gfx__end(void);
 void z_gfx__flush(void);
 
-bool z_gfx__create_texture(SHIZResourceImage *, int32_t width, int32_t height, int32_t components, uint8_t * data);
+bool z_gfx__create_texture(SHIZResourceImage *, int32_t width, int32_t height, int32_t components, uint8_t const * data);
+/**
+ * @brief Create a texture over the next frames, rather than right away.
+ *
+ * The pixels are copied into a pixel buffer, and are uploaded from it once
+ * the upload budget of a frame allows (see `SHIZGFXUploadBudget`); at which
+ * point the image is finished (see `z_res__finish_texture`). Until then, the
+ * image has no texture.
+ *
+ * @return `true` if the texture was queued, `false` otherwise
+ */
+bool z_gfx__queue_texture(SHIZResourceImage *, int32_t width, int32_t height, int32_t components, uint8_t const * data);
+/**
+ * @brief Upload every queued texture right away, regardless of budget.
+ */
+void z_gfx__finish_uploads(void);
+/**
+ * @brief Replace a region of a texture.
+ *
+ * The region is specified in texture space; i.e. with the first row at the
+ * bottom of the texture.
+ */
+bool z_gfx__update_texture(SHIZResourceImage const *, int32_t x, int32_t y, int32_t width, int32_t height, int32_t components, uint8_t const * data);
+/**
+ * @brief Replace the entire contents of a texture, at any size.
+ *
+ * The texture keeps its id, so anything drawing it keeps working.
+ */
+bool z_gfx__resize_texture(SHIZResourceImage const *, int32_t width, int32_t height, int32_t components, uint8_t const * data);
 bool z_gfx__destroy_texture(SHIZResourceImage const *);
@@ -11,6 +11,8 @@
 
 #include "immediate.h"
 
+#include <stdlib.h> // realloc, free
+
 #include "shader.h"
 #include "viewport.h"
 #include "transform.h"
@@ -22,7 +24,19 @@
 
 static void z_gfx__immediate_state(bool enable);
 
+typedef struct SHIZImmediateBuffer {
+    SHIZVertexPositionColor * vertices;
+    uint32_t capacity;
+    /** The number of vertices queued; only used by the triangle batch */
+    uint32_t count;
+} SHIZImmediateBuffer;
+
+static bool z_gfx__grow_immediate(SHIZImmediateBuffer *, uint32_t count);
+
 static SHIZRenderObject _renderer;
+static SHIZImmediateBuffer _buffer;
+// triangles queued during a frame; drawn all at once when flushed
+static SHIZImmediateBuffer _triangles;
 
 bool
 z_gfx__init_immediate()
@@ -138,6 +152,48 @@ z_gfx__render_immediate(GLenum const mode,
 #endif
 }
 
+SHIZVertexPositionColor *
+z_gfx__reserve_immediate(uint32_t const count)
+{
+    if (!z_gfx__grow_immediate(&_buffer, count)) {
+        return NULL;
+    }
+    
+    return _buffer.vertices;
+}
+
+SHIZVertexPositionColor *
+z_gfx__reserve_triangles_immediate(uint32_t const count)
+{
+    if (count > UINT32_MAX - _triangles.count ||
+        !z_gfx__grow_immediate(&_triangles, _triangles.count + count)) {
+        return NULL;
+    }
+    
+    return _triangles.vertices + _triangles.count;
+}
+
+void
+z_gfx__queue_triangles_immediate(uint32_t const count)
+{
+    _triangles.count += count;
+}
+
+void
+z_gfx__flush_immediate()
+{
+    if (_triangles.count == 0) {
+        return;
+    }
+    
+    // every queued vertex is already in place; so the whole batch is drawn
+    // with the same (identity) model transform
+    z_gfx__render_immediate(GL_TRIANGLES, _triangles.vertices, _triangles.count,
+                            SHIZVector3Zero, 0);
+    
+    _triangles.count = 0;
+}
+
 bool
 z_gfx__kill_immediate()
 {
@@ -145,6 +201,42 @@ z_gfx__kill_immediate()
     glDeleteVertexArrays(1, &_renderer.vao);
     glDeleteBuffers(1, &_renderer.vbo);
     
+    free(_buffer.vertices);
+    free(_triangles.vertices);
+    
+    _buffer = (SHIZImmediateBuffer) { NULL, 0, 0 };
+    _triangles = (SHIZImmediateBuffer) { NULL, 0, 0 };
+    
+    return true;
+}
+
+static
+bool
+z_gfx__grow_immediate(SHIZImmediateBuffer * const buffer,
+                      uint32_t const count)
+{
+    if (count <= buffer->capacity) {
+        return true;
+    }
+    
+    // grow geometrically so that a path growing by a few points each
+    // frame does not cause a reallocation every frame
+    uint32_t capacity = buffer->capacity > 0 ? buffer->capacity : 256;
+    
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    
+    SHIZVertexPositionColor * const vertices =
+        realloc(buffer->vertices, sizeof(SHIZVertexPositionColor) * capacity);
+    
+    if (vertices == NULL) {
+        return false;
+    }
+    
+    buffer->vertices = vertices;
+    buffer->capacity = capacity;
+    
     return true;
 }
 
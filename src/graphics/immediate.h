@@ -19,3 +19,9 @@ bool z_gfx__init_immediate(void);
 bool z_gfx__kill_immediate(void);
 
 void z_gfx__render_immediate(GLenum mode, SHIZVertexPositionColor const * restrict vertices, uint32_t count, SHIZVector3 origin, float angle);
+
+SHIZVertexPositionColor * z_gfx__reserve_immediate(uint32_t count);
+
+SHIZVertexPositionColor * z_gfx__reserve_triangles_immediate(uint32_t count);
+void z_gfx__queue_triangles_immediate(uint32_t count);
+void z_gfx__flush_immediate(void);
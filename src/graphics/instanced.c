@@ -0,0 +1,409 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#include "instanced.h"
+
+#include <stdlib.h> // realloc, free, qsort
+#include <string.h> // memcpy
+
+#include "shader.h"
+#include "viewport.h"
+#include "transform.h"
+
+#ifdef SHIZ_DEBUG
+ #include "../debug/debug.h"
+ #include "../debug/profiler.h"
+#endif
+
+#define VERTEX_COUNT_PER_INSTANCE 4 /* 1 quad drawn as a triangle strip */
+
+typedef struct SHIZInstanceBuffer {
+    SHIZInstance * instances;
+    uint32_t capacity;
+    /** The number of instances queued */
+    uint32_t count;
+} SHIZInstanceBuffer;
+
+/**
+ * A run of instances queued together; e.g. the particles of an emitter.
+ */
+typedef struct SHIZInstanceRun {
+    /** The index of the first instance of the run, in order of queueing */
+    uint32_t first;
+    uint32_t count;
+    float z;
+    GLuint texture_id;
+} SHIZInstanceRun;
+
+typedef struct SHIZInstanceRunList {
+    SHIZInstanceRun * runs;
+    uint32_t capacity;
+    uint32_t count;
+} SHIZInstanceRunList;
+
+static void z_gfx__instanced_state(bool enable);
+static void z_gfx__instanced_attributes(uint32_t first);
+
+static bool z_gfx__grow_instanced(SHIZInstanceBuffer *, uint32_t count);
+
+static int z_gfx__compare_runs(void const * run, void const * other_run);
+
+static SHIZRenderObject _renderer;
+static GLint _transform_location;
+// instances queued during a frame, and the same instances once sorted
+static SHIZInstanceBuffer _buffer;
+static SHIZInstanceBuffer _sorted;
+static SHIZInstanceRunList _runs;
+
+bool
+z_gfx__init_instanced()
+{
+    // every instance is a quad; the corners are derived from the vertex
+    // index (in clockwise order; tl, tr, bl, br), while the quad itself,
+    // its texture coordinates and its tint are attributes of the instance;
+    // so that instances of any sprite in the same texture can be drawn at once
+    char const * const vertex_shader =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 instance_position;\n"
+    "layout (location = 1) in vec4 instance_quad;\n"
+    "layout (location = 2) in vec4 instance_uv;\n"
+    "layout (location = 3) in vec4 instance_tint;\n"
+    "uniform mat4 transform;\n"
+    "out vec2 texture_coord;\n"
+    "out vec4 tint_color;\n"
+    "void main() {\n"
+    "    vec2 corner = vec2(gl_VertexID & 1, 1 - (gl_VertexID >> 1));\n"
+    "    vec2 position = instance_position.xy + instance_quad.xy + (corner * instance_quad.zw);\n"
+    "    gl_Position = transform * vec4(position, instance_position.z, 1);\n"
+    "    texture_coord = mix(instance_uv.xy, instance_uv.zw, corner);\n"
+    "    tint_color = instance_tint;\n"
+    "}\n";
+    
+    char const * const fragment_shader =
+    "#version 330 core\n"
+    "in vec2 texture_coord;\n"
+    "in vec4 tint_color;\n"
+    "uniform sampler2D sampler;\n"
+    "layout (location = 0) out vec4 fragment_color;\n"
+    "void main() {\n"
+    "    fragment_color = texture(sampler, texture_coord.st) * tint_color;\n"
+    "}\n";
+    
+    GLuint const vs = z_gfx__compile_shader(GL_VERTEX_SHADER, vertex_shader);
+    GLuint const fs = z_gfx__compile_shader(GL_FRAGMENT_SHADER, fragment_shader);
+    
+    if (!vs && !fs) {
+        return false;
+    }
+    
+    _renderer.program = z_gfx__link_program(vs, fs);
+    
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    
+    if (!_renderer.program) {
+        return false;
+    }
+    
+    _transform_location = glGetUniformLocation(_renderer.program, "transform");
+    
+    glGenBuffers(1, &_renderer.vbo);
+    glGenVertexArrays(1, &_renderer.vao);
+    
+    glBindVertexArray(_renderer.vao); {
+        glBindBuffer(GL_ARRAY_BUFFER, _renderer.vbo); {
+            z_gfx__instanced_attributes(0);
+            
+            for (GLuint location = 0; location < 4; location++) {
+                glVertexAttribDivisor(location, 1 /* advance once per instance */);
+                glEnableVertexAttribArray(location);
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glBindVertexArray(0);
+    
+    return true;
+}
+
+SHIZInstance *
+z_gfx__reserve_instanced(uint32_t const count)
+{
+    if (count > UINT32_MAX - _buffer.count ||
+        !z_gfx__grow_instanced(&_buffer, _buffer.count + count)) {
+        return NULL;
+    }
+    
+    return _buffer.instances + _buffer.count;
+}
+
+void
+z_gfx__queue_instanced(uint32_t const count,
+                       float const z,
+                       GLuint const texture_id)
+{
+    if (count == 0) {
+        return;
+    }
+    
+    if (_runs.count == _runs.capacity) {
+        uint32_t const capacity = _runs.capacity > 0 ? _runs.capacity * 2 : 16;
+        
+        SHIZInstanceRun * const runs =
+            realloc(_runs.runs, sizeof(SHIZInstanceRun) * capacity);
+        
+        if (runs == NULL) {
+            // the instances are left out, as if never reserved
+            return;
+        }
+        
+        _runs.runs = runs;
+        _runs.capacity = capacity;
+    }
+    
+    SHIZInstanceRun * const run = &_runs.runs[_runs.count];
+    
+    run->first = _buffer.count;
+    run->count = count;
+    run->z = z;
+    run->texture_id = texture_id;
+    
+    _runs.count += 1;
+    _buffer.count += count;
+}
+
+void
+z_gfx__flush_instanced()
+{
+    if (_runs.count == 0) {
+        return;
+    }
+    
+    if (!z_gfx__grow_instanced(&_sorted, _buffer.count)) {
+        _runs.count = 0;
+        _buffer.count = 0;
+        
+        return;
+    }
+    
+    // sort runs by layer, then texture; the same order as sprites, so that
+    // runs in the same layer and texture end up next to each other
+    qsort(_runs.runs, _runs.count, sizeof(SHIZInstanceRun),
+          z_gfx__compare_runs);
+    
+    uint32_t sorted_count = 0;
+    
+    for (uint32_t i = 0; i < _runs.count; i++) {
+        SHIZInstanceRun * const run = &_runs.runs[i];
+        
+        memcpy(&_sorted.instances[sorted_count],
+               &_buffer.instances[run->first],
+               sizeof(SHIZInstance) * run->count);
+        
+        run->first = sorted_count;
+        
+        sorted_count += run->count;
+    }
+    
+    mat4x4 model;
+    mat4x4_identity(model);
+    
+    mat4x4 transform;
+    
+    z_transform__project_ortho(transform, model, z_viewport__get());
+    
+    z_gfx__instanced_state(true);
+    
+    glUseProgram(_renderer.program);
+    glUniformMatrix4fv(_transform_location, 1, GL_FALSE, *transform);
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(_renderer.vao); {
+        glBindBuffer(GL_ARRAY_BUFFER, _renderer.vbo); {
+            // orphan the previous storage so that we don't have to wait
+            // for the driver to finish any draw still using it
+            glBufferData(GL_ARRAY_BUFFER,
+                         sizeof(SHIZInstance) * sorted_count,
+                         _sorted.instances,
+                         GL_STREAM_DRAW);
+            
+            uint32_t i = 0;
+            
+            while (i < _runs.count) {
+                SHIZInstanceRun const run = _runs.runs[i];
+                
+                uint32_t count = run.count;
+                
+                // merge every following run of the same texture; these are
+                // already contiguous, and each instance carries its own z
+                for (i = i + 1; i < _runs.count; i++) {
+                    if (_runs.runs[i].texture_id != run.texture_id) {
+                        break;
+                    }
+                    
+                    count += _runs.runs[i].count;
+                }
+                
+                z_gfx__instanced_attributes(run.first);
+                
+                glBindTexture(GL_TEXTURE_2D, run.texture_id);
+                glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0,
+                                      VERTEX_COUNT_PER_INSTANCE,
+                                      (GLsizei)count);
+#ifdef SHIZ_DEBUG
+                z_profiler__increment_draw_count(1);
+                z_debug__add_event_draw(SHIZDebugEventNameInstanced,
+                                        _sorted.instances[run.first].position);
+#endif
+            }
+            
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+    
+    z_gfx__instanced_state(false);
+    
+    _runs.count = 0;
+    _buffer.count = 0;
+}
+
+bool
+z_gfx__kill_instanced()
+{
+    glDeleteProgram(_renderer.program);
+    glDeleteVertexArrays(1, &_renderer.vao);
+    glDeleteBuffers(1, &_renderer.vbo);
+    
+    free(_buffer.instances);
+    free(_sorted.instances);
+    free(_runs.runs);
+    
+    _buffer = (SHIZInstanceBuffer) { NULL, 0, 0 };
+    _sorted = (SHIZInstanceBuffer) { NULL, 0, 0 };
+    _runs = (SHIZInstanceRunList) { NULL, 0, 0 };
+    
+    return true;
+}
+
+static
+void
+z_gfx__instanced_attributes(uint32_t const first)
+{
+    // there is no base instance in this version of OpenGL; instead, every
+    // attribute is pointed at the first instance of each draw
+    GLsizei const stride = sizeof(SHIZInstance);
+    
+    size_t const offset = (size_t)first * sizeof(SHIZInstance);
+    
+    glVertexAttribPointer(0 /* position location */,
+                          3 /* number of position components per instance */,
+                          GL_FLOAT, GL_FALSE /* values are not normalized */,
+                          stride /* offset to reach next instance */,
+                          (GLvoid*)(offset));
+    glVertexAttribPointer(1 /* quad location */,
+                          4 /* origin and size */,
+                          GL_FLOAT, GL_FALSE,
+                          stride,
+                          (GLvoid*)(offset +
+                                    sizeof(SHIZVector3)) /* offset to reach quad component */);
+    glVertexAttribPointer(2 /* texture coord location */,
+                          4 /* min and max */,
+                          GL_FLOAT, GL_FALSE,
+                          stride,
+                          (GLvoid*)(offset +
+                                    sizeof(SHIZVector3) +
+                                    sizeof(SHIZRect)) /* offset to reach texture coord components */);
+    glVertexAttribPointer(3 /* tint location */,
+                          4 /* number of color components per instance */,
+                          GL_FLOAT, GL_FALSE,
+                          stride,
+                          (GLvoid*)(offset +
+                                    sizeof(SHIZVector3) +
+                                    sizeof(SHIZRect) +
+                                    sizeof(SHIZVector2) * 2) /* offset to reach tint component */);
+}
+
+static
+bool
+z_gfx__grow_instanced(SHIZInstanceBuffer * const buffer,
+                      uint32_t const count)
+{
+    if (count <= buffer->capacity) {
+        return true;
+    }
+    
+    uint32_t capacity = buffer->capacity > 0 ? buffer->capacity : 1024;
+    
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    
+    SHIZInstance * const instances =
+        realloc(buffer->instances, sizeof(SHIZInstance) * capacity);
+    
+    if (instances == NULL) {
+        return false;
+    }
+    
+    buffer->instances = instances;
+    buffer->capacity = capacity;
+    
+    return true;
+}
+
+static
+int
+z_gfx__compare_runs(void const * const run,
+                    void const * const other_run)
+{
+    SHIZInstanceRun const * lhs = (SHIZInstanceRun *)run;
+    SHIZInstanceRun const * rhs = (SHIZInstanceRun *)other_run;
+    
+    if (lhs->z < rhs->z) {
+        return -1;
+    } else if (lhs->z > rhs->z) {
+        return 1;
+    } else if (lhs->texture_id < rhs->texture_id) {
+        return -1;
+    } else if (lhs->texture_id > rhs->texture_id) {
+        return 1;
+    } else if (lhs->first < rhs->first) {
+        // fall back to the order of queueing if both are equal
+        return -1;
+    } else if (lhs->first > rhs->first) {
+        return 1;
+    }
+    
+    return 0;
+}
+
+static
+void
+z_gfx__instanced_state(bool const enable)
+{
+    if (enable) {
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+        
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_BACK);
+        glFrontFace(GL_CW);
+        
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+        glDisable(GL_CULL_FACE);
+    }
+}
@@ -0,0 +1,23 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdint.h> // uint32_t
+
+#include "../internal.h" // SHIZInstance, GLuint
+
+bool z_gfx__init_instanced(void);
+bool z_gfx__kill_instanced(void);
+
+SHIZInstance * z_gfx__reserve_instanced(uint32_t count);
+void z_gfx__queue_instanced(uint32_t count, float z, GLuint texture_id);
+void z_gfx__flush_instanced(void);
@@ -32,6 +32,9 @@ typedef struct SHIZSpriteBatch {
     SHIZVertexPositionColorTexture vertices[VERTEX_COUNT_PER_BATCH];
     SHIZRenderObject render;
     GLuint texture_id;
+    /** The locations of uniforms; looked up once, rather than every flush */
+    GLint transform_location;
+    GLint additive_tint_location;
     uint16_t count;
 } SHIZSpriteBatch;
 
@@ -97,6 +100,11 @@ z_gfx__init_spritebatch()
         return false;
     }
     
+    _spritebatch.transform_location =
+        glGetUniformLocation(_spritebatch.render.program, "transform");
+    _spritebatch.additive_tint_location =
+        glGetUniformLocation(_spritebatch.render.program, "enable_additive_tint");
+    
     glGenBuffers(1, &_spritebatch.render.vbo);
     glGenVertexArrays(1, &_spritebatch.render.vao);
     
@@ -252,8 +260,8 @@ z_gfx__spritebatch_flush()
     
     glUseProgram(_spritebatch.render.program);
     // todo: a way to provide this flag; problem is that it affects the entire batch
-    glUniform1i(glGetUniformLocation(_spritebatch.render.program, "enable_additive_tint"), false);
-    glUniformMatrix4fv(glGetUniformLocation(_spritebatch.render.program, "transform"), 1, GL_FALSE, *transform);
+    glUniform1i(_spritebatch.additive_tint_location, false);
+    glUniformMatrix4fv(_spritebatch.transform_location, 1, GL_FALSE, *transform);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, _spritebatch.texture_id); {
         glBindVertexArray(_spritebatch.render.vao); {
@@ -126,6 +126,15 @@ typedef struct SHIZVertexPositionColorTexture {
     SHIZVector2 texture_coord_max;
 } SHIZVertexPositionColorTexture;
 
+typedef struct SHIZInstance {
+    SHIZVector3 position;
+    /** The quad, relative to the position */
+    SHIZRect quad;
+    SHIZVector2 texture_coord_min;
+    SHIZVector2 texture_coord_max;
+    SHIZColor tint;
+} SHIZInstance;
+
 static inline
 SHIZVector3 const
 SHIZVector3Make(float const x, float const y, float const z)
@@ -139,6 +148,12 @@ SHIZVector3Make(float const x, float const y, float const z)
 
 void z_engine__present_frame(void);
 
+/**
+ * @brief Determine the duration (in seconds) of every tick so far; i.e. the
+ *        time that has been simulated, however scaled or reversed.
+ */
+double z_time__get_ticked(void);
+
 #ifdef SHIZ_DEBUG
 double z_time__get_lag(void);
 #endif
@@ -9,11 +9,29 @@
 // under the terms of the MIT license. See LICENSE for details.
 //
 
+#if !defined(_WIN32) && !defined(_XOPEN_SOURCE)
+ #define _XOPEN_SOURCE 700 // realpath
+#endif
+
 #include "io.h" // z_io_*
 
 #include <stdint.h> // uint8_t, int16_t, uint32_t, int32_t
-#include <stdio.h> // fprintf, sprintf, vsnprintf
+#include <stdlib.h> // malloc, free, realpath, _fullpath
+#include <stdio.h> // fprintf, sprintf, vsnprintf, fopen, fread
 #include <stdarg.h> // va_list
+#include <string.h> // memcpy, memcmp, strlen
+#include <limits.h> // PATH_MAX
+
+#ifndef _WIN32
+ #include <sys/mman.h> // mmap, munmap
+ #include <sys/stat.h> // fstat
+ #include <fcntl.h> // open
+ #include <unistd.h> // close
+#endif
+
+#ifndef PATH_MAX
+ #define PATH_MAX 4096
+#endif
 
 #include <stb/stb_vorbis.h> // stb_vorbis_*
 
@@ -27,6 +45,9 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_PNG
+// failure strings are kept in a global, which is not safe to write while
+// decoding on more than one thread (and they are never reported anyway)
+#define STBI_NO_FAILURE_STRINGS
 
 #include <stb/stb_image.h> // stbi_*
 
@@ -34,7 +55,14 @@
  #pragma clang diagnostic pop
 #endif
 
+static bool z_io__load_image_buffer(uint8_t const * buffer, uint32_t length, z_io__load_image_handler, bool * decoded);
+static bool z_io__is_texture(uint8_t const * buffer, uint32_t length);
+static uint8_t const * z_io__texture_pixels(uint8_t const * buffer, uint32_t length, int32_t * width, int32_t * height);
+static uint32_t z_io__read_u32(uint8_t const * buffer);
 static bool z_io__handle_image(uint8_t * data, int32_t width, int32_t height, int32_t components, z_io__load_image_handler);
+static bool z_io__handle_font(uint8_t * data, uint32_t length, z_io__load_font_handler);
+static bool z_io__handle_sound(int16_t * data, int32_t channels, int32_t sample_rate, int32_t length, z_io__load_sound_handler);
+static void z_io__flip_image(uint8_t * data, int32_t width, int32_t height);
 static void z_io__printf(char const * format, va_list args);
 
 #define SHIZIOBufferCapacity 256
@@ -101,73 +129,439 @@ bool
 z_io__load_image(char const * const filename,
                  z_io__load_image_handler const handler)
 {
-    int32_t width, height;
-    int32_t components;
+    uint32_t length = 0;
+    
+    uint8_t const * const buffer = z_io__map_file(filename, &length);
+    
+    bool decoded = false;
+    bool loaded = false;
+    
+    if (buffer != NULL) {
+        loaded = z_io__load_image_buffer(buffer, length, handler, &decoded);
+        
+        z_io__unmap_file(buffer, length);
+    }
+    
+    if (!decoded) {
+        z_io__error("failed to load image: '%s'", filename);
+    }
+    
+    return loaded;
+}
 
-    // stbi defaults to reading the first pixel at the top-left of the image,
-    // however, opengl expects the first pixel to be at the bottom-left of
-    // the image, so we need to flip it
-    stbi_set_flip_vertically_on_load(true);
+bool
+z_io__load_image_data(uint8_t const * const buffer,
+                      uint32_t const length,
+                      z_io__load_image_handler const handler)
+{
+    bool decoded = false;
     
-    uint8_t * const image =
-        stbi_load(filename, &width, &height, &components,
-                  STBI_rgb_alpha);
+    bool const loaded =
+        z_io__load_image_buffer(buffer, length, handler, &decoded);
+    
+    if (!decoded) {
+        z_io__error("failed to load image (from memory)");
+    }
+    
+    return loaded;
+}
 
-    if (!image) {
-        z_io__error("failed to load image: '%s'", filename);
+bool
+z_io__load_sound(char const * const filename,
+                 z_io__load_sound_handler const handler)
+{
+    int32_t channels;
+    int32_t sample_rate;
+    int32_t length;
+    
+    int16_t * const data =
+        z_io__decode_sound(filename, &channels, &sample_rate, &length);
+    
+    if (data == NULL) {
+        z_io__error("failed to load sound: '%s'", filename);
+        
+        return false;
+    }
+    
+    return z_io__handle_sound(data, channels, sample_rate, length, handler);
+}
 
+bool
+z_io__load_sound_data(uint8_t const * const buffer,
+                      uint32_t const length,
+                      z_io__load_sound_handler const handler)
+{
+    int32_t channels;
+    int32_t sample_rate;
+    int32_t size;
+    
+    int16_t * const data =
+        z_io__decode_sound_data(buffer, length, &channels, &sample_rate, &size);
+    
+    if (data == NULL) {
+        z_io__error("failed to load sound (from memory)");
+        
         return false;
     }
+    
+    return z_io__handle_sound(data, channels, sample_rate, size, handler);
+}
 
-    return z_io__handle_image(image, width, height, components, handler);
+bool
+z_io__load_font(char const * const filename,
+                z_io__load_font_handler const handler)
+{
+    uint32_t length;
+    
+    uint8_t * const data = z_io__read_file(filename, &length);
+    
+    if (data == NULL) {
+        z_io__error("failed to load font: '%s'", filename);
+        
+        return false;
+    }
+    
+    return z_io__handle_font(data, length, handler);
 }
 
 bool
-z_io__load_image_data(uint8_t const * const buffer,
-                      uint32_t const length,
-                      z_io__load_image_handler const handler)
+z_io__load_font_data(uint8_t const * const buffer,
+                     uint32_t const length,
+                     z_io__load_font_handler const handler)
 {
-    int32_t width, height;
-    int32_t components;
+    if (buffer == NULL || length == 0) {
+        z_io__error("failed to load font (from memory)");
+        
+        return false;
+    }
+    
+    // the font is read from as long as it is loaded, so keep a copy rather
+    // than relying on the buffer to outlive it
+    uint8_t * const data = malloc(length);
+    
+    if (data == NULL) {
+        z_io__error("failed to load font (from memory)");
+        
+        return false;
+    }
+    
+    memcpy(data, buffer, length);
+    
+    return z_io__handle_font(data, length, handler);
+}
 
-    stbi_set_flip_vertically_on_load(true);
+uint8_t *
+z_io__decode_image(char const * const filename,
+                   int32_t * const width,
+                   int32_t * const height,
+                   int32_t * const components)
+{
+    uint32_t length = 0;
+    
+    uint8_t const * const buffer = z_io__map_file(filename, &length);
+    
+    if (buffer == NULL) {
+        return NULL;
+    }
+    
+    uint8_t * const image =
+        z_io__decode_image_data(buffer, length, width, height, components);
+    
+    z_io__unmap_file(buffer, length);
+    
+    return image;
+}
 
-    unsigned char * const image =
-        stbi_load_from_memory(buffer, (int32_t)length, &width, &height, &components,
+uint8_t *
+z_io__decode_image_data(uint8_t const * const buffer,
+                        uint32_t const length,
+                        int32_t * const width,
+                        int32_t * const height,
+                        int32_t * const components)
+{
+    if (buffer == NULL || length == 0 || length > INT32_MAX) {
+        return NULL;
+    }
+    
+    if (z_io__is_texture(buffer, length)) {
+        uint8_t const * const pixels =
+            z_io__texture_pixels(buffer, length, width, height);
+        
+        if (pixels == NULL) {
+            return NULL;
+        }
+        
+        // the pixels must outlive the buffer; this is only a copy
+        size_t const size =
+            (size_t)*width * (size_t)*height * SHIZTextureComponents;
+        
+        uint8_t * const image = STBI_MALLOC(size);
+        
+        if (image != NULL) {
+            memcpy(image, pixels, size);
+            
+            *components = SHIZTextureComponents;
+        }
+        
+        return image;
+    }
+    
+    uint8_t * const image =
+        stbi_load_from_memory(buffer, (int32_t)length, width, height, components,
                               STBI_rgb_alpha);
-
-    if (!image) {
-        z_io__error("failed to load image (from memory)");
+    
+    if (image != NULL) {
+        z_io__flip_image(image, *width, *height);
         
+        // stbi reports the components of the file, not of the pixels
+        *components = STBI_rgb_alpha;
+    }
+    
+    return image;
+}
+
+void
+z_io__free_image(uint8_t * const data)
+{
+    stbi_image_free(data);
+}
+
+bool
+z_io__probe_image(char const * const filename,
+                  int32_t * const width,
+                  int32_t * const height)
+{
+    uint32_t length = 0;
+    
+    // only the pages holding the header are ever read from the mapping
+    uint8_t const * const buffer = z_io__map_file(filename, &length);
+    
+    if (buffer == NULL) {
         return false;
     }
     
-    return z_io__handle_image(image, width, height, components, handler);
+    bool const probed = z_io__probe_image_data(buffer, length, width, height);
+    
+    z_io__unmap_file(buffer, length);
+    
+    return probed;
 }
 
 bool
-z_io__load_sound(char const * const filename,
-                 z_io__load_sound_handler const handler)
+z_io__probe_image_data(uint8_t const * const buffer,
+                       uint32_t const length,
+                       int32_t * const width,
+                       int32_t * const height)
 {
-    int32_t channels;
-    int32_t sample_rate;
+    if (buffer == NULL || length == 0 || length > INT32_MAX) {
+        return false;
+    }
     
+    if (z_io__is_texture(buffer, length)) {
+        return z_io__texture_pixels(buffer, length, width, height) != NULL;
+    }
+    
+    int32_t components;
+    
+    return stbi_info_from_memory(buffer, (int32_t)length,
+                                 width, height, &components) != 0;
+}
+
+int16_t *
+z_io__decode_sound(char const * const filename,
+                   int32_t * const channels,
+                   int32_t * const sample_rate,
+                   int32_t * const length)
+{
     int16_t * data = NULL;
     
-    int size = stb_vorbis_decode_filename(filename, &channels, &sample_rate, &data);
+    int const size = stb_vorbis_decode_filename(filename, channels, sample_rate, &data);
     
-    if (size == -1 || size == -2) {
+    if (size < 0) {
         if (data != NULL) {
             free(data);
         }
         
-        return false;
+        return NULL;
+    }
+    
+    *length = size * *channels * (int32_t)sizeof(uint16_t);
+    
+    return data;
+}
+
+int16_t *
+z_io__decode_sound_data(uint8_t const * const buffer,
+                        uint32_t const length,
+                        int32_t * const channels,
+                        int32_t * const sample_rate,
+                        int32_t * const size)
+{
+    if (buffer == NULL || length == 0 || length > INT32_MAX) {
+        return NULL;
+    }
+    
+    int16_t * data = NULL;
+    
+    int const samples = stb_vorbis_decode_memory(buffer, (int32_t)length,
+                                                 channels, sample_rate, &data);
+    
+    if (samples < 0) {
+        if (data != NULL) {
+            free(data);
+        }
+        
+        return NULL;
+    }
+    
+    *size = samples * *channels * (int32_t)sizeof(uint16_t);
+    
+    return data;
+}
+
+uint8_t *
+z_io__read_file(char const * const filename,
+                uint32_t * const length)
+{
+    FILE * const file = fopen(filename, "rb");
+    
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    uint8_t * data = NULL;
+    long size = -1;
+    
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
     }
     
-    int32_t length = size * channels * (int32_t)sizeof(uint16_t);
+    if (size > 0 && (unsigned long)size <= UINT32_MAX &&
+        fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)size);
+        
+        if (data != NULL &&
+            fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            
+            data = NULL;
+        }
+    }
+    
+    fclose(file);
+    
+    if (data != NULL) {
+        *length = (uint32_t)size;
+    }
+    
+    return data;
+}
+
+uint8_t const *
+z_io__map_file(char const * const filename,
+               uint32_t * const length)
+{
+#ifdef _WIN32
+    // no mapping; just read all of it
+    return z_io__read_file(filename, length);
+#else
+    int const file = open(filename, O_RDONLY);
+    
+    if (file == -1) {
+        return NULL;
+    }
     
+    struct stat status;
+    
+    void * data = NULL;
+    
+    if (fstat(file, &status) == 0 &&
+        status.st_size > 0 && (uint64_t)status.st_size <= UINT32_MAX) {
+        data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE,
+                    file, 0);
+        
+        if (data == MAP_FAILED) {
+            data = NULL;
+        } else {
+            *length = (uint32_t)status.st_size;
+        }
+    }
+    
+    // the mapping stays valid after closing the file
+    close(file);
+    
+    return data;
+#endif
+}
+
+void
+z_io__unmap_file(uint8_t const * const data,
+                 uint32_t const length)
+{
+    if (data == NULL) {
+        return;
+    }
+    
+#ifdef _WIN32
+    (void)length;
+    
+    free((void *)data);
+#else
+    munmap((void *)data, length);
+#endif
+}
+
+void
+z_io__canonical_path(char const * const filename,
+                     char * const path,
+                     size_t const size)
+{
+    if (size == 0) {
+        return;
+    }
+    
+    char const * resolved_path = filename;
+    
+#ifdef _WIN32
+    char resolved[_MAX_PATH];
+    
+    if (_fullpath(resolved, filename, _MAX_PATH) != NULL) {
+        resolved_path = resolved;
+    }
+#else
+    char resolved[PATH_MAX];
+    
+    if (realpath(filename, resolved) != NULL) {
+        resolved_path = resolved;
+    }
+#endif
+    
+    size_t length = strlen(resolved_path);
+    
+    if (length >= size) {
+        length = size - 1;
+    }
+    
+    memcpy(path, resolved_path, length);
+    
+    path[length] = '\0';
+}
+
+static
+bool
+z_io__handle_font(uint8_t * const data,
+                  uint32_t const length,
+                  z_io__load_font_handler const handler)
+{
     if (handler) {
-        return (*handler)(channels, sample_rate, data, length);
+        if ((*handler)(data, length)) {
+            // the handler has taken ownership of the data
+            return true;
+        }
+        
+        free(data);
+        
+        return false;
     }
     
     free(data);
@@ -175,6 +569,117 @@ z_io__load_sound(char const * const filename,
     return true;
 }
 
+static
+bool
+z_io__handle_sound(int16_t * const data,
+                   int32_t const channels,
+                   int32_t const sample_rate,
+                   int32_t const length,
+                   z_io__load_sound_handler const handler)
+{
+    bool handled = true;
+    
+    if (handler) {
+        handled = (*handler)(channels, sample_rate, data, length);
+    }
+    
+    // the samples are copied by the handler, if kept at all
+    free(data);
+    
+    return handled;
+}
+
+static
+bool
+z_io__load_image_buffer(uint8_t const * const buffer,
+                        uint32_t const length,
+                        z_io__load_image_handler const handler,
+                        bool * const decoded)
+{
+    if (buffer != NULL && z_io__is_texture(buffer, length)) {
+        int32_t width, height;
+        
+        uint8_t const * const pixels =
+            z_io__texture_pixels(buffer, length, &width, &height);
+        
+        *decoded = pixels != NULL;
+        
+        if (pixels == NULL) {
+            return false;
+        }
+        
+        // already decoded; the pixels are handed over as they are
+        return handler == NULL ||
+            (*handler)(width, height, SHIZTextureComponents, pixels);
+    }
+    
+    int32_t width, height;
+    int32_t components;
+    
+    uint8_t * const image =
+        z_io__decode_image_data(buffer, length, &width, &height, &components);
+    
+    *decoded = image != NULL;
+    
+    if (image == NULL) {
+        return false;
+    }
+    
+    return z_io__handle_image(image, width, height, components, handler);
+}
+
+static
+bool
+z_io__is_texture(uint8_t const * const buffer,
+                 uint32_t const length)
+{
+    return length >= SHIZTextureHeaderSize &&
+        memcmp(buffer, SHIZTextureMagic, 4) == 0;
+}
+
+static
+uint8_t const *
+z_io__texture_pixels(uint8_t const * const buffer,
+                     uint32_t const length,
+                     int32_t * const width,
+                     int32_t * const height)
+{
+    if (!z_io__is_texture(buffer, length) ||
+        z_io__read_u32(buffer + 4) != SHIZTextureVersion) {
+        return NULL;
+    }
+    
+    uint32_t const texture_width = z_io__read_u32(buffer + 8);
+    uint32_t const texture_height = z_io__read_u32(buffer + 12);
+    
+    if (texture_width == 0 || texture_width > INT32_MAX ||
+        texture_height == 0 || texture_height > INT32_MAX) {
+        return NULL;
+    }
+    
+    uint64_t const size = (uint64_t)texture_width * texture_height *
+        SHIZTextureComponents;
+    
+    if (size > length - SHIZTextureHeaderSize) {
+        return NULL;
+    }
+    
+    *width = (int32_t)texture_width;
+    *height = (int32_t)texture_height;
+    
+    return buffer + SHIZTextureHeaderSize;
+}
+
+static
+uint32_t
+z_io__read_u32(uint8_t const * const buffer)
+{
+    return (uint32_t)buffer[0] |
+        ((uint32_t)buffer[1] << 8) |
+        ((uint32_t)buffer[2] << 16) |
+        ((uint32_t)buffer[3] << 24);
+}
+
 static
 bool
 z_io__handle_image(uint8_t * const data,
@@ -196,6 +701,34 @@ z_io__handle_image(uint8_t * const data,
     return true;
 }
 
+static
+void
+z_io__flip_image(uint8_t * const data,
+                 int32_t const width,
+                 int32_t const height)
+{
+    // stbi reads the first pixel at the top-left of the image, however,
+    // opengl expects the first pixel to be at the bottom-left of the image,
+    // so we need to flip it; stbi can do this too, but only through a global
+    // setting, which is not safe while decoding on more than one thread
+    size_t const stride = (size_t)width * STBI_rgb_alpha;
+    
+    uint8_t * top = data;
+    uint8_t * bottom = data + (size_t)(height - 1) * stride;
+    
+    while (top < bottom) {
+        for (size_t i = 0; i < stride; i++) {
+            uint8_t const pixel = top[i];
+            
+            top[i] = bottom[i];
+            bottom[i] = pixel;
+        }
+        
+        top += stride;
+        bottom -= stride;
+    }
+}
+
 static
 void
 z_io__printf(char const * const format, va_list args)
@@ -12,10 +12,35 @@
 #pragma once
 
 #include <stdbool.h> // bool
+#include <stddef.h> // size_t
 #include <stdint.h> // uint8_t, int16_t, uint32_t, int32_t
 
-typedef bool (* z_io__load_image_handler)(int32_t width, int32_t height, int32_t components, uint8_t * data);
+/**
+ * A texture is an image that has already been decoded, so that it can be
+ * loaded without decoding it again:
+ *
+ *   header    magic, version, width, height
+ *   pixels    8-bit RGBA; rows from the bottom of the image to the top
+ *
+ * Every number is stored as a little-endian, 32-bit unsigned integer. The
+ * pixels are exactly as uploaded, so a texture file is never copied when it
+ * is loaded.
+ */
+#define SHIZTextureMagic "SHZT"
+#define SHIZTextureVersion 1
+
+#define SHIZTextureHeaderSize 16
+#define SHIZTextureComponents 4
+
+typedef bool (* z_io__load_image_handler)(int32_t width, int32_t height, int32_t components, uint8_t const * data);
 typedef bool (* z_io__load_sound_handler)(int32_t channels, int32_t sample_rate, int16_t * data, int32_t size);
+/**
+ * @brief Receives the contents of a font file.
+ *
+ * The handler takes ownership of the data if it returns `true`; otherwise the
+ * data is released.
+ */
+typedef bool (* z_io__load_font_handler)(uint8_t * data, uint32_t length);
 
 void z_io__error(char const * format, ...);
 void z_io__warning(char const * format, ...);
@@ -30,3 +55,59 @@ void z_io__warning_context(char const * context, char const * format, ...);
 bool z_io__load_image(char const * filename, z_io__load_image_handler);
 bool z_io__load_image_data(uint8_t const * buffer, uint32_t length, z_io__load_image_handler);
 bool z_io__load_sound(char const * filename, z_io__load_sound_handler);
+bool z_io__load_sound_data(uint8_t const * buffer, uint32_t length, z_io__load_sound_handler);
+bool z_io__load_font(char const * filename, z_io__load_font_handler);
+bool z_io__load_font_data(uint8_t const * buffer, uint32_t length, z_io__load_font_handler);
+
+/**
+ * @brief Decode an image file; flipped so that the first row is at the bottom.
+ *
+ * The file can be either a PNG or a texture. Nothing is reported on failure,
+ * so that images can be decoded from any thread. The pixels are always RGBA,
+ * and must be released with `z_io__free_image`.
+ *
+ * @return The pixels of the image, or `NULL` if it could not be decoded
+ */
+uint8_t * z_io__decode_image(char const * filename, int32_t * width, int32_t * height, int32_t * components);
+uint8_t * z_io__decode_image_data(uint8_t const * buffer, uint32_t length, int32_t * width, int32_t * height, int32_t * components);
+void z_io__free_image(uint8_t * data);
+/**
+ * @brief Determine the size of an image without decoding it.
+ *
+ * Only the header of the image is read.
+ */
+bool z_io__probe_image(char const * filename, int32_t * width, int32_t * height);
+bool z_io__probe_image_data(uint8_t const * buffer, uint32_t length, int32_t * width, int32_t * height);
+/**
+ * @brief Decode a sound file into 16-bit samples.
+ *
+ * Like `z_io__decode_image`, this can be called from any thread. The samples
+ * must be released with `free`.
+ */
+int16_t * z_io__decode_sound(char const * filename, int32_t * channels, int32_t * sample_rate, int32_t * length);
+int16_t * z_io__decode_sound_data(uint8_t const * buffer, uint32_t length, int32_t * channels, int32_t * sample_rate, int32_t * size);
+/**
+ * @brief Read the entire contents of a file; the data must be released with
+ *        `free`.
+ */
+uint8_t * z_io__read_file(char const * filename, uint32_t * length);
+
+/**
+ * @brief Map the entire contents of a file into memory (read-only).
+ *
+ * Nothing is read until it is accessed, so mapping a large file is cheap.
+ * The mapping must be released with `z_io__unmap_file`.
+ *
+ * @return The contents of the file, or `NULL` if it could not be mapped
+ */
+uint8_t const * z_io__map_file(char const * filename, uint32_t * length);
+void z_io__unmap_file(uint8_t const * data, uint32_t length);
+
+/**
+ * @brief Resolve a filename to an absolute path, so that different paths to
+ *        the same file can be told apart from paths to different files.
+ *
+ * If the filename can not be resolved (e.g. because the file does not exist),
+ * it is copied as is.
+ */
+void z_io__canonical_path(char const * filename, char * path, size_t size);
@@ -9,15 +9,148 @@
 // under the terms of the MIT license. See LICENSE for details.
 //
 
+#if defined(__linux__) && !defined(_XOPEN_SOURCE)
+ #define _XOPEN_SOURCE 700 // clock_gettime
+#endif
+
 #include "mixer.h" // z_mixer_*
 #include "res.h" // SHIZResourceSound
 #include "io.h" // z_io_*
+#include "stream.h" // z_stream__*
+#include "bus.h" // z_bus__*
+#include "adpcm.h" // z_adpcm__*, SHIZADPCM*
+#include "ring.h" // z_ring__*, SHIZRing
 
-#include <stdlib.h> // NULL
-#include <stdint.h> // uint8_t, int16_t, in32_t
+#include <stdlib.h> // NULL, malloc, free
+#include <string.h> // memcpy
+#include <stdint.h> // uint8_t, uint16_t, int16_t, in32_t
+#include <math.h> // sqrtf
+#include <time.h> // timespec, clock_gettime
+#include <pthread.h> // pthread_*
 
 #include "internal.h" // ALCdevice, ALCcontext, ALenum, al*
 
+#ifndef AL_FORMAT_MONO_IMA4
+ // AL_EXT_IMA4; not declared by every implementation
+ #define AL_FORMAT_MONO_IMA4 0x1300
+ #define AL_FORMAT_STEREO_IMA4 0x1301
+#endif
+
+#ifndef ALC_FORMAT_CHANNELS_SOFT
+ // ALC_SOFT_loopback; not declared by every implementation
+ #define ALC_FORMAT_CHANNELS_SOFT 0x1990
+ #define ALC_FORMAT_TYPE_SOFT 0x1991
+ #define ALC_STEREO_SOFT 0x1501
+ #define ALC_SHORT_SOFT 0x1402
+#endif
+
+/**
+ * The sample rate that sound is rendered into memory at.
+ */
+#define SHIZMixerRenderRate 48000
+/**
+ * The number of samples rendered at a time; in between, the bus is mixed
+ * and streams are refilled (see `z_bus__update` and `z_stream__update`).
+ */
+#define SHIZMixerRenderFrames 480
+
+/**
+ * The time (in seconds) between scheduling a sound and playing it; at least
+ * as long as a frame (at 30 frames per second), so that sounds scheduled
+ * during any tick of a frame can still play at the time of that tick.
+ */
+#define SHIZMixerScheduleLatency (1.0 / 20)
+/**
+ * The max time (in seconds) that a sound can be scheduled ahead of the
+ * latency; any further (e.g. after the clock was reset) and the clock is
+ * anchored anew.
+ */
+#define SHIZMixerScheduleAheadMax (1.0 / 4)
+
+/**
+ * The max number of commands waiting for the audio thread; e.g. sounds
+ * played during a single frame. A power of two.
+ */
+#define SHIZMixerCommandCount 1024
+/**
+ * The time (in seconds) between processing commands on the audio thread;
+ * i.e. the most that a sound is delayed by.
+ */
+#define SHIZMixerInterval (1.0 / 500)
+
+typedef ALCdevice * (* z_mixer__loopback_open)(ALCchar const * name);
+typedef ALCboolean (* z_mixer__loopback_supports)(ALCdevice * device, ALCsizei rate, ALCenum channels, ALCenum type);
+typedef void (* z_mixer__loopback_render)(ALCdevice * device, ALCvoid * samples, ALCsizei frames);
+
+/**
+ * @brief Represents a source that sounds are played by.
+ */
+typedef struct SHIZMixerVoice {
+    ALuint source_id;
+    /** The sound most recently played by the voice; 0 if none */
+    uint32_t sound_resource_id;
+    /** The order that the voice began playing in; for stealing the oldest */
+    uint32_t sequence;
+    /** The frame that the voice began playing in */
+    uint32_t frame;
+    /** The sample of the bus that the voice was scheduled to start at; 0 if
+        not scheduled (see `z_mixer__schedule_sound`) */
+    uint64_t start;
+    float gain;
+    uint8_t priority;
+} SHIZMixerVoice;
+
+typedef enum SHIZMixerCommandType {
+    SHIZMixerCommandPlay,
+    SHIZMixerCommandStop,
+    SHIZMixerCommandLoop,
+    SHIZMixerCommandDestroy
+} SHIZMixerCommandType;
+
+/**
+ * @brief Represents something to be done by the audio thread.
+ *
+ * The sound is a copy of the resource, rather than looked up by the audio
+ * thread; resources are only ever looked up (and changed) by the main thread.
+ */
+typedef struct SHIZMixerCommand {
+    SHIZResourceSound sound;
+    /** The time of the clock that the sound plays at; if scheduled (see
+        `z_mixer__schedule_sound`) */
+    double time;
+    /** The frame that the command was sent in */
+    uint32_t frame;
+    float gain;
+    float pitch;
+    float pan;
+    SHIZMixerCommandType type;
+    uint8_t priority;
+    bool is_scheduled;
+    bool loop;
+} SHIZMixerCommand;
+
+static ALCdevice * z_mixer__open_loopback(void);
+static void z_mixer__render(void);
+
+static bool z_mixer__send_play(uint32_t sound_resource_id, bool is_scheduled, double time, float gain, float pitch, float pan, uint8_t priority);
+static void z_mixer__send(SHIZMixerCommand const *);
+
+static void * z_mixer__work(void * argument);
+static void z_mixer__process(void);
+static void z_mixer__publish(void);
+
+static void z_mixer__play(SHIZMixerCommand const *);
+static void z_mixer__stop(SHIZResourceSound const *);
+static void z_mixer__destroy(SHIZResourceSound const *);
+static uint64_t z_mixer__start(double time);
+
+static SHIZMixerVoice * z_mixer__voice(uint8_t priority);
+static bool z_mixer__is_playing(SHIZMixerVoice const *);
+static uint16_t z_mixer__index(SHIZMixerVoice const *);
+
+static void z_mixer__create_sources(void);
+static void z_mixer__delete_sources(void);
+
 #ifdef SHIZ_DEBUG
 static
 void
@@ -27,19 +160,106 @@ z_mixer__process_errors(void);
 static ALCdevice * _device;
 static ALCcontext * _context;
 
+// every sound is played (and stopped) on the audio thread; the main thread
+// only sends commands to it, which never waits
+static pthread_t _worker;
+static bool _has_worker = false;
+
+// guards everything below that is only changed by the audio thread (the
+// voices and their usage), the popping end of the commands and the stopping
+// flag; the main thread only locks it to change mixing (usage is published
+// instead, see z_mixer__publish)
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _stopped = PTHREAD_COND_INITIALIZER;
+
+static bool _is_stopping = false;
+
+static SHIZRing _commands;
+static SHIZMixerCommand _command_elements[SHIZMixerCommandCount];
+
+// whether sound is rendered into memory (see SHIZSoundDeviceLoopback)
+static bool _is_rendering = false;
+static z_mixer__loopback_render _render = NULL;
+static uint64_t _rendered_frames = 0;
+static int16_t _rendered[SHIZMixerRenderFrames * 2];
+
+// while mixing in software, every voice of the bus is used; otherwise only
+// those with a source
+static SHIZMixerVoice _voices[SHIZBusVoiceCount];
+static bool _playing[SHIZBusVoiceCount];
+
+static uint16_t _voice_count = 0;
+static uint16_t _source_count = 0;
+
+static bool _is_mixing = false;
+static bool _is_compressing = false;
+// whether OpenAL takes compressed samples as they are
+static bool _has_ima4 = false;
+
+// the number of sounds created (not streamed); mixing can only be changed
+// while there are none
+static uint32_t _sound_count = 0;
+// the size of the samples of every sound created
+static uint64_t _bytes = 0;
+// the number of sounds not played, because too many commands were waiting
+static uint32_t _unsent = 0;
+
+static SHIZSoundUsage _usage;
+
+// a copy of the usage (of every voice, aside from the bus), published by
+// whichever thread processes commands; the sequence is odd while it is being
+// written, so that a reader can tell whether it read the copy half-written
+static SHIZSoundUsage _published_usage;
+static uint32_t _published_sequence = 0;
+
+static uint32_t _sequence = 0;
+static uint32_t _frame = 0;
+
+// the sample of the bus that the time 0 of the clock plays at; found the
+// first time a sound is scheduled
+static int64_t _schedule_offset = 0;
+static bool _is_scheduling = false;
+
 bool
-z_mixer__init()
+z_mixer__init(SHIZSoundDevice const device)
 {
-    _device = alcOpenDevice(NULL);
+    _device = NULL;
+    _is_rendering = false;
+    
+    if (device == SHIZSoundDeviceDefault) {
+        _device = alcOpenDevice(NULL);
+        
+        if (!_device) {
+            z_io__warning("could not open a sound device; rendering sound into memory instead");
+        }
+    }
     
     if (!_device) {
+        _device = z_mixer__open_loopback();
+        
+        if (!_device) {
+            z_io__error("could not render sound into memory; not supported");
 #ifdef SHIZ_DEBUG
-        z_mixer__process_errors();
+            z_mixer__process_errors();
 #endif
-        return false;
+            return false;
+        }
+        
+        _is_rendering = true;
     }
     
-    _context = alcCreateContext(_device, NULL);
+    // while rendering, streams are decoded in step with it instead
+    z_stream__init(!_is_rendering);
+    
+    // a loopback device must be told what to render
+    ALCint const attributes[] = {
+        ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+        ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+        ALC_FREQUENCY, SHIZMixerRenderRate,
+        0
+    };
+    
+    _context = alcCreateContext(_device, _is_rendering ? attributes : NULL);
     
     if (!alcMakeContextCurrent(_context)) {
 #ifdef SHIZ_DEBUG
@@ -57,6 +277,39 @@ z_mixer__init()
     alListener3f(AL_VELOCITY, 0, 0, 0);
     alListenerfv(AL_ORIENTATION, orientation);
     
+    _has_ima4 = alIsExtensionPresent("AL_EXT_IMA4") == AL_TRUE;
+    
+    z_mixer__create_sources();
+    
+    if (_voice_count == 0) {
+        z_io__error("could not create any voices");
+        
+        return false;
+    }
+    
+    _usage = (SHIZSoundUsage) {
+        .voices = _voice_count
+    };
+    
+    z_ring__init(&_commands, _command_elements, SHIZMixerCommandCount,
+                 sizeof(SHIZMixerCommand));
+    
+    z_mixer__publish();
+    
+    if (_is_rendering) {
+        // begin rendering from now on; commands are processed as sound is
+        // rendered, rather than on a thread of their own
+        _rendered_frames = (uint64_t)(z_time__get_ticked() * SHIZMixerRenderRate);
+    } else {
+        if (pthread_create(&_worker, NULL, z_mixer__work, NULL) != 0) {
+            z_io__error("could not play sounds; no thread");
+            
+            return false;
+        }
+        
+        _has_worker = true;
+    }
+    
     return true;
 }
 
@@ -66,7 +319,33 @@ z_mixer__kill()
     if (_device == NULL) {
         return false;
     }
-
+    
+    if (_has_worker) {
+        pthread_mutex_lock(&_mutex);
+        
+        _is_stopping = true;
+        
+        pthread_cond_signal(&_stopped);
+        pthread_mutex_unlock(&_mutex);
+        
+        pthread_join(_worker, NULL);
+        
+        _has_worker = false;
+        _is_stopping = false;
+    }
+    
+    // anything still waiting is done right away; e.g. freeing the samples
+    // of destroyed sounds
+    z_mixer__process();
+    
+    z_bus__kill();
+    
+    _is_mixing = false;
+    
+    z_mixer__delete_sources();
+    
+    z_stream__kill();
+    
     alcMakeContextCurrent(NULL);
     alcDestroyContext(_context);
     
@@ -81,25 +360,185 @@ z_mixer__kill()
 }
 
 void
-z_mixer__play_sound(uint8_t const sound_resource_id)
+z_mixer__reset()
 {
-    SHIZResourceSound const resource = z_res__sound(sound_resource_id);
+    _frame += 1;
     
-    alSourcePlay(resource.source_id);
-#ifdef SHIZ_DEBUG
-    z_mixer__process_errors();
-#endif
+    if (_is_rendering) {
+        pthread_mutex_lock(&_mutex);
+        
+        z_mixer__process();
+        z_mixer__render();
+        z_mixer__publish();
+        
+        pthread_mutex_unlock(&_mutex);
+    }
 }
 
 void
-z_mixer__stop_sound(uint8_t const sound_resource_id)
+z_mixer__sync()
 {
-    SHIZResourceSound const resource = z_res__sound(sound_resource_id);
+    pthread_mutex_lock(&_mutex);
     
-    alSourceStop(resource.source_id);
-#ifdef SHIZ_DEBUG
-    z_mixer__process_errors();
-#endif
+    z_mixer__process();
+    z_mixer__publish();
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+bool
+z_mixer__set_mixing(bool const enabled)
+{
+    if (enabled == _is_mixing) {
+        return true;
+    }
+    
+    if (_sound_count > 0) {
+        // the samples of every sound are kept differently while mixing
+        z_io__warning("could not change mixing; unload every sound first");
+        
+        return false;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    // anything sent before is done as before
+    z_mixer__process();
+    
+    bool changed = true;
+    
+    if (enabled) {
+        // the sources of the voices are not needed while mixing; let the bus
+        // have one of them instead, in case sources are few
+        z_mixer__delete_sources();
+        
+        // while rendering, the bus is mixed in step with it instead
+        if (z_bus__init(!_is_rendering)) {
+            for (uint16_t i = 0; i < SHIZBusVoiceCount; i++) {
+                _voices[i].sound_resource_id = SHIZResourceInvalid;
+            }
+            
+            _voice_count = SHIZBusVoiceCount;
+        } else {
+            z_mixer__create_sources();
+            
+            changed = false;
+        }
+    } else {
+        z_bus__kill();
+        
+        z_mixer__create_sources();
+    }
+    
+    if (changed) {
+        _is_mixing = enabled;
+        _is_scheduling = false;
+    }
+    
+    _usage.voices = _voice_count;
+    
+    z_mixer__publish();
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return changed;
+}
+
+void
+z_mixer__set_compressing(bool const enabled)
+{
+    _is_compressing = enabled;
+}
+
+bool
+z_mixer__play_sound(uint32_t const sound_resource_id,
+                    float const gain,
+                    float const pitch,
+                    float const pan,
+                    uint8_t const priority)
+{
+    return z_mixer__send_play(sound_resource_id, false, 0,
+                              gain, pitch, pan, priority);
+}
+
+bool
+z_mixer__schedule_sound(uint32_t const sound_resource_id,
+                        double const time,
+                        float const gain,
+                        float const pitch,
+                        float const pan,
+                        uint8_t const priority)
+{
+    return z_mixer__send_play(sound_resource_id, true, time,
+                              gain, pitch, pan, priority);
+}
+
+void
+z_mixer__stop_sound(uint32_t const sound_resource_id)
+{
+    SHIZResourceSound const * const resource = z_res__sound(sound_resource_id);
+    
+    if (resource == NULL) {
+        return;
+    }
+    
+    SHIZMixerCommand const command = {
+        .type = SHIZMixerCommandStop,
+        .sound = *resource
+    };
+    
+    z_mixer__send(&command);
+}
+
+bool
+z_mixer__loop_sound(uint32_t const sound_resource_id,
+                    bool const loop)
+{
+    SHIZResourceSound const * const resource = z_res__sound(sound_resource_id);
+    
+    if (resource == NULL || resource->stream == NULL) {
+        return false;
+    }
+    
+    SHIZMixerCommand const command = {
+        .type = SHIZMixerCommandLoop,
+        .sound = *resource,
+        .loop = loop
+    };
+    
+    z_mixer__send(&command);
+    
+    return true;
+}
+
+SHIZSoundUsage
+z_mixer__usage()
+{
+    SHIZSoundUsage usage;
+    
+    uint32_t sequence;
+    
+    do {
+        // retry until the copy was not being published meanwhile
+        sequence = __atomic_load_n(&_published_sequence, __ATOMIC_ACQUIRE);
+        
+        usage = _published_usage;
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((sequence & 1) != 0 ||
+             sequence != __atomic_load_n(&_published_sequence,
+                                         __ATOMIC_RELAXED));
+    
+    if (_is_mixing) {
+        usage.mix_time = z_bus__mix_time();
+    }
+    
+    usage.decode_time = z_stream__decode_time();
+    
+    usage.bytes = _bytes;
+    usage.drops += _unsent;
+    
+    return usage;
 }
 
 bool
@@ -113,32 +552,96 @@ z_mixer__create_sound(SHIZResourceSound * const resource,
         return false;
     }
     
-    alGenSources(1, &resource->source_id);
-    alGenBuffers(1, &resource->buffer_id);
-    
-    alSourcef(resource->source_id, AL_PITCH, 1);
-    alSourcef(resource->source_id, AL_GAIN, 1);
-    alSource3f(resource->source_id, AL_POSITION, 0, 0, 0);
-    alSource3f(resource->source_id, AL_VELOCITY, 0, 0, 0);
-    alSourcei(resource->source_id, AL_LOOPING, AL_FALSE);
+    resource->channels = channels > 1 ? 2 : 1;
+    resource->sample_rate = sample_rate;
+    resource->frames = (uint32_t)size /
+        (uint32_t)(sizeof(int16_t) * resource->channels);
     
-    bool stereo = channels > 1;
+    uint8_t * blocks = NULL;
+    uint32_t blocks_size = 0;
     
-    ALenum format = stereo ?
-        AL_FORMAT_STEREO16 :
-        AL_FORMAT_MONO16;
+    if (_is_compressing && (_is_mixing || _has_ima4)) {
+        blocks_size = z_adpcm__blocks(resource->frames) *
+            SHIZADPCMBlockSize * resource->channels;
+        
+        blocks = malloc(blocks_size);
+        
+        if (blocks == NULL) {
+            return false;
+        }
+        
+        z_adpcm__encode(data, resource->frames, resource->channels, blocks);
+    }
     
-    alBufferData(resource->buffer_id,
-                 format, data, size, sample_rate);
-
-    alSourcei(resource->source_id, AL_BUFFER,
-              (ALint)resource->buffer_id);
+    if (_is_mixing) {
+        // the samples are read while mixing; keep them (or a copy of them)
+        if (blocks != NULL) {
+            resource->blocks = blocks;
+            resource->size = blocks_size;
+        } else {
+            resource->samples = malloc((size_t)size);
+            
+            if (resource->samples == NULL) {
+                return false;
+            }
+            
+            memcpy(resource->samples, data, (size_t)size);
+            
+            resource->size = (uint32_t)size;
+        }
+    } else {
+        alGenBuffers(1, &resource->buffer_id);
+        
+        bool stereo = resource->channels > 1;
+        
+        if (blocks != NULL) {
+            ALenum format = stereo ?
+                AL_FORMAT_STEREO_IMA4 :
+                AL_FORMAT_MONO_IMA4;
+            
+            alBufferData(resource->buffer_id,
+                         format, blocks, (ALsizei)blocks_size, sample_rate);
+            
+            free(blocks);
+            
+            resource->size = blocks_size;
+        } else {
+            ALenum format = stereo ?
+                AL_FORMAT_STEREO16 :
+                AL_FORMAT_MONO16;
+            
+            alBufferData(resource->buffer_id,
+                         format, data, size, sample_rate);
+            
+            resource->size = (uint32_t)size;
+        }
 #ifdef SHIZ_DEBUG
-    z_mixer__process_errors();
+        z_mixer__process_errors();
 #endif
+    }
+    
+    _sound_count += 1;
+    
+    _bytes += resource->size;
+    
     return true;
 }
 
+bool
+z_mixer__create_stream(SHIZResourceSound * const resource,
+                       char const * const filename,
+                       uint8_t const * const data,
+                       uint32_t const length)
+{
+    if (resource == NULL) {
+        return false;
+    }
+    
+    resource->stream = z_stream__open(filename, data, length);
+    
+    return resource->stream != NULL;
+}
+
 bool
 z_mixer__destroy_sound(SHIZResourceSound const * const resource)
 {
@@ -146,17 +649,549 @@ z_mixer__destroy_sound(SHIZResourceSound const * const resource)
         return false;
     }
     
-    if (resource->source_id != 0) {
-        alDeleteSources(1, &resource->source_id);
+    if (resource->stream == NULL) {
+        if (_sound_count > 0) {
+            _sound_count -= 1;
+        }
+        
+        _bytes -= resource->size;
+    }
+    
+    // the sound may still be playing; it is stopped (and its samples freed)
+    // by the audio thread, once done with every command sent before
+    SHIZMixerCommand const command = {
+        .type = SHIZMixerCommandDestroy,
+        .sound = *resource
+    };
+    
+    z_mixer__send(&command);
+    
+    return true;
+}
+
+static
+bool
+z_mixer__send_play(uint32_t const sound_resource_id,
+                   bool const is_scheduled,
+                   double const time,
+                   float const gain,
+                   float const pitch,
+                   float const pan,
+                   uint8_t const priority)
+{
+    SHIZResourceSound const * const resource = z_res__sound(sound_resource_id);
+    
+    if (resource == NULL) {
+        return false;
+    }
+    
+    SHIZMixerCommand const command = {
+        .type = SHIZMixerCommandPlay,
+        .sound = *resource,
+        .time = time,
+        .frame = _frame,
+        .gain = gain,
+        .pitch = pitch,
+        .pan = pan,
+        .priority = priority,
+        .is_scheduled = is_scheduled
+    };
+    
+    if (!z_ring__push(&_commands, &command)) {
+        // too many sounds at once; rather than waiting, the sound is dropped
+        _unsent += 1;
+        
+        return false;
+    }
+    
+    return true;
+}
+
+static
+void
+z_mixer__send(SHIZMixerCommand const * const command)
+{
+    if (z_ring__push(&_commands, command)) {
+        return;
+    }
+    
+    // every command is waiting; unlike playing, this one must not be
+    // dropped, so do every command right away to make room for it
+    pthread_mutex_lock(&_mutex);
+    
+    z_mixer__process();
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    z_ring__push(&_commands, command);
+}
+
+static
+void *
+z_mixer__work(void * const argument)
+{
+    (void)argument;
+    
+    pthread_mutex_lock(&_mutex);
+    
+    while (!_is_stopping) {
+        z_mixer__process();
+        z_mixer__publish();
+        
+        // nothing tells the thread that a command was sent (that could make
+        // the sender wait); instead, it checks back at a steady interval
+        struct timespec deadline;
+        
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        
+        deadline.tv_nsec += (long)(SHIZMixerInterval * 1000000000L);
+        
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        
+        pthread_cond_timedwait(&_stopped, &_mutex, &deadline);
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return NULL;
+}
+
+static
+void
+z_mixer__process()
+{
+    SHIZMixerCommand command;
+    
+    while (z_ring__pop(&_commands, &command)) {
+        if (command.type == SHIZMixerCommandPlay) {
+            z_mixer__play(&command);
+        } else if (command.type == SHIZMixerCommandStop) {
+            z_mixer__stop(&command.sound);
+        } else if (command.type == SHIZMixerCommandLoop) {
+            z_stream__loop(command.sound.stream, command.loop);
+        } else if (command.type == SHIZMixerCommandDestroy) {
+            z_mixer__destroy(&command.sound);
+        }
+    }
+}
+
+static
+void
+z_mixer__publish()
+{
+    SHIZSoundUsage usage = _usage;
+    
+    if (_is_mixing) {
+        usage.playing = z_bus__playing_count();
+    } else {
+        usage.playing = 0;
+        
+        for (uint16_t i = 0; i < _voice_count; i++) {
+            if (z_mixer__is_playing(&_voices[i])) {
+                usage.playing += 1;
+            }
+        }
+    }
+    
+    // only ever published with the lock held, so there is one writer at most
+    uint32_t const sequence = _published_sequence;
+    
+    __atomic_store_n(&_published_sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    _published_usage = usage;
+    
+    __atomic_store_n(&_published_sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+static
+void
+z_mixer__play(SHIZMixerCommand const * const command)
+{
+    SHIZResourceSound const * const resource = &command->sound;
+    
+    float const gain = command->gain;
+    // OpenAL rejects a pitch that is not positive (leaving the pitch of the
+    // last sound played by the source), and the bus cannot step backwards
+    float const pitch = !(command->pitch >= SHIZBusPitchMin) ? SHIZBusPitchMin :
+        (command->pitch > SHIZBusPitchMax ? SHIZBusPitchMax : command->pitch);
+    float const pan = command->pan;
+    
+    uint8_t const priority = command->priority;
+    
+    if (resource->stream != NULL) {
+        // a stream plays by itself, and restarts if already playing
+        z_stream__play(resource->stream, gain, pitch);
+        
+        _usage.plays += 1;
+        
+        return;
+    }
+    
+    // only the bus can start a sound partway through; otherwise, it simply
+    // plays right away
+    uint64_t const start = _is_mixing && command->is_scheduled ?
+        z_mixer__start(command->time) : 0;
+    
+    float const balance = pan < -1 ? -1 : (pan > 1 ? 1 : pan);
+    
+    for (uint16_t i = 0; i < _voice_count; i++) {
+        SHIZMixerVoice * const voice = &_voices[i];
+        
+        if (voice->sound_resource_id == resource->resource_id &&
+            voice->frame == command->frame && voice->start == start &&
+            z_mixer__is_playing(voice)) {
+            // playing the same sound more than once at the same time only
+            // makes it louder; play it once, as loud as the loudest
+            if (gain > voice->gain) {
+                voice->gain = gain;
+                
+                if (_is_mixing) {
+                    z_bus__set_gain(i, gain);
+                } else {
+                    alSourcef(voice->source_id, AL_GAIN, gain);
+                }
+            }
+            
+            if (priority > voice->priority) {
+                voice->priority = priority;
+            }
+            
+            _usage.merges += 1;
+            
+            return;
+        }
+    }
+    
+    SHIZMixerVoice * const voice = z_mixer__voice(priority);
+    
+    if (voice == NULL) {
+        _usage.drops += 1;
+        
+        return;
+    }
+    
+    if (z_mixer__is_playing(voice)) {
+        if (!_is_mixing) {
+            alSourceStop(voice->source_id);
+        }
+        
+        _usage.steals += 1;
+    }
+    
+    if (_is_mixing) {
+        // the voice simply replaces what it was playing
+        if (resource->blocks != NULL) {
+            z_bus__play_compressed(z_mixer__index(voice),
+                                   resource->blocks, resource->frames,
+                                   resource->channels, resource->sample_rate,
+                                   gain, pitch, balance, start);
+        } else {
+            z_bus__play(z_mixer__index(voice),
+                        resource->samples, resource->frames,
+                        resource->channels, resource->sample_rate,
+                        gain, pitch, balance, start);
+        }
+    } else {
+        // the listener is at (0, 0, 1) facing along z, so its right is
+        // towards -x; a sound is kept at the same distance however panned
+        // (only a mono sound is positioned; a stereo sound is played as is)
+        float const x = -balance;
+        float const z = 1 - sqrtf(1 - balance * balance);
+        
+        // every voice playing the same sound shares its buffer
+        alSourcei(voice->source_id, AL_BUFFER, (ALint)resource->buffer_id);
+        alSourcef(voice->source_id, AL_GAIN, gain);
+        alSourcef(voice->source_id, AL_PITCH, pitch);
+        alSource3f(voice->source_id, AL_POSITION, x, 0, z);
+        
+        alSourcePlay(voice->source_id);
+#ifdef SHIZ_DEBUG
+        z_mixer__process_errors();
+#endif
+    }
+    
+    voice->sound_resource_id = resource->resource_id;
+    voice->sequence = _sequence++;
+    voice->frame = command->frame;
+    voice->start = start;
+    voice->gain = gain;
+    voice->priority = priority;
+    
+    _usage.plays += 1;
+}
+
+static
+void
+z_mixer__stop(SHIZResourceSound const * const resource)
+{
+    if (resource->stream != NULL) {
+        z_stream__stop(resource->stream);
+        
+        return;
+    }
+    
+    for (uint16_t i = 0; i < _voice_count; i++) {
+        SHIZMixerVoice const * const voice = &_voices[i];
+        
+        if (voice->sound_resource_id == resource->resource_id) {
+            if (_is_mixing) {
+                z_bus__stop(i);
+            } else {
+                alSourceStop(voice->source_id);
+            }
+        }
+    }
+#ifdef SHIZ_DEBUG
+    z_mixer__process_errors();
+#endif
+}
+
+static
+void
+z_mixer__destroy(SHIZResourceSound const * const resource)
+{
+    if (resource->stream != NULL) {
+        z_stream__close(resource->stream);
+        
+        return;
+    }
+    
+    for (uint16_t i = 0; i < _voice_count; i++) {
+        SHIZMixerVoice * const voice = &_voices[i];
+        
+        if (voice->sound_resource_id == resource->resource_id) {
+            if (_is_mixing) {
+                // once stopped, the samples are no longer read
+                z_bus__stop(i);
+            } else {
+                // a buffer can not be deleted while attached to a source
+                alSourceStop(voice->source_id);
+                alSourcei(voice->source_id, AL_BUFFER, 0);
+            }
+            
+            voice->sound_resource_id = SHIZResourceInvalid;
+        }
     }
     
     if (resource->buffer_id != 0) {
         alDeleteBuffers(1, &resource->buffer_id);
     }
+    
+    free(resource->samples);
+    free(resource->blocks);
 #ifdef SHIZ_DEBUG
     z_mixer__process_errors();
 #endif
-    return true;
+}
+
+static
+SHIZMixerVoice *
+z_mixer__voice(uint8_t const priority)
+{
+    SHIZMixerVoice * stolen = NULL;
+    
+    if (_is_mixing) {
+        // one look at every voice, rather than one at a time
+        z_bus__get_playing(_playing, _voice_count);
+    }
+    
+    for (uint16_t i = 0; i < _voice_count; i++) {
+        SHIZMixerVoice * const voice = &_voices[i];
+        
+        bool const is_playing = _is_mixing ?
+            voice->sound_resource_id != SHIZResourceInvalid && _playing[i] :
+            z_mixer__is_playing(voice);
+        
+        if (!is_playing) {
+            return voice;
+        }
+        
+        // otherwise steal the voice of least priority; of those, the oldest
+        if (voice->priority <= priority &&
+            (stolen == NULL ||
+             voice->priority < stolen->priority ||
+             (voice->priority == stolen->priority &&
+              voice->sequence < stolen->sequence))) {
+            stolen = voice;
+        }
+    }
+    
+    return stolen;
+}
+
+static
+bool
+z_mixer__is_playing(SHIZMixerVoice const * const voice)
+{
+    if (voice->sound_resource_id == SHIZResourceInvalid) {
+        return false;
+    }
+    
+    if (_is_mixing) {
+        return z_bus__is_playing(z_mixer__index(voice));
+    }
+    
+    ALint state;
+    
+    alGetSourcei(voice->source_id, AL_SOURCE_STATE, &state);
+    
+    return state == AL_PLAYING;
+}
+
+static
+uint64_t
+z_mixer__start(double const time)
+{
+    int64_t const mixed_frames = (int64_t)z_bus__mixed_frames();
+    int64_t const frame = (int64_t)(time * SHIZBusSampleRate);
+    
+    int64_t const latency = (int64_t)(SHIZMixerScheduleLatency * SHIZBusSampleRate);
+    int64_t const ahead = (int64_t)(SHIZMixerScheduleAheadMax * SHIZBusSampleRate);
+    
+    int64_t start = frame + _schedule_offset;
+    
+    if (!_is_scheduling ||
+        start < mixed_frames || start > mixed_frames + latency + ahead) {
+        // too late to play at the time (or too far ahead); e.g. after a
+        // stall, or if the clock was reset or scaled. Anchor the clock anew,
+        // so that the sound (and those that follow) plays after the latency
+        _schedule_offset = mixed_frames + latency - frame;
+        _is_scheduling = true;
+        
+        start = mixed_frames + latency;
+    }
+    
+    return (uint64_t)start;
+}
+
+static
+ALCdevice *
+z_mixer__open_loopback()
+{
+    if (!alcIsExtensionPresent(NULL, "ALC_SOFT_loopback")) {
+        return NULL;
+    }
+    
+    z_mixer__loopback_open const open =
+        (z_mixer__loopback_open)alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT");
+    z_mixer__loopback_supports const supports =
+        (z_mixer__loopback_supports)alcGetProcAddress(NULL, "alcIsRenderFormatSupportedSOFT");
+    
+    _render = (z_mixer__loopback_render)alcGetProcAddress(NULL, "alcRenderSamplesSOFT");
+    
+    if (open == NULL || supports == NULL || _render == NULL) {
+        return NULL;
+    }
+    
+    ALCdevice * const device = open(NULL);
+    
+    if (device == NULL) {
+        return NULL;
+    }
+    
+    if (!supports(device, SHIZMixerRenderRate, ALC_STEREO_SOFT, ALC_SHORT_SOFT)) {
+        alcCloseDevice(device);
+        
+        return NULL;
+    }
+    
+    return device;
+}
+
+static
+void
+z_mixer__render()
+{
+    // render as much sound as has been ticked, rather than as much time as
+    // has passed; so the same ticks always render the same sound, however
+    // long each frame took. A little at a time, so that the bus is mixed
+    // and streams are refilled in between, just as if it was playing
+    uint64_t const frames = (uint64_t)(z_time__get_ticked() * SHIZMixerRenderRate);
+    
+    if (frames <= _rendered_frames) {
+        // the clock may have been reset; carry on from there
+        _rendered_frames = frames;
+        
+        return;
+    }
+    
+    double const start = glfwGetTime();
+    
+    while (_rendered_frames < frames) {
+        uint64_t const remaining = frames - _rendered_frames;
+        
+        ALCsizei const count = remaining < SHIZMixerRenderFrames ?
+            (ALCsizei)remaining : SHIZMixerRenderFrames;
+        
+        _render(_device, _rendered, count);
+        
+        if (_is_mixing) {
+            z_bus__update();
+        }
+        
+        z_stream__update();
+        
+        _rendered_frames += (uint64_t)count;
+        
+        _usage.audio_time += (double)count / SHIZMixerRenderRate;
+    }
+    
+    _usage.render_time += glfwGetTime() - start;
+}
+
+static
+uint16_t
+z_mixer__index(SHIZMixerVoice const * const voice)
+{
+    return (uint16_t)(voice - _voices);
+}
+
+static
+void
+z_mixer__create_sources()
+{
+    // sources are limited (and expensive to create); create them once, and
+    // play every sound through them
+    while (_source_count < SHIZMixerVoiceCount) {
+        SHIZMixerVoice * const voice = &_voices[_source_count];
+        
+        alGetError();
+        alGenSources(1, &voice->source_id);
+        
+        if (alGetError() != AL_NO_ERROR) {
+            break;
+        }
+        
+        alSource3f(voice->source_id, AL_POSITION, 0, 0, 0);
+        alSource3f(voice->source_id, AL_VELOCITY, 0, 0, 0);
+        alSourcei(voice->source_id, AL_LOOPING, AL_FALSE);
+        
+        _source_count += 1;
+    }
+    
+    for (uint16_t i = 0; i < SHIZBusVoiceCount; i++) {
+        _voices[i].sound_resource_id = SHIZResourceInvalid;
+    }
+    
+    _voice_count = _source_count;
+}
+
+static
+void
+z_mixer__delete_sources()
+{
+    for (uint16_t i = 0; i < _source_count; i++) {
+        alDeleteSources(1, &_voices[i].source_id);
+        
+        _voices[i].source_id = 0;
+    }
+    
+    _voice_count = 0;
+    _source_count = 0;
 }
 
 #ifdef SHIZ_DEBUG
@@ -14,13 +14,104 @@
 #include <stdbool.h> // bool
 #include <stdint.h> // uint8_t, int16_t, int32_t
 
+#include <SHIZEN/zsound.h> // SHIZSoundUsage
+
 #include "res.h" // SHIZResourceSound
 
-bool z_mixer__init(void);
+/**
+ * The max number of sounds that can play at the same time; each is played
+ * by a voice (an OpenAL source) out of a fixed pool. While mixing in
+ * software, there is a voice for every voice of the bus instead (see
+ * `SHIZBusVoiceCount`).
+ */
+#define SHIZMixerVoiceCount 32
+
+/**
+ * @brief Open a sound device; or render sound into memory instead.
+ *
+ * Sounds are played, stopped and destroyed on an audio thread of its own;
+ * each call merely sends a command to it, without waiting (or locking), so
+ * that the main thread is never held up by OpenAL. Commands must only be
+ * sent from the main thread.
+ *
+ * When rendering, sound is rendered as the clock ticks; every frame (see
+ * `z_mixer__reset`), as much as the ticks since the previous frame lasted.
+ * There is no audio thread then; instead, commands are processed, the bus
+ * is mixed and streams are decoded as sound is rendered, so that the same
+ * ticks always render the same sound.
+ */
+bool z_mixer__init(SHIZSoundDevice device);
 bool z_mixer__kill(void);
 
-void z_mixer__play_sound(uint8_t sound_resource_id);
-void z_mixer__stop_sound(uint8_t sound_resource_id);
+/**
+ * @brief Begin a new frame.
+ *
+ * A sound played more than once during the same frame is only played once.
+ */
+void z_mixer__reset(void);
+/**
+ * @brief Do every command sent so far right away, rather than waiting for
+ *        the audio thread to get to them; e.g. so that the streams of
+ *        destroyed sounds are closed once this returns.
+ */
+void z_mixer__sync(void);
+
+/**
+ * @brief Set whether sounds are mixed in software (see `z_bus`), rather than
+ *        played by a source each.
+ *
+ * Can only be changed while no sounds are loaded (streams aside). Waits for
+ * the audio thread to finish every command sent before.
+ *
+ * @return `true` if mixing was enabled (or disabled), `false` otherwise
+ */
+bool z_mixer__set_mixing(bool enabled);
+/**
+ * @brief Set whether sounds created from now on are kept compressed.
+ *
+ * While mixing in software, a compressed sound is decoded a little at a
+ * time as it plays (see `z_bus__play_compressed`). Otherwise, it is only
+ * kept compressed if OpenAL supports IMA-ADPCM (`AL_EXT_IMA4`).
+ */
+void z_mixer__set_compressing(bool enabled);
+
+/**
+ * @brief Play a sound on a voice of its own.
+ *
+ * If every voice is playing, the voice of least priority (and of those, the
+ * oldest) is stolen; unless all of them are of higher priority than the
+ * sound, in which case the sound is not played (see `SHIZSoundUsage`).
+ *
+ * @return `true` if the sound is about to play, `false` if there is no such
+ *         sound, or too many commands are already waiting
+ */
+bool z_mixer__play_sound(uint32_t sound_resource_id, float gain, float pitch, float pan, uint8_t priority);
+/**
+ * @brief Play a sound at a time of the clock; e.g. the time of the tick
+ *        that played it.
+ *
+ * While mixing in software, the sound starts at the sample that matches the
+ * time, a short latency from now (see `SHIZMixerScheduleLatency`); so sounds
+ * played during the ticks of a frame are as far apart as those ticks, rather
+ * than all playing at once. Otherwise, the sound simply plays right away.
+ */
+bool z_mixer__schedule_sound(uint32_t sound_resource_id, double time, float gain, float pitch, float pan, uint8_t priority);
+/**
+ * @brief Stop every voice playing a sound.
+ */
+void z_mixer__stop_sound(uint32_t sound_resource_id);
+/**
+ * @brief Set whether a streamed sound starts over once it ends.
+ *
+ * @return `true` if the sound is streamed, `false` otherwise
+ */
+bool z_mixer__loop_sound(uint32_t sound_resource_id, bool loop);
+
+/**
+ * @brief Determine the usage of voices, as last published by the audio
+ *        thread; never waits on it, however busy.
+ */
+SHIZSoundUsage z_mixer__usage(void);
 
 bool z_mixer__create_sound(SHIZResourceSound * resource,
                            int32_t channels,
@@ -28,4 +119,18 @@ bool z_mixer__create_sound(SHIZResourceSound * resource,
                            int16_t * data,
                            int32_t size);
 
+/**
+ * @brief Create a sound that is decoded while it plays (see `z_stream`).
+ */
+bool z_mixer__create_stream(SHIZResourceSound * resource,
+                            char const * filename,
+                            uint8_t const * data,
+                            uint32_t length);
+
+/**
+ * @brief Destroy a sound once every command sent before has been processed.
+ *
+ * The resource is copied; its samples are freed by the audio thread, once
+ * no voice is playing them.
+ */
 bool z_mixer__destroy_sound(SHIZResourceSound const * resource);
@@ -0,0 +1,279 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#include "pack.h"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // NULL, size_t
+#include <string.h> // memcmp, memcpy, strcmp, strlen
+
+#include "io.h" // z_io__map_file, z_io__unmap_file, z_io__error
+#include "async.h" // z_async__wait
+#include "mixer.h" // z_mixer__sync
+#include "stream.h" // z_stream__reads
+
+typedef struct SHIZPack {
+    /** A copy of the filename that the pack was loaded from */
+    char * filename;
+    uint8_t const * data;
+    uint32_t length;
+    uint32_t entry_count;
+    uint32_t names_offset;
+} SHIZPack;
+
+static bool z_pack__validate(SHIZPack const *);
+static uint32_t z_pack__read(uint8_t const * data, uint32_t offset);
+static int z_pack__compare(SHIZPack const *, uint32_t entry, char const * name, size_t length);
+
+static SHIZPack _packs[SHIZPackMax];
+static uint8_t _pack_count = 0;
+
+bool
+z_pack__load(char const * const filename)
+{
+    if (_pack_count >= SHIZPackMax) {
+        z_io__error("pack not loaded ('%s'); pack limit reached (%d)",
+                    filename, SHIZPackMax);
+        
+        return false;
+    }
+    
+    SHIZPack pack;
+    
+    pack.data = z_io__map_file(filename, &pack.length);
+    
+    if (pack.data == NULL) {
+        z_io__error("pack not loaded ('%s'); could not be read", filename);
+        
+        return false;
+    }
+    
+    if (pack.length < SHIZPackHeaderSize ||
+        memcmp(pack.data, SHIZPackMagic, 4) != 0 ||
+        z_pack__read(pack.data, 4) != SHIZPackVersion) {
+        z_io__error("pack not loaded ('%s'); not a pack", filename);
+        
+        z_io__unmap_file(pack.data, pack.length);
+        
+        return false;
+    }
+    
+    pack.entry_count = z_pack__read(pack.data, 8);
+    pack.names_offset = z_pack__read(pack.data, 12);
+    
+    if (!z_pack__validate(&pack)) {
+        z_io__error("pack not loaded ('%s'); table of contents is damaged",
+                    filename);
+        
+        z_io__unmap_file(pack.data, pack.length);
+        
+        return false;
+    }
+    
+    // the pack is unloaded by the same name, which may be long gone by then
+    size_t const filename_length = strlen(filename);
+    
+    pack.filename = malloc(filename_length + 1);
+    
+    if (pack.filename == NULL) {
+        z_io__unmap_file(pack.data, pack.length);
+        
+        return false;
+    }
+    
+    memcpy(pack.filename, filename, filename_length + 1);
+    
+    _packs[_pack_count] = pack;
+    _pack_count += 1;
+    
+    return true;
+}
+
+bool
+z_pack__unload(char const * const filename)
+{
+    for (uint8_t i = 0; i < _pack_count; i++) {
+        if (strcmp(_packs[i].filename, filename) == 0) {
+            // anything found in the pack and still being decoded in the
+            // background is read straight out of it, as is any stream
+            // (including those of sounds just unloaded, until closed by the
+            // audio thread); so finish all of that before unmapping
+            z_async__wait();
+            z_mixer__sync();
+            
+            if (z_stream__reads(_packs[i].data, _packs[i].length)) {
+                z_io__error("pack not unloaded ('%s'); still streaming from it",
+                            filename);
+                
+                return false;
+            }
+            
+            z_io__unmap_file(_packs[i].data, _packs[i].length);
+            
+            free(_packs[i].filename);
+            
+            // keep the remaining packs in the order they were loaded
+            for (uint8_t j = i + 1; j < _pack_count; j++) {
+                _packs[j - 1] = _packs[j];
+            }
+            
+            _pack_count -= 1;
+            
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void
+z_pack__unload_all()
+{
+    // every sound has been unloaded by now, but the audio thread may not
+    // yet have closed their streams
+    z_mixer__sync();
+    
+    for (uint8_t i = 0; i < _pack_count; i++) {
+        z_io__unmap_file(_packs[i].data, _packs[i].length);
+        
+        free(_packs[i].filename);
+    }
+    
+    _pack_count = 0;
+}
+
+bool
+z_pack__find(char const * filename,
+             uint8_t const ** const data,
+             uint32_t * const length)
+{
+    if (_pack_count == 0) {
+        return false;
+    }
+    
+    // names are stored without any leading "./"
+    while (filename[0] == '.' && filename[1] == '/') {
+        filename += 2;
+    }
+    
+    size_t const name_length = strlen(filename);
+    
+    for (uint8_t i = _pack_count; i > 0; i--) {
+        SHIZPack const * const pack = &_packs[i - 1];
+        
+        uint32_t first = 0;
+        uint32_t last = pack->entry_count;
+        
+        while (first < last) {
+            uint32_t const middle = first + (last - first) / 2;
+            
+            int const order = z_pack__compare(pack, middle,
+                                              filename, name_length);
+            
+            if (order == 0) {
+                uint32_t const entry = SHIZPackHeaderSize +
+                    (middle * SHIZPackEntrySize);
+                
+                *data = pack->data + z_pack__read(pack->data, entry + 8);
+                *length = z_pack__read(pack->data, entry + 12);
+                
+                return true;
+            }
+            
+            if (order < 0) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+    }
+    
+    return false;
+}
+
+static
+bool
+z_pack__validate(SHIZPack const * const pack)
+{
+    uint64_t const entries_end = SHIZPackHeaderSize +
+        ((uint64_t)pack->entry_count * SHIZPackEntrySize);
+    
+    if (entries_end > pack->names_offset ||
+        pack->names_offset > pack->length) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < pack->entry_count; i++) {
+        uint32_t const entry = SHIZPackHeaderSize + (i * SHIZPackEntrySize);
+        
+        uint64_t const name_offset = z_pack__read(pack->data, entry);
+        uint64_t const name_length = z_pack__read(pack->data, entry + 4);
+        uint64_t const data_offset = z_pack__read(pack->data, entry + 8);
+        uint64_t const data_length = z_pack__read(pack->data, entry + 12);
+        
+        if (name_offset < pack->names_offset ||
+            name_offset + name_length > pack->length ||
+            data_offset + data_length > pack->length) {
+            return false;
+        }
+        
+        if (i > 0) {
+            // entries must be sorted (and unique) to be searchable
+            char const * const name =
+                (char const *)pack->data + name_offset;
+            
+            if (z_pack__compare(pack, i - 1, name, name_length) >= 0) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+static
+uint32_t
+z_pack__read(uint8_t const * const data,
+             uint32_t const offset)
+{
+    return (uint32_t)data[offset] |
+        ((uint32_t)data[offset + 1] << 8) |
+        ((uint32_t)data[offset + 2] << 16) |
+        ((uint32_t)data[offset + 3] << 24);
+}
+
+static
+int
+z_pack__compare(SHIZPack const * const pack,
+                uint32_t const entry,
+                char const * const name,
+                size_t const length)
+{
+    uint32_t const offset = SHIZPackHeaderSize + (entry * SHIZPackEntrySize);
+    
+    uint32_t const entry_name_offset = z_pack__read(pack->data, offset);
+    uint32_t const entry_name_length = z_pack__read(pack->data, offset + 4);
+    
+    size_t const shortest = entry_name_length < length ?
+        entry_name_length : length;
+    
+    int const order = memcmp(pack->data + entry_name_offset, name, shortest);
+    
+    if (order != 0) {
+        return order;
+    }
+    
+    if (entry_name_length == length) {
+        return 0;
+    }
+    
+    return entry_name_length < length ? -1 : 1;
+}
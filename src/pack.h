@@ -0,0 +1,68 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t, uint32_t
+
+/**
+ * A pack is a single file that holds the contents of any number of files:
+ *
+ *   header    magic, version, number of entries, offset of names
+ *   entries   offset and length of name, offset and length of data;
+ *             sorted by name
+ *   names     the name of every entry (not terminated)
+ *   data      the contents of every entry, each aligned to
+ *             `SHIZPackAlignment` bytes
+ *
+ * Every number is stored as a little-endian, 32-bit unsigned integer, and
+ * every offset is from the beginning of the pack.
+ */
+#define SHIZPackMagic "SHZP"
+#define SHIZPackVersion 1
+
+#define SHIZPackHeaderSize 16
+#define SHIZPackEntrySize 16
+
+#define SHIZPackAlignment 16
+
+/**
+ * The max number of packs that can be loaded at once.
+ */
+#define SHIZPackMax 4
+
+/**
+ * @brief Map a pack into memory.
+ *
+ * The table of contents is validated once, so that looking up entries can
+ * trust it.
+ */
+bool z_pack__load(char const * filename);
+/**
+ * @brief Unmap a pack from memory.
+ *
+ * Waits for anything being decoded in the background first; but refuses to
+ * unmap a pack that any open stream is decoded from.
+ */
+bool z_pack__unload(char const * filename);
+void z_pack__unload_all(void);
+
+/**
+ * @brief Find the contents of a file in any loaded pack.
+ *
+ * Packs are searched from the most recently loaded, so a pack can override
+ * files of the packs loaded before it. The contents are not copied, and stay
+ * valid until the pack is unloaded.
+ *
+ * @return `true` if the file was found, `false` otherwise
+ */
+bool z_pack__find(char const * filename, uint8_t const ** data, uint32_t * length);
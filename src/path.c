@@ -0,0 +1,425 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#include "path.h"
+
+#include <stdlib.h> // NULL
+#include <stdbool.h> // bool
+#include <math.h> // sqrtf
+
+#include "internal.h" // SHIZVertexPositionColor, PIXEL
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+ #define SHIZ_PATH_SIMD 1
+ #include <xmmintrin.h> // _mm_*
+#else
+ #define SHIZ_PATH_SIMD 0
+#endif
+
+/**
+ * The number of segment normals that are computed at a time; normals are
+ * computed in blocks to keep them on the stack regardless of path length.
+ */
+#define SHIZPathNormalBlockSize 64
+
+/**
+ * The max length of a miter (relative to half the stroke width) before the
+ * join falls back to a bevel.
+ */
+#define SHIZPathMiterLimit 4.0f
+
+typedef struct SHIZPathCorners {
+    SHIZVector2 left;
+    SHIZVector2 right;
+} SHIZPathCorners;
+
+static
+void
+z_path__compute_normals(SHIZVector2 const * points,
+                        uint32_t count,
+                        SHIZVector2 * normals);
+
+static
+SHIZPathCorners
+z_path__corners(SHIZVector2 point,
+                SHIZVector2 normal,
+                float half_width);
+
+static
+SHIZPathCorners
+z_path__cap(SHIZVector2 point,
+            SHIZVector2 normal,
+            float half_width,
+            SHIZPathCap cap,
+            float direction);
+
+static
+bool
+z_path__miter(SHIZVector2 point,
+              SHIZVector2 normal,
+              SHIZVector2 next_normal,
+              float half_width,
+              SHIZPathCorners * corners);
+
+static
+uint32_t
+z_path__bevel(SHIZVertexPositionColor * vertices,
+              SHIZVector2 point,
+              SHIZVector2 normal,
+              SHIZVector2 next_normal,
+              float half_width,
+              SHIZColor color,
+              float z);
+
+static
+uint32_t
+z_path__quad(SHIZVertexPositionColor * vertices,
+             SHIZPathCorners start,
+             SHIZPathCorners end,
+             SHIZColor color,
+             float z);
+
+static
+uint32_t
+z_path__triangle(SHIZVertexPositionColor * vertices,
+                 SHIZVector2 a,
+                 SHIZVector2 b,
+                 SHIZVector2 c,
+                 SHIZColor color,
+                 float z);
+
+uint32_t
+z_path__vertex_count(uint32_t const point_count)
+{
+    if (point_count < 2) {
+        return 0;
+    }
+    
+    uint32_t const segment_count = point_count - 1;
+    uint32_t const join_count = segment_count - 1;
+    
+    // 2 triangles per segment, and at most 1 triangle per join
+    return (segment_count * 6) + (join_count * 3);
+}
+
+uint32_t
+z_path__tessellate(SHIZVector2 const * const points,
+                   uint32_t const count,
+                   SHIZVector2 const offset,
+                   float const width,
+                   SHIZPathJoin const join,
+                   SHIZPathCap const cap,
+                   SHIZColor const color,
+                   float const z,
+                   SHIZVertexPositionColor * const vertices)
+{
+    if (points == NULL || count < 2 || width <= 0) {
+        return 0;
+    }
+    
+    float const half_width = width / 2;
+    
+    uint32_t const segment_count = count - 1;
+    uint32_t vertex_count = 0;
+    
+    SHIZVector2 normals[SHIZPathNormalBlockSize];
+    
+    // a segment is kept pending until the next segment is known, because
+    // its end corners depend on how it is joined with the next segment
+    bool has_pending_segment = false;
+    
+    SHIZPathCorners pending_start;
+    SHIZVector2 pending_normal = SHIZVector2Zero;
+    SHIZVector2 pending_end = SHIZVector2Zero;
+    
+    for (uint32_t block = 0; block < segment_count; block += SHIZPathNormalBlockSize) {
+        uint32_t block_count = segment_count - block;
+        
+        if (block_count > SHIZPathNormalBlockSize) {
+            block_count = SHIZPathNormalBlockSize;
+        }
+        
+        z_path__compute_normals(&points[block], block_count, normals);
+        
+        for (uint32_t i = 0; i < block_count; i++) {
+            SHIZVector2 const normal = normals[i];
+            
+            if (normal.x == 0 && normal.y == 0) {
+                // zero-length segment; skip it entirely and let the
+                // pending segment join with the next one instead
+                continue;
+            }
+            
+            SHIZVector2 const from = points[block + i];
+            SHIZVector2 const to = points[block + i + 1];
+            
+            SHIZVector2 const start = SHIZVector2Make(PIXEL(from.x) + offset.x,
+                                                      PIXEL(from.y) + offset.y);
+            SHIZVector2 const end = SHIZVector2Make(PIXEL(to.x) + offset.x,
+                                                    PIXEL(to.y) + offset.y);
+            
+            if (!has_pending_segment) {
+                pending_start = z_path__cap(start, normal, half_width, cap, -1);
+            } else {
+                SHIZPathCorners joined;
+                
+                bool const is_mitered = (join == SHIZPathJoinMiter &&
+                                         z_path__miter(start,
+                                                       pending_normal, normal,
+                                                       half_width,
+                                                       &joined));
+                
+                if (is_mitered) {
+                    vertex_count += z_path__quad(&vertices[vertex_count],
+                                                 pending_start, joined,
+                                                 color, z);
+                } else {
+                    vertex_count += z_path__quad(&vertices[vertex_count],
+                                                 pending_start,
+                                                 z_path__corners(start,
+                                                                 pending_normal,
+                                                                 half_width),
+                                                 color, z);
+                    vertex_count += z_path__bevel(&vertices[vertex_count],
+                                                  start,
+                                                  pending_normal, normal,
+                                                  half_width,
+                                                  color, z);
+                    
+                    joined = z_path__corners(start, normal, half_width);
+                }
+                
+                pending_start = joined;
+            }
+            
+            pending_normal = normal;
+            pending_end = end;
+            
+            has_pending_segment = true;
+        }
+    }
+    
+    if (has_pending_segment) {
+        vertex_count += z_path__quad(&vertices[vertex_count],
+                                     pending_start,
+                                     z_path__cap(pending_end, pending_normal,
+                                                 half_width, cap, 1),
+                                     color, z);
+    }
+    
+    return vertex_count;
+}
+
+static
+void
+z_path__compute_normals(SHIZVector2 const * const points,
+                        uint32_t const count,
+                        SHIZVector2 * const normals)
+{
+    // note that segment i spans point i and i + 1; so `count` segments
+    // reads `count + 1` points
+    uint32_t i = 0;
+
+#if SHIZ_PATH_SIMD
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const one = _mm_set1_ps(1);
+    
+    for (; i + 4 <= count; i += 4) {
+        __m128 const from_01 = _mm_loadu_ps(&points[i].x); // x0 y0 x1 y1
+        __m128 const from_23 = _mm_loadu_ps(&points[i + 2].x); // x2 y2 x3 y3
+        __m128 const to_01 = _mm_loadu_ps(&points[i + 1].x); // x1 y1 x2 y2
+        __m128 const to_23 = _mm_loadu_ps(&points[i + 3].x); // x3 y3 x4 y4
+        
+        // deinterleave into x0 x1 x2 x3 and y0 y1 y2 y3
+        __m128 const from_x = _mm_shuffle_ps(from_01, from_23, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 const from_y = _mm_shuffle_ps(from_01, from_23, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 const to_x = _mm_shuffle_ps(to_01, to_23, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 const to_y = _mm_shuffle_ps(to_01, to_23, _MM_SHUFFLE(3, 1, 3, 1));
+        
+        __m128 const dx = _mm_sub_ps(to_x, from_x);
+        __m128 const dy = _mm_sub_ps(to_y, from_y);
+        
+        __m128 const length_squared = _mm_add_ps(_mm_mul_ps(dx, dx),
+                                                 _mm_mul_ps(dy, dy));
+        
+        // zero-length segments end up with a zero normal
+        __m128 const has_length = _mm_cmpgt_ps(length_squared, zero);
+        __m128 const inverse_length = _mm_and_ps(_mm_div_ps(one, _mm_sqrt_ps(length_squared)),
+                                                 has_length);
+        
+        // the normal points to the left of the direction; i.e. (-dy, dx)
+        __m128 const normal_x = _mm_mul_ps(_mm_sub_ps(zero, dy), inverse_length);
+        __m128 const normal_y = _mm_mul_ps(dx, inverse_length);
+        
+        // interleave back into x/y pairs
+        _mm_storeu_ps(&normals[i].x, _mm_unpacklo_ps(normal_x, normal_y));
+        _mm_storeu_ps(&normals[i + 2].x, _mm_unpackhi_ps(normal_x, normal_y));
+    }
+#endif
+
+    for (; i < count; i++) {
+        float const dx = points[i + 1].x - points[i].x;
+        float const dy = points[i + 1].y - points[i].y;
+        
+        float const length_squared = (dx * dx) + (dy * dy);
+        
+        if (length_squared > 0) {
+            float const inverse_length = 1.0f / sqrtf(length_squared);
+            
+            normals[i] = SHIZVector2Make(-dy * inverse_length,
+                                         dx * inverse_length);
+        } else {
+            normals[i] = SHIZVector2Zero;
+        }
+    }
+}
+
+static
+SHIZPathCorners
+z_path__corners(SHIZVector2 const point,
+                SHIZVector2 const normal,
+                float const half_width)
+{
+    SHIZPathCorners corners;
+    
+    corners.left = SHIZVector2Make(point.x + (normal.x * half_width),
+                                   point.y + (normal.y * half_width));
+    corners.right = SHIZVector2Make(point.x - (normal.x * half_width),
+                                    point.y - (normal.y * half_width));
+    
+    return corners;
+}
+
+static
+SHIZPathCorners
+z_path__cap(SHIZVector2 const point,
+            SHIZVector2 const normal,
+            float const half_width,
+            SHIZPathCap const cap,
+            float const direction)
+{
+    SHIZVector2 capped_point = point;
+    
+    if (cap == SHIZPathCapSquare) {
+        // the direction of a segment is its normal rotated clockwise
+        capped_point.x += normal.y * half_width * direction;
+        capped_point.y += -normal.x * half_width * direction;
+    }
+    
+    return z_path__corners(capped_point, normal, half_width);
+}
+
+static
+bool
+z_path__miter(SHIZVector2 const point,
+              SHIZVector2 const normal,
+              SHIZVector2 const next_normal,
+              float const half_width,
+              SHIZPathCorners * const corners)
+{
+    SHIZVector2 const miter = SHIZVector2Make(normal.x + next_normal.x,
+                                              normal.y + next_normal.y);
+    
+    float const miter_length_squared = (miter.x * miter.x) + (miter.y * miter.y);
+    
+    // the length of the miter (relative to half the stroke width) is
+    // 2 / |miter|, so the limit can be tested without a square root
+    float const miter_length_squared_min =
+        4.0f / (SHIZPathMiterLimit * SHIZPathMiterLimit);
+    
+    if (miter_length_squared < miter_length_squared_min) {
+        return false;
+    }
+    
+    float const scale = (2.0f * half_width) / miter_length_squared;
+    
+    SHIZVector2 const miter_offset = SHIZVector2Make(miter.x * scale,
+                                                     miter.y * scale);
+    
+    corners->left = SHIZVector2Make(point.x + miter_offset.x,
+                                    point.y + miter_offset.y);
+    corners->right = SHIZVector2Make(point.x - miter_offset.x,
+                                     point.y - miter_offset.y);
+    
+    return true;
+}
+
+static
+uint32_t
+z_path__bevel(SHIZVertexPositionColor * const vertices,
+              SHIZVector2 const point,
+              SHIZVector2 const normal,
+              SHIZVector2 const next_normal,
+              float const half_width,
+              SHIZColor const color,
+              float const z)
+{
+    float const turn = (normal.x * next_normal.y) - (normal.y * next_normal.x);
+    
+    // fill the gap on the outer side of the turn; i.e. the right side
+    // when turning left, and vice versa
+    float const side = turn > 0 ? -half_width : half_width;
+    
+    SHIZVector2 const a = SHIZVector2Make(point.x + (normal.x * side),
+                                          point.y + (normal.y * side));
+    SHIZVector2 const b = SHIZVector2Make(point.x + (next_normal.x * side),
+                                          point.y + (next_normal.y * side));
+    
+    return z_path__triangle(vertices, point, a, b, color, z);
+}
+
+static
+uint32_t
+z_path__quad(SHIZVertexPositionColor * const vertices,
+             SHIZPathCorners const start,
+             SHIZPathCorners const end,
+             SHIZColor const color,
+             float const z)
+{
+    uint32_t vertex_count = 0;
+    
+    vertex_count += z_path__triangle(&vertices[vertex_count],
+                                     start.left, end.left, end.right,
+                                     color, z);
+    vertex_count += z_path__triangle(&vertices[vertex_count],
+                                     start.left, end.right, start.right,
+                                     color, z);
+    
+    return vertex_count;
+}
+
+static
+uint32_t
+z_path__triangle(SHIZVertexPositionColor * const vertices,
+                 SHIZVector2 const a,
+                 SHIZVector2 const b,
+                 SHIZVector2 const c,
+                 SHIZColor const color,
+                 float const z)
+{
+    float const area = ((b.x - a.x) * (c.y - a.y)) - ((c.x - a.x) * (b.y - a.y));
+    
+    // back faces are culled, so every triangle must be wound clockwise
+    bool const is_clockwise = area <= 0;
+    
+    SHIZVector2 const second = is_clockwise ? b : c;
+    SHIZVector2 const third = is_clockwise ? c : b;
+    
+    vertices[0].position = SHIZVector3Make(a.x, a.y, z);
+    vertices[1].position = SHIZVector3Make(second.x, second.y, z);
+    vertices[2].position = SHIZVector3Make(third.x, third.y, z);
+    
+    vertices[0].color = color;
+    vertices[1].color = color;
+    vertices[2].color = color;
+    
+    return 3;
+}
@@ -0,0 +1,44 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdint.h> // uint32_t
+
+#include <SHIZEN/ztype.h> // SHIZVector2, SHIZColor, SHIZPathJoin, SHIZPathCap
+
+#include "internal.h" // SHIZVertexPositionColor
+
+/**
+ * @brief Determine the max number of vertices needed to tessellate a path.
+ */
+uint32_t z_path__vertex_count(uint32_t point_count);
+
+/**
+ * @brief Tessellate a path into a list of triangles.
+ *
+ * Tessellate a path of connected segments into clockwise triangles with
+ * the specified width, joins and caps.
+ *
+ * @remark The vertex buffer must have room for at least
+ *         `z_path__vertex_count(count)` vertices.
+ *
+ * @return The number of vertices written
+ */
+uint32_t z_path__tessellate(SHIZVector2 const * points,
+                            uint32_t count,
+                            SHIZVector2 offset,
+                            float width,
+                            SHIZPathJoin join,
+                            SHIZPathCap cap,
+                            SHIZColor color,
+                            float z,
+                            SHIZVertexPositionColor * vertices);
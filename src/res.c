@@ -11,15 +11,20 @@
 
 #include "res.h" // SHIZResource*, z_res_*
 
-#include <stdlib.h> // NULL
+#include <stdlib.h> // NULL, calloc, free
 #include <stdbool.h> // bool
-#include <stdint.h> // uint8_t, uint16_t, int32_t
-#include <string.h> // strcmp, strrchr
+#include <stdint.h> // uint8_t, uint16_t, uint32_t, int32_t
+#include <string.h> // strcmp, strrchr, memset
 
 #include "graphics/gfx.h"
 #include "mixer.h"
+#include "truetype.h"
+#include "spritefont.h"
 
 #include "io.h"
+#include "async.h"
+#include "pack.h"
+#include "watch.h"
 
 #ifdef SHIZ_DEBUG
  #include "debug/debug.h"
@@ -31,52 +36,197 @@ SHIZResourceImage const SHIZResourceImageEmpty = {
     .width = 0,
     .height = 0,
     .texture_id = 0,
+    .drawn_frame = 0,
+    .size = 0,
     .filename = NULL
 };
 
 SHIZResourceSound const SHIZResourceSoundEmpty = {
     .resource_id = 0,
+    .samples = NULL,
+    .blocks = NULL,
+    .stream = NULL,
     .filename = NULL
 };
 
-uint8_t const SHIZResourceInvalid = 0;
+SHIZResourceFont const SHIZResourceFontEmpty = {
+    .resource_id = 0,
+    .face = NULL,
+    .filename = NULL
+};
 
-#define SHIZResourceImageMax 16
-#define SHIZResourceSoundMax 8
+uint32_t const SHIZResourceInvalid = 0;
 
-// offset by 1 to skip the invalid resource id (0); index 0 still used
-#define SHIZResourceImageIdOffset 1
-#define SHIZResourceImageIdMax (SHIZResourceImageIdOffset + SHIZResourceImageMax)
+/**
+ * A resource id is a handle made of the type of the resource, the generation
+ * of the slot that the resource occupies and the index of that slot:
+ *
+ *   [ type: 4 | generation: 12 | index: 16 ]
+ *
+ * The generation of a slot is bumped every time the slot is occupied, so that
+ * an id kept around after unloading a resource does not resolve to whatever
+ * is loaded into the slot next. Because the type is never 0, neither is an id.
+ *
+ * Freed slots are occupied again in the order they were freed (oldest first),
+ * so that the generations of every free slot are used up evenly, instead of
+ * those of the most recently freed slot only. A slot whose generation has run
+ * out is retired (i.e. never occupied again) rather than wrapping around, as
+ * that would make the ids of its past resources valid once more.
+ */
+#define SHIZResourceIndexBits 16
+#define SHIZResourceGenerationBits 12
 
-#define SHIZResourceSoundIdOffset SHIZResourceImageIdMax
-#define SHIZResourceSoundIdMax (SHIZResourceSoundIdOffset + SHIZResourceSoundMax)
+#define SHIZResourceIndexMax (1 << SHIZResourceIndexBits)
+#define SHIZResourceIndexMask (SHIZResourceIndexMax - 1)
+#define SHIZResourceGenerationMask ((1 << SHIZResourceGenerationBits) - 1)
+#define SHIZResourceTypeShift (SHIZResourceIndexBits + SHIZResourceGenerationBits)
 
-#ifdef SHIZ_DEBUG
- #define SHIZResourceIdMax SHIZResourceSoundIdMax
-#endif
+/**
+ * Set on the generation of a slot for as long as the slot is occupied.
+ */
+#define SHIZResourceSlotOccupied 0x8000
+/**
+ * Set on the generation of a slot while its resource is loading in the
+ * background. Looking up the resource fails until it has finished loading.
+ */
+#define SHIZResourceSlotPending 0x4000
+
+/**
+ * The number of slots that are allocated at a time. Slots are never moved
+ * once allocated, so a resource stays at the same address while loaded.
+ */
+#define SHIZResourcePageSize 64
+
+typedef struct SHIZResourceSlot {
+    /** The key that the resource is cached by; 0 if not cached */
+    uint64_t key;
+    /** The number of times the resource has been loaded, but not unloaded */
+    uint32_t references;
+    /** The index (+1) of the slot freed after this one; 0 if none */
+    uint32_t next_free;
+    /** The current generation of the slot, flagged while occupied */
+    uint16_t generation;
+} SHIZResourceSlot;
+
+/**
+ * @brief Holds every resource of a type.
+ *
+ * The table grows as needed, so any number of resources can be loaded, and
+ * looking one up costs the same regardless of how many are loaded.
+ */
+typedef struct SHIZResourceTable {
+    /** The pages that resources are stored in */
+    uint8_t ** pages;
+    /** The bookkeeping of every slot */
+    SHIZResourceSlot * slots;
+    /** The size of a single resource */
+    size_t resource_size;
+    /** The number of slots allocated */
+    uint32_t capacity;
+    /** The number of slots that have been occupied at some point */
+    uint32_t count;
+    /** The index (+1) of the least recently freed slot; 0 if none */
+    uint32_t free_slot;
+    /** The index (+1) of the most recently freed slot; 0 if none */
+    uint32_t free_slot_last;
+    SHIZResourceType type;
+} SHIZResourceTable;
 
-static bool z_res__image_loaded_callback(int32_t width, int32_t height, int32_t components, uint8_t * data);
+/**
+ * The max length of a resolved filename.
+ */
+#define SHIZResourcePathMax 1024
+
+/**
+ * The number of entries that the cache starts out with (a power of two).
+ */
+#define SHIZResourceCacheCapacity 64
+
+typedef struct SHIZResourceCacheEntry {
+    uint64_t key;
+    uint32_t resource_id;
+} SHIZResourceCacheEntry;
+
+/**
+ * @brief Maps the resolved filename, or the contents, of every loaded resource
+ *        to its id, so that loading the same resource twice does not load it
+ *        twice.
+ *
+ * The cache is an open-addressed hash table with linear probing.
+ */
+typedef struct SHIZResourceCache {
+    SHIZResourceCacheEntry * entries;
+    /** The number of entries allocated (a power of two) */
+    uint32_t capacity;
+    /** The number of entries in use */
+    uint32_t count;
+    /** The number of loads that found the resource already loaded */
+    uint32_t hits;
+    /** The number of loads that did not */
+    uint32_t misses;
+} SHIZResourceCache;
+
+static bool z_res__image_loaded_callback(int32_t width, int32_t height, int32_t components, uint8_t const * data);
 static bool z_res__sound_loaded_callback(int32_t channels, int32_t sample_rate, int16_t * data, int32_t size);
+static bool z_res__font_loaded_callback(uint8_t * data, uint32_t length);
 
-static bool z_res__is_image(uint8_t resource_id);
-static bool z_res__is_sound(uint8_t resource_id);
-static bool z_res__is_index_free(uint8_t resource_index, SHIZResourceType);
+static SHIZResourceTable * z_res__table(SHIZResourceType);
+static SHIZResourceType z_res__type_from_id(uint32_t resource_id);
 
-static SHIZResourceType z_res__type_from_id(uint8_t resource_id);
-static int16_t const z_res__index_from_id(uint8_t resource_id, SHIZResourceType);
+static void * z_res__lookup(uint32_t resource_id, SHIZResourceType);
+static void * z_res__record(SHIZResourceTable const *, uint32_t index);
+static SHIZResourceSlot * z_res__slot(uint32_t resource_id);
+static uint32_t z_res__acquire(SHIZResourceType, char const * filename, void ** resource);
+static char ** z_res__filename(SHIZResourceType, void * resource);
+static void z_res__release(uint32_t resource_id);
+static bool z_res__destroy(uint32_t resource_id);
+static bool z_res__reside(SHIZResourceImage *);
+static bool z_res__probe(SHIZResourceImage *);
+static void z_res__evict(uint32_t size);
+static bool z_res__reload_image(uint32_t resource_id, int32_t width, int32_t height, int32_t components, uint8_t const * data);
+static bool z_res__finish(uint32_t resource_id, char const * filename, bool loaded);
+static bool z_res__grow(SHIZResourceTable *);
+static void z_res__free_table(SHIZResourceTable *);
+static uint32_t z_res__id_at(SHIZResourceTable const *, uint32_t index);
 
-static uint8_t z_res__next_id(SHIZResourceType, uint8_t * index);
+static uint64_t z_res__path_key(char const * filename);
+static uint64_t z_res__data_key(SHIZResourceType, uint8_t const * buffer, uint32_t length);
+
+static uint32_t z_res__cache_retain(uint64_t key);
+static void z_res__cache_insert(uint64_t key, uint32_t resource_id);
+static void z_res__cache_remove(uint64_t key);
+static bool z_res__cache_grow(void);
 
 static char const * z_res__filename_ext(char const * filename);
 
 static SHIZResourceImage * _current_image_resource; // temporary pointer to the image being loaded
 static SHIZResourceSound * _current_sound_resource; // temporary pointer to the sound being loaded
+static SHIZResourceFont * _current_font_resource; // temporary pointer to the font being loaded
+
+static SHIZResourceTable _images = {
+    .resource_size = sizeof(SHIZResourceImage),
+    .type = SHIZResourceTypeImage
+};
+
+static SHIZResourceTable _sounds = {
+    .resource_size = sizeof(SHIZResourceSound),
+    .type = SHIZResourceTypeSound
+};
+
+static SHIZResourceTable _fonts = {
+    .resource_size = sizeof(SHIZResourceFont),
+    .type = SHIZResourceTypeFont
+};
+
+static SHIZResourceCache _cache;
 
-static SHIZResourceImage _images[SHIZResourceImageMax];
-static SHIZResourceSound _sounds[SHIZResourceSoundMax];
+static SHIZTextureUsage _texture_usage;
+static uint32_t _frame = 0;
+
+static uint32_t _atlas_resource_id;
 
 #ifdef SHIZ_DEBUG
-static SHIZResourceImage _font_resource;
+static uint32_t _font_resource_id;
 #endif
 
 SHIZResourceType const
@@ -86,361 +236,1466 @@ z_res__type(char const * const filename)
     
     char const * const extension = z_res__filename_ext(filename);
     
-    if (strcmp("png", extension) == 0) {
+    if (strcmp("png", extension) == 0 ||
+        strcmp("tex", extension) == 0) {
         resource_type = SHIZResourceTypeImage;
     } else if (strcmp("ogg", extension) == 0) {
         resource_type = SHIZResourceTypeSound;
+    } else if (strcmp("ttf", extension) == 0) {
+        resource_type = SHIZResourceTypeFont;
     }
     
     return resource_type;
 }
 
-SHIZResourceImage
-z_res__image(uint8_t const resource_id)
+SHIZResourceImage const *
+z_res__image(uint32_t const resource_id)
 {
-    if (resource_id > SHIZResourceImageIdMax) {
-#ifdef SHIZ_DEBUG
-        if (resource_id == _font_resource.resource_id) {
-            return _font_resource;
+    return z_res__lookup(resource_id, SHIZResourceTypeImage);
+}
+
+SHIZResourceSound const *
+z_res__sound(uint32_t const resource_id)
+{
+    return z_res__lookup(resource_id, SHIZResourceTypeSound);
+}
+
+SHIZResourceFont const *
+z_res__font(uint32_t const resource_id)
+{
+    return z_res__lookup(resource_id, SHIZResourceTypeFont);
+}
+
+uint32_t
+z_res__load(char const * const filename)
+{
+    SHIZResourceType const type = z_res__type(filename);
+    
+    if (type == SHIZResourceTypeNotSupported) {
+        z_io__error("resource not loaded ('%s'); unsupported type (%s)",
+                    filename, z_res__filename_ext(filename));
+        
+        return SHIZResourceInvalid;
+    }
+    
+    uint64_t const key = z_res__path_key(filename);
+    
+    uint32_t const cached_id = z_res__cache_retain(key);
+    
+    if (cached_id != SHIZResourceInvalid) {
+        return cached_id;
+    }
+    
+    void * resource = NULL;
+    
+    uint32_t const expected_id = z_res__acquire(type, filename, &resource);
+    
+    if (expected_id == SHIZResourceInvalid) {
+        return SHIZResourceInvalid;
+    }
+    
+    bool loaded = false;
+    
+    // prefer the contents of a loaded pack over the file itself
+    uint8_t const * packed_data = NULL;
+    uint32_t packed_length = 0;
+    
+    bool const packed = z_pack__find(filename, &packed_data, &packed_length);
+    
+    if (type == SHIZResourceTypeImage) {
+        SHIZResourceImage * const image = resource;
+        
+        image->resource_id = expected_id;
+        
+        // with a budget, the texture is not loaded until drawn
+        loaded = _texture_usage.budget > 0 ?
+            z_res__probe(image) :
+            z_res__reside(image);
+    } else if (type == SHIZResourceTypeSound) {
+        _current_sound_resource = resource;
+        _current_sound_resource->resource_id = expected_id;
+        
+        loaded = packed ?
+            z_io__load_sound_data(packed_data, packed_length, z_res__sound_loaded_callback) :
+            z_io__load_sound(filename, z_res__sound_loaded_callback);
+        
+        _current_sound_resource = NULL;
+    } else if (type == SHIZResourceTypeFont) {
+        _current_font_resource = resource;
+        _current_font_resource->resource_id = expected_id;
+        
+        loaded = packed ?
+            z_io__load_font_data(packed_data, packed_length, z_res__font_loaded_callback) :
+            z_io__load_font(filename, z_res__font_loaded_callback);
+        
+        _current_font_resource = NULL;
+    }
+    
+    if (!loaded) {
+        z_res__release(expected_id);
+        
+        return SHIZResourceInvalid;
+    }
+    
+    if (type == SHIZResourceTypeImage && !packed) {
+        z_watch__add(expected_id, filename);
+    }
+    
+    z_res__cache_insert(key, expected_id);
+    
+    return expected_id;
+}
+
+uint32_t
+z_res__load_data(SHIZResourceType const type,
+                 uint8_t const * const buffer,
+                 uint32_t const length)
+{
+    if (type == SHIZResourceTypeNotSupported) {
+        z_io__error("resource not loaded; unsupported type");
+        
+        return SHIZResourceInvalid;
+    }
+    
+    uint64_t const key = z_res__data_key(type, buffer, length);
+    
+    uint32_t const cached_id = z_res__cache_retain(key);
+    
+    if (cached_id != SHIZResourceInvalid) {
+        return cached_id;
+    }
+    
+    void * resource = NULL;
+    
+    uint32_t const expected_id = z_res__acquire(type, NULL, &resource);
+    
+    if (expected_id == SHIZResourceInvalid) {
+        return SHIZResourceInvalid;
+    }
+    
+    bool loaded = false;
+    
+    if (type == SHIZResourceTypeImage) {
+        _current_image_resource = resource;
+        _current_image_resource->resource_id = expected_id;
+        
+        loaded = z_io__load_image_data(buffer, length, z_res__image_loaded_callback);
+        
+        _current_image_resource = NULL;
+    } else if (type == SHIZResourceTypeSound) {
+        _current_sound_resource = resource;
+        _current_sound_resource->resource_id = expected_id;
+        
+        loaded = z_io__load_sound_data(buffer, length, z_res__sound_loaded_callback);
+        
+        _current_sound_resource = NULL;
+    } else if (type == SHIZResourceTypeFont) {
+        _current_font_resource = resource;
+        // the face must know its id before it is created
+        _current_font_resource->resource_id = expected_id;
+        
+        loaded = z_io__load_font_data(buffer, length, z_res__font_loaded_callback);
+        
+        _current_font_resource = NULL;
+    }
+    
+    if (!loaded) {
+        z_res__release(expected_id);
+        
+        return SHIZResourceInvalid;
+    }
+    
+    z_res__cache_insert(key, expected_id);
+    
+    return expected_id;
+}
+
+uint32_t
+z_res__load_stream(char const * const filename)
+{
+    if (z_res__type(filename) != SHIZResourceTypeSound) {
+        z_io__error("resource not loaded ('%s'); unsupported type (%s)",
+                    filename, z_res__filename_ext(filename));
+        
+        return SHIZResourceInvalid;
+    }
+    
+    void * resource = NULL;
+    
+    uint32_t const expected_id = z_res__acquire(SHIZResourceTypeSound, filename, &resource);
+    
+    if (expected_id == SHIZResourceInvalid) {
+        return SHIZResourceInvalid;
+    }
+    
+    SHIZResourceSound * const sound = resource;
+    
+    sound->resource_id = expected_id;
+    
+    // a packed stream is decoded straight out of the pack for as long as it
+    // is loaded
+    uint8_t const * packed_data = NULL;
+    uint32_t packed_length = 0;
+    
+    if (!z_pack__find(filename, &packed_data, &packed_length)) {
+        packed_data = NULL;
+    }
+    
+    if (!z_mixer__create_stream(sound, filename, packed_data, packed_length)) {
+        z_io__error("resource not loaded ('%s'); could not be streamed",
+                    filename);
+        
+        z_res__release(expected_id);
+        
+        return SHIZResourceInvalid;
+    }
+    
+    // note that the stream is not cached; it is not shared by other loads
+    return expected_id;
+}
+
+bool
+z_res__unload(uint32_t const resource_id)
+{
+    if (resource_id == SHIZResourceInvalid) {
+        return false;
+    }
+    
+    SHIZResourceSlot * const slot = z_res__slot(resource_id);
+    
+    if (slot == NULL) {
+        z_io__error("could not unload resource (%08x); resource not found",
+                    resource_id);
+        
+        return false;
+    }
+    
+    if (slot->references > 1) {
+        // the resource is still in use by whatever else loaded it
+        slot->references -= 1;
+        
+        return true;
+    }
+    
+    return z_res__destroy(resource_id);
+}
+
+bool
+z_res__unload_all()
+{
+    bool something_failed = false;
+    
+    SHIZResourceTable * const tables[] = {
+        &_images, &_sounds, &_fonts
+    };
+    
+    for (uint8_t table_index = 0; table_index < 3; table_index++) {
+        SHIZResourceTable * const table = tables[table_index];
+        
+        for (uint32_t index = 0; index < table->count; index++) {
+            uint32_t const resource_id = z_res__id_at(table, index);
+            
+            if (resource_id != SHIZResourceInvalid) {
+                // unload regardless of how many times it was loaded
+                if (!z_res__destroy(resource_id)) {
+                    something_failed = true;
+                }
+            }
         }
-#endif
-        return SHIZResourceImageEmpty;
+        
+        z_res__free_table(table);
+    }
+    
+    free(_cache.entries);
+    
+    _cache.entries = NULL;
+    _cache.capacity = 0;
+    _cache.count = 0;
+    
+    return !something_failed;
+}
+
+static
+bool
+z_res__destroy(uint32_t const resource_id)
+{
+    bool unloaded = false;
+    
+    SHIZResourceType const type = z_res__type_from_id(resource_id);
+    
+    void * const resource = z_res__lookup(resource_id, type);
+    
+    if (resource == NULL) {
+        SHIZResourceSlot const * const slot = z_res__slot(resource_id);
+        
+        if (slot != NULL && (slot->generation & SHIZResourceSlotPending)) {
+            // nothing has been created yet; whatever is decoded for the
+            // resource is discarded once it no longer finds the slot
+            if (type == SHIZResourceTypeImage) {
+                // except an image that is already waiting to be uploaded
+                z_gfx__destroy_texture(z_res__record(&_images, resource_id & SHIZResourceIndexMask));
+            }
+            
+            z_res__release(resource_id);
+            
+            return true;
+        }
+        
+        return false;
+    }
+    
+    if (type == SHIZResourceTypeImage) {
+        SHIZResourceImage const * const image = resource;
+        
+        if (image->texture_id != 0) {
+            _texture_usage.bytes -= image->size;
+        }
+        
+        unloaded = z_gfx__destroy_texture(image);
+        
+        if (!unloaded) {
+            z_io__error("could not unload image (%08x)", resource_id);
+        }
+        
+        // any sprite fonts of the image are gone too
+        z_spritefont__release_lookups(resource_id);
+    } else if (type == SHIZResourceTypeSound) {
+        unloaded = z_mixer__destroy_sound(resource);
+        
+        if (!unloaded) {
+            z_io__error("could not unload sound (%08x)", resource_id);
+        }
+    } else if (type == SHIZResourceTypeFont) {
+        unloaded = z_truetype__destroy_face(resource);
+        
+        if (!unloaded) {
+            z_io__error("could not unload font (%08x)", resource_id);
+        }
+    }
+    
+    // the slot is freed either way; the id is no longer usable
+    z_res__release(resource_id);
+    
+    return unloaded;
+}
+
+uint32_t
+z_res__load_async(char const * const filename)
+{
+    SHIZResourceType const type = z_res__type(filename);
+    
+    if (type == SHIZResourceTypeNotSupported) {
+        z_io__error("resource not loaded ('%s'); unsupported type (%s)",
+                    filename, z_res__filename_ext(filename));
+        
+        return SHIZResourceInvalid;
+    }
+    
+    uint64_t const key = z_res__path_key(filename);
+    
+    uint32_t const cached_id = z_res__cache_retain(key);
+    
+    if (cached_id != SHIZResourceInvalid) {
+        // either loaded already, or still loading
+        return cached_id;
+    }
+    
+    void * resource = NULL;
+    
+    uint32_t const resource_id = z_res__acquire(type, filename, &resource);
+    
+    if (resource_id == SHIZResourceInvalid) {
+        return SHIZResourceInvalid;
+    }
+    
+    if (type == SHIZResourceTypeImage) {
+        ((SHIZResourceImage *)resource)->resource_id = resource_id;
+    } else if (type == SHIZResourceTypeSound) {
+        ((SHIZResourceSound *)resource)->resource_id = resource_id;
+    } else if (type == SHIZResourceTypeFont) {
+        ((SHIZResourceFont *)resource)->resource_id = resource_id;
     }
     
-    int16_t const index = z_res__index_from_id(resource_id, SHIZResourceTypeImage);
+    uint8_t const * packed_data = NULL;
+    uint32_t packed_length = 0;
+    
+    if (!z_pack__find(filename, &packed_data, &packed_length)) {
+        packed_data = NULL;
+    }
+    
+    // queue the copy kept by the resource, rather than whatever the caller
+    // passed in, which may not outlive this call
+    if (!z_async__queue(resource_id, type, *z_res__filename(type, resource),
+                        packed_data, packed_length)) {
+        z_io__error("resource not loaded ('%s'); could not be queued", filename);
+        
+        z_res__release(resource_id);
+        
+        return SHIZResourceInvalid;
+    }
+    
+    z_res__slot(resource_id)->generation |= SHIZResourceSlotPending;
+    
+    if (type == SHIZResourceTypeImage && packed_data == NULL) {
+        z_watch__add(resource_id, filename);
+    }
+    
+    z_res__cache_insert(key, resource_id);
+    
+    return resource_id;
+}
+
+uint32_t
+z_res__load_many(char const * const * const filenames,
+                 uint32_t const count,
+                 uint32_t * const resource_ids)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        char const * const filename = filenames[i];
+        
+        if (_texture_usage.budget > 0 &&
+            z_res__type(filename) == SHIZResourceTypeImage) {
+            // with a budget, nothing is decoded until drawn anyway
+            resource_ids[i] = z_res__load(filename);
+        } else {
+            resource_ids[i] = z_res__load_async(filename);
+        }
+    }
+    
+    // decode everything at once, then create the textures in one go rather
+    // than spread across frames
+    z_async__wait();
+    z_gfx__finish_uploads();
+    
+    uint32_t loaded_count = 0;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (resource_ids[i] == SHIZResourceInvalid) {
+            continue;
+        }
+        
+        if (!z_res__is_loaded(resource_ids[i])) {
+            // failed to decode; already reported and released
+            resource_ids[i] = SHIZResourceInvalid;
+            
+            continue;
+        }
+        
+        loaded_count += 1;
+    }
+    
+    return loaded_count;
+}
+
+bool
+z_res__finish_image(uint32_t const resource_id,
+                    int32_t const width,
+                    int32_t const height,
+                    int32_t const components,
+                    uint8_t * const data)
+{
+    SHIZResourceSlot const * const slot = z_res__slot(resource_id);
+    
+    if (slot == NULL) {
+        return false;
+    }
+    
+    if ((slot->generation & SHIZResourceSlotPending) == 0) {
+        return z_res__reload_image(resource_id, width, height, components, data);
+    }
+    
+    SHIZResourceImage * const image =
+        z_res__record(&_images, resource_id & SHIZResourceIndexMask);
+    
+    if (data == NULL ||
+        (width <= 0 || height <= 0) ||
+        (width > UINT16_MAX || height > UINT16_MAX)) {
+        return z_res__finish(resource_id, image->filename, false);
+    }
+    
+    image->width = (uint16_t)width;
+    image->height = (uint16_t)height;
+    image->size = (uint32_t)width * (uint32_t)height * (uint32_t)components;
+    
+    // the image keeps loading until its texture has been uploaded, so that
+    // uploading large images does not stall the frame
+    if (z_gfx__queue_texture(image, width, height, components, data)) {
+        return true;
+    }
+    
+    z_res__evict(image->size);
+    
+    bool const loaded =
+        z_gfx__create_texture(image, width, height, components, data);
+    
+    if (loaded) {
+        _texture_usage.bytes += image->size;
+    }
+    
+    return z_res__finish(resource_id, image->filename, loaded);
+}
+
+void
+z_res__finish_texture(uint32_t const resource_id)
+{
+    SHIZResourceSlot const * const slot = z_res__slot(resource_id);
+    
+    if (slot == NULL || (slot->generation & SHIZResourceSlotPending) == 0) {
+        return;
+    }
+    
+    SHIZResourceImage const * const image =
+        z_res__record(&_images, resource_id & SHIZResourceIndexMask);
+    
+    // the image is still loading, so it is not evicted along with others
+    z_res__evict(image->size);
+    
+    _texture_usage.bytes += image->size;
+    
+    z_res__finish(resource_id, NULL, true);
+}
+
+bool
+z_res__finish_sound(uint32_t const resource_id,
+                    int32_t const channels,
+                    int32_t const sample_rate,
+                    int16_t * const data,
+                    int32_t const size)
+{
+    SHIZResourceSlot const * const slot = z_res__slot(resource_id);
+    
+    if (slot == NULL || (slot->generation & SHIZResourceSlotPending) == 0) {
+        return false;
+    }
+    
+    _current_sound_resource = z_res__record(&_sounds, resource_id & SHIZResourceIndexMask);
+    
+    bool const loaded = data != NULL &&
+        z_res__sound_loaded_callback(channels, sample_rate, data, size);
+    
+    char const * const filename = _current_sound_resource->filename;
+    
+    _current_sound_resource = NULL;
+    
+    return z_res__finish(resource_id, filename, loaded);
+}
+
+bool
+z_res__finish_font(uint32_t const resource_id,
+                   uint8_t * const data,
+                   uint32_t const length)
+{
+    SHIZResourceSlot const * const slot = z_res__slot(resource_id);
+    
+    if (slot == NULL || (slot->generation & SHIZResourceSlotPending) == 0) {
+        return false;
+    }
+    
+    _current_font_resource = z_res__record(&_fonts, resource_id & SHIZResourceIndexMask);
+    
+    bool const loaded = data != NULL &&
+        z_res__font_loaded_callback(data, length);
+    
+    char const * const filename = _current_font_resource->filename;
+    
+    _current_font_resource = NULL;
+    
+    return z_res__finish(resource_id, filename, loaded);
+}
+
+bool
+z_res__is_loaded(uint32_t const resource_id)
+{
+    return z_res__lookup(resource_id, z_res__type_from_id(resource_id)) != NULL;
+}
+
+bool
+z_res__is_loading(uint32_t const resource_id)
+{
+    SHIZResourceSlot const * const slot = z_res__slot(resource_id);
+    
+    return slot != NULL && (slot->generation & SHIZResourceSlotPending);
+}
+
+void
+z_res__reset()
+{
+    _frame += 1;
+}
+
+SHIZResourceImage const *
+z_res__use_image(uint32_t const resource_id)
+{
+    SHIZResourceImage * const image =
+        z_res__lookup(resource_id, SHIZResourceTypeImage);
+    
+    if (image == NULL) {
+        return NULL;
+    }
+    
+    image->drawn_frame = _frame;
+    
+    if (image->texture_id != 0) {
+        _texture_usage.hits += 1;
+        
+        return image;
+    }
+    
+    _texture_usage.misses += 1;
+    
+    if (!z_res__reside(image)) {
+        return NULL;
+    }
+    
+    return image;
+}
+
+void
+z_res__set_texture_budget(uint32_t const bytes)
+{
+    _texture_usage.budget = bytes;
+    
+    z_res__evict(0);
+}
+
+SHIZTextureUsage
+z_res__texture_usage()
+{
+    return _texture_usage;
+}
+
+static
+bool
+z_res__reside(SHIZResourceImage * const image)
+{
+    // note that this happens whenever the image is first drawn, or drawn
+    // after being evicted; so only the copy of the filename kept by the
+    // image is read, never the one originally passed to `z_load`
+    if (image->filename == NULL) {
+        // an image loaded from memory can not be loaded again
+        return false;
+    }
+    
+    // make room before loading; the size is known unless loading for the
+    // first time without a budget
+    z_res__evict(image->size);
+    
+    uint8_t const * packed_data = NULL;
+    uint32_t packed_length = 0;
+    
+    _current_image_resource = image;
+    
+    bool const loaded =
+        z_pack__find(image->filename, &packed_data, &packed_length) ?
+            z_io__load_image_data(packed_data, packed_length, z_res__image_loaded_callback) :
+            z_io__load_image(image->filename, z_res__image_loaded_callback);
+    
+    _current_image_resource = NULL;
+    
+    return loaded;
+}
+
+static
+bool
+z_res__probe(SHIZResourceImage * const image)
+{
+    uint8_t const * packed_data = NULL;
+    uint32_t packed_length = 0;
+    
+    int32_t width, height;
+    
+    bool const probed =
+        z_pack__find(image->filename, &packed_data, &packed_length) ?
+            z_io__probe_image_data(packed_data, packed_length, &width, &height) :
+            z_io__probe_image(image->filename, &width, &height);
+    
+    if (!probed ||
+        (width <= 0 || height <= 0) ||
+        (width > UINT16_MAX || height > UINT16_MAX)) {
+        z_io__error("failed to load image: '%s'", image->filename);
+        
+        return false;
+    }
+    
+    image->width = (uint16_t)width;
+    image->height = (uint16_t)height;
+    // images are always decoded to 4 components
+    image->size = (uint32_t)width * (uint32_t)height * 4;
+    
+    return true;
+}
+
+static
+void
+z_res__evict(uint32_t const size)
+{
+    if (_texture_usage.budget == 0) {
+        return;
+    }
+    
+    while (_texture_usage.bytes + size > _texture_usage.budget) {
+        SHIZResourceImage * least_recent = NULL;
+        
+        // eviction is rare compared to drawing, so rather than keeping the
+        // images ordered by use, just find the one drawn the longest ago
+        for (uint32_t index = 0; index < _images.count; index++) {
+            uint16_t const generation = _images.slots[index].generation;
+            
+            if ((generation & SHIZResourceSlotOccupied) == 0 ||
+                (generation & SHIZResourceSlotPending) != 0) {
+                continue;
+            }
+            
+            SHIZResourceImage * const image = z_res__record(&_images, index);
+            
+            if (image->texture_id == 0 ||
+                image->filename == NULL ||
+                image->drawn_frame == _frame) {
+                // not in memory, can not be loaded again, or in use
+                continue;
+            }
+            
+            if (least_recent == NULL ||
+                image->drawn_frame < least_recent->drawn_frame) {
+                least_recent = image;
+            }
+        }
+        
+        if (least_recent == NULL) {
+            // nothing more can be evicted; exceed the budget for now
+            break;
+        }
+        
+        z_gfx__destroy_texture(least_recent);
+        
+        least_recent->texture_id = 0;
+        
+        _texture_usage.bytes -= least_recent->size;
+        _texture_usage.evictions += 1;
+    }
+}
+
+static
+bool
+z_res__reload_image(uint32_t const resource_id,
+                    int32_t const width,
+                    int32_t const height,
+                    int32_t const components,
+                    uint8_t const * const data)
+{
+    SHIZResourceImage * const image =
+        z_res__record(&_images, resource_id & SHIZResourceIndexMask);
+    
+    if (data == NULL ||
+        (width <= 0 || height <= 0) ||
+        (width > UINT16_MAX || height > UINT16_MAX)) {
+        // e.g. the file was read while still being written; keep the image
+        // as it was, the next change will reload it again
+        z_io__warning("resource not reloaded ('%s'); could not be decoded",
+                      image->filename);
+        
+        return false;
+    }
+    
+    uint32_t const size = (uint32_t)width * (uint32_t)height *
+        (uint32_t)components;
+    
+    bool reloaded;
+    
+    if (image->texture_id == 0) {
+        // not in memory; the new image is loaded once drawn
+        reloaded = true;
+    } else if (width == image->width && height == image->height) {
+        reloaded = z_gfx__update_texture(image, 0, 0, width, height,
+                                         components, data);
+    } else {
+        reloaded = z_gfx__resize_texture(image, width, height,
+                                         components, data);
+        
+        if (reloaded) {
+            _texture_usage.bytes -= image->size;
+            _texture_usage.bytes += size;
+        }
+    }
+    
+    if (reloaded) {
+        image->width = (uint16_t)width;
+        image->height = (uint16_t)height;
+        image->size = size;
+    }
+    
+#ifdef SHIZ_DEBUG
+    if (reloaded) {
+        z_io__debug("resource reloaded ('%s')", image->filename);
+    }
+#endif
+    
+    return reloaded;
+}
+
+static
+bool
+z_res__finish(uint32_t const resource_id,
+              char const * const filename,
+              bool const loaded)
+{
+    SHIZResourceSlot * const slot = z_res__slot(resource_id);
+    
+    if (!loaded) {
+        z_io__error("resource not loaded ('%s'); could not be decoded",
+                    filename);
+        
+        z_res__release(resource_id);
+        
+        return false;
+    }
+    
+    slot->generation &= ~SHIZResourceSlotPending;
+    
+    return true;
+}
+
+static
+SHIZResourceTable *
+z_res__table(SHIZResourceType const type)
+{
+    if (type == SHIZResourceTypeImage) {
+        return &_images;
+    } else if (type == SHIZResourceTypeSound) {
+        return &_sounds;
+    } else if (type == SHIZResourceTypeFont) {
+        return &_fonts;
+    }
+    
+    return NULL;
+}
+
+static
+SHIZResourceType
+z_res__type_from_id(uint32_t const resource_id)
+{
+    uint32_t const type = resource_id >> SHIZResourceTypeShift;
+    
+    if (type == SHIZResourceTypeImage ||
+        type == SHIZResourceTypeSound ||
+        type == SHIZResourceTypeFont) {
+        return (SHIZResourceType)type;
+    }
+    
+    return SHIZResourceTypeNotSupported;
+}
+
+static
+void *
+z_res__record(SHIZResourceTable const * const table,
+              uint32_t const index)
+{
+    uint8_t * const page = table->pages[index / SHIZResourcePageSize];
+    
+    return page + (index % SHIZResourcePageSize) * table->resource_size;
+}
+
+static
+void *
+z_res__lookup(uint32_t const resource_id,
+              SHIZResourceType const type)
+{
+    if (z_res__type_from_id(resource_id) != type) {
+        return NULL;
+    }
+    
+    SHIZResourceTable const * const table = z_res__table(type);
+    
+    uint32_t const index = resource_id & SHIZResourceIndexMask;
+    
+    if (index >= table->count) {
+        return NULL;
+    }
+    
+    uint16_t const generation =
+        (resource_id >> SHIZResourceIndexBits) & SHIZResourceGenerationMask;
+    
+    if (table->slots[index].generation != (generation | SHIZResourceSlotOccupied)) {
+        // either the slot is free, or it has been occupied again since
+        return NULL;
+    }
+    
+    return z_res__record(table, index);
+}
+
+static
+SHIZResourceSlot *
+z_res__slot(uint32_t const resource_id)
+{
+    SHIZResourceTable const * const table =
+        z_res__table(z_res__type_from_id(resource_id));
+    
+    if (table == NULL) {
+        return NULL;
+    }
+    
+    uint32_t const index = resource_id & SHIZResourceIndexMask;
+    
+    if (index >= table->count) {
+        return NULL;
+    }
+    
+    uint16_t const generation =
+        (resource_id >> SHIZResourceIndexBits) & SHIZResourceGenerationMask;
+    
+    SHIZResourceSlot * const slot = &table->slots[index];
+    
+    // unlike looking up the resource, this includes resources still loading
+    if ((slot->generation & ~SHIZResourceSlotPending) !=
+        (generation | SHIZResourceSlotOccupied)) {
+        return NULL;
+    }
+    
+    return slot;
+}
+
+static
+uint32_t
+z_res__id_at(SHIZResourceTable const * const table,
+             uint32_t const index)
+{
+    uint16_t const generation = table->slots[index].generation;
+    
+    if ((generation & SHIZResourceSlotOccupied) == 0) {
+        return SHIZResourceInvalid;
+    }
+    
+    return ((uint32_t)table->type << SHIZResourceTypeShift) |
+        ((uint32_t)(generation & SHIZResourceGenerationMask) << SHIZResourceIndexBits) |
+        index;
+}
+
+static
+uint32_t
+z_res__acquire(SHIZResourceType const type,
+               char const * const filename,
+               void ** const resource)
+{
+    SHIZResourceTable * const table = z_res__table(type);
+    
+    if (table == NULL) {
+        return SHIZResourceInvalid;
+    }
+    
+    char * filename_copy = NULL;
+    
+    if (filename != NULL) {
+        // the resource keeps its own copy; the filename may be read again
+        // long after loading (e.g. when reloading an evicted texture, or on
+        // another thread), by which time the original may be gone
+        size_t const length = strlen(filename);
+        
+        filename_copy = malloc(length + 1);
+        
+        if (filename_copy == NULL) {
+            return SHIZResourceInvalid;
+        }
+        
+        memcpy(filename_copy, filename, length + 1);
+    }
+    
+    uint32_t index;
+    
+    if (table->free_slot != 0) {
+        index = table->free_slot - 1;
+        
+        table->free_slot = table->slots[index].next_free;
+        
+        if (table->free_slot == 0) {
+            table->free_slot_last = 0;
+        }
+    } else {
+        if (table->count == table->capacity) {
+            if (!z_res__grow(table)) {
+                free(filename_copy);
+                
+                return SHIZResourceInvalid;
+            }
+        }
+        
+        index = table->count;
+        
+        table->slots[index].generation = 0;
+        table->count += 1;
+    }
+    
+    uint16_t const generation =
+        (table->slots[index].generation + 1) & SHIZResourceGenerationMask;
+    
+    table->slots[index].generation = generation | SHIZResourceSlotOccupied;
+    table->slots[index].next_free = 0;
+    table->slots[index].references = 1;
+    table->slots[index].key = 0;
+    
+    void * const slot = z_res__record(table, index);
+    
+    memset(slot, 0, table->resource_size);
+    
+    *z_res__filename(type, slot) = filename_copy;
+    
+    *resource = slot;
+    
+    return z_res__id_at(table, index);
+}
+
+static
+char **
+z_res__filename(SHIZResourceType const type,
+                void * const resource)
+{
+    if (type == SHIZResourceTypeImage) {
+        return &((SHIZResourceImage *)resource)->filename;
+    } else if (type == SHIZResourceTypeSound) {
+        return &((SHIZResourceSound *)resource)->filename;
+    }
+    
+    return &((SHIZResourceFont *)resource)->filename;
+}
+
+static
+void
+z_res__release(uint32_t const resource_id)
+{
+    SHIZResourceTable * const table = z_res__table(z_res__type_from_id(resource_id));
+    
+    if (table == NULL) {
+        return;
+    }
+    
+    uint32_t const index = resource_id & SHIZResourceIndexMask;
+    
+    if (index >= table->count || z_res__id_at(table, index) != resource_id) {
+        return;
+    }
+    
+    if (table->slots[index].key != 0) {
+        z_res__cache_remove(table->slots[index].key);
+    }
+    
+    void * const resource = z_res__record(table, index);
+    
+    free(*z_res__filename(table->type, resource));
+    
+    memset(resource, 0, table->resource_size);
+    
+    table->slots[index].key = 0;
+    table->slots[index].references = 0;
+    
+    // keep the generation so that it is bumped when the slot is occupied again
+    table->slots[index].generation &= ~SHIZResourceSlotOccupied;
+    table->slots[index].next_free = 0;
+    
+    if ((table->slots[index].generation & SHIZResourceGenerationMask) ==
+        SHIZResourceGenerationMask) {
+        // out of generations; retire the slot
+        return;
+    }
     
-    if (index < 0) {
-        return SHIZResourceImageEmpty;
+    if (table->free_slot_last != 0) {
+        table->slots[table->free_slot_last - 1].next_free = index + 1;
+    } else {
+        table->free_slot = index + 1;
     }
     
-    return _images[index];
+    table->free_slot_last = index + 1;
 }
 
-SHIZResourceSound
-z_res__sound(uint8_t const resource_id)
+static
+bool
+z_res__grow(SHIZResourceTable * const table)
 {
-    if (resource_id > SHIZResourceSoundIdMax) {
-        return SHIZResourceSoundEmpty;
+    if (table->capacity >= SHIZResourceIndexMax) {
+        z_io__error("resource limit reached (%d)", SHIZResourceIndexMax);
+        
+        return false;
     }
     
-    int16_t const index = z_res__index_from_id(resource_id, SHIZResourceTypeSound);
+    uint32_t const capacity = table->capacity == 0 ?
+        SHIZResourcePageSize : table->capacity * 2;
     
-    if (index < 0) {
-        return SHIZResourceSoundEmpty;
-    }
+    uint32_t const page_count = table->capacity / SHIZResourcePageSize;
+    uint32_t const new_page_count = capacity / SHIZResourcePageSize;
     
-    return _sounds[index];
-}
-
-uint8_t
-z_res__load(char const * const filename)
-{
-    SHIZResourceType const type = z_res__type(filename);
+    SHIZResourceSlot * const slots =
+        realloc(table->slots, capacity * sizeof(SHIZResourceSlot));
     
-    if (type == SHIZResourceTypeNotSupported) {
-        z_io__error("resource not loaded ('%s'); unsupported type (%s)",
-                    filename, z_res__filename_ext(filename));
-        
-        return SHIZResourceInvalid;
+    if (slots == NULL) {
+        return false;
     }
     
-    uint8_t resource_id = SHIZResourceInvalid;
+    table->slots = slots;
     
-    uint8_t expected_index;
-    uint8_t const expected_id = z_res__next_id(type, &expected_index);
+    uint8_t ** const pages =
+        realloc(table->pages, new_page_count * sizeof(uint8_t *));
     
-    if (expected_id != SHIZResourceInvalid) {
-        if (type == SHIZResourceTypeImage) {
-            _current_image_resource = &_images[expected_index];
-            _current_image_resource->resource_id = expected_id;
-            _current_image_resource->filename = filename;
-            
-            if (z_io__load_image(filename, z_res__image_loaded_callback)) {
-                resource_id = expected_id;
-            }
-            
-            _current_image_resource = NULL;
-        } else if (type == SHIZResourceTypeSound) {
-            _current_sound_resource = &_sounds[expected_index];
-            _current_sound_resource->resource_id = expected_id;
-            _current_sound_resource->filename = filename;
-            
-            if (z_io__load_sound(filename, z_res__sound_loaded_callback)) {
-                resource_id = expected_id;
-            }
+    if (pages == NULL) {
+        return false;
+    }
+    
+    table->pages = pages;
+    
+    for (uint32_t page = page_count; page < new_page_count; page++) {
+        table->pages[page] = calloc(SHIZResourcePageSize, table->resource_size);
+        
+        if (table->pages[page] == NULL) {
+            // keep the pages that were allocated
+            table->capacity = page * SHIZResourcePageSize;
             
-            _current_sound_resource = NULL;
+            return page > page_count;
         }
     }
     
-    return resource_id;
+    table->capacity = capacity;
+    
+    return true;
 }
 
-uint8_t
-z_res__load_data(SHIZResourceType const type,
-                 uint8_t const * const buffer,
-                 uint32_t const length)
+static
+void
+z_res__free_table(SHIZResourceTable * const table)
 {
-    if (type == SHIZResourceTypeNotSupported) {
-        z_io__error("resource not loaded; unsupported type");
-        
-        return SHIZResourceInvalid;
-    }
-    
-    uint8_t resource_id = SHIZResourceInvalid;
+    uint32_t const page_count = table->capacity / SHIZResourcePageSize;
 
-    uint8_t expected_index;
-    uint8_t const expected_id = z_res__next_id(type, &expected_index);
-    
-    if (expected_id != SHIZResourceInvalid) {
-        if (type == SHIZResourceTypeImage) {
-            _current_image_resource = &_images[expected_index];
-            
-            if (z_io__load_image_data(buffer, length, z_res__image_loaded_callback)) {
-                _current_image_resource->resource_id = expected_id;
-                _current_image_resource->filename = NULL;
-                
-                resource_id = expected_id;
-            }
-            
-            _current_image_resource = NULL;
-        } else if (type == SHIZResourceTypeSound) {
-            // todo: actual loading left blank for future implementation
-            
-            _sounds[expected_index].resource_id = expected_id;
-            
-            resource_id = expected_id;
-        }
+    for (uint32_t page = 0; page < page_count; page++) {
+        free(table->pages[page]);
     }
     
-    return resource_id;
+    free(table->pages);
+    free(table->slots);
+
+    table->pages = NULL;
+    table->slots = NULL;
+    table->capacity = 0;
+    table->count = 0;
+    table->free_slot = 0;
+    table->free_slot_last = 0;
 }
 
+static
 bool
-z_res__unload(uint8_t const resource_id)
+z_res__image_loaded_callback(int32_t const width,
+                             int32_t const height,
+                             int32_t const components,
+                             uint8_t const * const data)
 {
-    if (resource_id == SHIZResourceInvalid) {
+    if (_current_image_resource == NULL) {
         return false;
     }
     
-    bool unloaded = false;
+    if (data == NULL ||
+        (width <= 0 || height <= 0) ||
+        (width > UINT16_MAX || height > UINT16_MAX)) {
+        return false;
+    }
     
-    SHIZResourceType const type = z_res__type_from_id(resource_id);
+    _current_image_resource->width = (uint16_t)width;
+    _current_image_resource->height = (uint16_t)height;
+    _current_image_resource->size = (uint32_t)width * (uint32_t)height *
+        (uint32_t)components;
     
-    int16_t const index = z_res__index_from_id(resource_id, type);
+    if (!z_gfx__create_texture(_current_image_resource,
+                               width, height,
+                               components,
+                               data)) {
+        return false;
+    }
     
-    if (index < 0) {
-        z_io__error("could not unload resource (%d); index out of bounds (%d)",
-                    resource_id, index);
-    } else {
-        if (type == SHIZResourceTypeImage) {
-            unloaded = z_gfx__destroy_texture(&_images[index]);
-            
-            if (!unloaded) {
-                z_io__error("could not unload image (%d)", resource_id);
-            }
-            
-            _images[index].width = 0;
-            _images[index].height = 0;
-            _images[index].resource_id = SHIZResourceInvalid;
-            _images[index].filename = NULL;
-            _images[index].texture_id = 0;
-        } else if (type == SHIZResourceTypeSound) {
-            unloaded = z_mixer__destroy_sound(&_sounds[index]);
-            
-            if (!unloaded) {
-                z_io__error("could not unload sound (%d)", resource_id);
-            }
-            
-            _sounds[index].resource_id = SHIZResourceInvalid;
-            _sounds[index].filename = NULL;
-            _sounds[index].source_id = 0;
-        } else {
-            z_io__error("could not unload resource (%d); resource not found",
-                        resource_id);
-        }
+    _texture_usage.bytes += _current_image_resource->size;
+    
+    return true;
+}
+
+static
+bool
+z_res__sound_loaded_callback(int32_t const channels,
+                             int32_t const sample_rate,
+                             int16_t * const data,
+                             int32_t size)
+{
+    if (_current_sound_resource == NULL) {
+        return false;
     }
     
-    return unloaded;
+    if (data == NULL) {
+        return false;
+    }
+    
+    return z_mixer__create_sound(_current_sound_resource,
+                                 channels, sample_rate,
+                                 data, size);
 }
 
+static
 bool
-z_res__unload_all()
+z_res__font_loaded_callback(uint8_t * const data,
+                            uint32_t const length)
 {
-    bool something_failed = false;
+    if (_current_font_resource == NULL) {
+        return false;
+    }
     
-    for (uint8_t image_resource_index = 0; image_resource_index < SHIZResourceImageMax; image_resource_index++) {
-        uint8_t const resource_id = _images[image_resource_index].resource_id;
-        
-        if (resource_id != SHIZResourceInvalid) {
-            if (!z_res__unload(resource_id)) {
-                something_failed = true;
-            }
-        }
+    return z_truetype__create_face(_current_font_resource, data, length);
+}
+
+uint32_t
+z_res__create_atlas(uint16_t const width,
+                    uint16_t const height)
+{
+    if (z_res__image(_atlas_resource_id) != NULL) {
+        return _atlas_resource_id;
+    }
+    
+    uint8_t * const blank = calloc((size_t)width * height, sizeof(uint8_t));
+    
+    if (blank == NULL) {
+        return SHIZResourceInvalid;
     }
     
-    for (uint8_t sound_resource_index = 0; sound_resource_index < SHIZResourceSoundMax; sound_resource_index++) {
-        uint8_t const resource_id = _sounds[sound_resource_index].resource_id;
+    void * resource = NULL;
+    
+    uint32_t const resource_id = z_res__acquire(SHIZResourceTypeImage, NULL, &resource);
+    
+    if (resource_id == SHIZResourceInvalid) {
+        free(blank);
         
-        if (resource_id != SHIZResourceInvalid) {
-            if (!z_res__unload(resource_id)) {
-                something_failed = true;
-            }
-        }
+        return SHIZResourceInvalid;
     }
     
-#ifdef SHIZ_DEBUG
-    if (_font_resource.resource_id != SHIZResourceInvalid) {
-        if (!z_debug__unload_font()) {
-            something_failed = true;
-        }
+    SHIZResourceImage * const atlas = resource;
+    
+    bool const created =
+        z_gfx__create_texture(atlas, width, height, 1, blank);
+    
+    free(blank);
+    
+    if (!created) {
+        z_res__release(resource_id);
+        
+        return SHIZResourceInvalid;
     }
-#endif
     
-    return !something_failed;
+    atlas->width = width;
+    atlas->height = height;
+    atlas->size = (uint32_t)width * height;
+    atlas->resource_id = resource_id;
+    
+    _texture_usage.bytes += atlas->size;
+    
+    _atlas_resource_id = resource_id;
+    
+    return _atlas_resource_id;
 }
 
-static
-int16_t const
-z_res__index_from_id(uint8_t const resource_id,
-                     SHIZResourceType const type)
+bool
+z_res__destroy_atlas()
 {
-    if (type == SHIZResourceTypeImage) {
-        return resource_id - SHIZResourceImageIdOffset;
-    } else if (type == SHIZResourceTypeSound) {
-        return resource_id - SHIZResourceSoundIdOffset;
+    if (z_res__image(_atlas_resource_id) == NULL) {
+        return false;
     }
     
-    return -1;
+    bool const destroyed = z_res__unload(_atlas_resource_id);
+    
+    _atlas_resource_id = SHIZResourceInvalid;
+    
+    return destroyed;
 }
 
 static
-SHIZResourceType
-z_res__type_from_id(uint8_t const resource_id)
+uint64_t
+z_res__hash(uint64_t hash,
+            uint8_t const * const bytes,
+            size_t const length)
 {
-    if (z_res__is_image(resource_id)) {
-        return SHIZResourceTypeImage;
-    } else if (z_res__is_sound(resource_id)) {
-        return SHIZResourceTypeSound;
+    // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211u;
     }
     
-    return SHIZResourceTypeNotSupported;
+    return hash;
 }
 
 static
-bool
-z_res__is_image(uint8_t const resource_id)
+uint64_t
+z_res__path_key(char const * const filename)
 {
-    return resource_id < SHIZResourceImageIdMax;
+    char path[SHIZResourcePathMax];
+    
+    z_io__canonical_path(filename, path, SHIZResourcePathMax);
+    
+    uint8_t const tag = 0;
+    
+    uint64_t key = z_res__hash(14695981039346656037u, &tag, sizeof(tag));
+    
+    key = z_res__hash(key, (uint8_t const *)path, strlen(path));
+    
+    // 0 is reserved for resources that are not cached
+    return key != 0 ? key : 1;
 }
 
 static
-bool
-z_res__is_sound(uint8_t const resource_id)
+uint64_t
+z_res__data_key(SHIZResourceType const type,
+                uint8_t const * const buffer,
+                uint32_t const length)
 {
-    return !z_res__is_image(resource_id) &&
-        resource_id < SHIZResourceSoundIdMax;
+    // tag by type; the same bytes loaded as different types are not the same
+    // resource (and should never hash equal to a filename either)
+    uint8_t const tag = (uint8_t)type;
+    
+    uint64_t key = z_res__hash(14695981039346656037u, &tag, sizeof(tag));
+    
+    key = z_res__hash(key, (uint8_t const *)&length, sizeof(length));
+    
+    if (buffer != NULL) {
+        key = z_res__hash(key, buffer, length);
+    }
+    
+    return key != 0 ? key : 1;
 }
 
 static
-bool
-z_res__is_index_free(uint8_t const resource_index,
-                     SHIZResourceType const type)
+uint32_t
+z_res__cache_retain(uint64_t const key)
 {
-    if (type == SHIZResourceTypeImage) {
-        return _images[resource_index].resource_id == SHIZResourceInvalid;
-    } else if (type == SHIZResourceTypeSound) {
-        return _sounds[resource_index].resource_id == SHIZResourceInvalid;
+    if (_cache.count > 0) {
+        uint32_t const mask = _cache.capacity - 1;
+        
+        for (uint32_t i = (uint32_t)key & mask;
+             _cache.entries[i].resource_id != SHIZResourceInvalid;
+             i = (i + 1) & mask) {
+            if (_cache.entries[i].key == key) {
+                uint32_t const resource_id = _cache.entries[i].resource_id;
+                
+                z_res__slot(resource_id)->references += 1;
+                
+                _cache.hits += 1;
+                
+                return resource_id;
+            }
+        }
     }
     
-    return false;
+    _cache.misses += 1;
+    
+    return SHIZResourceInvalid;
 }
 
 static
-uint8_t
-z_res__next_id(SHIZResourceType const type,
-               uint8_t * const index)
+void
+z_res__cache_insert(uint64_t const key,
+                    uint32_t const resource_id)
 {
-    if (type == SHIZResourceTypeNotSupported) {
-        return SHIZResourceInvalid;
+    // keep the table at most half full, so that probes stay short
+    if ((_cache.count + 1) * 2 > _cache.capacity) {
+        if (!z_res__cache_grow()) {
+            // the resource is still loaded; it just won't be shared
+            return;
+        }
     }
     
-    uint8_t start_id = 0;
-    uint8_t max_id = 0;
+    uint32_t const mask = _cache.capacity - 1;
     
-    if (type == SHIZResourceTypeImage) {
-        start_id = SHIZResourceImageIdOffset;
-        max_id = SHIZResourceImageIdMax;
-    } else if (type == SHIZResourceTypeSound) {
-        start_id = SHIZResourceSoundIdOffset;
-        max_id = SHIZResourceSoundIdMax;
-    }
-    
-    uint8_t next_index = 0;
+    uint32_t i = (uint32_t)key & mask;
     
-    for (uint8_t next_id = start_id; next_id < max_id; next_id++) {
-        next_index = next_id - start_id;
-        
-        if (z_res__is_index_free(next_index, type)) {
-            *index = next_index;
-            
-            return next_id;
-        }
+    while (_cache.entries[i].resource_id != SHIZResourceInvalid) {
+        i = (i + 1) & mask;
     }
     
-    if (type == SHIZResourceTypeImage) {
-        z_io__error("image limit reached (%d)", SHIZResourceImageMax);
-    } else if (type == SHIZResourceTypeSound) {
-        z_io__error("sound limit reached (%d)", SHIZResourceSoundMax);
-    }
+    _cache.entries[i].key = key;
+    _cache.entries[i].resource_id = resource_id;
+    _cache.count += 1;
     
-    return SHIZResourceInvalid;
+    z_res__slot(resource_id)->key = key;
 }
 
 static
-bool
-z_res__image_loaded_callback(int32_t const width,
-                             int32_t const height,
-                             int32_t const components,
-                             uint8_t * const data)
+void
+z_res__cache_remove(uint64_t const key)
 {
-    if (_current_image_resource == NULL) {
-        return false;
+    if (_cache.count == 0) {
+        return;
     }
     
-    if (data == NULL ||
-        (width <= 0 || height <= 0) ||
-        (width > UINT16_MAX || height > UINT16_MAX)) {
-        return false;
+    uint32_t const mask = _cache.capacity - 1;
+    
+    uint32_t i = (uint32_t)key & mask;
+    
+    while (_cache.entries[i].key != key) {
+        if (_cache.entries[i].resource_id == SHIZResourceInvalid) {
+            return;
+        }
+        
+        i = (i + 1) & mask;
     }
     
-    _current_image_resource->width = (uint16_t)width;
-    _current_image_resource->height = (uint16_t)height;
-
-    return z_gfx__create_texture(_current_image_resource,
-                                 width, height,
-                                 components,
-                                 data);
+    // shift back any entries that would no longer be found past the hole
+    uint32_t j = i;
+    
+    while (true) {
+        _cache.entries[i].resource_id = SHIZResourceInvalid;
+        _cache.entries[i].key = 0;
+        
+        uint32_t home;
+        
+        do {
+            j = (j + 1) & mask;
+            
+            if (_cache.entries[j].resource_id == SHIZResourceInvalid) {
+                _cache.count -= 1;
+                
+                return;
+            }
+            
+            home = (uint32_t)_cache.entries[j].key & mask;
+        } while (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+        
+        _cache.entries[i] = _cache.entries[j];
+        
+        i = j;
+    }
 }
 
 static
 bool
-z_res__sound_loaded_callback(int32_t const channels,
-                             int32_t const sample_rate,
-                             int16_t * const data,
-                             int32_t size)
+z_res__cache_grow()
 {
-    if (_current_sound_resource == NULL) {
+    uint32_t const capacity = _cache.capacity == 0 ?
+        SHIZResourceCacheCapacity : _cache.capacity * 2;
+    
+    SHIZResourceCacheEntry * const entries =
+        calloc(capacity, sizeof(SHIZResourceCacheEntry));
+    
+    if (entries == NULL) {
         return false;
     }
     
-    if (data == NULL) {
-        return false;
+    uint32_t const mask = capacity - 1;
+    
+    for (uint32_t i = 0; i < _cache.capacity; i++) {
+        SHIZResourceCacheEntry const entry = _cache.entries[i];
+        
+        if (entry.resource_id != SHIZResourceInvalid) {
+            uint32_t j = (uint32_t)entry.key & mask;
+            
+            while (entries[j].resource_id != SHIZResourceInvalid) {
+                j = (j + 1) & mask;
+            }
+            
+            entries[j] = entry;
+        }
     }
     
-    return z_mixer__create_sound(_current_sound_resource,
-                                 channels, sample_rate,
-                                 data, size);
+    free(_cache.entries);
+    
+    _cache.entries = entries;
+    _cache.capacity = capacity;
+    
+    return true;
 }
 
 static
@@ -461,50 +1716,85 @@ z_res__filename_ext(char const * const filename)
 void
 z_debug__print_resources()
 {
-    printf("  IDX  ID  RESOURCE\n");
-    printf("  -----------------\n");
-    for (uint8_t image_resource_index = 0; image_resource_index < SHIZResourceImageMax; image_resource_index++) {
-        uint8_t resource_id = _images[image_resource_index].resource_id;
-        
-        if (resource_id != SHIZResourceInvalid) {
-            printf("i %02d: [%02d] %s (%dx%d)\n",
-                   image_resource_index, resource_id,
-                   _images[image_resource_index].filename,
-                   _images[image_resource_index].width,
-                   _images[image_resource_index].height);
-        } else {
-            printf("i %02d: [%02d] ---\n", image_resource_index, resource_id);
-        }
-    }
-    for (uint8_t sound_resource_index = 0; sound_resource_index < SHIZResourceSoundMax; sound_resource_index++) {
-        uint8_t resource_id = _sounds[sound_resource_index].resource_id;
+    printf("  IDX  ID        REFS  RESOURCE\n");
+    printf("  -----------------------------\n");
+    
+    SHIZResourceTable const * const tables[] = {
+        &_images, &_sounds, &_fonts
+    };
+    
+    char const prefixes[] = { 'i', 's', 'f' };
+    
+    for (uint8_t table_index = 0; table_index < 3; table_index++) {
+        SHIZResourceTable const * const table = tables[table_index];
         
-        if (resource_id != SHIZResourceInvalid) {
-            printf("s %02d: [%02d] %s\n",
-                   sound_resource_index, resource_id,
-                   _sounds[sound_resource_index].filename);
-        } else {
-            printf("s %02d: [%02d] ---\n", sound_resource_index, resource_id);
+        char const prefix = prefixes[table_index];
+        
+        for (uint32_t index = 0; index < table->count; index++) {
+            uint32_t const resource_id = z_res__id_at(table, index);
+            
+            if (resource_id == SHIZResourceInvalid) {
+                printf("%c %02u: [--------]    -  ---\n", prefix, index);
+                
+                continue;
+            }
+            
+            uint32_t const references = table->slots[index].references;
+            
+            if (table->slots[index].generation & SHIZResourceSlotPending) {
+                printf("%c %02u: [%08x] %4u  (loading)\n",
+                       prefix, index, resource_id, references);
+                
+                continue;
+            }
+            
+            if (table->type == SHIZResourceTypeImage) {
+                SHIZResourceImage const * const image = z_res__record(table, index);
+                
+                printf("%c %02u: [%08x] %4u  %s (%dx%d)%s\n",
+                       prefix, index, resource_id, references,
+                       image->filename != NULL ? image->filename : "-",
+                       image->width, image->height,
+                       image->texture_id == 0 ? " (not in memory)" : "");
+            } else if (table->type == SHIZResourceTypeSound) {
+                SHIZResourceSound const * const sound = z_res__record(table, index);
+                
+                printf("%c %02u: [%08x] %4u  %s%s\n",
+                       prefix, index, resource_id, references,
+                       sound->filename != NULL ? sound->filename : "-",
+                       sound->stream != NULL ? " (streamed)" : "");
+            } else if (table->type == SHIZResourceTypeFont) {
+                SHIZResourceFont const * const font = z_res__record(table, index);
+                
+                printf("%c %02u: [%08x] %4u  %s\n",
+                       prefix, index, resource_id, references,
+                       font->filename != NULL ? font->filename : "-");
+            }
         }
     }
+    
+    uint32_t const loads = _cache.hits + _cache.misses;
+    
+    printf("  -----------------------------\n");
+    printf("  cache: %u/%u loads shared (%.1f%%), %u cached\n",
+           _cache.hits, loads,
+           loads > 0 ? (_cache.hits / (double)loads) * 100 : 0,
+           _cache.count);
+    printf("  textures: %u/%u bytes, %u hits, %u misses, %u evictions\n",
+           _texture_usage.bytes, _texture_usage.budget,
+           _texture_usage.hits, _texture_usage.misses,
+           _texture_usage.evictions);
 }
 
 bool
 z_debug__load_font(uint8_t const * const buffer,
                    uint32_t const length)
 {
-    if (_font_resource.resource_id != SHIZResourceInvalid) {
+    if (z_res__image(_font_resource_id) != NULL) {
         return false;
     }
     
-    _current_image_resource = &_font_resource;
-    
-    if (z_io__load_image_data(buffer, length, z_res__image_loaded_callback)) {
-        // offset by 1 to ensure the id won't be occupied by any other resource
-        _font_resource.resource_id = SHIZResourceIdMax + 1;
-    }
-    
-    _current_image_resource = NULL;
+    _font_resource_id = z_res__load_data(SHIZResourceTypeImage, buffer, length);
     
     return true;
 }
@@ -512,25 +1802,21 @@ z_debug__load_font(uint8_t const * const buffer,
 bool
 z_debug__unload_font()
 {
-    if (_font_resource.texture_id == 0) {
+    if (z_res__image(_font_resource_id) == NULL) {
         return false;
     }
     
-    glDeleteTextures(1, &_font_resource.texture_id);
+    bool const unloaded = z_res__unload(_font_resource_id);
     
-    _font_resource.width = 0;
-    _font_resource.height = 0;
-    _font_resource.resource_id = SHIZResourceInvalid;
-    _font_resource.filename = NULL;
-    _font_resource.texture_id = 0;
+    _font_resource_id = SHIZResourceInvalid;
     
-    return true;
+    return unloaded;
 }
 
-uint8_t
+uint32_t
 z_debug__get_font_resource()
 {
-    return _font_resource.resource_id;
+    return _font_resource_id;
 }
 
 #endif
@@ -12,43 +12,189 @@
 #pragma once
 
 #include <stdbool.h> // bool
-#include <stdint.h> // uint8_t, uint16_t
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
 
 #include "internal.h" // todo: preferaby get rid of this! only needed for GL/ALuint
 
+#include <SHIZEN/zloader.h> // SHIZTextureUsage
+
 typedef enum SHIZResourceType {
     SHIZResourceTypeNotSupported,
     SHIZResourceTypeImage,
-    SHIZResourceTypeSound
+    SHIZResourceTypeSound,
+    SHIZResourceTypeFont
 } SHIZResourceType;
 
+/**
+ * @brief Represents a loaded image.
+ *
+ * The fields needed for drawing come first, so that looking up an image only
+ * touches a single cache line.
+ */
 typedef struct SHIZResourceImage {
-    char const * filename;
+    /** The texture of the image; 0 if not in memory (see `z_res__use_image`) */
     GLuint texture_id;
     uint16_t width;
     uint16_t height;
-    uint8_t resource_id;
+    uint32_t resource_id;
+    /** The frame that the image was most recently drawn in */
+    uint32_t drawn_frame;
+    /** The size (in bytes) of the texture */
+    uint32_t size;
+    /** A copy of the filename that the image was loaded from; `NULL` if
+        loaded from memory */
+    char * filename;
 } SHIZResourceImage;
 
 typedef struct SHIZResourceSound {
-    char const * filename;
-    ALuint source_id;
+    /** The samples of the sound; shared by every voice playing it */
     ALuint buffer_id;
-    uint8_t resource_id;
+    /** The samples of the sound while mixing in software, instead of a
+        buffer; `NULL` otherwise */
+    int16_t * samples;
+    /** The compressed samples of the sound while mixing in software (see
+        `z_adpcm`), instead of `samples`; `NULL` otherwise */
+    uint8_t * blocks;
+    /** The size (in bytes) of the samples; however kept */
+    uint32_t size;
+    uint32_t frames;
+    int32_t sample_rate;
+    uint8_t channels;
+    /** The stream that the sound is decoded from while playing; `NULL` if
+        the sound was decoded up front */
+    struct SHIZStream * stream;
+    uint32_t resource_id;
+    /** A copy of the filename that the sound was loaded from; `NULL` if
+        loaded from memory */
+    char * filename;
 } SHIZResourceSound;
 
+struct SHIZTrueTypeFace;
+
+typedef struct SHIZResourceFont {
+    struct SHIZTrueTypeFace * face;
+    uint32_t resource_id;
+    /** A copy of the filename that the font was loaded from; `NULL` if
+        loaded from memory */
+    char * filename;
+} SHIZResourceFont;
+
 extern SHIZResourceImage const SHIZResourceImageEmpty;
 extern SHIZResourceSound const SHIZResourceSoundEmpty;
+extern SHIZResourceFont const SHIZResourceFontEmpty;
+
+extern uint32_t const SHIZResourceInvalid;
+
+uint32_t z_res__load(char const * filename);
+uint32_t z_res__load_data(SHIZResourceType, uint8_t const * buffer, uint32_t length);
+/**
+ * @brief Load a sound that is decoded while it plays, rather than up front.
+ *
+ * Unlike other resources, a stream is never shared; each load opens a stream
+ * of its own, which plays independently of any other.
+ */
+uint32_t z_res__load_stream(char const * filename);
+
+/**
+ * @brief Begin loading a resource in the background.
+ *
+ * The resource is decoded by `z_async` and finished by one of the
+ * `z_res__finish_*` functions. Until then, looking up the resource fails.
+ *
+ * @return The resource id that the resource will be loaded as, or
+ *         `SHIZResourceInvalid` if it could not be queued for loading
+ */
+uint32_t z_res__load_async(char const * filename);
 
-extern uint8_t const SHIZResourceInvalid;
+/**
+ * @brief Load many resources at once, decoding them in parallel.
+ *
+ * Every resource is decoded by `z_async` (with the calling thread helping
+ * out), and finished before returning; including anything else already
+ * loading in the background.
+ *
+ * @param resource_ids
+ *        Receives the id of each resource, or `SHIZResourceInvalid` for each
+ *        resource that failed to load
+ *
+ * @return The number of resources that were loaded successfully
+ */
+uint32_t z_res__load_many(char const * const * filenames, uint32_t count, uint32_t * resource_ids);
 
-uint8_t z_res__load(char const * filename);
-uint8_t z_res__load_data(SHIZResourceType, uint8_t const * buffer, uint32_t length);
+/**
+ * @brief Create the resource of a decoded image, sound or font that was
+ *        queued with `z_res__load_async`.
+ *
+ * If the data is `NULL`, the resource failed to decode and is released.
+ * A font takes ownership of its data if it was finished successfully.
+ *
+ * An image is not finished until its texture has been uploaded (see
+ * `z_gfx__queue_texture`), which may take a few frames.
+ *
+ * An image that is already loaded is instead reloaded (see `z_watch`); its
+ * texture is replaced in place, and it is kept as is if the data is `NULL`.
+ *
+ * @return `true` if the resource was finished (or is being uploaded), `false`
+ *         if it failed, or if it was unloaded before it could be finished
+ */
+bool z_res__finish_image(uint32_t resource_id, int32_t width, int32_t height, int32_t components, uint8_t * data);
+bool z_res__finish_sound(uint32_t resource_id, int32_t channels, int32_t sample_rate, int16_t * data, int32_t size);
+bool z_res__finish_font(uint32_t resource_id, uint8_t * data, uint32_t length);
+/**
+ * @brief Finish an image once its texture has been uploaded.
+ */
+void z_res__finish_texture(uint32_t resource_id);
 
-bool z_res__unload(uint8_t resource_id);
+/**
+ * @brief Begin a new frame.
+ *
+ * Textures drawn during the current frame are never evicted.
+ */
+void z_res__reset(void);
+
+/**
+ * @brief Look up an image that is about to be drawn.
+ *
+ * Unlike `z_res__image`, this makes sure that the texture of the image is in
+ * memory; loading it if needed, and evicting the textures least recently
+ * drawn to stay within budget.
+ *
+ * @return The image, or `NULL` if not found or its texture could not be
+ *         loaded
+ */
+SHIZResourceImage const * z_res__use_image(uint32_t resource_id);
+
+void z_res__set_texture_budget(uint32_t bytes);
+SHIZTextureUsage z_res__texture_usage(void);
+
+bool z_res__is_loaded(uint32_t resource_id);
+bool z_res__is_loading(uint32_t resource_id);
+
+bool z_res__unload(uint32_t resource_id);
 bool z_res__unload_all(void);
 
 SHIZResourceType const z_res__type(char const * filename);
 
-SHIZResourceImage z_res__image(uint8_t resource_id);
-SHIZResourceSound z_res__sound(uint8_t resource_id);
+/**
+ * @brief Look up a loaded resource.
+ *
+ * A resource stays at the same address for as long as it is loaded, but the
+ * pointer must not be kept past unloading it.
+ *
+ * @return A pointer to the resource, or `NULL` if the id does not refer to a
+ *         loaded resource of the type (e.g. because it has been unloaded)
+ */
+SHIZResourceImage const * z_res__image(uint32_t resource_id);
+SHIZResourceSound const * z_res__sound(uint32_t resource_id);
+SHIZResourceFont const * z_res__font(uint32_t resource_id);
+
+/**
+ * @brief Create the blank, single-channel image that glyphs are rasterized into.
+ *
+ * The atlas is kept as any other image, so that it can be drawn from like one.
+ *
+ * @return The resource id of the atlas, or `SHIZResourceInvalid` if it could
+ *         not be created
+ */
+uint32_t z_res__create_atlas(uint16_t width, uint16_t height);
+bool z_res__destroy_atlas(void);
@@ -0,0 +1,85 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#include "ring.h"
+
+#include <string.h> // memcpy, memset
+
+// the count of each end is stored with release semantics, after the element
+// has been copied; and loaded with acquire semantics by the other end before
+// the element is copied. So an element is never seen half-written
+
+void
+z_ring__init(SHIZRing * const ring,
+             void * const elements,
+             uint32_t const capacity,
+             uint32_t const element_size)
+{
+    memset(ring, 0, sizeof(SHIZRing));
+    
+    ring->elements = elements;
+    ring->element_size = element_size;
+    ring->capacity = capacity;
+}
+
+bool
+z_ring__push(SHIZRing * const ring,
+             void const * const element)
+{
+    uint32_t const count = __atomic_load_n(&ring->producer.count,
+                                           __ATOMIC_RELAXED);
+    
+    if (count - ring->producer.other_count == ring->capacity) {
+        // seemingly full; see whether anything was popped since
+        ring->producer.other_count = __atomic_load_n(&ring->consumer.count,
+                                                     __ATOMIC_ACQUIRE);
+        
+        if (count - ring->producer.other_count == ring->capacity) {
+            return false;
+        }
+    }
+    
+    uint32_t const index = count & (ring->capacity - 1);
+    
+    memcpy(ring->elements + index * ring->element_size,
+           element, ring->element_size);
+    
+    __atomic_store_n(&ring->producer.count, count + 1, __ATOMIC_RELEASE);
+    
+    return true;
+}
+
+bool
+z_ring__pop(SHIZRing * const ring,
+            void * const element)
+{
+    uint32_t const count = __atomic_load_n(&ring->consumer.count,
+                                           __ATOMIC_RELAXED);
+    
+    if (count == ring->consumer.other_count) {
+        // seemingly empty; see whether anything was pushed since
+        ring->consumer.other_count = __atomic_load_n(&ring->producer.count,
+                                                     __ATOMIC_ACQUIRE);
+        
+        if (count == ring->consumer.other_count) {
+            return false;
+        }
+    }
+    
+    uint32_t const index = count & (ring->capacity - 1);
+    
+    memcpy(element, ring->elements + index * ring->element_size,
+           ring->element_size);
+    
+    __atomic_store_n(&ring->consumer.count, count + 1, __ATOMIC_RELEASE);
+    
+    return true;
+}
@@ -0,0 +1,74 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t, uint32_t
+
+/**
+ * The size (in bytes) of a cache line; each end of a ring is kept on a line
+ * of its own, so that neither thread invalidates the line of the other.
+ */
+#define SHIZRingCacheLineSize 64
+
+/**
+ * @brief Represents one end of a ring; only ever advanced by one thread.
+ */
+typedef struct SHIZRingEnd {
+    /** The number of elements pushed (or popped) so far */
+    uint32_t count;
+    /** The count of the other end, as most recently seen; so that the other
+        end is only looked at once this end has caught up with it */
+    uint32_t other_count;
+    uint8_t padding[SHIZRingCacheLineSize - sizeof(uint32_t) * 2];
+} SHIZRingEnd;
+
+/**
+ * @brief Represents a fixed number of elements passed from one thread to
+ *        another, in order, without locking.
+ *
+ * Only one thread may push, and only one thread may pop; though not
+ * necessarily the same thread every time, as long as something else (e.g.
+ * a mutex) keeps any two from doing so at once.
+ */
+typedef struct SHIZRing {
+    SHIZRingEnd producer;
+    SHIZRingEnd consumer;
+    uint8_t * elements;
+    uint32_t element_size;
+    /** The max number of elements; a power of two */
+    uint32_t capacity;
+} SHIZRing;
+
+/**
+ * @brief Set up a ring over a fixed block of elements.
+ *
+ * @param elements
+ *        Must hold `capacity` elements, and stay in memory for as long as the
+ *        ring is used
+ * @param capacity
+ *        Must be a power of two
+ */
+void z_ring__init(SHIZRing *, void * elements, uint32_t capacity, uint32_t element_size);
+
+/**
+ * @brief Copy an element onto the end of a ring.
+ *
+ * @return `true` if the element was pushed, `false` if the ring is full
+ */
+bool z_ring__push(SHIZRing *, void const * element);
+/**
+ * @brief Copy the element at the beginning of a ring, and remove it.
+ *
+ * @return `true` if an element was popped, `false` if the ring is empty
+ */
+bool z_ring__pop(SHIZRing *, void * element);
@@ -52,6 +52,9 @@ typedef struct SHIZSpriteList {
 static int z_sprite__compare(void const * sprite, void const * other_sprite);
 static void z_sprite__sort(void);
 
+static uint32_t z_sprite__key(GLuint texture_id, SHIZLayer layer, bool opaque);
+static void z_sprite__add(void);
+
 static void z_sprite__set_position(SHIZSpriteObject * sprite,
                                    SHIZSize destination_size,
                                    SHIZVector2 anchor);
@@ -77,10 +80,9 @@ z_sprite__draw(SHIZSprite const sprite,
                bool const opaque,
                SHIZLayer const layer)
 {
-    SHIZResourceImage const image = z_res__image(sprite.resource_id);
+    SHIZResourceImage const * const image = z_res__use_image(sprite.resource_id);
 
-    if (sprite.resource_id == SHIZResourceInvalid ||
-        sprite.resource_id != image.resource_id ||
+    if (image == NULL ||
         (sprite.source.size.width <= 0 ||
          sprite.source.size.height <= 0) ||
         (size.target.width == 0 ||
@@ -90,25 +92,17 @@ z_sprite__draw(SHIZSprite const sprite,
 
     float const z = z_layer__get_z(layer);
     
-    uint32_t sort_key = 0;
-    
-    SHIZSpriteKey * const sprite_key = (SHIZSpriteKey *)&sort_key;
-
-    sprite_key->layer = layer;
-    sprite_key->texture_id = (uint8_t)image.texture_id;
-    sprite_key->is_transparent = !opaque;
-    
     struct SHIZSpriteObject * const sprite_object =
         &_sprite_list.sprites[_sprite_list.count];
     
-    sprite_object->key = sort_key;
+    sprite_object->key = z_sprite__key(image->texture_id, layer, opaque);
     sprite_object->angle = angle;
     sprite_object->order = _sprite_list.total;
     sprite_object->origin = SHIZVector3Make(PIXEL(origin.x),
                                             PIXEL(origin.y),
                                             z);
     
-    SHIZSize const texture_size = SHIZSizeMake(image.width, image.height);
+    SHIZSize const texture_size = SHIZSizeMake(image->width, image->height);
 
     SHIZSize const source_size = SHIZSizeMake(size.target.width > 0 ?
                                                 size.target.width : sprite.source.size.width,
@@ -123,16 +117,143 @@ z_sprite__draw(SHIZSprite const sprite,
     z_sprite__set_uv(sprite_object, destination_size, texture_size,
                      sprite.source, flip, tint, repeat);
 
-    // count for current batch
-    _sprite_list.count += 1;
-    // count for total sprites during a frame; i.e. the accumulation of all flushed sprites
-    _sprite_list.total += 1;
+    z_sprite__add();
 
-    if (_sprite_list.count >= SHIZSpriteMax) {
-        z_sprite__flush();
+    return destination_size;
+}
+
+bool
+z_sprite__begin_run(SHIZSpriteRun * const run,
+                    uint32_t const resource_id,
+                    SHIZSize const size,
+                    SHIZVector2 const anchor,
+                    bool const opaque,
+                    SHIZLayer const layer)
+{
+    SHIZResourceImage const * const image = z_res__use_image(resource_id);
+    
+    if (image == NULL ||
+        (size.width <= 0 || size.height <= 0)) {
+        return false;
     }
+    
+    SHIZRect const anchored = z_sprite__anchor_rect(size, anchor);
+    
+    float const l = PIXEL(anchored.origin.x);
+    float const r = PIXEL(anchored.origin.x + anchored.size.width);
+    float const b = PIXEL(anchored.origin.y);
+    float const t = PIXEL(anchored.origin.y + anchored.size.height);
+    
+    run->bottom_left = SHIZVector2Make(l, b);
+    run->top_right = SHIZVector2Make(r, t);
+    run->texture_size = SHIZSizeMake(image->width, image->height);
+    run->key = z_sprite__key(image->texture_id, layer, opaque);
+    run->z = z_layer__get_z(layer);
+    
+    return true;
+}
 
-    return destination_size;
+void
+z_sprite__draw_run(SHIZSpriteRun const * const run,
+                   SHIZRect const source,
+                   SHIZVector2 const origin,
+                   SHIZColor const tint)
+{
+    struct SHIZSpriteObject * const sprite_object =
+        &_sprite_list.sprites[_sprite_list.count];
+    
+    sprite_object->key = run->key;
+    sprite_object->angle = 0;
+    sprite_object->order = _sprite_list.total;
+    sprite_object->origin = SHIZVector3Make(PIXEL(origin.x),
+                                            PIXEL(origin.y),
+                                            run->z);
+    
+    float const l = run->bottom_left.x;
+    float const r = run->top_right.x;
+    float const b = run->bottom_left.y;
+    float const t = run->top_right.y;
+    
+    SHIZVector2 uv_min;
+    SHIZVector2 uv_max;
+    
+    z_sprite__source_uv(source, run->texture_size, &uv_min, &uv_max);
+    
+    SHIZVertexPositionColorTexture * const vertices = sprite_object->vertices;
+    
+    // same as z_sprite__set_position and z_sprite__set_uv, without any
+    // flipping or repeating
+    vertices[0].position = SHIZVector3Make(l, t, 0);
+    vertices[0].texture_coord = SHIZVector2Make(uv_min.x, uv_max.y);
+    vertices[1].position = SHIZVector3Make(r, b, 0);
+    vertices[1].texture_coord = SHIZVector2Make(uv_max.x, uv_min.y);
+    vertices[2].position = SHIZVector3Make(l, b, 0);
+    vertices[2].texture_coord = SHIZVector2Make(uv_min.x, uv_min.y);
+    
+    vertices[3].position = SHIZVector3Make(l, t, 0);
+    vertices[3].texture_coord = SHIZVector2Make(uv_min.x, uv_max.y);
+    vertices[4].position = SHIZVector3Make(r, t, 0);
+    vertices[4].texture_coord = SHIZVector2Make(uv_max.x, uv_max.y);
+    vertices[5].position = SHIZVector3Make(r, b, 0);
+    vertices[5].texture_coord = SHIZVector2Make(uv_max.x, uv_min.y);
+    
+    for (uint8_t vertex = 0; vertex < SHIZSpriteVertexCount; vertex++) {
+        vertices[vertex].color = tint;
+        vertices[vertex].texture_coord_min = uv_min;
+        vertices[vertex].texture_coord_max = uv_max;
+    }
+    
+    z_sprite__add();
+}
+
+bool
+z_sprite__draw_quads(uint32_t const resource_id,
+                     SHIZVertexPositionColorTexture const * const vertices,
+                     uint32_t const quad_count,
+                     SHIZVector2 const origin,
+                     SHIZColor const tint,
+                     bool const opaque,
+                     SHIZLayer const layer)
+{
+    SHIZResourceImage const * const image = z_res__use_image(resource_id);
+    
+    if (image == NULL) {
+        return false;
+    }
+    
+    uint32_t const key = z_sprite__key(image->texture_id, layer, opaque);
+    
+    SHIZVector3 const quad_origin = SHIZVector3Make(PIXEL(origin.x),
+                                                    PIXEL(origin.y),
+                                                    z_layer__get_z(layer));
+    
+    for (uint32_t i = 0; i < quad_count; i++) {
+        struct SHIZSpriteObject * const sprite_object =
+            &_sprite_list.sprites[_sprite_list.count];
+        
+        sprite_object->key = key;
+        sprite_object->angle = 0;
+        sprite_object->order = _sprite_list.total;
+        sprite_object->origin = quad_origin;
+        
+        SHIZVertexPositionColorTexture const * const quad =
+            &vertices[i * SHIZSpriteVertexCount];
+        
+        for (uint8_t vertex = 0; vertex < SHIZSpriteVertexCount; vertex++) {
+            SHIZColor const color = quad[vertex].color;
+            
+            sprite_object->vertices[vertex] = quad[vertex];
+            sprite_object->vertices[vertex].color =
+                SHIZColorMake(color.r * tint.r,
+                              color.g * tint.g,
+                              color.b * tint.b,
+                              color.alpha * tint.alpha);
+        }
+        
+        z_sprite__add();
+    }
+    
+    return true;
 }
 
 SHIZRect const
@@ -151,6 +272,33 @@ z_sprite__anchor_rect(SHIZSize const size,
     return SHIZRectMake(SHIZVector2Make(l, b), size);
 }
 
+void
+z_sprite__source_uv(SHIZRect source,
+                    SHIZSize const texture_size,
+                    SHIZVector2 * const uv_min,
+                    SHIZVector2 * const uv_max)
+{
+    bool const flip_source_vertically = true;
+    
+    if (flip_source_vertically) {
+        // opengl assumes that the origin of textures is at the bottom-left of the image,
+        // however, it is common to specify top-left as origin when using e.g. sprite sheets (and we want that)
+        // so, assuming that the provided source frame expects the top-left to be the origin,
+        // we have to flip the specified coordinate so that the origin becomes bottom-left
+        source.origin.y =
+            (texture_size.height - source.size.height) - source.origin.y;
+    }
+
+    // bias sampling towards the center of each texel
+    float const w = HALF_PIXEL / texture_size.width;
+    float const h = HALF_PIXEL / texture_size.height;
+
+    *uv_min = SHIZVector2Make((source.origin.x + w) / texture_size.width,
+                              (source.origin.y + h) / texture_size.height);
+    *uv_max = SHIZVector2Make((source.origin.x + source.size.width - w) / texture_size.width,
+                              (source.origin.y + source.size.height - h) / texture_size.height);
+}
+
 void
 z_sprite__reset()
 {
@@ -200,6 +348,37 @@ z_sprite__flush()
     _sprite_list.count = 0;
 }
 
+static
+uint32_t
+z_sprite__key(GLuint const texture_id,
+              SHIZLayer const layer,
+              bool const opaque)
+{
+    uint32_t sort_key = 0;
+    
+    SHIZSpriteKey * const sprite_key = (SHIZSpriteKey *)&sort_key;
+    
+    sprite_key->layer = layer;
+    sprite_key->texture_id = (uint8_t)texture_id;
+    sprite_key->is_transparent = !opaque;
+    
+    return sort_key;
+}
+
+static
+void
+z_sprite__add()
+{
+    // count for current batch
+    _sprite_list.count += 1;
+    // count for total sprites during a frame; i.e. the accumulation of all flushed sprites
+    _sprite_list.total += 1;
+    
+    if (_sprite_list.count >= SHIZSpriteMax) {
+        z_sprite__flush();
+    }
+}
+
 static
 int
 z_sprite__compare(void const * const sprite,
@@ -273,27 +452,10 @@ z_sprite__set_uv(SHIZSpriteObject * const sprite,
                  SHIZColor const tint,
                  bool const repeat)
 {
-    bool const flip_source_vertically = true;
+    SHIZVector2 uv_min;
+    SHIZVector2 uv_max;
     
-    if (flip_source_vertically) {
-        // opengl assumes that the origin of textures is at the bottom-left of the image,
-        // however, it is common to specify top-left as origin when using e.g. sprite sheets (and we want that)
-        // so, assuming that the provided source frame expects the top-left to be the origin,
-        // we have to flip the specified coordinate so that the origin becomes bottom-left
-        source.origin.y =
-            (texture_size.height - source.size.height) - source.origin.y;
-    }
-
-    // bias sampling towards the center of each texel
-    float const w = HALF_PIXEL / texture_size.width;
-    float const h = HALF_PIXEL / texture_size.height;
-
-    SHIZVector2 const uv_min =
-        SHIZVector2Make((source.origin.x + w) / texture_size.width,
-                        (source.origin.y + h) / texture_size.height);
-    SHIZVector2 const uv_max =
-        SHIZVector2Make((source.origin.x + source.size.width - w) / texture_size.width,
-                        (source.origin.y + source.size.height - h) / texture_size.height);
+    z_sprite__source_uv(source, texture_size, &uv_min, &uv_max);
     
     float uv_scale_x = 1;
     float uv_scale_y = 1;
@@ -13,6 +13,8 @@
 
 #include <SHIZEN/ztype.h> // SHIZRect, SHIZSize, SHIZVector2, SHIZSprite
 
+#include "internal.h" // SHIZVertexPositionColorTexture
+
 /**
  * The amount of sprites that can be sorted per frame before a batch is issued.
  */
@@ -20,6 +22,72 @@
 
 SHIZRect const z_sprite__anchor_rect(SHIZSize size, SHIZVector2 anchor);
 
+/**
+ * @brief Determine the texture coordinates of a source frame.
+ *
+ * The source frame is expected to have its origin at the top-left of the
+ * texture. The coordinates are biased towards the center of each texel.
+ */
+void z_sprite__source_uv(SHIZRect source, SHIZSize texture_size, SHIZVector2 * uv_min, SHIZVector2 * uv_max);
+
+/**
+ * @brief Holds everything about a run of sprites that does not change from one
+ *        sprite to the next; e.g. the characters of a string of text.
+ */
+typedef struct SHIZSpriteRun {
+    /** The size of the texture that every sprite is sourced from */
+    SHIZSize texture_size;
+    /** The anchored (and pixel-aligned) corners of every sprite */
+    SHIZVector2 bottom_left;
+    SHIZVector2 top_right;
+    /** The sort key shared by every sprite */
+    uint32_t key;
+    /** The depth of every sprite */
+    float z;
+} SHIZSpriteRun;
+
+/**
+ * @brief Prepare drawing any number of sprites of the same size, anchor and
+ *        layer, sourced from the same image.
+ *
+ * @return `true` if sprites can be drawn with the run, `false` otherwise
+ */
+bool z_sprite__begin_run(SHIZSpriteRun * run,
+                         uint32_t resource_id,
+                         SHIZSize size,
+                         SHIZVector2 anchor,
+                         bool opaque,
+                         SHIZLayer layer);
+
+/**
+ * @brief Draw a sprite from a run.
+ *
+ * Only the source frame, origin and tint vary from one sprite to the next, so
+ * the sprite is added to the queue without looking up its image or layer.
+ */
+void z_sprite__draw_run(SHIZSpriteRun const * run,
+                        SHIZRect source,
+                        SHIZVector2 origin,
+                        SHIZColor tint);
+
+/**
+ * @brief Draw quads that were laid out ahead of time; e.g. baked text.
+ *
+ * Each quad (6 vertices, positioned relative to the origin) is added to the
+ * queue as a sprite of its own, so that it is sorted and batched along with
+ * any other sprite of the same image and layer. The color of every vertex is
+ * multiplied by the tint.
+ *
+ * @return `true` if the quads were drawn, `false` otherwise
+ */
+bool z_sprite__draw_quads(uint32_t resource_id,
+                          SHIZVertexPositionColorTexture const * vertices,
+                          uint32_t quad_count,
+                          SHIZVector2 origin,
+                          SHIZColor tint,
+                          bool opaque,
+                          SHIZLayer layer);
+
 void z_sprite__reset(void);
 void z_sprite__flush(void);
 
@@ -11,10 +11,123 @@
 
 #include "spritefont.h"
 #include "sprite.h"
+#include "res.h"
 
-#include <stdlib.h> // NULL
+#include "graphics/gfx.h"
+
+#include <stdlib.h> // NULL, malloc, realloc, free
+#include <string.h> // memset, memcmp, memcpy, strlen, strcmp
 #include <math.h> // floorf
 
+#ifdef SHIZ_DEBUG
+ #include "debug/profiler.h"
+#endif
+
+/**
+ * The number of characters (starting from 0) that are mapped directly;
+ * this covers ASCII and Latin-1.
+ */
+#define SHIZSpriteFontLookupDirectSize 256
+
+typedef struct SHIZSpriteFontLookupEntry {
+    uint32_t character_decimal;
+    int32_t index; // -1 if empty
+} SHIZSpriteFontLookupEntry;
+
+typedef struct SHIZSpriteFontLookup {
+    /** The codepage that this lookup was built from; NULL if unused */
+    uint32_t const * codepage;
+    /** The image resource of the font that the lookup belongs to; the lookup
+      * is released along with it */
+    uint32_t resource_id;
+    /** An open-addressed hash table for any characters outside the direct range */
+    SHIZSpriteFontLookupEntry * entries;
+    /** The number of entries; always a power of two, or 0 */
+    uint32_t entries_capacity;
+    /** The index of each character in the direct range; -1 if not in the codepage */
+    int32_t direct[SHIZSpriteFontLookupDirectSize];
+    uint16_t columns;
+    uint16_t rows;
+} SHIZSpriteFontLookup;
+
+static SHIZSpriteFontLookup _lookups[SHIZSpriteFontMaxLookups];
+
+#define SHIZSpriteFontVertexCountPerGlyph 6 /* 2 triangles per quad */
+
+typedef struct SHIZSpriteFontLayoutKey {
+    // note that this is compared byte for byte, so it must be cleared before
+    // being filled; any padding would otherwise cause false mismatches
+    SHIZRect source;
+    SHIZSize character;
+    SHIZSize bounds;
+    SHIZVector2 scale;
+    SHIZColor colors[SHIZSpriteFontMaxColors];
+    uint32_t const * codepage;
+    float character_spread;
+    float character_padding;
+    float line_padding;
+    uint32_t resource_id;
+    uint16_t columns;
+    uint16_t rows;
+    uint8_t wrap;
+    uint8_t alignment;
+    uint8_t colors_count;
+    bool includes_whitespace;
+} SHIZSpriteFontLayoutKey;
+
+typedef struct SHIZSpriteFontGlyph {
+    /** The source frame of the character in the font sprite */
+    SHIZRect source;
+    /** The offset from the origin of the text */
+    SHIZVector2 offset;
+    /** The index of the color that tints the character; -1 if tinted as drawn */
+    int8_t color_index;
+} SHIZSpriteFontGlyph;
+
+typedef struct SHIZSpriteFontLayout {
+    SHIZSpriteFontLayoutKey key;
+    /** The measured size of the text */
+    SHIZSize size;
+    /** The size of each character as it should appear when drawn */
+    SHIZSize character_size;
+    char * text;
+    SHIZSpriteFontGlyph * glyphs;
+    /** The length of the text; not including the terminator */
+    uint32_t text_length;
+    uint32_t text_capacity;
+    uint32_t glyph_count;
+    uint32_t glyph_capacity;
+    uint32_t hash;
+    /** The time this layout was last drawn; the least recently drawn
+      * layout is replaced first */
+    uint32_t last_used;
+    /** Determines whether this layout is complete and can be drawn */
+    bool is_valid;
+} SHIZSpriteFontLayout;
+
+static SHIZSpriteFontLayout _layouts[SHIZSpriteFontLayoutCacheSize];
+static uint32_t _layouts_clock = 0;
+
+// baked text is laid out into this layout, which is not part of the cache
+static SHIZSpriteFontLayout _bake_layout;
+
+/**
+ * The number of lines that the first block of the line arena can hold.
+ */
+#define SHIZSpriteFontLineBlockSize 256
+
+typedef struct SHIZSpriteFontLineBlock {
+    /** The block that was current before this one; released on reset */
+    struct SHIZSpriteFontLineBlock * previous;
+    uint32_t capacity;
+    uint32_t count;
+    SHIZSpriteFontLine lines[];
+} SHIZSpriteFontLineBlock;
+
+// the lines of every measurement made during a frame are allocated from
+// this arena, which is cleared (but kept) at the beginning of each frame
+static SHIZSpriteFontLineBlock * _line_arena = NULL;
+
 static
 unsigned int
 utf8_decode(char const * str, uint32_t * i)
@@ -69,14 +182,101 @@ z_spritefont__character_table_index(SHIZSpriteFont const * font,
                                     char character,
                                     uint32_t character_decimal);
 
+static
+int32_t
+z_spritefont__lookup_index(SHIZSpriteFontLookup const * lookup,
+                           uint32_t character_decimal);
+
+static
+bool
+z_spritefont__lookup_insert(SHIZSpriteFontLookup * lookup,
+                            uint32_t character_decimal,
+                            int32_t index);
+
+static
+SHIZSize const
+z_spritefont__layout_text(SHIZSpriteFont font,
+                          char const * text,
+                          SHIZVector2 origin,
+                          SHIZSpriteFontAlignment alignment,
+                          SHIZSize bounds,
+                          SHIZSpriteFontAttributes attribs,
+                          SHIZColor tint,
+                          SHIZLayer layer,
+                          SHIZSpriteFontLayout * layout,
+                          bool draw);
+
+static
+bool
+z_spritefont__layout_lines(SHIZSpriteFont font,
+                           char const * text,
+                           SHIZSpriteFontMeasurement const * measurement,
+                           uint32_t first_line,
+                           uint32_t end_line,
+                           SHIZVector2 origin,
+                           SHIZVector2 line_origin,
+                           SHIZSpriteFontAlignment alignment,
+                           SHIZSpriteFontAttributes attribs,
+                           SHIZColor tint,
+                           SHIZSpriteRun const * run,
+                           SHIZSpriteFontLayout * layout);
+
+static
+SHIZSpriteFontLine *
+z_spritefont__push_line(SHIZSpriteFontMeasurement * measurement);
+
+static
+SHIZRect
+z_spritefont__character_source(SHIZSpriteFont const * font,
+                               uint16_t character_table_index);
+
+static
+bool
+z_spritefont__begin_run(SHIZSpriteRun * run,
+                        SHIZSpriteFont const * font,
+                        SHIZSize character_size,
+                        SHIZLayer layer);
+
 static
 void
-z_spritefont__draw_character_index(SHIZSpriteFont const * font,
-                                   SHIZSpriteFontMeasurement const * measurement,
-                                   SHIZVector2 character_origin,
-                                   uint16_t character_table_index,
-                                   SHIZColor highlight_color,
-                                   SHIZLayer layer);
+z_spritefont__layout_key(SHIZSpriteFontLayoutKey * key,
+                         SHIZSpriteFont const * font,
+                         SHIZSpriteFontAlignment alignment,
+                         SHIZSize bounds,
+                         SHIZSpriteFontAttributes const * attribs);
+
+static
+uint32_t
+z_spritefont__layout_hash(SHIZSpriteFontLayoutKey const * key,
+                          char const * text,
+                          uint32_t length);
+
+static
+SHIZSpriteFontLayout *
+z_spritefont__find_layout(SHIZSpriteFontLayoutKey const * key,
+                          uint32_t hash,
+                          char const * text,
+                          uint32_t length);
+
+static
+SHIZSpriteFontLayout *
+z_spritefont__claim_layout(SHIZSpriteFontLayoutKey const * key,
+                           uint32_t hash,
+                           char const * text,
+                           uint32_t length);
+
+static
+bool
+z_spritefont__layout_add_glyph(SHIZSpriteFontLayout * layout,
+                               SHIZRect source,
+                               SHIZVector2 offset,
+                               int8_t color_index);
+
+static
+SHIZColor
+z_spritefont__glyph_color(SHIZSpriteFontGlyph const * glyph,
+                          SHIZColor const * colors,
+                          SHIZColor tint);
 
 SHIZSpriteFontMeasurement const
 z_spritefont__measure_text(SHIZSpriteFont const font,
@@ -88,6 +288,7 @@ z_spritefont__measure_text(SHIZSpriteFont const font,
 
     measurement.size = SHIZSizeZero;
     measurement.max_characters = -1; // no truncation
+    measurement.lines = NULL;
     measurement.line_count = 0;
 
     measurement.character_size = SHIZSizeMake(font.character.width * attribs.scale.x,
@@ -120,18 +321,18 @@ z_spritefont__measure_text(SHIZSpriteFont const font,
         float const max_lines_in_bounds =
             floorf(bounds.height / line_height);
         
-        if (max_lines_in_bounds > SHIZSpriteFontMaxLines) {
-            measurement.max_lines_in_bounds = SHIZSpriteFontMaxLines;
+        if (max_lines_in_bounds > UINT32_MAX) {
+            measurement.max_lines_in_bounds = UINT32_MAX;
         } else {
             measurement.max_lines_in_bounds =
-                (uint16_t)max_lines_in_bounds;
+                (uint32_t)max_lines_in_bounds;
         }
     } else {
-        measurement.max_lines_in_bounds = UINT16_MAX;
+        measurement.max_lines_in_bounds = UINT32_MAX;
     }
 
-    uint16_t character_count = 0;
-    uint8_t line_index = 0;
+    uint32_t character_count = 0;
+    uint32_t line_index = 0;
     uint16_t line_character_count = 0;
     uint16_t line_character_ignored_count = 0;
 
@@ -143,14 +344,26 @@ z_spritefont__measure_text(SHIZSpriteFont const font,
     bool current_line_has_leading_whitespace = false;
     bool next_line_has_leading_whitespace = false;
 
+    // the latest whitespace in the current line; i.e. where the line would
+    // be broken if a word does not fit (along with the counts at that point)
+    char const * wrap_ptr = NULL;
+    uint16_t wrap_line_character_count = 0;
+    uint32_t wrap_character_count = 0;
+
     const char * text_ptr = text;
 
     if (!text_ptr) {
         return measurement;
     }
+    
+    if (z_spritefont__push_line(&measurement) == NULL) {
+        return measurement;
+    }
+    
+    char const * line_ptr = text_ptr;
 
     while (*text_ptr) {
-        char character = *text_ptr;
+        char const character = *text_ptr;
         unsigned int character_size = 0;
 
         utf8_decode(text_ptr, &character_size);
@@ -180,32 +393,42 @@ z_spritefont__measure_text(SHIZSpriteFont const font,
 
             if (break_line_required) {
                 if (attribs.wrap == SHIZSpriteFontWrapModeWord) {
-                    // backtrack until finding a whitespace
-                    while (*text_ptr) {
-                        text_ptr -= character_size;
+                    // note that the latest whitespace is tracked while scanning
+                    // forward, so breaking a line never requires stepping back
+                    // through it; an explicit linebreak, or running out of
+                    // text, ends the line right here either way
+                    if (!break_line_explicit && *text_ptr) {
+                        if (character == whitespace_character) {
+                            // the breaking character is the latest whitespace
+                            wrap_ptr = text_ptr - character_size;
+                            wrap_line_character_count = line_character_count;
+                            wrap_character_count = character_count;
+                        }
                         
-                        character_count -= 1;
-
-                        utf8_decode(text_ptr, &character_size);
-
-                        character = *text_ptr;
-
-                        if (character == whitespace_character &&
-                            !break_line_explicit) {
+                        if (wrap_ptr != NULL && wrap_line_character_count > 0) {
+                            // break at the latest whitespace, moving the word
+                            // that follows it onto the next line
+                            text_ptr = wrap_ptr;
+                            
+                            line_character_count = wrap_line_character_count;
+                            // note that the whitespace is discounted as well;
+                            // truncation depends on this count, so keep it as is
+                            character_count = wrap_character_count - 1;
+                            
                             next_line_has_leading_whitespace = true;
-
-                            break;
-                        }
-
-                        if (line_character_count > 0) {
-                            line_character_count -= 1;
+                        } else if (line_character_count > 0) {
+                            // the word does not fit on a line by itself,
+                            // so it has to be broken where it overflows
+                            text_ptr -= character_size;
                         } else {
-                            break;
-                        }
-                        
-                        if (character_count == 0) {
-                            // additional safety measure
-                            break;
+                            // not even a single character fits; keep it on
+                            // this line anyway, or we would never move on
+                            if (z_spritefont__is_tint_character(character)) {
+                                line_character_ignored_count += 1;
+                            }
+                            
+                            line_character_count += 1;
+                            character_count += 1;
                         }
                     }
                 } else {
@@ -222,6 +445,19 @@ z_spritefont__measure_text(SHIZSpriteFont const font,
                 }
             }
             
+            bool const is_repeating_line =
+                text_ptr < line_ptr ||
+                (text_ptr == line_ptr &&
+                 (skip_leading_whitespace && next_line_has_leading_whitespace) ==
+                 (skip_leading_whitespace && current_line_has_leading_whitespace &&
+                  line_index > 0));
+            
+            if (is_repeating_line) {
+                // the next line would be measured exactly like this one,
+                // and so on; the rest of the text can never fit, so stop here
+                break;
+            }
+            
             z_spritefont__set_line(&measurement.lines[line_index],
                                    &measurement,
                                    line_height,
@@ -229,33 +465,40 @@ z_spritefont__measure_text(SHIZSpriteFont const font,
                                    line_character_ignored_count,
                                    should_skip_leading_whitespace);
             
+            line_ptr = text_ptr;
+            
             line_character_ignored_count = 0;
             line_character_count = 0;
 
+            wrap_ptr = NULL;
+
             current_line_has_leading_whitespace = next_line_has_leading_whitespace;
 
             if (measurement.constrain_vertically) {
                 if (line_index + 1 >= measurement.max_lines_in_bounds) {
-                    measurement.max_characters = (int)character_count;
+                    measurement.max_characters = (int32_t)character_count;
 
                     break;
                 }
             }
 
-            line_index += 1;
-
-            if (line_index >= SHIZSpriteFontMaxLines) {
-                line_index -= 1;
-                // this is bad
+            if (z_spritefont__push_line(&measurement) == NULL) {
+                // out of memory; keep what was measured so far
                 break;
             }
 
+            line_index += 1;
+
             continue;
         }
 
         if (z_spritefont__is_tint_character(character)) {
             // increment ignored characters, but otherwise proceed as usual
             line_character_ignored_count += 1;
+        } else if (character == whitespace_character) {
+            wrap_ptr = text_ptr - character_size;
+            wrap_line_character_count = line_character_count;
+            wrap_character_count = character_count;
         }
 
         line_character_count += 1;
@@ -269,7 +512,6 @@ z_spritefont__measure_text(SHIZSpriteFont const font,
                                should_skip_leading_whitespace);
     }
 
-    measurement.line_count = line_index + 1;
     measurement.size.height = measurement.line_count * line_height;
 
     for (line_index = 0; line_index < measurement.line_count; line_index++) {
@@ -294,55 +536,183 @@ z_spritefont__draw_text(SHIZSpriteFont const font,
                         SHIZColor const tint,
                         SHIZLayer const layer)
 {
-    SHIZSpriteFontMeasurement const measurement =
-        z_spritefont__measure_text(font, text, bounds, attribs);
+    SHIZSpriteFontLayout * layout = NULL;
+    
+    if (text != NULL) {
+        size_t const text_length = strlen(text);
+        
+        if (text_length < UINT32_MAX) {
+            uint32_t const length = (uint32_t)text_length;
+            
+            SHIZSpriteFontLayoutKey key;
+            
+            z_spritefont__layout_key(&key, &font, alignment, bounds, &attribs);
+            
+            uint32_t const hash = z_spritefont__layout_hash(&key, text, length);
+            
+            SHIZSpriteFontLayout const * const cached_layout =
+                z_spritefont__find_layout(&key, hash, text, length);
+            
+            if (cached_layout != NULL) {
+#ifdef SHIZ_DEBUG
+                z_profiler__increment_text_cache_hits();
+#endif
+                // the text was already laid out; skip measuring and decoding
+                // and just draw each character where it was previously placed
+                SHIZSpriteRun run;
+                
+                if (z_spritefont__begin_run(&run, &font,
+                                            cached_layout->character_size,
+                                            layer)) {
+                    for (uint32_t i = 0; i < cached_layout->glyph_count; i++) {
+                        SHIZSpriteFontGlyph const * const glyph = &cached_layout->glyphs[i];
+                        
+                        z_sprite__draw_run(&run, glyph->source,
+                                           SHIZVector2Make(origin.x + glyph->offset.x,
+                                                           origin.y + glyph->offset.y),
+                                           z_spritefont__glyph_color(glyph,
+                                                                     cached_layout->key.colors,
+                                                                     tint));
+                    }
+                }
+                
+                return cached_layout->size;
+            }
 
-    uint8_t const truncation_length = 3;
-    int32_t const truncation_index = measurement.max_characters - truncation_length;
+#ifdef SHIZ_DEBUG
+            z_profiler__increment_text_cache_misses();
+#endif
+
+            layout = z_spritefont__claim_layout(&key, hash, text, length);
+        }
+    }
     
-    char const truncation_character = '.';
-    char const whitespace_character = ' ';
-    char const newline_character = '\n';
+    return z_spritefont__layout_text(font, text, origin, alignment, bounds,
+                                     attribs, tint, layer, layout, true);
+}
 
-    SHIZVector2 character_origin = origin;
+static
+SHIZSize const
+z_spritefont__layout_text(SHIZSpriteFont const font,
+                          char const * const text,
+                          SHIZVector2 const origin,
+                          SHIZSpriteFontAlignment const alignment,
+                          SHIZSize const bounds,
+                          SHIZSpriteFontAttributes const attribs,
+                          SHIZColor const tint,
+                          SHIZLayer const layer,
+                          SHIZSpriteFontLayout * const layout,
+                          bool const draw)
+{
+    SHIZSpriteFontMeasurement const measurement =
+        z_spritefont__measure_text(font, text, bounds, attribs);
+
+    SHIZVector2 line_origin = origin;
 
     if ((alignment & SHIZSpriteFontAlignmentTop) == SHIZSpriteFontAlignmentTop) {
         // intentionally left blank; no operation necessary
     } else if ((alignment & SHIZSpriteFontAlignmentMiddle) == SHIZSpriteFontAlignmentMiddle) {
-        character_origin.y += floorf(measurement.size.height / 2);
+        line_origin.y += floorf(measurement.size.height / 2);
     } else if ((alignment & SHIZSpriteFontAlignmentBottom) == SHIZSpriteFontAlignmentBottom) {
-        character_origin.y += measurement.size.height;
+        line_origin.y += measurement.size.height;
     }
 
-    uint16_t character_count = 0;
+    SHIZSpriteRun run;
+    
+    bool const can_draw = draw &&
+        z_spritefont__begin_run(&run, &font, measurement.character_size, layer);
+    
+    bool const laid_out =
+        z_spritefont__layout_lines(font, text, &measurement,
+                                   0, measurement.line_count,
+                                   origin, line_origin, alignment,
+                                   attribs, tint,
+                                   can_draw ? &run : NULL,
+                                   layout);
+    
+    if (layout != NULL && laid_out) {
+        layout->size = measurement.size;
+        layout->character_size = measurement.character_size;
+        layout->is_valid = true;
+    }
+    
+    return measurement.size;
+}
+
+static
+bool
+z_spritefont__layout_lines(SHIZSpriteFont const font,
+                           char const * const text,
+                           SHIZSpriteFontMeasurement const * const measurement,
+                           uint32_t const first_line,
+                           uint32_t const end_line,
+                           SHIZVector2 const origin,
+                           SHIZVector2 const line_origin,
+                           SHIZSpriteFontAlignment const alignment,
+                           SHIZSpriteFontAttributes const attribs,
+                           SHIZColor const tint,
+                           SHIZSpriteRun const * const run,
+                           SHIZSpriteFontLayout * layout)
+{
+    if (first_line >= end_line || end_line > measurement->line_count) {
+        return true;
+    }
+    
+    uint8_t const truncation_length = 3;
+    int32_t const truncation_index = measurement->max_characters - truncation_length;
+    
+    char const truncation_character = '.';
+    char const whitespace_character = ' ';
+    char const newline_character = '\n';
+
+    SHIZVector2 character_origin = line_origin;
+
+    // pick up wherever the first line begins; this is what makes it possible
+    // to lay out any range of lines without going through the lines before it
+    SHIZSpriteFontLine const * const first = &measurement->lines[first_line];
+    
+    char const * text_ptr = text + first->text_offset;
+    
+    uint32_t character_count = first->character_offset;
 
     bool break_from_truncation = false;
+    bool laid_out = true;
 
+    int8_t highlight_color_index = first->color_index;
+    
     SHIZColor highlight_color = tint;
-
-    char const * text_ptr = text;
     
-    for (uint8_t line_index = 0; line_index < measurement.line_count; line_index++) {
-        SHIZSpriteFontLine const line = measurement.lines[line_index];
+    if (highlight_color_index >= 0 && attribs.colors &&
+        highlight_color_index < attribs.colors_count) {
+        highlight_color = attribs.colors[highlight_color_index];
+    }
+    
+    for (uint32_t line_index = first_line; line_index < end_line; line_index++) {
+        SHIZSpriteFontLine * const line = &measurement->lines[line_index];
+        
+        // keep track of where each line begins, so that it can be resumed later
+        line->text_offset = (uint32_t)(text_ptr - text);
+        line->character_offset = character_count;
+        line->color_index = highlight_color_index;
 
         if ((alignment & SHIZSpriteFontAlignmentCenter) == SHIZSpriteFontAlignmentCenter) {
-            character_origin.x -= floorf(line.size.width / 2);
+            character_origin.x -= floorf(line->size.width / 2);
         } else if ((alignment & SHIZSpriteFontAlignmentRight) == SHIZSpriteFontAlignmentRight) {
-            character_origin.x -= line.size.width;
+            character_origin.x -= line->size.width;
         }
 
         uint16_t character_index = 0;
         
         for (character_index = 0;
-             character_index < line.character_count;
+             character_index < line->character_count;
              character_index++) {
             bool const should_truncate =
-                (measurement.max_characters > 0 &&
-                 character_count > truncation_index);
+                (measurement->max_characters > 0 &&
+                 (int32_t)character_count > truncation_index);
 
             break_from_truncation =
-                measurement.max_characters > 0 &&
-                measurement.max_characters == character_count;
+                measurement->max_characters > 0 &&
+                measurement->max_characters == (int32_t)character_count;
 
             char const character = should_truncate ?
                 truncation_character : *text_ptr;
@@ -365,14 +735,16 @@ z_spritefont__draw_text(SHIZSpriteFont const font,
                     // at this point, we know that 'character' is one of the numeric tint specifiers
                     // so we can determine the index like below, where a tint specifier of 1 results
                     // in an index of -1, which we then use to reset any highlight
-                    int16_t const highlight_color_index = character - 2;
+                    int8_t const color_index = (int8_t)(character - 2);
 
-                    if (highlight_color_index < 0) {
+                    if (color_index < 0) {
                         // reset to original tint
                         highlight_color = tint;
+                        highlight_color_index = -1;
                     } else {
-                        if (highlight_color_index < attribs.colors_count) {
-                            highlight_color = attribs.colors[highlight_color_index];
+                        if (color_index < attribs.colors_count) {
+                            highlight_color = attribs.colors[color_index];
+                            highlight_color_index = color_index;
                         }
                     }
                 }
@@ -409,7 +781,7 @@ z_spritefont__draw_text(SHIZSpriteFont const font,
 
                 character_takes_space = false;
 
-                int32_t const previous_text_index = character_count - 2;
+                int32_t const previous_text_index = (int32_t)character_count - 2;
 
                 if (previous_text_index >= 0) {
                     // note that we don't care about character byte sizes here;
@@ -432,17 +804,35 @@ z_spritefont__draw_text(SHIZSpriteFont const font,
                                                  font.includes_whitespace);
 
                 if (can_draw_character) {
-                    z_spritefont__draw_character_index(&font,
-                                                       &measurement,
-                                                       character_origin,
-                                                       (uint16_t)character_table_index,
-                                                       highlight_color,
-                                                       layer);
+                    SHIZRect const source =
+                        z_spritefont__character_source(&font,
+                                                       (uint16_t)character_table_index);
+                    
+                    if (run != NULL) {
+                        z_sprite__draw_run(run, source, character_origin,
+                                           highlight_color);
+                    }
+                    
+                    if (layout != NULL) {
+                        SHIZVector2 const offset =
+                            SHIZVector2Make(character_origin.x - origin.x,
+                                            character_origin.y - origin.y);
+                        
+                        // the tint is applied when drawn, so only the color
+                        // index is kept; any tint can then reuse the layout
+                        if (!z_spritefont__layout_add_glyph(layout, source, offset,
+                                                            highlight_color_index)) {
+                            // keep drawing, but give up on the layout
+                            layout = NULL;
+                            
+                            laid_out = false;
+                        }
+                    }
                 }
             }
 
             if (character_takes_space) {
-                character_origin.x += measurement.character_size_perceived.width;
+                character_origin.x += measurement->character_size_perceived.width;
             }
 
             if (break_from_truncation) {
@@ -452,56 +842,50 @@ z_spritefont__draw_text(SHIZSpriteFont const font,
         }
         
         character_origin.x = origin.x;
-        character_origin.y -= line.size.height;
+        character_origin.y -= line->size.height;
         
         if (break_from_truncation) {
             break;
         }
     }
     
-    return measurement.size;
+    return laid_out;
 }
 
 static
-void
-z_spritefont__draw_character_index(SHIZSpriteFont const * const font,
-                                   SHIZSpriteFontMeasurement const * const measurement,
-                                   SHIZVector2 const character_origin,
-                                   uint16_t const character_table_index,
-                                   SHIZColor const highlight_color,
-                                   SHIZLayer const layer)
+SHIZRect
+z_spritefont__character_source(SHIZSpriteFont const * const font,
+                               uint16_t const character_table_index)
 {
     uint16_t const character_row = character_table_index / font->table.columns;
     uint16_t const character_column = character_table_index % font->table.columns;
     
-    SHIZSprite character_sprite = SHIZSpriteEmpty;
-    
-    character_sprite.resource_id = font->sprite.resource_id;
-    character_sprite.source = SHIZRectMake(font->sprite.source.origin,
-                                           font->character);
-    
-    character_sprite.source.origin.x = (font->sprite.source.origin.x +
-                                        (font->character.width * character_column));
-    character_sprite.source.origin.y = (font->sprite.source.origin.y +
-                                        (font->character.height * character_row));
-    
-
-    SHIZSpriteSize const character_sprite_size =
-        SHIZSpriteSized(measurement->character_size,
-                        SHIZVector2One);
-    
-    // todo: optimization; we already know the Z because the layer does not change per character
-    // todo: optimization; we don't need to calculate anchored rect each time either
-    z_sprite__draw(character_sprite,
-                   character_origin,
-                   character_sprite_size,
-                   SHIZSpriteNoRepeat,
-                   SHIZAnchorTopLeft,
-                   SHIZSpriteFlipModeNone,
-                   SHIZSpriteNoAngle,
-                   highlight_color,
-                   SHIZSpriteNotOpaque,
-                   layer);
+    SHIZRect source = SHIZRectMake(font->sprite.source.origin,
+                                   font->character);
+    
+    source.origin.x = (font->sprite.source.origin.x +
+                       (font->character.width * character_column));
+    source.origin.y = (font->sprite.source.origin.y +
+                       (font->character.height * character_row));
+    
+    return source;
+}
+
+static
+bool
+z_spritefont__begin_run(SHIZSpriteRun * const run,
+                        SHIZSpriteFont const * const font,
+                        SHIZSize const character_size,
+                        SHIZLayer const layer)
+{
+    // every character of a text shares the same image, size and layer,
+    // so all of that is only resolved once per text
+    return z_sprite__begin_run(run,
+                               font->sprite.resource_id,
+                               character_size,
+                               SHIZAnchorTopLeft,
+                               SHIZSpriteNotOpaque,
+                               layer);
 }
 
 static
@@ -516,11 +900,32 @@ z_spritefont__character_table_index(SHIZSpriteFont const * const font,
     
     if (table_size < INT32_MAX) {
         if (font->table.codepage != NULL) {
-            for (uint32_t i = 0; i < table_size; i++) {
-                if (font->table.codepage[i] == character_decimal) {
-                    character_table_index = (int)i;
-                    
-                    break;
+            SHIZSpriteFontLookup const * lookup = NULL;
+            
+            if (font->table_lookup_id > 0 &&
+                font->table_lookup_id <= SHIZSpriteFontMaxLookups) {
+                lookup = &_lookups[font->table_lookup_id - 1];
+                
+                if (lookup->codepage != font->table.codepage ||
+                    lookup->columns != font->table.columns ||
+                    lookup->rows != font->table.rows ||
+                    lookup->resource_id != font->sprite.resource_id) {
+                    // the table was changed after the font was loaded, or
+                    // the font was unloaded (and its lookup released)
+                    lookup = NULL;
+                }
+            }
+            
+            if (lookup != NULL) {
+                character_table_index =
+                    z_spritefont__lookup_index(lookup, character_decimal);
+            } else {
+                for (uint32_t i = 0; i < table_size; i++) {
+                    if (font->table.codepage[i] == character_decimal) {
+                        character_table_index = (int)i;
+                        
+                        break;
+                    }
                 }
             }
         } else {
@@ -536,6 +941,666 @@ z_spritefont__character_table_index(SHIZSpriteFont const * const font,
     return character_table_index;
 }
 
+uint8_t
+z_spritefont__build_lookup(SHIZSpriteFontTable const table,
+                           uint32_t const resource_id)
+{
+    if (table.codepage == NULL) {
+        return 0;
+    }
+    
+    uint8_t lookup_id = 0;
+    
+    for (uint8_t i = 0; i < SHIZSpriteFontMaxLookups; i++) {
+        SHIZSpriteFontLookup const * const lookup = &_lookups[i];
+        
+        if (lookup->codepage == NULL) {
+            if (lookup_id == 0) {
+                lookup_id = i + 1;
+            }
+        } else if (lookup->codepage == table.codepage &&
+                   lookup->columns == table.columns &&
+                   lookup->rows == table.rows &&
+                   lookup->resource_id == resource_id) {
+            return i + 1;
+        }
+    }
+    
+    if (lookup_id == 0) {
+        return 0;
+    }
+    
+    SHIZSpriteFontLookup * const lookup = &_lookups[lookup_id - 1];
+    
+    uint32_t const table_size = table.columns * table.rows;
+    uint32_t extended_count = 0;
+    
+    for (uint32_t i = 0; i < table_size; i++) {
+        if (table.codepage[i] >= SHIZSpriteFontLookupDirectSize) {
+            extended_count += 1;
+        }
+    }
+    
+    lookup->entries = NULL;
+    lookup->entries_capacity = 0;
+    
+    if (extended_count > 0) {
+        // keep the load factor at or below 50%
+        uint32_t capacity = 16;
+        
+        while (capacity < extended_count * 2) {
+            capacity *= 2;
+        }
+        
+        lookup->entries = malloc(sizeof(SHIZSpriteFontLookupEntry) * capacity);
+        
+        if (lookup->entries == NULL) {
+            return 0;
+        }
+        
+        lookup->entries_capacity = capacity;
+        
+        for (uint32_t i = 0; i < capacity; i++) {
+            lookup->entries[i].index = -1;
+        }
+    }
+    
+    for (uint16_t i = 0; i < SHIZSpriteFontLookupDirectSize; i++) {
+        lookup->direct[i] = -1;
+    }
+    
+    for (uint32_t i = 0; i < table_size; i++) {
+        uint32_t const character_decimal = table.codepage[i];
+        
+        // note that if a character occurs more than once, the first occurrence
+        // is kept; same as when scanning the codepage
+        if (character_decimal < SHIZSpriteFontLookupDirectSize) {
+            if (lookup->direct[character_decimal] < 0) {
+                lookup->direct[character_decimal] = (int32_t)i;
+            }
+        } else {
+            z_spritefont__lookup_insert(lookup, character_decimal, (int32_t)i);
+        }
+    }
+    
+    lookup->codepage = table.codepage;
+    lookup->columns = table.columns;
+    lookup->rows = table.rows;
+    lookup->resource_id = resource_id;
+    
+    return lookup_id;
+}
+
+void
+z_spritefont__release_lookups(uint32_t const resource_id)
+{
+    for (uint8_t i = 0; i < SHIZSpriteFontMaxLookups; i++) {
+        SHIZSpriteFontLookup * const lookup = &_lookups[i];
+        
+        if (lookup->codepage == NULL || lookup->resource_id != resource_id) {
+            continue;
+        }
+        
+        free(lookup->entries);
+        
+        lookup->entries = NULL;
+        lookup->entries_capacity = 0;
+        lookup->codepage = NULL;
+        lookup->resource_id = 0;
+    }
+}
+
+void
+z_spritefont__reset()
+{
+    if (_line_arena == NULL) {
+        return;
+    }
+    
+    // keep only the current block; it is the largest one, so a frame that
+    // measures as many lines as this one did will not need to allocate
+    SHIZSpriteFontLineBlock * block = _line_arena->previous;
+    
+    while (block != NULL) {
+        SHIZSpriteFontLineBlock * const previous_block = block->previous;
+        
+        free(block);
+        
+        block = previous_block;
+    }
+    
+    _line_arena->previous = NULL;
+    _line_arena->count = 0;
+}
+
+void
+z_spritefont__kill()
+{
+    for (uint8_t i = 0; i < SHIZSpriteFontMaxLookups; i++) {
+        SHIZSpriteFontLookup * const lookup = &_lookups[i];
+        
+        free(lookup->entries);
+        
+        lookup->entries = NULL;
+        lookup->entries_capacity = 0;
+        lookup->codepage = NULL;
+        lookup->resource_id = 0;
+    }
+    
+    for (uint8_t i = 0; i < SHIZSpriteFontLayoutCacheSize; i++) {
+        SHIZSpriteFontLayout * const layout = &_layouts[i];
+        
+        free(layout->text);
+        free(layout->glyphs);
+        
+        layout->text = NULL;
+        layout->text_capacity = 0;
+        layout->glyphs = NULL;
+        layout->glyph_capacity = 0;
+        layout->glyph_count = 0;
+        layout->is_valid = false;
+    }
+    
+    _layouts_clock = 0;
+    
+    free(_bake_layout.glyphs);
+    
+    _bake_layout.glyphs = NULL;
+    _bake_layout.glyph_capacity = 0;
+    _bake_layout.glyph_count = 0;
+    
+    z_spritefont__reset();
+    
+    free(_line_arena);
+    
+    _line_arena = NULL;
+}
+
+bool
+z_spritefont__bake_text(SHIZSpriteFont const font,
+                        char const * const text,
+                        SHIZSpriteFontAlignment const alignment,
+                        SHIZSize const bounds,
+                        SHIZSpriteFontAttributes const attribs,
+                        SHIZVertexPositionColorTexture ** const vertices,
+                        uint32_t * const quad_count,
+                        SHIZSize * const size)
+{
+    SHIZResourceImage const * const image = z_res__image(font.sprite.resource_id);
+    
+    if (image == NULL) {
+        return false;
+    }
+    
+    SHIZSpriteFontLayout * const layout = &_bake_layout;
+    
+    layout->glyph_count = 0;
+    layout->is_valid = false;
+    
+    SHIZSize const text_size =
+        z_spritefont__layout_text(font, text, SHIZVector2Zero, alignment, bounds,
+                                  attribs, SHIZSpriteNoTint, SHIZLayerDefault,
+                                  layout, false);
+    
+    if (!layout->is_valid) {
+        return false;
+    }
+    
+    uint32_t const vertex_count = layout->glyph_count * SHIZSpriteFontVertexCountPerGlyph;
+    
+    SHIZVertexPositionColorTexture * baked_vertices = NULL;
+    
+    if (vertex_count > 0) {
+        baked_vertices = malloc(sizeof(SHIZVertexPositionColorTexture) * vertex_count);
+        
+        if (baked_vertices == NULL) {
+            return false;
+        }
+    }
+    
+    SHIZSize const texture_size = SHIZSizeMake(image->width, image->height);
+    
+    for (uint32_t i = 0; i < layout->glyph_count; i++) {
+        SHIZSpriteFontGlyph const glyph = layout->glyphs[i];
+        
+        // characters are anchored at their top-left
+        float const l = PIXEL(glyph.offset.x);
+        float const t = PIXEL(glyph.offset.y);
+        float const r = PIXEL(glyph.offset.x + layout->character_size.width);
+        float const b = PIXEL(glyph.offset.y - layout->character_size.height);
+        
+        SHIZVector2 uv_min;
+        SHIZVector2 uv_max;
+        
+        z_sprite__source_uv(glyph.source, texture_size, &uv_min, &uv_max);
+        
+        SHIZVertexPositionColorTexture * const quad =
+            &baked_vertices[i * SHIZSpriteFontVertexCountPerGlyph];
+        
+        // same (clockwise) order as any sprite
+        quad[0].position = SHIZVector3Make(l, t, 0);
+        quad[0].texture_coord = SHIZVector2Make(uv_min.x, uv_max.y);
+        quad[1].position = SHIZVector3Make(r, b, 0);
+        quad[1].texture_coord = SHIZVector2Make(uv_max.x, uv_min.y);
+        quad[2].position = SHIZVector3Make(l, b, 0);
+        quad[2].texture_coord = SHIZVector2Make(uv_min.x, uv_min.y);
+        
+        quad[3].position = SHIZVector3Make(l, t, 0);
+        quad[3].texture_coord = SHIZVector2Make(uv_min.x, uv_max.y);
+        quad[4].position = SHIZVector3Make(r, t, 0);
+        quad[4].texture_coord = SHIZVector2Make(uv_max.x, uv_max.y);
+        quad[5].position = SHIZVector3Make(r, b, 0);
+        quad[5].texture_coord = SHIZVector2Make(uv_max.x, uv_min.y);
+        
+        for (uint8_t v = 0; v < SHIZSpriteFontVertexCountPerGlyph; v++) {
+            quad[v].color = z_spritefont__glyph_color(&glyph, attribs.colors,
+                                                      SHIZSpriteNoTint);
+            quad[v].texture_coord_min = uv_min;
+            quad[v].texture_coord_max = uv_max;
+        }
+    }
+    
+    free(*vertices);
+    
+    *vertices = baked_vertices;
+    *quad_count = layout->glyph_count;
+    
+    if (size != NULL) {
+        *size = text_size;
+    }
+    
+    return true;
+}
+
+bool
+z_spritefont__paginate_text(SHIZSpriteFont const font,
+                            char const * const text,
+                            float const width,
+                            SHIZSpriteFontAttributes const attribs,
+                            SHIZSpriteFontPages * const pages)
+{
+    if (text == NULL || pages == NULL) {
+        return false;
+    }
+    
+    size_t const text_length = strlen(text);
+    
+    if (text_length >= UINT32_MAX) {
+        return false;
+    }
+    
+    SHIZSpriteFontMeasurement measurement =
+        z_spritefont__measure_text(font, text, SHIZSizeMake(width, 0), attribs);
+    
+    if (measurement.line_count == 0) {
+        return false;
+    }
+    
+    // go through every line once (without drawing anything), so that
+    // each line knows where in the text it begins
+    z_spritefont__layout_lines(font, text, &measurement,
+                               0, measurement.line_count,
+                               SHIZVector2Zero, SHIZVector2Zero,
+                               SHIZSpriteFontAlignmentDefault,
+                               attribs, SHIZSpriteNoTint,
+                               NULL, NULL);
+    
+    // the lines were allocated for this frame only, so keep a copy
+    char * const text_copy = malloc(text_length + 1);
+    SHIZSpriteFontLine * const lines =
+        malloc(sizeof(SHIZSpriteFontLine) * measurement.line_count);
+    
+    if (text_copy == NULL || lines == NULL) {
+        free(text_copy);
+        free(lines);
+        
+        return false;
+    }
+    
+    memcpy(text_copy, text, text_length + 1);
+    memcpy(lines, measurement.lines,
+           sizeof(SHIZSpriteFontLine) * measurement.line_count);
+    
+    z_spritefont__release_pages(pages);
+    
+    measurement.lines = lines;
+    
+    pages->measurement = measurement;
+    pages->text = text_copy;
+    pages->font = font;
+    pages->attribs = attribs;
+    pages->attribs.colors = NULL;
+    pages->attribs.colors_count = 0;
+    
+    if (attribs.colors != NULL) {
+        // only the colors that can actually be specified are kept
+        pages->attribs.colors_count = attribs.colors_count < SHIZSpriteFontMaxColors ?
+            attribs.colors_count : SHIZSpriteFontMaxColors;
+        
+        for (uint8_t i = 0; i < pages->attribs.colors_count; i++) {
+            pages->colors[i] = attribs.colors[i];
+        }
+    }
+    
+    return true;
+}
+
+SHIZSize const
+z_spritefont__draw_lines(SHIZSpriteFontPages const * const pages,
+                         SHIZVector2 const origin,
+                         uint32_t const first_line,
+                         uint32_t const line_count,
+                         SHIZSpriteFontAlignment const alignment,
+                         SHIZColor const tint,
+                         SHIZLayer const layer)
+{
+    if (pages == NULL || pages->text == NULL ||
+        first_line >= pages->measurement.line_count) {
+        return SHIZSizeZero;
+    }
+    
+    SHIZSpriteFontMeasurement const * const measurement = &pages->measurement;
+    
+    uint32_t const end_line =
+        line_count < measurement->line_count - first_line ?
+            first_line + line_count : measurement->line_count;
+    
+    SHIZSize size = SHIZSizeZero;
+    
+    for (uint32_t line_index = first_line; line_index < end_line; line_index++) {
+        SHIZSpriteFontLine const * const line = &measurement->lines[line_index];
+        
+        size.height += line->size.height;
+        
+        if (line->size.width > size.width) {
+            size.width = line->size.width;
+        }
+    }
+    
+    SHIZVector2 line_origin = origin;
+    
+    if ((alignment & SHIZSpriteFontAlignmentTop) == SHIZSpriteFontAlignmentTop) {
+        // intentionally left blank; no operation necessary
+    } else if ((alignment & SHIZSpriteFontAlignmentMiddle) == SHIZSpriteFontAlignmentMiddle) {
+        line_origin.y += floorf(size.height / 2);
+    } else if ((alignment & SHIZSpriteFontAlignmentBottom) == SHIZSpriteFontAlignmentBottom) {
+        line_origin.y += size.height;
+    }
+    
+    SHIZSpriteFontAttributes attribs = pages->attribs;
+    
+    if (attribs.colors_count > 0) {
+        attribs.colors = pages->colors;
+    }
+    
+    SHIZSpriteRun run;
+    
+    if (z_spritefont__begin_run(&run, &pages->font,
+                                measurement->character_size, layer)) {
+        z_spritefont__layout_lines(pages->font, pages->text, measurement,
+                                   first_line, end_line,
+                                   origin, line_origin, alignment,
+                                   attribs, tint, &run, NULL);
+    }
+    
+    return size;
+}
+
+void
+z_spritefont__release_pages(SHIZSpriteFontPages * const pages)
+{
+    if (pages == NULL) {
+        return;
+    }
+    
+    free(pages->text);
+    free(pages->measurement.lines);
+    
+    pages->text = NULL;
+    pages->measurement.lines = NULL;
+    pages->measurement.line_count = 0;
+}
+
+static
+void
+z_spritefont__layout_key(SHIZSpriteFontLayoutKey * const key,
+                         SHIZSpriteFont const * const font,
+                         SHIZSpriteFontAlignment const alignment,
+                         SHIZSize const bounds,
+                         SHIZSpriteFontAttributes const * const attribs)
+{
+    memset(key, 0, sizeof(SHIZSpriteFontLayoutKey));
+    
+    key->source = font->sprite.source;
+    key->character = font->character;
+    key->bounds = bounds;
+    key->scale = attribs->scale;
+    key->codepage = font->table.codepage;
+    key->character_spread = attribs->character_spread;
+    key->character_padding = attribs->character_padding;
+    key->line_padding = attribs->line_padding;
+    key->columns = font->table.columns;
+    key->rows = font->table.rows;
+    key->resource_id = font->sprite.resource_id;
+    key->wrap = (uint8_t)attribs->wrap;
+    key->alignment = (uint8_t)alignment;
+    key->includes_whitespace = font->includes_whitespace;
+    
+    if (attribs->colors != NULL) {
+        // only the colors that can actually be specified are significant
+        key->colors_count = attribs->colors_count < SHIZSpriteFontMaxColors ?
+            attribs->colors_count : SHIZSpriteFontMaxColors;
+        
+        for (uint8_t i = 0; i < key->colors_count; i++) {
+            key->colors[i] = attribs->colors[i];
+        }
+    }
+}
+
+static
+uint32_t
+z_spritefont__layout_hash(SHIZSpriteFontLayoutKey const * const key,
+                          char const * const text,
+                          uint32_t const length)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    
+    unsigned char const * bytes = (unsigned char const *)key;
+    
+    for (size_t i = 0; i < sizeof(SHIZSpriteFontLayoutKey); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    
+    bytes = (unsigned char const *)text;
+    
+    for (uint32_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    
+    return hash;
+}
+
+static
+SHIZSpriteFontLayout *
+z_spritefont__find_layout(SHIZSpriteFontLayoutKey const * const key,
+                          uint32_t const hash,
+                          char const * const text,
+                          uint32_t const length)
+{
+    for (uint8_t i = 0; i < SHIZSpriteFontLayoutCacheSize; i++) {
+        SHIZSpriteFontLayout * const layout = &_layouts[i];
+        
+        if (!layout->is_valid || layout->hash != hash) {
+            continue;
+        }
+        
+        // the hash may collide, so make sure that this is the same text;
+        // a difference in length is the cheapest way to tell
+        if (layout->text_length == length &&
+            memcmp(&layout->key, key, sizeof(SHIZSpriteFontLayoutKey)) == 0 &&
+            memcmp(layout->text, text, length) == 0) {
+            layout->last_used = ++_layouts_clock;
+            
+            return layout;
+        }
+    }
+    
+    return NULL;
+}
+
+static
+SHIZSpriteFontLayout *
+z_spritefont__claim_layout(SHIZSpriteFontLayoutKey const * const key,
+                           uint32_t const hash,
+                           char const * const text,
+                           uint32_t const length)
+{
+    SHIZSpriteFontLayout * layout = &_layouts[0];
+    
+    for (uint8_t i = 1; i < SHIZSpriteFontLayoutCacheSize; i++) {
+        SHIZSpriteFontLayout * const candidate = &_layouts[i];
+        
+        if (!layout->is_valid) {
+            break;
+        }
+        
+        if (!candidate->is_valid ||
+            candidate->last_used < layout->last_used) {
+            layout = candidate;
+        }
+    }
+    
+    layout->is_valid = false;
+    
+    if (length + 1 > layout->text_capacity) {
+        char * const text_buffer = realloc(layout->text, length + 1);
+        
+        if (text_buffer == NULL) {
+            return NULL;
+        }
+        
+        layout->text = text_buffer;
+        layout->text_capacity = length + 1;
+    }
+    
+    memcpy(layout->text, text, length + 1);
+    
+    layout->text_length = length;
+    
+    memcpy(&layout->key, key, sizeof(SHIZSpriteFontLayoutKey));
+    layout->hash = hash;
+    layout->glyph_count = 0;
+    layout->last_used = ++_layouts_clock;
+    
+    return layout;
+}
+
+static
+bool
+z_spritefont__layout_add_glyph(SHIZSpriteFontLayout * const layout,
+                               SHIZRect const source,
+                               SHIZVector2 const offset,
+                               int8_t const color_index)
+{
+    if (layout->glyph_count + 1 > layout->glyph_capacity) {
+        uint32_t const capacity = layout->glyph_capacity > 0 ?
+            layout->glyph_capacity * 2 : 64;
+        
+        SHIZSpriteFontGlyph * const glyphs =
+            realloc(layout->glyphs, sizeof(SHIZSpriteFontGlyph) * capacity);
+        
+        if (glyphs == NULL) {
+            return false;
+        }
+        
+        layout->glyphs = glyphs;
+        layout->glyph_capacity = capacity;
+    }
+    
+    SHIZSpriteFontGlyph * const glyph = &layout->glyphs[layout->glyph_count];
+    
+    glyph->source = source;
+    glyph->offset = offset;
+    glyph->color_index = color_index;
+    
+    layout->glyph_count += 1;
+    
+    return true;
+}
+
+static
+SHIZColor
+z_spritefont__glyph_color(SHIZSpriteFontGlyph const * const glyph,
+                          SHIZColor const * const colors,
+                          SHIZColor const tint)
+{
+    if (glyph->color_index < 0) {
+        return tint;
+    }
+    
+    return colors[glyph->color_index];
+}
+
+static
+uint32_t
+z_spritefont__lookup_hash(uint32_t const character_decimal)
+{
+    // multiplicative (fibonacci) hashing; spreads consecutive code points
+    return character_decimal * 2654435761u;
+}
+
+static
+int32_t
+z_spritefont__lookup_index(SHIZSpriteFontLookup const * const lookup,
+                           uint32_t const character_decimal)
+{
+    if (character_decimal < SHIZSpriteFontLookupDirectSize) {
+        return lookup->direct[character_decimal];
+    }
+    
+    if (lookup->entries_capacity == 0) {
+        return -1;
+    }
+    
+    uint32_t const mask = lookup->entries_capacity - 1;
+    uint32_t slot = z_spritefont__lookup_hash(character_decimal) & mask;
+    
+    // the table is never more than half full, so an empty slot is always found
+    while (lookup->entries[slot].index >= 0) {
+        if (lookup->entries[slot].character_decimal == character_decimal) {
+            return lookup->entries[slot].index;
+        }
+        
+        slot = (slot + 1) & mask;
+    }
+    
+    return -1;
+}
+
+static
+bool
+z_spritefont__lookup_insert(SHIZSpriteFontLookup * const lookup,
+                            uint32_t const character_decimal,
+                            int32_t const index)
+{
+    uint32_t const mask = lookup->entries_capacity - 1;
+    uint32_t slot = z_spritefont__lookup_hash(character_decimal) & mask;
+    
+    while (lookup->entries[slot].index >= 0) {
+        if (lookup->entries[slot].character_decimal == character_decimal) {
+            return false;
+        }
+        
+        slot = (slot + 1) & mask;
+    }
+    
+    lookup->entries[slot].character_decimal = character_decimal;
+    lookup->entries[slot].index = index;
+    
+    return true;
+}
+
 static
 void
 z_spritefont__set_line(SHIZSpriteFontLine * const line,
@@ -555,6 +1620,70 @@ z_spritefont__set_line(SHIZSpriteFontLine * const line,
     line->character_count = character_count;
 }
 
+static
+SHIZSpriteFontLine *
+z_spritefont__push_line(SHIZSpriteFontMeasurement * const measurement)
+{
+    // the lines of a measurement are always at the end of the current block,
+    // because lines are only pushed while measuring; if the block is full,
+    // those lines are moved to a larger block and the lines of any previous
+    // measurement are left where they are, so that they remain valid
+    SHIZSpriteFontLineBlock * block = _line_arena;
+    
+    uint32_t const count = measurement->line_count;
+    
+    if (block == NULL || block->count >= block->capacity) {
+        uint32_t capacity = block != NULL ?
+            block->capacity * 2 : SHIZSpriteFontLineBlockSize;
+        
+        while (capacity < count + 1) {
+            capacity *= 2;
+        }
+        
+        SHIZSpriteFontLineBlock * const next_block =
+            malloc(sizeof(SHIZSpriteFontLineBlock) +
+                   sizeof(SHIZSpriteFontLine) * capacity);
+        
+        if (next_block == NULL) {
+            return NULL;
+        }
+        
+        next_block->previous = block;
+        next_block->capacity = capacity;
+        next_block->count = 0;
+        
+        if (count > 0) {
+            memcpy(next_block->lines, measurement->lines,
+                   sizeof(SHIZSpriteFontLine) * count);
+            
+            block->count -= count;
+            next_block->count = count;
+        }
+        
+        measurement->lines = next_block->lines;
+        
+        _line_arena = block = next_block;
+    }
+    
+    if (measurement->lines == NULL) {
+        measurement->lines = &block->lines[block->count];
+    }
+    
+    SHIZSpriteFontLine * const line = &block->lines[block->count];
+    
+    block->count += 1;
+    
+    line->size = SHIZSizeZero;
+    line->text_offset = 0;
+    line->character_offset = 0;
+    line->character_count = 0;
+    line->color_index = -1;
+    
+    measurement->line_count += 1;
+    
+    return line;
+}
+
 static
 bool
 z_spritefont__is_tint_character(char const character)
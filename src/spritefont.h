@@ -13,13 +13,38 @@
 
 #include <SHIZEN/ztype.h>
 
-#define SHIZSpriteFontMaxLines 16
+#include "internal.h" // SHIZVertexPositionColorTexture
+
+/**
+ * The max number of distinct codepage lookups that can exist at the same time.
+ */
+#define SHIZSpriteFontMaxLookups 8
+
+/**
+ * The number of text layouts that are kept between frames; when full, the
+ * least recently drawn layout is replaced.
+ */
+#define SHIZSpriteFontLayoutCacheSize 32
+
+/**
+ * The number of tint colors that can be specified in text (\2 through \7).
+ */
+#define SHIZSpriteFontMaxColors 6
 
 typedef struct SHIZSpriteFontLine {
     /** The measured size of the line of text */
     SHIZSize size;
+    /** The offset (in bytes) into the text where the line begins; only known
+        after the text has been laid out */
+    uint32_t text_offset;
+    /** The number of characters laid out before the line; only known after
+        the text has been laid out */
+    uint32_t character_offset;
     /** The number of characters in the line */
     uint16_t character_count;
+    /** The index of the tint color in effect where the line begins; -1 if
+        none */
+    int8_t color_index;
 } SHIZSpriteFontLine;
 
 typedef struct SHIZSpriteFontMeasurement {
@@ -30,17 +55,18 @@ typedef struct SHIZSpriteFontMeasurement {
     /** The size of a character sprite after applying any size-altering attributes (may be sized with
         offsets/padding, so these values are not suitable for drawing; use `character_size` instead) */
     SHIZSize character_size_perceived;
-    /** A buffer holding the measured size of each line */
-    SHIZSpriteFontLine lines[SHIZSpriteFontMaxLines];
+    /** The measured size of each line; these are only valid until the next
+        frame begins */
+    SHIZSpriteFontLine * lines;
     /** The index of the last character that can fit within specified bounds,
         if any; -1 otherwise */
     int32_t max_characters;
     /** The max number of characters per line before a linebreak is forced */
     uint16_t max_characters_per_line;
     /** The max number of lines that can fit within specified bounds, if any */
-    uint16_t max_lines_in_bounds;
+    uint32_t max_lines_in_bounds;
     /** The number of lines */
-    uint8_t line_count;
+    uint32_t line_count;
     /** Determines whether to keep text within horizontal bounds */
     bool constrain_horizontally;
     /** Determines whether to keep text within vertical bounds,
@@ -48,11 +74,31 @@ typedef struct SHIZSpriteFontMeasurement {
     bool constrain_vertically;
 } SHIZSpriteFontMeasurement;
 
+/**
+ * @brief Represents text that was laid out once, so that any range of its
+ *        lines can be drawn without laying out the lines before it.
+ */
+typedef struct SHIZSpriteFontPages {
+    /** The measurement of the text; the lines are owned by the pages */
+    SHIZSpriteFontMeasurement measurement;
+    SHIZSpriteFontAttributes attribs;
+    SHIZSpriteFont font;
+    SHIZColor colors[SHIZSpriteFontMaxColors];
+    /** A copy of the text */
+    char * text;
+} SHIZSpriteFontPages;
+
 SHIZSpriteFontMeasurement const z_spritefont__measure_text(SHIZSpriteFont font,
                                                            char const * text,
                                                            SHIZSize bounds,
                                                            SHIZSpriteFontAttributes attrs);
 
+/**
+ * @brief Draw text.
+ *
+ * The layout of the text is cached, so that drawing the same text with the
+ * same font, bounds and attributes again skips measuring and decoding it.
+ */
 SHIZSize const z_spritefont__draw_text(SHIZSpriteFont font,
                                        char const * text,
                                        SHIZVector2 origin,
@@ -61,3 +107,91 @@ SHIZSize const z_spritefont__draw_text(SHIZSpriteFont font,
                                        SHIZSpriteFontAttributes attrs,
                                        SHIZColor tint,
                                        SHIZLayer layer);
+
+/**
+ * @brief Build a lookup table for a font codepage.
+ *
+ * Build a table that maps a character directly to its index in the codepage,
+ * so that a character can be found in constant time.
+ *
+ * The lookup belongs to the image resource of the font, and is released
+ * when that is unloaded. Fonts of the same image that share the same codepage
+ * also share the same lookup.
+ *
+ * @return A lookup id, or 0 if the table has no codepage or the lookup could
+ *         not be built (in which case characters are found by scanning the
+ *         codepage instead)
+ */
+uint8_t z_spritefont__build_lookup(SHIZSpriteFontTable table, uint32_t resource_id);
+/**
+ * @brief Release the codepage lookups of any fonts of an image resource.
+ */
+void z_spritefont__release_lookups(uint32_t resource_id);
+
+/**
+ * @brief Release all codepage lookups, cached text layouts and measured lines.
+ */
+void z_spritefont__kill(void);
+
+/**
+ * @brief Bake text into quads.
+ *
+ * Lay out text and build a textured quad (6 vertices) for each character,
+ * positioned relative to the origin of the text. Any previous vertices are
+ * released (and replaced) only if the text was baked successfully.
+ *
+ * @remark Characters are tinted as if drawn with `SHIZSpriteNoTint`; any
+ *         tint is instead applied when the quads are drawn.
+ *
+ * @return `true` if the text was baked successfully, `false` otherwise
+ */
+bool z_spritefont__bake_text(SHIZSpriteFont font,
+                             char const * text,
+                             SHIZSpriteFontAlignment alignment,
+                             SHIZSize bounds,
+                             SHIZSpriteFontAttributes attrs,
+                             SHIZVertexPositionColorTexture ** vertices,
+                             uint32_t * quad_count,
+                             SHIZSize * size);
+
+/**
+ * @brief Lay out text so that it can be drawn a range of lines at a time.
+ *
+ * Measure and lay out every line of the text once. Any previous contents of
+ * the pages are released.
+ *
+ * @return `true` if the text was laid out successfully, `false` otherwise
+ */
+bool z_spritefont__paginate_text(SHIZSpriteFont font,
+                                 char const * text,
+                                 float width,
+                                 SHIZSpriteFontAttributes attrs,
+                                 SHIZSpriteFontPages * pages);
+
+/**
+ * @brief Draw a range of lines of paginated text.
+ *
+ * Only the lines within the range are laid out and drawn; the first line
+ * is positioned at the origin.
+ *
+ * @return The size of the drawn lines
+ */
+SHIZSize const z_spritefont__draw_lines(SHIZSpriteFontPages const * pages,
+                                        SHIZVector2 origin,
+                                        uint32_t first_line,
+                                        uint32_t line_count,
+                                        SHIZSpriteFontAlignment alignment,
+                                        SHIZColor tint,
+                                        SHIZLayer layer);
+
+/**
+ * @brief Release the lines and text of paginated text.
+ */
+void z_spritefont__release_pages(SHIZSpriteFontPages * pages);
+
+/**
+ * @brief Clear the lines measured during the previous frame.
+ *
+ * Any measurement made before this call must no longer be used.
+ */
+void z_spritefont__reset(void);
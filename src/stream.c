@@ -0,0 +1,519 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#if defined(__linux__) && !defined(_XOPEN_SOURCE)
+ #define _XOPEN_SOURCE 700 // clock_gettime
+#endif
+
+#include "stream.h"
+
+#include <stdlib.h> // NULL, calloc, free
+#include <time.h> // timespec, clock_gettime
+#include <pthread.h> // pthread_*
+
+#include <stb/stb_vorbis.h> // stb_vorbis_*
+
+#include "internal.h" // ALuint, ALenum, al*, glfwGetTime
+#include "io.h" // z_io__error
+
+struct SHIZStream {
+    struct SHIZStream * next;
+    stb_vorbis * vorbis;
+    /** The contents of the file, if decoded from memory; `NULL` otherwise */
+    uint8_t const * data;
+    ALuint source_id;
+    ALuint buffer_ids[SHIZStreamBufferCount];
+    ALenum format;
+    /** The number of channels decoded; any more than two are mixed down */
+    int32_t channels;
+    int32_t sample_rate;
+    /** Whether the stream is playing, or about to */
+    bool is_playing;
+    /** Whether the buffers must be decoded from the beginning, then played */
+    bool is_starting;
+    bool is_looping;
+    /** Whether the end has been decoded; never while looping */
+    bool is_ended;
+    /** Whether the worker is decoding into a buffer, without holding the lock */
+    bool is_decoding;
+};
+
+static void * z_stream__work(void * argument);
+static bool z_stream__pump(void);
+static void z_stream__start(SHIZStream *);
+static void z_stream__refill(SHIZStream *);
+static bool z_stream__is_interrupted(SHIZStream const *);
+static bool z_stream__fill(SHIZStream *, ALuint buffer_id);
+
+static pthread_t _worker;
+static bool _has_worker = false;
+// whether streams are refilled by the worker; otherwise by z_stream__update
+static bool _is_threaded = true;
+
+// guards every stream, the list of streams and the stopping flag; but not
+// the decoding itself, which is done with the lock released (see z_stream__fill)
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _changed = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t _decoded = PTHREAD_COND_INITIALIZER;
+
+static SHIZStream * _streams = NULL; // every open stream
+
+static bool _is_stopping = false;
+
+// in nanoseconds; only added to by the worker, but read from any thread
+static uint64_t _decode_time = 0;
+
+// only decoded into by the worker (or z_stream__update, if not threaded);
+// each buffer is copied by OpenAL
+static int16_t _samples[SHIZStreamBufferSamples * 2];
+
+void
+z_stream__init(bool const threaded)
+{
+    _is_threaded = threaded;
+}
+
+SHIZStream *
+z_stream__open(char const * const filename,
+               uint8_t const * const data,
+               uint32_t const length)
+{
+    if (_is_threaded && !_has_worker) {
+        if (pthread_create(&_worker, NULL, z_stream__work, NULL) != 0) {
+            z_io__error("could not begin streaming");
+            
+            return NULL;
+        }
+        
+        _has_worker = true;
+    }
+    
+    int error = 0;
+    
+    stb_vorbis * vorbis = NULL;
+    
+    if (data != NULL) {
+        if (length > 0 && length <= INT32_MAX) {
+            vorbis = stb_vorbis_open_memory(data, (int32_t)length, &error, NULL);
+        }
+    } else {
+        vorbis = stb_vorbis_open_filename(filename, &error, NULL);
+    }
+    
+    if (vorbis == NULL) {
+        return NULL;
+    }
+    
+    SHIZStream * const stream = calloc(1, sizeof(SHIZStream));
+    
+    if (stream == NULL) {
+        stb_vorbis_close(vorbis);
+        
+        return NULL;
+    }
+    
+    stb_vorbis_info const info = stb_vorbis_get_info(vorbis);
+    
+    stream->vorbis = vorbis;
+    stream->data = data;
+    stream->channels = info.channels > 1 ? 2 : 1;
+    stream->sample_rate = (int32_t)info.sample_rate;
+    stream->format = stream->channels > 1 ?
+        AL_FORMAT_STEREO16 :
+        AL_FORMAT_MONO16;
+    
+    alGenSources(1, &stream->source_id);
+    alGenBuffers(SHIZStreamBufferCount, stream->buffer_ids);
+    
+    alSource3f(stream->source_id, AL_POSITION, 0, 0, 0);
+    alSource3f(stream->source_id, AL_VELOCITY, 0, 0, 0);
+    // looping is done by decoding; the source only ever plays what is queued
+    alSourcei(stream->source_id, AL_LOOPING, AL_FALSE);
+    
+    pthread_mutex_lock(&_mutex);
+    
+    stream->next = _streams;
+    
+    _streams = stream;
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return stream;
+}
+
+void
+z_stream__close(SHIZStream * const stream)
+{
+    pthread_mutex_lock(&_mutex);
+    
+    while (stream->is_decoding) {
+        pthread_cond_wait(&_decoded, &_mutex);
+    }
+    
+    SHIZStream * * link = &_streams;
+    
+    while (*link != NULL && *link != stream) {
+        link = &(*link)->next;
+    }
+    
+    if (*link != NULL) {
+        *link = stream->next;
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    // the worker no longer knows of the stream
+    alSourceStop(stream->source_id);
+    alSourcei(stream->source_id, AL_BUFFER, 0);
+    
+    alDeleteSources(1, &stream->source_id);
+    alDeleteBuffers(SHIZStreamBufferCount, stream->buffer_ids);
+    
+    stb_vorbis_close(stream->vorbis);
+    
+    free(stream);
+}
+
+void
+z_stream__play(SHIZStream * const stream,
+               float const gain,
+               float const pitch)
+{
+    pthread_mutex_lock(&_mutex);
+    
+    alSourcef(stream->source_id, AL_GAIN, gain);
+    alSourcef(stream->source_id, AL_PITCH, pitch);
+    
+    stream->is_playing = true;
+    stream->is_starting = true;
+    
+    pthread_cond_signal(&_changed);
+    pthread_mutex_unlock(&_mutex);
+}
+
+void
+z_stream__stop(SHIZStream * const stream)
+{
+    pthread_mutex_lock(&_mutex);
+    
+    stream->is_playing = false;
+    stream->is_starting = false;
+    
+    alSourceStop(stream->source_id);
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+void
+z_stream__loop(SHIZStream * const stream,
+               bool const loop)
+{
+    pthread_mutex_lock(&_mutex);
+    
+    stream->is_looping = loop;
+    
+    if (loop) {
+        // if the end has already been decoded, the beginning simply follows
+        // in the next buffer instead
+        stream->is_ended = false;
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+bool
+z_stream__reads(uint8_t const * const data,
+                uint32_t const length)
+{
+    bool reads = false;
+    
+    pthread_mutex_lock(&_mutex);
+    
+    for (SHIZStream const * stream = _streams;
+         stream != NULL;
+         stream = stream->next) {
+        if (stream->data != NULL &&
+            stream->data >= data && stream->data < data + length) {
+            reads = true;
+            
+            break;
+        }
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return reads;
+}
+
+double
+z_stream__decode_time()
+{
+    uint64_t const decode_time = __atomic_load_n(&_decode_time,
+                                                 __ATOMIC_RELAXED);
+    
+    return (double)decode_time / 1000000000.0;
+}
+
+void
+z_stream__update()
+{
+    if (_is_threaded) {
+        return;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    z_stream__pump();
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+void
+z_stream__kill()
+{
+    if (!_has_worker) {
+        return;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    _is_stopping = true;
+    
+    pthread_cond_signal(&_changed);
+    pthread_mutex_unlock(&_mutex);
+    
+    pthread_join(_worker, NULL);
+    
+    _has_worker = false;
+    _is_stopping = false;
+}
+
+static
+void *
+z_stream__work(void * const argument)
+{
+    (void)argument;
+    
+    pthread_mutex_lock(&_mutex);
+    
+    while (!_is_stopping) {
+        bool const is_playing = z_stream__pump();
+        
+        if (!is_playing) {
+            // nothing to refill until a stream begins playing
+            pthread_cond_wait(&_changed, &_mutex);
+            
+            continue;
+        }
+        
+        struct timespec deadline;
+        
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        
+        deadline.tv_nsec += (long)(SHIZStreamInterval * 1000000000L);
+        
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        
+        pthread_cond_timedwait(&_changed, &_mutex, &deadline);
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return NULL;
+}
+
+static
+bool
+z_stream__pump()
+{
+    bool is_playing = false;
+    
+    for (SHIZStream * stream = _streams;
+         stream != NULL;
+         stream = stream->next) {
+        if (stream->is_starting) {
+            z_stream__start(stream);
+        } else if (stream->is_playing) {
+            z_stream__refill(stream);
+        }
+        
+        if (stream->is_playing) {
+            is_playing = true;
+        }
+    }
+    
+    return is_playing;
+}
+
+static
+void
+z_stream__start(SHIZStream * const stream)
+{
+    stream->is_starting = false;
+    stream->is_ended = false;
+    
+    // discard anything still queued from playing before
+    alSourceStop(stream->source_id);
+    alSourcei(stream->source_id, AL_BUFFER, 0);
+    
+    stb_vorbis_seek_start(stream->vorbis);
+    
+    ALsizei queued = 0;
+    
+    while (queued < SHIZStreamBufferCount &&
+           z_stream__fill(stream, stream->buffer_ids[queued])) {
+        queued += 1;
+        
+        if (stream->is_ended || z_stream__is_interrupted(stream)) {
+            break;
+        }
+    }
+    
+    if (z_stream__is_interrupted(stream)) {
+        // played again or stopped while decoding; nothing is queued
+        return;
+    }
+    
+    if (queued == 0) {
+        stream->is_playing = false;
+        
+        return;
+    }
+    
+    alSourceQueueBuffers(stream->source_id, queued, stream->buffer_ids);
+    alSourcePlay(stream->source_id);
+}
+
+static
+void
+z_stream__refill(SHIZStream * const stream)
+{
+    ALint processed = 0;
+    
+    alGetSourcei(stream->source_id, AL_BUFFERS_PROCESSED, &processed);
+    
+    while (processed > 0) {
+        ALuint buffer_id;
+        
+        alSourceUnqueueBuffers(stream->source_id, 1, &buffer_id);
+        
+        if (!stream->is_ended && z_stream__fill(stream, buffer_id)) {
+            alSourceQueueBuffers(stream->source_id, 1, &buffer_id);
+        }
+        
+        processed -= 1;
+        
+        if (z_stream__is_interrupted(stream)) {
+            // played again or stopped while decoding; leave the source be,
+            // rather than set it playing again below
+            return;
+        }
+    }
+    
+    ALint queued = 0;
+    ALint state = AL_STOPPED;
+    
+    alGetSourcei(stream->source_id, AL_BUFFERS_QUEUED, &queued);
+    alGetSourcei(stream->source_id, AL_SOURCE_STATE, &state);
+    
+    if (state != AL_PLAYING) {
+        if (queued > 0) {
+            // every buffer played before it could be refilled; carry on
+            alSourcePlay(stream->source_id);
+        } else {
+            // the end has played
+            stream->is_playing = false;
+        }
+    }
+}
+
+static
+bool
+z_stream__is_interrupted(SHIZStream const * const stream)
+{
+    return stream->is_starting || !stream->is_playing;
+}
+
+static
+bool
+z_stream__fill(SHIZStream * const stream,
+               ALuint const buffer_id)
+{
+    int32_t const capacity = SHIZStreamBufferSamples * stream->channels;
+    int32_t count = 0;
+    
+    bool const is_looping = stream->is_looping;
+    bool is_ended = false;
+    bool rewound = false;
+    
+    // decoding takes a while; release the lock meanwhile, so that playing,
+    // stopping or looping any stream does not have to wait for it (closing
+    // this one waits until the buffer is decoded, see z_stream__close)
+    stream->is_decoding = true;
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    double const start = glfwGetTime();
+    
+    while (count < capacity) {
+        int32_t const samples =
+            stb_vorbis_get_samples_short_interleaved(stream->vorbis,
+                                                     stream->channels,
+                                                     _samples + count,
+                                                     capacity - count);
+        
+        if (samples > 0) {
+            count += samples * stream->channels;
+            
+            rewound = false;
+            
+            continue;
+        }
+        
+        // the end; when looping, go on from the beginning in the same buffer
+        // (unless there is nothing at all to decode)
+        if (!is_looping || rewound ||
+            !stb_vorbis_seek_start(stream->vorbis)) {
+            is_ended = true;
+            
+            break;
+        }
+        
+        rewound = true;
+    }
+    
+    if (count > 0) {
+        // the buffer is not queued, so it can be filled without the lock
+        alBufferData(buffer_id, stream->format, _samples,
+                     count * (int32_t)sizeof(int16_t), stream->sample_rate);
+    }
+    
+    __atomic_fetch_add(&_decode_time,
+                       (uint64_t)((glfwGetTime() - start) * 1000000000.0),
+                       __ATOMIC_RELAXED);
+    
+    pthread_mutex_lock(&_mutex);
+    
+    stream->is_decoding = false;
+    
+    pthread_cond_broadcast(&_decoded);
+    
+    // if looping was set while decoding past the end, the beginning simply
+    // follows in the next buffer instead (as in z_stream__loop)
+    if (is_ended && (is_looping || !stream->is_looping)) {
+        stream->is_ended = true;
+    }
+    
+    return count > 0;
+}
@@ -0,0 +1,106 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t, uint32_t
+
+/**
+ * The number of buffers that each stream cycles through; while one is
+ * playing, the others are decoded into.
+ */
+#define SHIZStreamBufferCount 4
+/**
+ * The number of samples (of every channel) decoded into each buffer at a
+ * time; e.g. 8192 stereo samples is roughly 90ms of sound at 44.1kHz.
+ */
+#define SHIZStreamBufferSamples 8192
+/**
+ * The time (in seconds) between refilling the buffers of playing streams.
+ */
+#define SHIZStreamInterval (1.0 / 100)
+
+/**
+ * @brief Represents a sound that is decoded a little at a time while it
+ *        plays, rather than all at once up front.
+ */
+typedef struct SHIZStream SHIZStream;
+
+/**
+ * @brief Set whether streams are refilled on a background thread of their
+ *        own, as their buffers are played; otherwise `z_stream__update` must
+ *        be called instead.
+ *
+ * Must be set before any stream is opened; streams are threaded by default.
+ */
+void z_stream__init(bool threaded);
+
+/**
+ * @brief Open an Ogg Vorbis file for streaming.
+ *
+ * Only the headers of the file are decoded; the rest is decoded into a
+ * fixed set of buffers on a background thread while playing, so the memory
+ * used is the same regardless of the length of the file.
+ *
+ * The thread (if threaded) is started the first time a stream is opened.
+ *
+ * @param data
+ *        The contents of the file, if already in memory (e.g. in a pack);
+ *        otherwise `NULL` to read the file. The contents must stay in memory
+ *        until the stream is closed
+ *
+ * @return A stream, or `NULL` if the file could not be opened
+ */
+SHIZStream * z_stream__open(char const * filename, uint8_t const * data, uint32_t length);
+void z_stream__close(SHIZStream *);
+
+/**
+ * @brief Play a stream from the beginning.
+ *
+ * The first buffers are decoded on the background thread too, so the stream
+ * begins playing shortly after.
+ */
+void z_stream__play(SHIZStream *, float gain, float pitch);
+void z_stream__stop(SHIZStream *);
+
+/**
+ * @brief Set whether a stream starts over once it ends.
+ *
+ * The beginning is decoded into the same buffer as the end, so there is no
+ * gap between them.
+ */
+void z_stream__loop(SHIZStream *, bool loop);
+
+/**
+ * @brief Start, and refill the played buffers of, every playing stream.
+ *
+ * Only needed when not threaded; e.g. when sound is rendered into memory, so
+ * that the decoding is in step with the rendering.
+ */
+void z_stream__update(void);
+
+/**
+ * @brief Determine whether any open stream is decoded from a block of memory.
+ */
+bool z_stream__reads(uint8_t const * data, uint32_t length);
+
+/**
+ * @brief Stop the background thread.
+ *
+ * Every stream must have been closed already.
+ */
+void z_stream__kill(void);
+
+/**
+ * @brief Determine the time (in seconds) spent decoding streams so far.
+ */
+double z_stream__decode_time(void);
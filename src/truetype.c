@@ -0,0 +1,754 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#include "truetype.h"
+
+#include <stdlib.h> // malloc, free
+#include <string.h> // memset
+#include <math.h> // floorf
+
+#include "internal.h"
+#include "sprite.h"
+#include "io.h"
+#include "ttf.h"
+
+#include "graphics/gfx.h"
+
+/**
+ * The width and height of the texture that every glyph is rasterized into.
+ */
+#define SHIZGlyphAtlasSize 1024
+/**
+ * The max number of glyphs (of any font and size) that can be cached at the
+ * same time; the least recently used glyph is replaced beyond this.
+ */
+#define SHIZGlyphMax 2048
+/**
+ * The number of buckets that cached glyphs are hashed into (a power of two).
+ */
+#define SHIZGlyphBucketCount 1024
+/**
+ * The max number of rows of glyphs in the atlas.
+ */
+#define SHIZGlyphShelfMax 128
+/**
+ * The height of every row of glyphs in the atlas is a multiple of this.
+ */
+#define SHIZGlyphShelfGranularity 4
+/**
+ * The empty space kept around every glyph in the atlas.
+ */
+#define SHIZGlyphPadding 1
+/**
+ * The largest width or height (in pixels) of a glyph; larger glyphs are not
+ * drawn.
+ */
+#define SHIZGlyphBitmapMax (SHIZTrueTypeFontSizeMax * 2)
+
+#define SHIZGlyphReplacementCharacter 0xfffd
+
+typedef struct SHIZTrueTypeFace {
+    SHIZTrueTypeInfo info;
+    uint8_t * data;
+} SHIZTrueTypeFace;
+
+typedef struct SHIZGlyph {
+    /** The source frame of the glyph in the atlas (origin only valid while
+      * the glyph is on a shelf) */
+    SHIZRect source;
+    /** The offset from the pen (on the baseline) to the top-left corner of
+      * the glyph; y grows downwards */
+    SHIZVector2 offset;
+    /** The distance to the next glyph on the line (excluding kerning) */
+    float advance;
+    uint32_t codepoint;
+    /** The frame that the glyph was last drawn or measured in */
+    uint32_t last_used;
+    uint32_t resource_id;
+    /** The index of the glyph in the font */
+    uint16_t index;
+    uint16_t size;
+    /** The slot of the next glyph in the same bucket; 0 if none */
+    uint16_t next;
+    /** The shelf that the glyph is placed on; 0 if not in the atlas */
+    uint8_t shelf;
+    /** Determines whether the glyph has an outline (whitespace does not) */
+    bool has_bitmap;
+} SHIZGlyph;
+
+/**
+ * @brief Represents a row of glyphs in the atlas, filled from left to right.
+ *
+ * The atlas is evicted a shelf at a time; this keeps packing trivial while
+ * still reclaiming the space of glyphs that are no longer drawn.
+ */
+typedef struct SHIZGlyphShelf {
+    uint32_t last_used;
+    uint16_t y;
+    uint16_t height;
+    uint16_t used_width;
+} SHIZGlyphShelf;
+
+typedef struct SHIZGlyphAtlas {
+    SHIZGlyphShelf shelves[SHIZGlyphShelfMax];
+    uint16_t shelf_count;
+    uint16_t used_height;
+    uint32_t resource_id;
+} SHIZGlyphAtlas;
+
+static SHIZGlyph * z_truetype__glyph(SHIZResourceFont const *, uint16_t size, float scale, uint32_t codepoint);
+static uint16_t z_truetype__next_slot(void);
+static uint16_t z_truetype__bucket(uint32_t resource_id, uint16_t size, uint32_t codepoint);
+static void z_truetype__unlink(uint16_t slot);
+
+static bool z_truetype__place(SHIZGlyph *, SHIZTrueTypeFace const *, float scale);
+static uint8_t z_truetype__allocate(uint16_t width, uint16_t height, uint16_t * x, uint16_t * y);
+static void z_truetype__evict_shelf(uint8_t shelf);
+
+static bool z_truetype__begin_run(SHIZSpriteRun *, SHIZLayer);
+
+static SHIZSize const z_truetype__layout(SHIZTrueTypeFont, char const * text, SHIZVector2 origin, SHIZSpriteFontAlignment, SHIZColor tint, SHIZLayer, bool draw);
+static float z_truetype__layout_line(SHIZResourceFont const *, uint16_t size, float scale, char const * text, SHIZVector2 pen, SHIZColor tint, SHIZSpriteRun * run);
+
+static uint16_t z_truetype__size(float size);
+static uint32_t z_truetype__decode(char const * text, uint32_t * length);
+
+static SHIZGlyph _glyphs[SHIZGlyphMax];
+static uint16_t _glyph_count = 0;
+static uint16_t _buckets[SHIZGlyphBucketCount];
+
+static SHIZGlyphAtlas _atlas;
+
+// scratch space for rasterizing a single (padded) glyph
+static uint8_t _bitmap[(SHIZGlyphBitmapMax + (SHIZGlyphPadding * 2)) *
+                       (SHIZGlyphBitmapMax + (SHIZGlyphPadding * 2))];
+
+static uint32_t _frame = 1;
+
+bool
+z_truetype__create_face(SHIZResourceFont * const font,
+                        uint8_t * const data,
+                        uint32_t const length)
+{
+    if (font == NULL) {
+        return false;
+    }
+    
+    SHIZTrueTypeFace * const face = malloc(sizeof(SHIZTrueTypeFace));
+    
+    if (face == NULL) {
+        return false;
+    }
+    
+    if (!z_ttf__init(&face->info, data, length)) {
+        z_io__error("font could not be read ('%s'); only TrueType outlines are supported",
+                    font->filename != NULL ? font->filename : "from memory");
+        
+        free(face);
+        
+        return false;
+    }
+    
+    face->data = data;
+    
+    font->face = face;
+    
+    return true;
+}
+
+bool
+z_truetype__destroy_face(SHIZResourceFont * const font)
+{
+    if (font == NULL || font->face == NULL) {
+        return false;
+    }
+    
+    for (uint16_t slot = 1; slot <= _glyph_count; slot++) {
+        SHIZGlyph * const glyph = &_glyphs[slot - 1];
+        
+        if (glyph->resource_id == font->resource_id) {
+            z_truetype__unlink(slot);
+            
+            // the space on its shelf is reclaimed once the shelf is evicted
+            glyph->resource_id = SHIZResourceInvalid;
+            glyph->shelf = 0;
+            glyph->last_used = 0;
+        }
+    }
+    
+    free(font->face->data);
+    free(font->face);
+    
+    font->face = NULL;
+    
+    return true;
+}
+
+void
+z_truetype__kill()
+{
+    if (_atlas.resource_id != SHIZResourceInvalid) {
+        z_res__destroy_atlas();
+    }
+    
+    memset(&_atlas, 0, sizeof(SHIZGlyphAtlas));
+    memset(_buckets, 0, sizeof(_buckets));
+    
+    _glyph_count = 0;
+}
+
+void
+z_truetype__reset()
+{
+    _frame += 1;
+}
+
+SHIZSize const
+z_truetype__measure_text(SHIZTrueTypeFont const font,
+                         char const * const text)
+{
+    return z_truetype__layout(font, text, SHIZVector2Zero,
+                              SHIZSpriteFontAlignmentDefault,
+                              SHIZSpriteNoTint, SHIZLayerDefault,
+                              false);
+}
+
+SHIZSize const
+z_truetype__draw_text(SHIZTrueTypeFont const font,
+                      char const * const text,
+                      SHIZVector2 const origin,
+                      SHIZSpriteFontAlignment const alignment,
+                      SHIZColor const tint,
+                      SHIZLayer const layer)
+{
+    return z_truetype__layout(font, text, origin, alignment, tint, layer,
+                              true);
+}
+
+static
+SHIZSize const
+z_truetype__layout(SHIZTrueTypeFont const font,
+                   char const * const text,
+                   SHIZVector2 const origin,
+                   SHIZSpriteFontAlignment const alignment,
+                   SHIZColor const tint,
+                   SHIZLayer const layer,
+                   bool const draw)
+{
+    SHIZResourceFont const * const resource = z_res__font(font.resource_id);
+    
+    if (text == NULL || resource == NULL || resource->face == NULL) {
+        return SHIZSizeZero;
+    }
+    
+    uint16_t const size = z_truetype__size(font.size);
+    
+    if (size == 0) {
+        return SHIZSizeZero;
+    }
+    
+    SHIZTrueTypeInfo const * const info = &resource->face->info;
+    
+    float const scale = z_ttf__scale_for_pixel_height(info, size);
+    // keep baselines on whole pixels, so that glyphs are drawn exactly as
+    // they were rasterized
+    float const ascent = floorf((info->ascent * scale) + 0.5f);
+    float const line_height =
+        floorf(((info->ascent - info->descent + info->line_gap) * scale) + 0.5f);
+    
+    uint32_t line_count = 1;
+    
+    for (char const * text_ptr = text; *text_ptr != '\0'; text_ptr++) {
+        if (*text_ptr == '\n') {
+            line_count += 1;
+        }
+    }
+    
+    SHIZSize text_size =
+        SHIZSizeMake(0, (line_height * (line_count - 1)) + size);
+    
+    SHIZSpriteRun run;
+    
+    bool const can_draw = draw && z_truetype__begin_run(&run, layer);
+    
+    SHIZVector2 line_origin = origin;
+    
+    if ((alignment & SHIZSpriteFontAlignmentTop) == SHIZSpriteFontAlignmentTop) {
+        // intentionally left blank; no operation necessary
+    } else if ((alignment & SHIZSpriteFontAlignmentMiddle) == SHIZSpriteFontAlignmentMiddle) {
+        line_origin.y += floorf(text_size.height / 2);
+    } else if ((alignment & SHIZSpriteFontAlignmentBottom) == SHIZSpriteFontAlignmentBottom) {
+        line_origin.y += text_size.height;
+    }
+    
+    line_origin.y = floorf(line_origin.y + 0.5f) - ascent;
+    
+    char const * line_ptr = text;
+    
+    for (uint32_t line_index = 0; line_index < line_count; line_index++) {
+        // measure the line first; it must be aligned before it is drawn
+        float const line_width =
+            z_truetype__layout_line(resource, size, scale, line_ptr,
+                                    line_origin, tint, NULL);
+        
+        if (line_width > text_size.width) {
+            text_size.width = line_width;
+        }
+        
+        if (can_draw) {
+            SHIZVector2 pen = line_origin;
+            
+            if ((alignment & SHIZSpriteFontAlignmentCenter) == SHIZSpriteFontAlignmentCenter) {
+                pen.x -= floorf(line_width / 2);
+            } else if ((alignment & SHIZSpriteFontAlignmentRight) == SHIZSpriteFontAlignmentRight) {
+                pen.x -= line_width;
+            }
+            
+            z_truetype__layout_line(resource, size, scale, line_ptr,
+                                    pen, tint, &run);
+        }
+        
+        while (*line_ptr != '\0' && *line_ptr != '\n') {
+            line_ptr++;
+        }
+        
+        if (*line_ptr == '\n') {
+            line_ptr++;
+        }
+        
+        line_origin.y -= line_height;
+    }
+    
+    return text_size;
+}
+
+static
+float
+z_truetype__layout_line(SHIZResourceFont const * const font,
+                        uint16_t const size,
+                        float const scale,
+                        char const * const text,
+                        SHIZVector2 pen,
+                        SHIZColor const tint,
+                        SHIZSpriteRun * const run)
+{
+    SHIZTrueTypeInfo const * const info = &font->face->info;
+    
+    float const line_start = pen.x;
+    
+    char const * text_ptr = text;
+    
+    SHIZGlyph const * previous = NULL;
+    
+    while (*text_ptr != '\0' && *text_ptr != '\n') {
+        uint32_t length;
+        uint32_t const codepoint = z_truetype__decode(text_ptr, &length);
+        
+        text_ptr += length;
+        
+        SHIZGlyph * const glyph = z_truetype__glyph(font, size, scale, codepoint);
+        
+        if (glyph == NULL) {
+            previous = NULL;
+            
+            continue;
+        }
+        
+        if (previous != NULL) {
+            pen.x += z_ttf__get_kerning(info, previous->index, glyph->index) * scale;
+        }
+        
+        if (run != NULL && glyph->has_bitmap &&
+            z_truetype__place(glyph, font->face, scale)) {
+            // glyphs differ in size, so the corners of the run (anchored at
+            // the top-left) are replaced for each glyph
+            run->bottom_left = SHIZVector2Make(0, -glyph->source.size.height);
+            run->top_right = SHIZVector2Make(glyph->source.size.width, 0);
+            
+            SHIZVector2 const origin =
+                SHIZVector2Make(floorf(pen.x + 0.5f) + glyph->offset.x,
+                                pen.y - glyph->offset.y);
+            
+            z_sprite__draw_run(run, glyph->source, origin, tint);
+        }
+        
+        pen.x += glyph->advance;
+        
+        previous = glyph;
+    }
+    
+    return pen.x - line_start;
+}
+
+static
+bool
+z_truetype__begin_run(SHIZSpriteRun * const run,
+                      SHIZLayer const layer)
+{
+    if (z_res__image(_atlas.resource_id) == NULL) {
+        // only create the atlas once text is actually drawn
+        _atlas.resource_id = z_res__create_atlas(SHIZGlyphAtlasSize,
+                                                 SHIZGlyphAtlasSize);
+        
+        if (_atlas.resource_id == SHIZResourceInvalid) {
+            return false;
+        }
+    }
+    
+    return z_sprite__begin_run(run, _atlas.resource_id,
+                               SHIZSizeMake(1, 1), SHIZAnchorTopLeft,
+                               SHIZSpriteNotOpaque, layer);
+}
+
+static
+SHIZGlyph *
+z_truetype__glyph(SHIZResourceFont const * const font,
+                  uint16_t const size,
+                  float const scale,
+                  uint32_t const codepoint)
+{
+    uint16_t const bucket = z_truetype__bucket(font->resource_id, size, codepoint);
+    
+    for (uint16_t slot = _buckets[bucket]; slot != 0; slot = _glyphs[slot - 1].next) {
+        SHIZGlyph * const glyph = &_glyphs[slot - 1];
+        
+        if (glyph->codepoint == codepoint &&
+            glyph->size == size &&
+            glyph->resource_id == font->resource_id) {
+            glyph->last_used = _frame;
+            
+            return glyph;
+        }
+    }
+    
+    uint16_t const slot = z_truetype__next_slot();
+    
+    if (slot == 0) {
+        return NULL;
+    }
+    
+    SHIZGlyph * const glyph = &_glyphs[slot - 1];
+    
+    SHIZTrueTypeInfo const * const info = &font->face->info;
+    
+    int const index = z_ttf__find_glyph(info, codepoint);
+    
+    int advance;
+    
+    z_ttf__get_hmetrics(info, index, &advance, NULL);
+    
+    int x0, y0, x1, y1;
+    
+    glyph->has_bitmap =
+        z_ttf__get_glyph_box(info, index, scale, &x0, &y0, &x1, &y1) &&
+        (x1 - x0) <= SHIZGlyphBitmapMax &&
+        (y1 - y0) <= SHIZGlyphBitmapMax;
+    
+    if (glyph->has_bitmap) {
+        glyph->source = SHIZRectMake(SHIZVector2Zero,
+                                     SHIZSizeMake(x1 - x0, y1 - y0));
+        glyph->offset = SHIZVector2Make(x0, y0);
+    } else {
+        glyph->source = SHIZRectEmpty;
+        glyph->offset = SHIZVector2Zero;
+    }
+    
+    glyph->advance = advance * scale;
+    glyph->codepoint = codepoint;
+    glyph->last_used = _frame;
+    glyph->index = (uint16_t)index;
+    glyph->size = size;
+    glyph->resource_id = font->resource_id;
+    glyph->shelf = 0;
+    
+    glyph->next = _buckets[bucket];
+    
+    _buckets[bucket] = slot;
+    
+    return glyph;
+}
+
+static
+uint16_t
+z_truetype__next_slot()
+{
+    if (_glyph_count < SHIZGlyphMax) {
+        _glyph_count += 1;
+        
+        return _glyph_count;
+    }
+    
+    // the cache is full; replace the least recently used glyph, as long as
+    // it has not been used during this frame
+    uint16_t oldest = 0;
+    
+    for (uint16_t slot = 1; slot <= SHIZGlyphMax; slot++) {
+        uint32_t const last_used = _glyphs[slot - 1].last_used;
+        
+        if (last_used < _frame &&
+            (oldest == 0 || last_used < _glyphs[oldest - 1].last_used)) {
+            oldest = slot;
+        }
+    }
+    
+    if (oldest != 0 && _glyphs[oldest - 1].resource_id != SHIZResourceInvalid) {
+        z_truetype__unlink(oldest);
+    }
+    
+    return oldest;
+}
+
+static
+uint16_t
+z_truetype__bucket(uint32_t const resource_id,
+                   uint16_t const size,
+                   uint32_t const codepoint)
+{
+    uint32_t hash = codepoint * 2654435761u;
+    
+    hash ^= ((uint32_t)size * 3266489917u) ^ (resource_id * 2246822519u);
+    
+    return (uint16_t)((hash >> 16) & (SHIZGlyphBucketCount - 1));
+}
+
+static
+void
+z_truetype__unlink(uint16_t const slot)
+{
+    SHIZGlyph const * const glyph = &_glyphs[slot - 1];
+    
+    uint16_t * link = &_buckets[z_truetype__bucket(glyph->resource_id,
+                                                   glyph->size,
+                                                   glyph->codepoint)];
+    
+    while (*link != 0) {
+        if (*link == slot) {
+            *link = glyph->next;
+            
+            break;
+        }
+        
+        link = &_glyphs[*link - 1].next;
+    }
+}
+
+static
+bool
+z_truetype__place(SHIZGlyph * const glyph,
+                  SHIZTrueTypeFace const * const face,
+                  float const scale)
+{
+    if (glyph->shelf != 0) {
+        _atlas.shelves[glyph->shelf - 1].last_used = _frame;
+        
+        return true;
+    }
+    
+    uint16_t const width = (uint16_t)glyph->source.size.width;
+    uint16_t const height = (uint16_t)glyph->source.size.height;
+    
+    uint16_t const padded_width = width + (SHIZGlyphPadding * 2);
+    uint16_t const padded_height = height + (SHIZGlyphPadding * 2);
+    
+    uint16_t x, y;
+    
+    uint8_t const shelf = z_truetype__allocate(padded_width, padded_height,
+                                               &x, &y);
+    
+    if (shelf == 0) {
+        return false;
+    }
+    
+    // the padding is uploaded too, so that nothing left behind by an
+    // evicted glyph can bleed into this one
+    memset(_bitmap, 0, (size_t)padded_width * padded_height);
+    
+    // the atlas has its first row at the bottom, so rasterize upside down;
+    // i.e. starting from the last row and stepping backwards
+    uint8_t * const last_row = _bitmap +
+        ((padded_height - 1 - SHIZGlyphPadding) * padded_width) +
+        SHIZGlyphPadding;
+    
+    z_ttf__render_glyph(&face->info, glyph->index, scale,
+                     last_row, width, height, -padded_width);
+    
+    SHIZResourceImage const * const atlas = z_res__image(_atlas.resource_id);
+    
+    if (atlas == NULL ||
+        !z_gfx__update_texture(atlas,
+                               x, atlas->height - y - padded_height,
+                               padded_width, padded_height,
+                               1, _bitmap)) {
+        return false;
+    }
+    
+    glyph->source.origin = SHIZVector2Make(x + SHIZGlyphPadding,
+                                           y + SHIZGlyphPadding);
+    glyph->shelf = shelf;
+    
+    _atlas.shelves[shelf - 1].last_used = _frame;
+    
+    return true;
+}
+
+static
+uint8_t
+z_truetype__allocate(uint16_t const width,
+                     uint16_t const height,
+                     uint16_t * const x,
+                     uint16_t * const y)
+{
+    uint16_t const shelf_height =
+        ((height + SHIZGlyphShelfGranularity - 1) / SHIZGlyphShelfGranularity) *
+        SHIZGlyphShelfGranularity;
+    
+    uint8_t best = 0;
+    
+    // find the lowest shelf that fits; shelves much taller than the glyph
+    // are skipped, so that small text does not take up tall rows
+    for (uint8_t shelf = 1; shelf <= _atlas.shelf_count; shelf++) {
+        SHIZGlyphShelf const * const candidate = &_atlas.shelves[shelf - 1];
+        
+        if (candidate->height >= height &&
+            candidate->height <= shelf_height + (shelf_height / 2) &&
+            candidate->used_width + width <= SHIZGlyphAtlasSize &&
+            (best == 0 || candidate->height < _atlas.shelves[best - 1].height)) {
+            best = shelf;
+        }
+    }
+    
+    if (best == 0 &&
+        _atlas.shelf_count < SHIZGlyphShelfMax &&
+        _atlas.used_height + shelf_height <= SHIZGlyphAtlasSize) {
+        SHIZGlyphShelf * const shelf = &_atlas.shelves[_atlas.shelf_count];
+        
+        shelf->y = _atlas.used_height;
+        shelf->height = shelf_height;
+        shelf->used_width = 0;
+        shelf->last_used = 0;
+        
+        _atlas.used_height += shelf_height;
+        _atlas.shelf_count += 1;
+        
+        best = (uint8_t)_atlas.shelf_count;
+    }
+    
+    if (best == 0) {
+        // the atlas is full; clear the least recently used shelf that fits,
+        // as long as none of its glyphs were used during this frame
+        for (uint8_t shelf = 1; shelf <= _atlas.shelf_count; shelf++) {
+            SHIZGlyphShelf const * const candidate = &_atlas.shelves[shelf - 1];
+            
+            if (candidate->height >= height &&
+                candidate->last_used < _frame &&
+                (best == 0 || candidate->last_used < _atlas.shelves[best - 1].last_used)) {
+                best = shelf;
+            }
+        }
+        
+        if (best == 0) {
+            return 0;
+        }
+        
+        z_truetype__evict_shelf(best);
+    }
+    
+    SHIZGlyphShelf * const shelf = &_atlas.shelves[best - 1];
+    
+    *x = shelf->used_width;
+    *y = shelf->y;
+    
+    shelf->used_width += width;
+    
+    return best;
+}
+
+static
+void
+z_truetype__evict_shelf(uint8_t const shelf)
+{
+    for (uint16_t slot = 1; slot <= _glyph_count; slot++) {
+        SHIZGlyph * const glyph = &_glyphs[slot - 1];
+        
+        if (glyph->shelf == shelf) {
+            // keep the metrics; the glyph is rasterized again if drawn
+            glyph->shelf = 0;
+        }
+    }
+    
+    _atlas.shelves[shelf - 1].used_width = 0;
+}
+
+static
+uint16_t
+z_truetype__size(float const size)
+{
+    if (size < 1) {
+        return 0;
+    }
+    
+    // glyphs are cached per whole pixel size
+    uint16_t const pixels = (uint16_t)floorf(size + 0.5f);
+    
+    if (pixels > SHIZTrueTypeFontSizeMax) {
+        return SHIZTrueTypeFontSizeMax;
+    }
+    
+    return pixels;
+}
+
+static
+uint32_t
+z_truetype__decode(char const * const text,
+                   uint32_t * const length)
+{
+    unsigned char const * const s = (unsigned char const *)text;
+    
+    if (s[0] < 0x80) {
+        *length = 1;
+        
+        return s[0];
+    }
+    
+    uint32_t count;
+    uint32_t codepoint;
+    
+    if ((s[0] & 0xe0) == 0xc0) {
+        count = 2;
+        codepoint = s[0] & 0x1f;
+    } else if ((s[0] & 0xf0) == 0xe0) {
+        count = 3;
+        codepoint = s[0] & 0x0f;
+    } else if ((s[0] & 0xf8) == 0xf0) {
+        count = 4;
+        codepoint = s[0] & 0x07;
+    } else {
+        *length = 1;
+        
+        return SHIZGlyphReplacementCharacter;
+    }
+    
+    for (uint32_t i = 1; i < count; i++) {
+        // a terminator is never a continuation byte, so this never reads
+        // past the end of the string
+        if ((s[i] & 0xc0) != 0x80) {
+            *length = i;
+            
+            return SHIZGlyphReplacementCharacter;
+        }
+        
+        codepoint = (codepoint << 6) | (s[i] & 0x3f);
+    }
+    
+    *length = count;
+    
+    return codepoint;
+}
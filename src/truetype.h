@@ -0,0 +1,67 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t, uint32_t
+
+#include <SHIZEN/ztype.h> // SHIZTrueTypeFont, SHIZSize, SHIZVector2, SHIZColor
+#include <SHIZEN/zlayer.h> // SHIZLayer
+
+#include "res.h" // SHIZResourceFont
+
+/**
+ * The largest size (in pixels) that text can be drawn at.
+ */
+#define SHIZTrueTypeFontSizeMax 128
+
+/**
+ * @brief Parse a loaded font file.
+ *
+ * The face takes ownership of the data, which is released when the face is
+ * destroyed.
+ */
+bool z_truetype__create_face(SHIZResourceFont *, uint8_t * data, uint32_t length);
+/**
+ * @brief Release a face and remove any of its glyphs from the cache.
+ */
+bool z_truetype__destroy_face(SHIZResourceFont *);
+
+/**
+ * @brief Release the glyph cache and its atlas.
+ */
+void z_truetype__kill(void);
+
+/**
+ * @brief Begin a new frame.
+ *
+ * Glyphs used during the current frame are never evicted from the atlas, so
+ * that characters already queued for drawing keep their pixels.
+ */
+void z_truetype__reset(void);
+
+SHIZSize const z_truetype__measure_text(SHIZTrueTypeFont font,
+                                        char const * text);
+
+/**
+ * @brief Draw text from the glyph atlas.
+ *
+ * Glyphs are rasterized the first time they are drawn at a size, and are
+ * then drawn from the atlas for as long as they stay in use. Because every
+ * font and size shares the atlas, all text is drawn from the same texture.
+ */
+SHIZSize const z_truetype__draw_text(SHIZTrueTypeFont font,
+                                     char const * text,
+                                     SHIZVector2 origin,
+                                     SHIZSpriteFontAlignment alignment,
+                                     SHIZColor tint,
+                                     SHIZLayer layer);
@@ -0,0 +1,917 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#include "ttf.h"
+
+#include <stdlib.h> // calloc, malloc, free
+#include <string.h> // memset, memcmp
+#include <math.h> // floorf, ceilf, fabsf, sqrtf
+
+// only what is needed to rasterize glyphs of a TrueType font into 8-bit
+// coverage bitmaps is supported; i.e. no CFF outlines, no GPOS kerning,
+// no hinting and no composite glyphs positioned by matching points
+
+/**
+ * The max number of nested components in a composite glyph.
+ */
+#define SHIZTrueTypeMaxComponentDepth 8
+/**
+ * The max number of lines that a curve is flattened into.
+ */
+#define SHIZTrueTypeMaxCurveSegments 32
+
+/**
+ * @brief Represents the signed area covered by an outline in each pixel.
+ *
+ * Summing the accumulation along a row yields the coverage of each pixel;
+ * non-zero winding is approximated by clamping it.
+ */
+typedef struct SHIZTrueTypeRaster {
+    float * accumulation;
+    int width;
+    int height;
+    int stride;
+} SHIZTrueTypeRaster;
+
+/**
+ * @brief Represents a mapping from font units to bitmap pixels;
+ *        x' = a*x + c*y + e, y' = b*x + d*y + f.
+ */
+typedef struct SHIZTrueTypeTransform {
+    float a, b, c, d, e, f;
+} SHIZTrueTypeTransform;
+
+static
+unsigned char
+z_ttf__u8(SHIZTrueTypeInfo const * const font,
+          uint32_t const offset)
+{
+    if (offset >= font->size) {
+        return 0;
+    }
+    
+    return font->data[offset];
+}
+
+static
+uint16_t
+z_ttf__u16(SHIZTrueTypeInfo const * const font,
+           uint32_t const offset)
+{
+    if (font->size < 2 || offset > font->size - 2) {
+        return 0;
+    }
+    
+    return (uint16_t)((font->data[offset] << 8) | font->data[offset + 1]);
+}
+
+static
+int16_t
+z_ttf__i16(SHIZTrueTypeInfo const * const font,
+           uint32_t const offset)
+{
+    return (int16_t)z_ttf__u16(font, offset);
+}
+
+static
+uint32_t
+z_ttf__u32(SHIZTrueTypeInfo const * const font,
+           uint32_t const offset)
+{
+    return ((uint32_t)z_ttf__u16(font, offset) << 16) | z_ttf__u16(font, offset + 2);
+}
+
+static
+float
+z_ttf__f2dot14(SHIZTrueTypeInfo const * const font,
+               uint32_t const offset)
+{
+    return z_ttf__i16(font, offset) / 16384.0f;
+}
+
+static
+uint32_t
+z_ttf__find_table(SHIZTrueTypeInfo const * const font,
+                  char const * const tag)
+{
+    uint16_t const num_tables = z_ttf__u16(font, 4);
+    
+    for (uint16_t i = 0; i < num_tables; i++) {
+        uint32_t const record = 12 + (16 * (uint32_t)i);
+        
+        if (record + 16 > font->size) {
+            break;
+        }
+        
+        if (memcmp(font->data + record, tag, 4) == 0) {
+            uint32_t const offset = z_ttf__u32(font, record + 8);
+            uint32_t const length = z_ttf__u32(font, record + 12);
+            
+            if (offset == 0 || offset > font->size ||
+                length > font->size - offset) {
+                return 0;
+            }
+            
+            return offset;
+        }
+    }
+    
+    return 0;
+}
+
+bool
+z_ttf__init(SHIZTrueTypeInfo * const font,
+            unsigned char const * const data,
+            uint32_t const size)
+{
+    memset(font, 0, sizeof(SHIZTrueTypeInfo));
+    
+    font->data = data;
+    font->size = size;
+    
+    if (data == NULL || size < 12) {
+        return false;
+    }
+    
+    uint32_t const head = z_ttf__find_table(font, "head");
+    uint32_t const hhea = z_ttf__find_table(font, "hhea");
+    uint32_t const maxp = z_ttf__find_table(font, "maxp");
+    uint32_t const cmap = z_ttf__find_table(font, "cmap");
+    
+    font->loca = z_ttf__find_table(font, "loca");
+    font->glyf = z_ttf__find_table(font, "glyf");
+    font->hmtx = z_ttf__find_table(font, "hmtx");
+    font->kern = z_ttf__find_table(font, "kern");
+    
+    if (!head || !hhea || !maxp || !cmap ||
+        !font->loca || !font->glyf || !font->hmtx) {
+        return false;
+    }
+    
+    font->units_per_em = z_ttf__u16(font, head + 18);
+    font->index_to_loc_format = z_ttf__i16(font, head + 50);
+    font->num_glyphs = z_ttf__u16(font, maxp + 4);
+    
+    font->ascent = z_ttf__i16(font, hhea + 4);
+    font->descent = z_ttf__i16(font, hhea + 6);
+    font->line_gap = z_ttf__i16(font, hhea + 8);
+    font->num_hmetrics = z_ttf__u16(font, hhea + 34);
+    
+    // descent is below ascent, or every scale (and glyph box) is flipped
+    if (font->num_hmetrics == 0 || font->ascent <= font->descent) {
+        return false;
+    }
+    
+    uint16_t const num_subtables = z_ttf__u16(font, cmap + 2);
+    
+    for (uint16_t i = 0; i < num_subtables; i++) {
+        uint32_t const record = cmap + 4 + (8 * (uint32_t)i);
+        uint16_t const platform = z_ttf__u16(font, record);
+        uint16_t const encoding = z_ttf__u16(font, record + 2);
+        uint32_t const subtable = cmap + z_ttf__u32(font, record + 4);
+        uint16_t const format = z_ttf__u16(font, subtable);
+        
+        bool const is_unicode = platform == 0 ||
+            (platform == 3 && (encoding == 1 || encoding == 10));
+        
+        if (!is_unicode) {
+            continue;
+        }
+        
+        if (format == 12) {
+            // prefer the full unicode range over the basic multilingual plane
+            font->cmap = subtable;
+            font->cmap_format = 12;
+            
+            break;
+        } else if (format == 4 && font->cmap == 0) {
+            font->cmap = subtable;
+            font->cmap_format = 4;
+        }
+    }
+    
+    return font->cmap != 0;
+}
+
+int
+z_ttf__find_glyph(SHIZTrueTypeInfo const * const font,
+                  uint32_t const codepoint)
+{
+    uint32_t const cmap = font->cmap;
+    
+    int glyph = 0;
+    
+    if (font->cmap_format == 4) {
+        if (codepoint > 0xffff) {
+            return 0;
+        }
+        
+        uint32_t const segments = z_ttf__u16(font, cmap + 6) / 2;
+        uint32_t const end_codes = cmap + 14;
+        uint32_t const start_codes = end_codes + (segments * 2) + 2;
+        uint32_t const id_deltas = start_codes + (segments * 2);
+        uint32_t const id_range_offsets = id_deltas + (segments * 2);
+        
+        uint32_t lo = 0;
+        uint32_t hi = segments;
+        
+        while (lo < hi) {
+            uint32_t const mid = (lo + hi) / 2;
+            
+            if (codepoint > z_ttf__u16(font, end_codes + (mid * 2))) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        
+        if (lo >= segments) {
+            return 0;
+        }
+        
+        uint32_t const start = z_ttf__u16(font, start_codes + (lo * 2));
+        
+        if (codepoint < start) {
+            return 0;
+        }
+        
+        uint16_t const delta = z_ttf__u16(font, id_deltas + (lo * 2));
+        uint16_t const range_offset = z_ttf__u16(font, id_range_offsets + (lo * 2));
+        
+        if (range_offset == 0) {
+            glyph = (int)((codepoint + delta) & 0xffff);
+        } else {
+            uint16_t const index =
+                z_ttf__u16(font, id_range_offsets + (lo * 2) + range_offset +
+                         ((codepoint - start) * 2));
+            
+            glyph = index == 0 ? 0 : (int)((index + delta) & 0xffff);
+        }
+    } else if (font->cmap_format == 12) {
+        uint32_t const groups = z_ttf__u32(font, cmap + 12);
+        
+        uint32_t lo = 0;
+        uint32_t hi = groups;
+        
+        while (lo < hi) {
+            uint32_t const mid = (lo + hi) / 2;
+            uint32_t const group = cmap + 16 + (mid * 12);
+            
+            if (codepoint < z_ttf__u32(font, group)) {
+                hi = mid;
+            } else if (codepoint > z_ttf__u32(font, group + 4)) {
+                lo = mid + 1;
+            } else {
+                glyph = (int)(z_ttf__u32(font, group + 8) +
+                              (codepoint - z_ttf__u32(font, group)));
+                
+                break;
+            }
+        }
+    }
+    
+    if (glyph < 0 || glyph >= font->num_glyphs) {
+        return 0;
+    }
+    
+    return glyph;
+}
+
+float
+z_ttf__scale_for_pixel_height(SHIZTrueTypeInfo const * const font,
+                              float const height)
+{
+    return height / (float)(font->ascent - font->descent);
+}
+
+void
+z_ttf__get_vmetrics(SHIZTrueTypeInfo const * const font,
+                    int * const ascent,
+                    int * const descent,
+                    int * const line_gap)
+{
+    if (ascent) {
+        *ascent = font->ascent;
+    }
+    
+    if (descent) {
+        *descent = font->descent;
+    }
+    
+    if (line_gap) {
+        *line_gap = font->line_gap;
+    }
+}
+
+void
+z_ttf__get_hmetrics(SHIZTrueTypeInfo const * const font,
+                    int const glyph,
+                    int * const advance,
+                    int * const left_side_bearing)
+{
+    uint32_t const hmtx = font->hmtx;
+    uint32_t const last = (uint32_t)font->num_hmetrics - 1;
+    
+    if (glyph < font->num_hmetrics) {
+        if (advance) {
+            *advance = z_ttf__u16(font, hmtx + (4 * (uint32_t)glyph));
+        }
+        
+        if (left_side_bearing) {
+            *left_side_bearing = z_ttf__i16(font, hmtx + (4 * (uint32_t)glyph) + 2);
+        }
+    } else {
+        // monospaced tail; only the bearing is stored for remaining glyphs
+        if (advance) {
+            *advance = z_ttf__u16(font, hmtx + (4 * last));
+        }
+        
+        if (left_side_bearing) {
+            *left_side_bearing =
+                z_ttf__i16(font, hmtx + (4 * (last + 1)) +
+                         (2 * ((uint32_t)glyph - (last + 1))));
+        }
+    }
+}
+
+int
+z_ttf__get_kerning(SHIZTrueTypeInfo const * const font,
+                   int const glyph1,
+                   int const glyph2)
+{
+    uint32_t const kern = font->kern;
+    
+    if (kern == 0) {
+        return 0;
+    }
+    
+    // only the first subtable is considered, and only if it is a
+    // horizontal, format 0 table
+    if (z_ttf__u16(font, kern + 2) < 1 || z_ttf__u16(font, kern + 8) != 1) {
+        return 0;
+    }
+    
+    uint32_t const pairs = z_ttf__u16(font, kern + 10);
+    uint32_t const needle = ((uint32_t)glyph1 << 16) | (uint32_t)glyph2;
+    
+    uint32_t lo = 0;
+    uint32_t hi = pairs;
+    
+    while (lo < hi) {
+        uint32_t const mid = (lo + hi) / 2;
+        uint32_t const pair = kern + 18 + (mid * 6);
+        uint32_t const key = z_ttf__u32(font, pair);
+        
+        if (needle < key) {
+            hi = mid;
+        } else if (needle > key) {
+            lo = mid + 1;
+        } else {
+            return z_ttf__i16(font, pair + 4);
+        }
+    }
+    
+    return 0;
+}
+
+static
+uint32_t
+z_ttf__glyph_offset(SHIZTrueTypeInfo const * const font,
+                    int const glyph)
+{
+    if (glyph < 0 || glyph >= font->num_glyphs) {
+        return 0;
+    }
+    
+    uint32_t start;
+    uint32_t end;
+    
+    if (font->index_to_loc_format == 0) {
+        start = font->glyf + (z_ttf__u16(font, font->loca + ((uint32_t)glyph * 2)) * 2u);
+        end = font->glyf + (z_ttf__u16(font, font->loca + ((uint32_t)glyph * 2) + 2) * 2u);
+    } else {
+        start = font->glyf + z_ttf__u32(font, font->loca + ((uint32_t)glyph * 4));
+        end = font->glyf + z_ttf__u32(font, font->loca + ((uint32_t)glyph * 4) + 4);
+    }
+    
+    if (start >= end || end > font->size) {
+        // no outline (e.g. whitespace)
+        return 0;
+    }
+    
+    return start;
+}
+
+bool
+z_ttf__get_glyph_box(SHIZTrueTypeInfo const * const font,
+                     int const glyph,
+                     float const scale,
+                     int * const x0,
+                     int * const y0,
+                     int * const x1,
+                     int * const y1)
+{
+    uint32_t const offset = z_ttf__glyph_offset(font, glyph);
+    
+    if (offset == 0) {
+        return false;
+    }
+    
+    int const x_min = z_ttf__i16(font, offset + 2);
+    int const y_min = z_ttf__i16(font, offset + 4);
+    int const x_max = z_ttf__i16(font, offset + 6);
+    int const y_max = z_ttf__i16(font, offset + 8);
+    
+    if (x_min >= x_max || y_min >= y_max) {
+        return false;
+    }
+    
+    // flip vertically; bitmaps have their first row at the top
+    *x0 = (int)floorf((float)x_min * scale);
+    *y0 = (int)floorf((float)-y_max * scale);
+    *x1 = (int)ceilf((float)x_max * scale);
+    *y1 = (int)ceilf((float)-y_min * scale);
+    
+    return true;
+}
+
+static
+float
+z_ttf__clamp(float const value,
+             float const max)
+{
+    // not a number (e.g. from a corrupted transform) clamps to 0 as well
+    if (!(value > 0)) {
+        return 0;
+    }
+    
+    return value > max ? max : value;
+}
+
+static
+void
+z_ttf__line(SHIZTrueTypeRaster * const raster,
+            float x0,
+            float y0,
+            float x1,
+            float y1)
+{
+    // accumulate the signed area covered by the line in each pixel it
+    // crosses; summing the accumulation along a row yields coverage
+    if (!(y0 < y1) && !(y0 > y1)) {
+        // horizontal, or not a number
+        return;
+    }
+    
+    float direction = 1;
+    
+    if (y0 > y1) {
+        float const x = x0;
+        float const y = y0;
+        
+        x0 = x1;
+        y0 = y1;
+        x1 = x;
+        y1 = y;
+        
+        direction = -1;
+    }
+    
+    if (y1 <= 0 || y0 >= raster->height) {
+        return;
+    }
+    
+    float const w = (float)raster->width;
+    
+    x0 = z_ttf__clamp(x0, w);
+    x1 = z_ttf__clamp(x1, w);
+    
+    float const dxdy = (x1 - x0) / (y1 - y0);
+    
+    float x = x0;
+    
+    if (y0 < 0) {
+        x = z_ttf__clamp(x - (y0 * dxdy), w);
+    }
+    
+    int const y_start = y0 < 0 ? 0 : (int)y0;
+    int const y_end = y1 > raster->height ? raster->height : (int)ceilf(y1);
+    
+    for (int y = y_start; y < y_end; y++) {
+        float * const row = raster->accumulation + (y * raster->stride);
+        
+        float const dy = (((float)(y + 1) < y1) ? (float)(y + 1) : y1) -
+                         (((float)y > y0) ? (float)y : y0);
+        // stepping along the line drifts, however slightly; unless kept
+        // within the row, a line along the left edge can step to -1
+        // (before the row) and one along the right edge past width + 1
+        float const x_next = z_ttf__clamp(x + (dxdy * dy), w);
+        float const d = dy * direction;
+        
+        float const xa = x < x_next ? x : x_next;
+        float const xb = x < x_next ? x_next : x;
+        
+        float const xa_floor = floorf(xa);
+        float const xb_ceil = ceilf(xb);
+        
+        int const xai = (int)xa_floor;
+        int const xbi = (int)xb_ceil;
+        
+        if (xbi <= xai + 1) {
+            float const xm = (0.5f * (x + x_next)) - xa_floor;
+            
+            row[xai] += d - (d * xm);
+            row[xai + 1] += d * xm;
+        } else {
+            float const s = 1.0f / (xb - xa);
+            float const xaf = xa - xa_floor;
+            float const a0 = 0.5f * s * (1 - xaf) * (1 - xaf);
+            float const xbf = xb - xb_ceil + 1;
+            float const am = 0.5f * s * xbf * xbf;
+            
+            row[xai] += d * a0;
+            
+            if (xbi == xai + 2) {
+                row[xai + 1] += d * (1 - a0 - am);
+            } else {
+                float const a1 = s * (1.5f - xaf);
+                
+                row[xai + 1] += d * (a1 - a0);
+                
+                for (int xi = xai + 2; xi < xbi - 1; xi++) {
+                    row[xi] += d * s;
+                }
+                
+                float const a2 = a1 + ((float)(xbi - xai - 3) * s);
+                
+                row[xbi - 1] += d * (1 - a2 - am);
+            }
+            
+            row[xbi] += d * am;
+        }
+        
+        x = x_next;
+    }
+}
+
+static
+void
+z_ttf__quad(SHIZTrueTypeRaster * const raster,
+            float const x0,
+            float const y0,
+            float const x1,
+            float const y1,
+            float const x2,
+            float const y2)
+{
+    float const dx = x0 - (2 * x1) + x2;
+    float const dy = y0 - (2 * y1) + y2;
+    float const deviation = (dx * dx) + (dy * dy);
+    
+    if (deviation < 0.333f) {
+        z_ttf__line(raster, x0, y0, x2, y2);
+        
+        return;
+    }
+    
+    int segments = 1 + (int)floorf(sqrtf(sqrtf(3 * deviation)));
+    
+    if (segments > SHIZTrueTypeMaxCurveSegments) {
+        segments = SHIZTrueTypeMaxCurveSegments;
+    }
+    
+    float px = x0;
+    float py = y0;
+    
+    for (int i = 1; i <= segments; i++) {
+        float const t = (float)i / (float)segments;
+        float const mt = 1 - t;
+        
+        float const x = (mt * mt * x0) + (2 * t * mt * x1) + (t * t * x2);
+        float const y = (mt * mt * y0) + (2 * t * mt * y1) + (t * t * y2);
+        
+        z_ttf__line(raster, px, py, x, y);
+        
+        px = x;
+        py = y;
+    }
+}
+
+static
+void
+z_ttf__simple_outline(SHIZTrueTypeInfo const * const font,
+                      uint32_t const offset,
+                      int const contours,
+                      SHIZTrueTypeTransform const * const m,
+                      SHIZTrueTypeRaster * const raster)
+{
+    uint32_t const end_points = offset + 10;
+    uint32_t const points = (uint32_t)z_ttf__u16(font, end_points + (2 * ((uint32_t)contours - 1))) + 1;
+    uint32_t const instructions = z_ttf__u16(font, end_points + (2 * (uint32_t)contours));
+    
+    uint32_t p = end_points + (2 * (uint32_t)contours) + 2 + instructions;
+    
+    // coordinates first, so that they are aligned; flags follow
+    float * const xs = malloc(points * ((2 * sizeof(float)) + sizeof(unsigned char)));
+    
+    if (xs == NULL) {
+        return;
+    }
+    
+    float * const ys = xs + points;
+    unsigned char * const flags = (unsigned char *)(ys + points);
+    
+    for (uint32_t i = 0; i < points; ) {
+        unsigned char const flag = z_ttf__u8(font, p++);
+        
+        flags[i++] = flag;
+        
+        if (flag & 8) {
+            unsigned char repeat = z_ttf__u8(font, p++);
+            
+            while (repeat-- > 0 && i < points) {
+                flags[i++] = flag;
+            }
+        }
+    }
+    
+    int value = 0;
+    
+    for (uint32_t i = 0; i < points; i++) {
+        if (flags[i] & 2) {
+            int const delta = z_ttf__u8(font, p++);
+            
+            value += (flags[i] & 16) ? delta : -delta;
+        } else if (!(flags[i] & 16)) {
+            value += z_ttf__i16(font, p);
+            
+            p += 2;
+        }
+        
+        xs[i] = (float)value;
+    }
+    
+    value = 0;
+    
+    for (uint32_t i = 0; i < points; i++) {
+        if (flags[i] & 4) {
+            int const delta = z_ttf__u8(font, p++);
+            
+            value += (flags[i] & 32) ? delta : -delta;
+        } else if (!(flags[i] & 32)) {
+            value += z_ttf__i16(font, p);
+            
+            p += 2;
+        }
+        
+        ys[i] = (float)value;
+    }
+    
+    // transform into bitmap space once; midpoints are preserved
+    for (uint32_t i = 0; i < points; i++) {
+        float const x = xs[i];
+        float const y = ys[i];
+        
+        xs[i] = (m->a * x) + (m->c * y) + m->e;
+        ys[i] = (m->b * x) + (m->d * y) + m->f;
+    }
+    
+    uint32_t start = 0;
+    
+    for (int contour = 0; contour < contours; contour++) {
+        uint32_t const end = z_ttf__u16(font, end_points + (2 * (uint32_t)contour));
+        
+        if (end < start || end >= points) {
+            break;
+        }
+        
+        uint32_t const count = end - start + 1;
+        
+        float sx, sy;
+        uint32_t from = start;
+        uint32_t n = count;
+        
+        if (flags[start] & 1) {
+            sx = xs[start];
+            sy = ys[start];
+            
+            from = start + 1;
+            n = count - 1;
+        } else if (flags[end] & 1) {
+            sx = xs[end];
+            sy = ys[end];
+            
+            n = count - 1;
+        } else {
+            // both ends are off-curve; start at the implied point between
+            sx = (xs[start] + xs[end]) / 2;
+            sy = (ys[start] + ys[end]) / 2;
+        }
+        
+        float cx = sx;
+        float cy = sy;
+        float qx = 0;
+        float qy = 0;
+        
+        bool has_control = false;
+        
+        for (uint32_t i = from; i < from + n; i++) {
+            float const x = xs[i];
+            float const y = ys[i];
+            
+            if (flags[i] & 1) {
+                if (has_control) {
+                    z_ttf__quad(raster, cx, cy, qx, qy, x, y);
+                    
+                    has_control = false;
+                } else {
+                    z_ttf__line(raster, cx, cy, x, y);
+                }
+                
+                cx = x;
+                cy = y;
+            } else {
+                if (has_control) {
+                    // two consecutive off-curve points imply an on-curve
+                    // point between them
+                    float const mx = (qx + x) / 2;
+                    float const my = (qy + y) / 2;
+                    
+                    z_ttf__quad(raster, cx, cy, qx, qy, mx, my);
+                    
+                    cx = mx;
+                    cy = my;
+                }
+                
+                qx = x;
+                qy = y;
+                
+                has_control = true;
+            }
+        }
+        
+        if (has_control) {
+            z_ttf__quad(raster, cx, cy, qx, qy, sx, sy);
+        } else {
+            z_ttf__line(raster, cx, cy, sx, sy);
+        }
+        
+        start = end + 1;
+    }
+    
+    free(xs);
+}
+
+static
+void
+z_ttf__outline(SHIZTrueTypeInfo const * const font,
+               int const glyph,
+               SHIZTrueTypeTransform const * const m,
+               SHIZTrueTypeRaster * const raster,
+               int const depth)
+{
+    uint32_t const offset = z_ttf__glyph_offset(font, glyph);
+    
+    if (offset == 0 || depth > SHIZTrueTypeMaxComponentDepth) {
+        return;
+    }
+    
+    int const contours = z_ttf__i16(font, offset);
+    
+    if (contours > 0) {
+        z_ttf__simple_outline(font, offset, contours, m, raster);
+        
+        return;
+    }
+    
+    if (contours == 0) {
+        return;
+    }
+    
+    uint32_t p = offset + 10;
+    uint16_t flags;
+    
+    do {
+        flags = z_ttf__u16(font, p);
+        
+        int const component = z_ttf__u16(font, p + 2);
+        
+        p += 4;
+        
+        float ox;
+        float oy;
+        
+        if (flags & 1) {
+            ox = z_ttf__i16(font, p);
+            oy = z_ttf__i16(font, p + 2);
+            
+            p += 4;
+        } else {
+            ox = (signed char)z_ttf__u8(font, p);
+            oy = (signed char)z_ttf__u8(font, p + 1);
+            
+            p += 2;
+        }
+        
+        if (!(flags & 2)) {
+            // components positioned by matching points are not supported
+            ox = 0;
+            oy = 0;
+        }
+        
+        float m0 = 1, m1 = 0, m2 = 0, m3 = 1;
+        
+        if (flags & 8) {
+            m0 = m3 = z_ttf__f2dot14(font, p);
+            
+            p += 2;
+        } else if (flags & 0x40) {
+            m0 = z_ttf__f2dot14(font, p);
+            m3 = z_ttf__f2dot14(font, p + 2);
+            
+            p += 4;
+        } else if (flags & 0x80) {
+            m0 = z_ttf__f2dot14(font, p);
+            m1 = z_ttf__f2dot14(font, p + 2);
+            m2 = z_ttf__f2dot14(font, p + 4);
+            m3 = z_ttf__f2dot14(font, p + 6);
+            
+            p += 8;
+        }
+        
+        SHIZTrueTypeTransform const combined = {
+            .a = (m->a * m0) + (m->c * m1),
+            .b = (m->b * m0) + (m->d * m1),
+            .c = (m->a * m2) + (m->c * m3),
+            .d = (m->b * m2) + (m->d * m3),
+            .e = (m->a * ox) + (m->c * oy) + m->e,
+            .f = (m->b * ox) + (m->d * oy) + m->f
+        };
+        
+        z_ttf__outline(font, component, &combined, raster, depth + 1);
+    } while ((flags & 0x20) && p < font->size);
+}
+
+bool
+z_ttf__render_glyph(SHIZTrueTypeInfo const * const font,
+                    int const glyph,
+                    float const scale,
+                    unsigned char * const output,
+                    int const width,
+                    int const height,
+                    int const stride)
+{
+    int x0, y0, x1, y1;
+    
+    if (width <= 0 || height <= 0 ||
+        !z_ttf__get_glyph_box(font, glyph, scale, &x0, &y0, &x1, &y1)) {
+        return false;
+    }
+    
+    SHIZTrueTypeRaster raster;
+    
+    // lines touching the right edge accumulate one pixel past it
+    raster.width = width;
+    raster.height = height;
+    raster.stride = width + 2;
+    raster.accumulation = calloc((size_t)(raster.stride * height), sizeof(float));
+    
+    if (raster.accumulation == NULL) {
+        return false;
+    }
+    
+    SHIZTrueTypeTransform const m = {
+        .a = scale, .b = 0,
+        .c = 0, .d = -scale,
+        .e = (float)-x0, .f = (float)-y0
+    };
+    
+    z_ttf__outline(font, glyph, &m, &raster, 0);
+    
+    for (int y = 0; y < height; y++) {
+        float const * const row = raster.accumulation + (y * raster.stride);
+        
+        float coverage = 0;
+        
+        for (int x = 0; x < width; x++) {
+            coverage += row[x];
+            
+            float const alpha = fabsf(coverage);
+            
+            output[(y * stride) + x] =
+                (unsigned char)(((alpha > 1 ? 1 : alpha) * 255.0f) + 0.5f);
+        }
+    }
+    
+    free(raster.accumulation);
+    
+    return true;
+}
@@ -0,0 +1,97 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint32_t
+
+/**
+ * @brief Represents the tables of a TrueType font that glyphs are read from.
+ *
+ * The font data is never copied; it must stay in memory for as long as the
+ * font is used.
+ */
+typedef struct SHIZTrueTypeInfo {
+    unsigned char const * data;
+    uint32_t size;
+    /** The offsets of tables (or subtables) in the data; 0 if not present */
+    uint32_t loca;
+    uint32_t glyf;
+    uint32_t hmtx;
+    uint32_t kern;
+    uint32_t cmap;
+    int cmap_format;
+    int num_glyphs;
+    int num_hmetrics;
+    int index_to_loc_format;
+    int units_per_em;
+    int ascent;
+    int descent;
+    int line_gap;
+} SHIZTrueTypeInfo;
+
+/**
+ * @brief Find the tables of a TrueType font.
+ *
+ * Only Unicode character maps (formats 4 and 12), simple and composite
+ * glyph outlines, horizontal metrics and format 0 pair kerning are read.
+ *
+ * @return `true` if the data is a supported TrueType font, `false` otherwise
+ */
+bool z_ttf__init(SHIZTrueTypeInfo *, unsigned char const * data, uint32_t size);
+
+/**
+ * @brief Find the glyph of a codepoint.
+ *
+ * @return The index of the glyph, or 0 (the missing glyph) if there is none
+ */
+int z_ttf__find_glyph(SHIZTrueTypeInfo const *, uint32_t codepoint);
+
+/**
+ * @brief Determine the scale that maps the distance from descent to ascent to
+ *        a height (in pixels).
+ */
+float z_ttf__scale_for_pixel_height(SHIZTrueTypeInfo const *, float height);
+
+/**
+ * @brief Get the vertical metrics (unscaled) of a font; ascent is above the
+ *        baseline (positive), descent is below (negative).
+ */
+void z_ttf__get_vmetrics(SHIZTrueTypeInfo const *, int * ascent, int * descent, int * line_gap);
+/**
+ * @brief Get the horizontal metrics (unscaled) of a glyph; the advance is the
+ *        distance to the next glyph on the line.
+ */
+void z_ttf__get_hmetrics(SHIZTrueTypeInfo const *, int glyph, int * advance, int * left_side_bearing);
+/**
+ * @brief Get the adjustment (unscaled) to the advance of a glyph when
+ *        followed by another.
+ */
+int z_ttf__get_kerning(SHIZTrueTypeInfo const *, int glyph1, int glyph2);
+
+/**
+ * @brief Get the box (in pixels, y down, relative to the origin on the
+ *        baseline) that encloses the bitmap of a glyph.
+ *
+ * @return `true` if the glyph has an outline, `false` otherwise
+ */
+bool z_ttf__get_glyph_box(SHIZTrueTypeInfo const *, int glyph, float scale, int * x0, int * y0, int * x1, int * y1);
+/**
+ * @brief Rasterize a glyph into a bitmap the size of its glyph box.
+ *
+ * Each pixel is the exact area covered by the outline; the first row is the
+ * top of the glyph.
+ *
+ * @return `true` if the glyph was rasterized, `false` if it has no outline or
+ *         memory could not be allocated
+ */
+bool z_ttf__render_glyph(SHIZTrueTypeInfo const *, int glyph, float scale, unsigned char * output, int width, int height, int stride);
@@ -0,0 +1,294 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#if defined(__linux__) && !defined(_XOPEN_SOURCE)
+ #define _XOPEN_SOURCE 700 // read, close
+#endif
+
+#include "watch.h"
+
+#include <stdlib.h> // NULL, realloc, free
+#include <string.h> // strcmp, strrchr, strlen, memcpy
+#include <limits.h> // PATH_MAX
+
+#ifdef __linux__
+ #include <sys/inotify.h> // inotify_*
+ #include <unistd.h> // read, close
+#endif
+
+#ifndef PATH_MAX
+ #define PATH_MAX 4096
+#endif
+
+#include "res.h" // SHIZResourceImage, z_res__image, z_res__is_loading
+#include "io.h" // z_io__canonical_path, z_io__warning
+#include "async.h" // z_async__queue_reload
+
+/**
+ * @brief Represents the file of a watched image.
+ */
+typedef struct SHIZWatchedFile {
+    /** The canonical path of the file */
+    char * path;
+    /** The name of the file in its directory; points into the path */
+    char const * name;
+    uint32_t resource_id;
+    /** The watch of the directory of the file */
+    int32_t directory;
+    bool changed;
+} SHIZWatchedFile;
+
+#ifdef __linux__
+static void z_watch__change(int32_t directory, char const * name);
+static void z_watch__reload(void);
+static void z_watch__remove(uint32_t index);
+#endif
+
+static SHIZWatchedFile * _files = NULL;
+static uint32_t _file_count = 0;
+static uint32_t _file_capacity = 0;
+
+static int _descriptor = -1;
+
+bool
+z_watch__start()
+{
+#ifdef __linux__
+    if (_descriptor != -1) {
+        return true;
+    }
+    
+    // never wait for changes; if there are none, reading simply fails
+    _descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    
+    if (_descriptor == -1) {
+        z_io__warning("could not watch files for changes");
+        
+        return false;
+    }
+    
+    return true;
+#else
+    z_io__warning("could not watch files for changes; not supported");
+    
+    return false;
+#endif
+}
+
+void
+z_watch__stop()
+{
+#ifdef __linux__
+    if (_descriptor == -1) {
+        return;
+    }
+    
+    // closing the descriptor removes every watch along with it
+    close(_descriptor);
+    
+    _descriptor = -1;
+    
+    for (uint32_t i = 0; i < _file_count; i++) {
+        free(_files[i].path);
+    }
+    
+    free(_files);
+    
+    _files = NULL;
+    _file_count = 0;
+    _file_capacity = 0;
+#endif
+}
+
+void
+z_watch__add(uint32_t const resource_id,
+             char const * const filename)
+{
+#ifdef __linux__
+    if (_descriptor == -1) {
+        return;
+    }
+    
+    for (uint32_t i = 0; i < _file_count; i++) {
+        if (_files[i].resource_id == resource_id) {
+            return;
+        }
+    }
+    
+    char path[PATH_MAX];
+    
+    z_io__canonical_path(filename, path, PATH_MAX);
+    
+    char * const separator = strrchr(path, '/');
+    
+    if (separator == NULL) {
+        return;
+    }
+    
+    size_t const length = strlen(path);
+    
+    // watch the directory rather than the file itself; most editors save by
+    // replacing the file, which would otherwise end the watch
+    *separator = '\0';
+    
+    int32_t const directory = inotify_add_watch(_descriptor,
+                                                separator == path ? "/" : path,
+                                                IN_CLOSE_WRITE | IN_MOVED_TO);
+    
+    *separator = '/';
+    
+    if (directory == -1) {
+        z_io__warning("could not watch '%s' for changes", filename);
+        
+        return;
+    }
+    
+    if (_file_count == _file_capacity) {
+        uint32_t const capacity = _file_capacity > 0 ? _file_capacity * 2 : 16;
+        
+        SHIZWatchedFile * const files =
+            realloc(_files, capacity * sizeof(SHIZWatchedFile));
+        
+        if (files == NULL) {
+            return;
+        }
+        
+        _files = files;
+        _file_capacity = capacity;
+    }
+    
+    char * const watched_path = malloc(length + 1);
+    
+    if (watched_path == NULL) {
+        return;
+    }
+    
+    memcpy(watched_path, path, length + 1);
+    
+    SHIZWatchedFile * const file = &_files[_file_count];
+    
+    file->path = watched_path;
+    file->name = watched_path + (separator - path) + 1;
+    file->resource_id = resource_id;
+    file->directory = directory;
+    file->changed = false;
+    
+    _file_count += 1;
+#else
+    (void)resource_id;
+    (void)filename;
+#endif
+}
+
+void
+z_watch__process()
+{
+#ifdef __linux__
+    if (_descriptor == -1) {
+        return;
+    }
+    
+    union {
+        struct inotify_event event; // for alignment
+        char bytes[4096];
+    } buffer;
+    
+    bool changed = false;
+    ssize_t length;
+    
+    while ((length = read(_descriptor, buffer.bytes, sizeof(buffer.bytes))) > 0) {
+        char const * event_bytes = buffer.bytes;
+        
+        while (event_bytes < buffer.bytes + length) {
+            struct inotify_event const * const event =
+                (struct inotify_event const *)event_bytes;
+            
+            if (event->len > 0) {
+                z_watch__change(event->wd, event->name);
+                
+                changed = true;
+            }
+            
+            event_bytes += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    
+    if (changed) {
+        // a file is often written more than once when saved; only reload it
+        // once for all of its changes
+        z_watch__reload();
+    }
+#endif
+}
+
+#ifdef __linux__
+static
+void
+z_watch__change(int32_t const directory,
+                char const * const name)
+{
+    for (uint32_t i = 0; i < _file_count; i++) {
+        SHIZWatchedFile * const file = &_files[i];
+        
+        if (file->directory == directory && strcmp(file->name, name) == 0) {
+            file->changed = true;
+        }
+    }
+}
+
+static
+void
+z_watch__reload()
+{
+    uint32_t i = 0;
+    
+    while (i < _file_count) {
+        SHIZWatchedFile * const file = &_files[i];
+        
+        SHIZResourceImage const * const image = z_res__image(file->resource_id);
+        
+        if (image == NULL) {
+            if (!z_res__is_loading(file->resource_id)) {
+                // the image has been unloaded
+                z_watch__remove(i);
+                
+                continue;
+            }
+        } else if (file->changed) {
+            // the texture is replaced once decoded (see z_res__finish_image)
+            if (!z_async__queue_reload(file->resource_id,
+                                       SHIZResourceTypeImage,
+                                       file->path)) {
+                z_io__warning("resource not reloaded ('%s'); could not be queued",
+                              file->path);
+            }
+        }
+        
+        file->changed = false;
+        
+        i += 1;
+    }
+}
+
+static
+void
+z_watch__remove(uint32_t const index)
+{
+    free(_files[index].path);
+    
+    _file_count -= 1;
+    
+    // order does not matter; move the last file into the gap
+    if (index < _file_count) {
+        _files[index] = _files[_file_count];
+    }
+}
+#endif
@@ -0,0 +1,43 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#pragma once
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint32_t
+
+/**
+ * @brief Begin watching the files of images for changes.
+ *
+ * Watching is only supported on Linux (through inotify).
+ *
+ * @return `true` if watching, `false` otherwise
+ */
+bool z_watch__start(void);
+void z_watch__stop(void);
+
+/**
+ * @brief Watch the file of an image that is loaded (or loading).
+ *
+ * The file stops being watched once the image is unloaded. This has no
+ * effect unless watching.
+ */
+void z_watch__add(uint32_t resource_id, char const * filename);
+
+/**
+ * @brief Reload the images whose files have changed since last processed.
+ *
+ * Changed images are decoded by `z_async`, and their textures are replaced
+ * as the results are finished; i.e. spread across frames like any other
+ * background loading. Unless a file has changed, this only polls for
+ * changes without waiting.
+ */
+void z_watch__process(void);
@@ -11,20 +11,26 @@
 
 #include <SHIZEN/zdraw.h>
 
-#include <stdlib.h> // qsort
+#include <stdlib.h> // qsort, free
 #include <math.h> // M_PI, cosf, sinf, fmodf
 
 #include "internal.h"
 
 #include "sprite.h"
 #include "spritefont.h"
+#include "truetype.h"
+#include "path.h"
 
 #include "graphics/gfx.h"
 
+#include "res.h"
+#include "async.h"
+#include "watch.h"
+#include "mixer.h"
+
 #ifdef SHIZ_DEBUG
  #include "debug/debug.h"
  #include "debug/profiler.h"
- #include "res.h"
 #endif
 
 extern SHIZGraphicsContext const _graphics_context;
@@ -72,10 +78,81 @@ z_draw__pixel_centering_offset(SHIZVector2 const anchor)
 // used per triangle draw to ensure clockwise ordering of vertices
 static SHIZVector2 current_triangle_center = { .x = 0, .y = 0 };
 
+typedef struct SHIZBakedText {
+    /** The quads of every character; 6 vertices each */
+    SHIZVertexPositionColorTexture * vertices;
+    uint32_t quad_count;
+    SHIZSpriteFont font;
+    /** The attributes that the text was baked with; its colors are kept in
+        `colors`, rather than pointing to those of the caller */
+    SHIZSpriteFontAttributes attributes;
+    SHIZColor colors[SHIZSpriteFontMaxColors];
+    SHIZSize bounds;
+    SHIZSize size;
+    SHIZSpriteFontAlignment alignment;
+    uint16_t text_id;
+} SHIZBakedText;
+
+uint16_t const SHIZBakedTextInvalid = 0;
+
+static SHIZBakedText _baked_texts[SHIZBakedTextMax];
+
+typedef struct SHIZPagedText {
+    SHIZSpriteFontPages pages;
+    uint16_t text_id;
+} SHIZPagedText;
+
+uint16_t const SHIZPagedTextInvalid = 0;
+
+static SHIZPagedText _paged_texts[SHIZPagedTextMax];
+
+static
+SHIZBakedText *
+z_draw__baked_text(uint16_t const text_id)
+{
+    if (text_id == SHIZBakedTextInvalid || text_id > SHIZBakedTextMax) {
+        return NULL;
+    }
+    
+    SHIZBakedText * const baked_text = &_baked_texts[text_id - 1];
+    
+    if (baked_text->text_id != text_id) {
+        return NULL;
+    }
+    
+    return baked_text;
+}
+
+static
+SHIZPagedText *
+z_draw__paged_text(uint16_t const text_id)
+{
+    if (text_id == SHIZPagedTextInvalid || text_id > SHIZPagedTextMax) {
+        return NULL;
+    }
+    
+    SHIZPagedText * const paged_text = &_paged_texts[text_id - 1];
+    
+    if (paged_text->text_id != text_id) {
+        return NULL;
+    }
+    
+    return paged_text;
+}
+
 void
 z_drawing_begin(SHIZColor const background)
 {
     z_sprite__reset();
+    z_spritefont__reset();
+    z_truetype__reset();
+    z_res__reset();
+    z_mixer__reset();
+
+    // reload any images whose files changed since the last frame, then finish
+    // any resources loaded in the background
+    z_watch__process();
+    z_async__process(SHIZAsyncFrameBudget);
 
     z_gfx__begin(background);
 
@@ -162,12 +239,16 @@ z_draw_path_ex(SHIZVector2 const points[],
 {
     float const z = z_layer__get_z(layer);
     
-    SHIZVertexPositionColor vertices[count];
+    SHIZVertexPositionColor * const vertices = z_gfx__reserve(count);
+    
+    if (vertices == NULL) {
+        return;
+    }
     
     SHIZVector2 const anchor = SHIZAnchorBottomLeft;
     SHIZVector2 const offset = z_draw__pixel_centering_offset(anchor);
     
-    for (uint8_t i = 0; i < count; i++) {
+    for (uint16_t i = 0; i < count; i++) {
         SHIZVector2 const point = points[i];
         
         vertices[i].position = SHIZVector3Make(PIXEL(point.x) + offset.x,
@@ -189,6 +270,49 @@ z_draw_path_ex(SHIZVector2 const points[],
 #endif
 }
 
+void
+z_draw_path_stroked(SHIZVector2 const points[],
+                    uint32_t const count,
+                    SHIZColor const color,
+                    SHIZPathParameters const params)
+{
+    // rather than drawing each path by itself, its triangles are queued
+    // alongside those of every other path drawn during the frame
+    SHIZVertexPositionColor * const vertices =
+        z_gfx__reserve_triangles(z_path__vertex_count(count));
+    
+    if (vertices == NULL) {
+        return;
+    }
+    
+    float const z = z_layer__get_z(params.layer);
+    
+    SHIZVector2 const offset =
+        z_draw__pixel_centering_offset(SHIZAnchorBottomLeft);
+    
+    uint32_t const vertex_count = z_path__tessellate(points, count, offset,
+                                                     params.width,
+                                                     params.join,
+                                                     params.cap,
+                                                     color, z,
+                                                     vertices);
+    
+    z_gfx__queue_triangles(vertex_count);
+    
+#ifdef SHIZ_DEBUG
+    if (z_debug__is_enabled()) {
+        if (z_debug__is_drawing_shapes() && count > 1) {
+            // note that bounds only cover as many points as can be counted
+            uint16_t const bounded_count = count > UINT16_MAX ?
+                UINT16_MAX : (uint16_t)count;
+            
+            z_debug__draw_points_bounds(points, bounded_count, SHIZColorRed,
+                                        SHIZSpriteNoAngle, params.layer);
+        }
+    }
+#endif
+}
+
 void
 z_draw_point(SHIZVector2 const point,
              SHIZColor const color)
@@ -612,7 +736,9 @@ z_draw_sprite_ex(SHIZSprite const sprite,
                                         anchor, angle, layer);
         }
 
-        z_debug__add_event_resource(z_res__image(sprite.resource_id).filename,
+        SHIZResourceImage const * const image = z_res__image(sprite.resource_id);
+
+        z_debug__add_event_resource(image != NULL ? image->filename : NULL,
                                     SHIZVector3Make(origin.x, origin.y, 0));
     }
 #endif
@@ -737,7 +863,41 @@ z_draw_text_ex(SHIZSpriteFont const font,
             }
         }
         
-        z_debug__add_event_resource(z_res__image(font.sprite.resource_id).filename,
+        SHIZResourceImage const * const image =
+            z_res__image(font.sprite.resource_id);
+        
+        z_debug__add_event_resource(image != NULL ? image->filename : NULL,
+                                    SHIZVector3Make(origin.x, origin.y, 0));
+    }
+#endif
+    
+    return text_size;
+}
+
+SHIZSize
+z_measure_truetype_text(SHIZTrueTypeFont const font,
+                        char const * const text)
+{
+    return z_truetype__measure_text(font, text);
+}
+
+SHIZSize
+z_draw_truetype_text(SHIZTrueTypeFont const font,
+                     char const * const text,
+                     SHIZVector2 const origin,
+                     SHIZSpriteFontParameters const params)
+{
+    SHIZSize const text_size =
+        z_truetype__draw_text(font, text,
+                              SHIZVector2Make(PIXEL(origin.x),
+                                              PIXEL(origin.y)),
+                              params.alignment, params.tint, params.layer);
+    
+#ifdef SHIZ_DEBUG
+    if (z_debug__is_enabled()) {
+        SHIZResourceFont const * const resource = z_res__font(font.resource_id);
+        
+        z_debug__add_event_resource(resource != NULL ? resource->filename : NULL,
                                     SHIZVector3Make(origin.x, origin.y, 0));
     }
 #endif
@@ -745,6 +905,215 @@ z_draw_text_ex(SHIZSpriteFont const font,
     return text_size;
 }
 
+uint16_t
+z_text_bake(SHIZSpriteFont const font,
+            char const * const text,
+            SHIZSize const bounds,
+            SHIZSpriteFontAttributes const attributes,
+            SHIZSpriteFontAlignment const alignment)
+{
+    for (uint16_t i = 0; i < SHIZBakedTextMax; i++) {
+        SHIZBakedText * const baked_text = &_baked_texts[i];
+        
+        if (baked_text->text_id != SHIZBakedTextInvalid) {
+            continue;
+        }
+        
+        baked_text->font = font;
+        baked_text->attributes = attributes;
+        baked_text->attributes.colors = NULL;
+        baked_text->attributes.colors_count = 0;
+        
+        if (attributes.colors != NULL) {
+            // the colors may be gone by the time the text is rebaked; keep
+            // those that can actually be specified
+            baked_text->attributes.colors_count =
+                attributes.colors_count < SHIZSpriteFontMaxColors ?
+                    attributes.colors_count : SHIZSpriteFontMaxColors;
+            
+            for (uint8_t c = 0; c < baked_text->attributes.colors_count; c++) {
+                baked_text->colors[c] = attributes.colors[c];
+            }
+        }
+        
+        baked_text->bounds = bounds;
+        baked_text->alignment = alignment;
+        baked_text->size = SHIZSizeZero;
+        
+        if (!z_spritefont__bake_text(font, text, alignment, bounds, attributes,
+                                     &baked_text->vertices,
+                                     &baked_text->quad_count,
+                                     &baked_text->size)) {
+            return SHIZBakedTextInvalid;
+        }
+        
+        baked_text->text_id = i + 1;
+        
+        return baked_text->text_id;
+    }
+    
+    return SHIZBakedTextInvalid;
+}
+
+bool
+z_text_rebake(uint16_t const text_id,
+              char const * const text)
+{
+    SHIZBakedText * const baked_text = z_draw__baked_text(text_id);
+    
+    if (baked_text == NULL) {
+        return false;
+    }
+    
+    SHIZSpriteFontAttributes attributes = baked_text->attributes;
+    
+    if (attributes.colors_count > 0) {
+        attributes.colors = baked_text->colors;
+    }
+    
+    return z_spritefont__bake_text(baked_text->font, text,
+                                   baked_text->alignment,
+                                   baked_text->bounds,
+                                   attributes,
+                                   &baked_text->vertices,
+                                   &baked_text->quad_count,
+                                   &baked_text->size);
+}
+
+bool
+z_text_unbake(uint16_t const text_id)
+{
+    SHIZBakedText * const baked_text = z_draw__baked_text(text_id);
+    
+    if (baked_text == NULL) {
+        return false;
+    }
+    
+    free(baked_text->vertices);
+    
+    baked_text->vertices = NULL;
+    baked_text->quad_count = 0;
+    baked_text->text_id = SHIZBakedTextInvalid;
+    
+    return true;
+}
+
+void
+z_text_unbake_all()
+{
+    for (uint16_t i = 0; i < SHIZBakedTextMax; i++) {
+        z_text_unbake(_baked_texts[i].text_id);
+    }
+}
+
+SHIZSize
+z_draw_text_baked(uint16_t const text_id,
+                  SHIZVector2 const origin,
+                  SHIZColor const tint,
+                  SHIZLayer const layer)
+{
+    SHIZBakedText const * const baked_text = z_draw__baked_text(text_id);
+    
+    if (baked_text == NULL) {
+        return SHIZSizeZero;
+    }
+    
+    // queued like any other text, so that every baked text of the same font
+    // and layer ends up in the same batch
+    if (!z_sprite__draw_quads(baked_text->font.sprite.resource_id,
+                              baked_text->vertices,
+                              baked_text->quad_count,
+                              origin, tint, SHIZSpriteNotOpaque, layer)) {
+        return SHIZSizeZero;
+    }
+    
+    return baked_text->size;
+}
+
+uint16_t
+z_text_paginate(SHIZSpriteFont const font,
+                char const * const text,
+                float const width,
+                SHIZSpriteFontAttributes const attributes)
+{
+    for (uint16_t i = 0; i < SHIZPagedTextMax; i++) {
+        SHIZPagedText * const paged_text = &_paged_texts[i];
+        
+        if (paged_text->text_id != SHIZPagedTextInvalid) {
+            continue;
+        }
+        
+        if (!z_spritefont__paginate_text(font, text, width, attributes,
+                                         &paged_text->pages)) {
+            return SHIZPagedTextInvalid;
+        }
+        
+        paged_text->text_id = i + 1;
+        
+        return paged_text->text_id;
+    }
+    
+    return SHIZPagedTextInvalid;
+}
+
+bool
+z_text_unpaginate(uint16_t const text_id)
+{
+    SHIZPagedText * const paged_text = z_draw__paged_text(text_id);
+    
+    if (paged_text == NULL) {
+        return false;
+    }
+    
+    z_spritefont__release_pages(&paged_text->pages);
+    
+    paged_text->text_id = SHIZPagedTextInvalid;
+    
+    return true;
+}
+
+void
+z_text_unpaginate_all()
+{
+    for (uint16_t i = 0; i < SHIZPagedTextMax; i++) {
+        z_text_unpaginate(_paged_texts[i].text_id);
+    }
+}
+
+uint32_t
+z_text_line_count(uint16_t const text_id)
+{
+    SHIZPagedText const * const paged_text = z_draw__paged_text(text_id);
+    
+    if (paged_text == NULL) {
+        return 0;
+    }
+    
+    return paged_text->pages.measurement.line_count;
+}
+
+SHIZSize
+z_draw_text_lines(uint16_t const text_id,
+                  SHIZVector2 const origin,
+                  uint32_t const first_line,
+                  uint32_t const line_count,
+                  SHIZSpriteFontParameters const params)
+{
+    SHIZPagedText const * const paged_text = z_draw__paged_text(text_id);
+    
+    if (paged_text == NULL) {
+        return SHIZSizeZero;
+    }
+    
+    return z_spritefont__draw_lines(&paged_text->pages,
+                                    SHIZVector2Make(PIXEL(origin.x),
+                                                    PIXEL(origin.y)),
+                                    first_line, line_count,
+                                    params.alignment,
+                                    params.tint,
+                                    params.layer);
+}
+
 static
 void
 z_draw__rect_outline(SHIZRect const rect,
@@ -20,6 +20,11 @@
 #include "viewport.h"
 #include "res.h"
 #include "io.h"
+#include "spritefont.h"
+#include "truetype.h"
+#include "async.h"
+#include "pack.h"
+#include "watch.h"
 
 #ifdef SHIZ_DEBUG
  #include "debug/debug.h"
@@ -40,7 +45,8 @@ const SHIZWindowSettings SHIZWindowSettingsDefault = {
         .width = 320,
         .height = 240
     },
-    .pixel_size = 1
+    .pixel_size = 1,
+    .sound_device = SHIZSoundDeviceDefault
 };
 
 static
@@ -171,7 +177,7 @@ z_startup(SHIZWindowSettings const settings)
         return false;
     }
     
-    if (!z_mixer__init()) {
+    if (!z_mixer__init(settings.sound_device)) {
         return false;
     }
     
@@ -208,8 +214,22 @@ z_shutdown()
         return false;
     }
     
+    z_particles_remove_all();
+    z_text_unbake_all();
+    z_text_unpaginate_all();
+    
+    z_spritefont__kill();
+    
+    // stop decoding before unloading, so that nothing is finished afterwards
+    z_async__kill();
+    z_watch__stop();
+    
     z_res__unload_all();
     
+    z_pack__unload_all();
+    
+    z_truetype__kill();
+    
     if (!z_mixer__kill()) {
         return false;
     }
@@ -15,23 +15,94 @@
 #include <stdint.h> // uint8_t, uint16_t, uint32_t
 
 #include "res.h"
+#include "pack.h"
+#include "watch.h"
+#include "spritefont.h"
 
-uint8_t
+uint32_t
 z_load(char const * const filename)
 {
     return z_res__load(filename);
 }
 
+uint32_t
+z_load_many(char const * const * const filenames,
+            uint32_t const count,
+            uint32_t * const resource_ids)
+{
+    return z_res__load_many(filenames, count, resource_ids);
+}
+
+uint32_t
+z_load_stream(char const * const filename)
+{
+    return z_res__load_stream(filename);
+}
+
 bool
-z_unload(uint8_t const resource_id)
+z_unload(uint32_t const resource_id)
 {
     return z_res__unload(resource_id);
 }
 
+bool
+z_load_pack(char const * const filename)
+{
+    return z_pack__load(filename);
+}
+
+bool
+z_unload_pack(char const * const filename)
+{
+    return z_pack__unload(filename);
+}
+
+void
+z_set_texture_budget(uint32_t const bytes)
+{
+    z_res__set_texture_budget(bytes);
+}
+
+SHIZTextureUsage
+z_get_texture_usage()
+{
+    return z_res__texture_usage();
+}
+
+bool
+z_watch(bool const enabled)
+{
+    if (!enabled) {
+        z_watch__stop();
+        
+        return true;
+    }
+    
+    return z_watch__start();
+}
+
+uint32_t
+z_load_async(char const * const filename)
+{
+    return z_res__load_async(filename);
+}
+
+bool
+z_is_loaded(uint32_t const resource_id)
+{
+    return z_res__is_loaded(resource_id);
+}
+
+bool
+z_is_loading(uint32_t const resource_id)
+{
+    return z_res__is_loading(resource_id);
+}
+
 SHIZSprite
 z_load_sprite(char const * const filename)
 {
-    uint8_t const resource_id = z_load(filename);
+    uint32_t const resource_id = z_load(filename);
     
     if (resource_id == SHIZResourceInvalid) {
         return SHIZSpriteEmpty;
@@ -84,22 +155,22 @@ z_load_spritesheet_src(char const * const filename,
 }
 
 SHIZSprite
-z_load_sprite_from(uint8_t const resource_id)
+z_load_sprite_from(uint32_t const resource_id)
 {
-    SHIZResourceImage const image = z_res__image(resource_id);
+    SHIZResourceImage const * const image = z_res__image(resource_id);
     
-    if (image.resource_id == SHIZResourceInvalid) {
+    if (image == NULL) {
         return SHIZSpriteEmpty;
     }
     
     SHIZRect const source = SHIZRectMake(SHIZVector2Zero,
-                                         SHIZSizeMake(image.width, image.height));
+                                         SHIZSizeMake(image->width, image->height));
     
     return z_load_sprite_from_src(resource_id, source);
 }
 
 SHIZSprite
-z_load_sprite_from_src(uint8_t const resource_id,
+z_load_sprite_from_src(uint32_t const resource_id,
                        SHIZRect const source)
 {
     SHIZSprite sprite = SHIZSpriteEmpty;
@@ -110,6 +181,19 @@ z_load_sprite_from_src(uint8_t const resource_id,
     return sprite;
 }
 
+SHIZSprite
+z_load_sprite_async(char const * const filename,
+                    SHIZRect const source)
+{
+    uint32_t const resource_id = z_load_async(filename);
+    
+    if (resource_id == SHIZResourceInvalid) {
+        return SHIZSpriteEmpty;
+    }
+    
+    return z_load_sprite_from_src(resource_id, source);
+}
+
 SHIZSpriteSheet
 z_load_spritesheet_from(SHIZSprite const resource,
                         SHIZSize const sprite_size)
@@ -270,6 +354,39 @@ z_load_spritefont_from_ex(SHIZSprite const sprite,
     spritefont.table = table;
     // default to skip whitespaces; this will reduce the number of sprites drawn
     spritefont.includes_whitespace = false;
+    // build the lookup once, so that finding a character in a custom codepage
+    // does not require scanning through the entire codepage for every character
+    spritefont.table_lookup_id = z_spritefont__build_lookup(table,
+                                                            sprite.resource_id);
     
     return spritefont;
 }
+
+SHIZTrueTypeFont
+z_load_truetype_font(char const * const filename,
+                     float const size)
+{
+    uint32_t const resource_id = z_load(filename);
+    
+    if (resource_id == SHIZResourceInvalid) {
+        return SHIZTrueTypeFontEmpty;
+    }
+    
+    return z_load_truetype_font_from(resource_id, size);
+}
+
+SHIZTrueTypeFont
+z_load_truetype_font_from(uint32_t const resource_id,
+                          float const size)
+{
+    if (z_res__font(resource_id) == NULL || size <= 0) {
+        return SHIZTrueTypeFontEmpty;
+    }
+    
+    SHIZTrueTypeFont truetype_font = SHIZTrueTypeFontEmpty;
+    
+    truetype_font.resource_id = resource_id;
+    truetype_font.size = size;
+    
+    return truetype_font;
+}
@@ -0,0 +1,427 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+#include <SHIZEN/zparticle.h>
+#include <SHIZEN/ztime.h>
+#include <SHIZEN/zrand.h>
+
+#include <stdlib.h> // malloc, free
+#include <math.h> // cosf, sinf
+
+#include "internal.h"
+#include "res.h"
+#include "sprite.h"
+
+#include "graphics/gfx.h"
+
+/**
+ * The number of float arrays that make up a particle pool.
+ */
+#define SHIZParticleComponentCount 7
+
+uint8_t const SHIZParticleEmitterInvalid = 0;
+
+typedef struct SHIZParticlePool {
+    // particles are stored as a structure of arrays so that each step
+    // of the simulation is a tight loop over contiguous floats
+    float * x;
+    float * y;
+    float * x_prev;
+    float * y_prev;
+    float * vx;
+    float * vy;
+    float * life; // in seconds remaining
+    uint32_t count;
+    uint32_t capacity;
+} SHIZParticlePool;
+
+typedef struct SHIZParticleEmitter {
+    SHIZParticleEmitterParameters params;
+    SHIZParticlePool pool;
+    SHIZSprite sprite;
+    SHIZVector2 origin;
+    float accumulator; // fraction of a particle carried over between ticks
+    bool emitting;
+    uint8_t emitter_id;
+} SHIZParticleEmitter;
+
+static SHIZParticleEmitter _emitters[SHIZParticleEmitterMax];
+
+static SHIZParticleEmitter * z_particles__get(uint8_t emitter_id);
+
+static void z_particles__spawn(SHIZParticleEmitter *, uint32_t count);
+static void z_particles__simulate(SHIZParticleEmitter *, float step);
+static void z_particles__draw(SHIZParticleEmitter const *, float t);
+
+static void z_particles__integrate(float * restrict position,
+                                   float * restrict position_prev,
+                                   float * restrict velocity,
+                                   float acceleration,
+                                   float step,
+                                   uint32_t count);
+
+static void z_particles__age(float * restrict life,
+                             float step,
+                             uint32_t count);
+
+static void z_particles__compact(SHIZParticlePool *);
+
+uint8_t
+z_particles_add(SHIZSprite const sprite,
+                SHIZVector2 const origin,
+                SHIZParticleEmitterParameters const params)
+{
+    if (params.capacity == 0) {
+        return SHIZParticleEmitterInvalid;
+    }
+    
+    for (uint8_t i = 0; i < SHIZParticleEmitterMax; i++) {
+        SHIZParticleEmitter * const emitter = &_emitters[i];
+        
+        if (emitter->emitter_id != SHIZParticleEmitterInvalid) {
+            continue;
+        }
+        
+        float * const components =
+            malloc(sizeof(float) * SHIZParticleComponentCount * params.capacity);
+        
+        if (components == NULL) {
+            return SHIZParticleEmitterInvalid;
+        }
+        
+        SHIZParticlePool * const pool = &emitter->pool;
+        
+        pool->x = components;
+        pool->y = pool->x + params.capacity;
+        pool->x_prev = pool->y + params.capacity;
+        pool->y_prev = pool->x_prev + params.capacity;
+        pool->vx = pool->y_prev + params.capacity;
+        pool->vy = pool->vx + params.capacity;
+        pool->life = pool->vy + params.capacity;
+        pool->count = 0;
+        pool->capacity = params.capacity;
+        
+        emitter->params = params;
+        emitter->sprite = sprite;
+        emitter->origin = origin;
+        emitter->accumulator = 0;
+        emitter->emitting = params.rate > 0;
+        emitter->emitter_id = i + 1;
+        
+        return emitter->emitter_id;
+    }
+    
+    return SHIZParticleEmitterInvalid;
+}
+
+bool
+z_particles_remove(uint8_t const emitter_id)
+{
+    SHIZParticleEmitter * const emitter = z_particles__get(emitter_id);
+    
+    if (emitter == NULL) {
+        return false;
+    }
+    
+    // all components share the allocation starting at x
+    free(emitter->pool.x);
+    
+    emitter->pool.x = NULL;
+    emitter->pool.count = 0;
+    emitter->pool.capacity = 0;
+    
+    emitter->emitter_id = SHIZParticleEmitterInvalid;
+    
+    return true;
+}
+
+void
+z_particles_remove_all()
+{
+    for (uint8_t i = 0; i < SHIZParticleEmitterMax; i++) {
+        z_particles_remove(_emitters[i].emitter_id);
+    }
+}
+
+void
+z_particles_set_origin(uint8_t const emitter_id,
+                       SHIZVector2 const origin)
+{
+    SHIZParticleEmitter * const emitter = z_particles__get(emitter_id);
+    
+    if (emitter != NULL) {
+        emitter->origin = origin;
+    }
+}
+
+void
+z_particles_set_emitting(uint8_t const emitter_id,
+                         bool const emitting)
+{
+    SHIZParticleEmitter * const emitter = z_particles__get(emitter_id);
+    
+    if (emitter != NULL) {
+        emitter->emitting = emitting;
+        emitter->accumulator = 0;
+    }
+}
+
+void
+z_particles_emit(uint8_t const emitter_id,
+                 uint32_t const count)
+{
+    SHIZParticleEmitter * const emitter = z_particles__get(emitter_id);
+    
+    if (emitter != NULL) {
+        z_particles__spawn(emitter, count);
+    }
+}
+
+uint32_t
+z_particles_count(uint8_t const emitter_id)
+{
+    SHIZParticleEmitter const * const emitter = z_particles__get(emitter_id);
+    
+    if (emitter == NULL) {
+        return 0;
+    }
+    
+    return emitter->pool.count;
+}
+
+void
+z_particles_tick()
+{
+    float const step = (float)z_time_get_tick_rate();
+    
+    for (uint8_t i = 0; i < SHIZParticleEmitterMax; i++) {
+        SHIZParticleEmitter * const emitter = &_emitters[i];
+        
+        if (emitter->emitter_id != SHIZParticleEmitterInvalid) {
+            z_particles__simulate(emitter, step);
+        }
+    }
+}
+
+void
+z_particles_draw(double const interpolation)
+{
+    float t = (float)interpolation;
+    
+    if (t < 0) {
+        t = 0;
+    } else if (t > 1) {
+        t = 1;
+    }
+    
+    for (uint8_t i = 0; i < SHIZParticleEmitterMax; i++) {
+        SHIZParticleEmitter const * const emitter = &_emitters[i];
+        
+        if (emitter->emitter_id != SHIZParticleEmitterInvalid &&
+            emitter->pool.count > 0) {
+            z_particles__draw(emitter, t);
+        }
+    }
+}
+
+static
+SHIZParticleEmitter *
+z_particles__get(uint8_t const emitter_id)
+{
+    if (emitter_id == SHIZParticleEmitterInvalid ||
+        emitter_id > SHIZParticleEmitterMax) {
+        return NULL;
+    }
+    
+    SHIZParticleEmitter * const emitter = &_emitters[emitter_id - 1];
+    
+    if (emitter->emitter_id != emitter_id) {
+        return NULL;
+    }
+    
+    return emitter;
+}
+
+static
+void
+z_particles__spawn(SHIZParticleEmitter * const emitter,
+                   uint32_t count)
+{
+    SHIZParticlePool * const pool = &emitter->pool;
+    SHIZParticleEmitterParameters const params = emitter->params;
+    
+    if (count > pool->capacity - pool->count) {
+        count = pool->capacity - pool->count;
+    }
+    
+    float const spread = params.spread / 2;
+    
+    for (uint32_t i = pool->count; i < pool->count + count; i++) {
+        float const angle = params.angle + z_randf_range(-spread, spread);
+        float const speed = z_randf_range(params.speed_min, params.speed_max);
+        
+        pool->x[i] = emitter->origin.x;
+        pool->y[i] = emitter->origin.y;
+        // start at rest so that a new particle is not blended in from
+        // wherever the previous occupant of this slot was
+        pool->x_prev[i] = pool->x[i];
+        pool->y_prev[i] = pool->y[i];
+        pool->vx[i] = cosf(angle) * speed;
+        pool->vy[i] = sinf(angle) * speed;
+        pool->life[i] = params.lifetime;
+    }
+    
+    pool->count += count;
+}
+
+static
+void
+z_particles__simulate(SHIZParticleEmitter * const emitter,
+                      float const step)
+{
+    SHIZParticlePool * const pool = &emitter->pool;
+    
+    z_particles__integrate(pool->x, pool->x_prev, pool->vx,
+                           emitter->params.gravity.x,
+                           step, pool->count);
+    z_particles__integrate(pool->y, pool->y_prev, pool->vy,
+                           emitter->params.gravity.y,
+                           step, pool->count);
+    
+    z_particles__age(pool->life, step, pool->count);
+    z_particles__compact(pool);
+    
+    if (emitter->emitting) {
+        emitter->accumulator += emitter->params.rate * step;
+        
+        uint32_t const count = (uint32_t)emitter->accumulator;
+        
+        emitter->accumulator -= count;
+        
+        z_particles__spawn(emitter, count);
+    }
+}
+
+static
+void
+z_particles__integrate(float * restrict const position,
+                       float * restrict const position_prev,
+                       float * restrict const velocity,
+                       float const acceleration,
+                       float const step,
+                       uint32_t const count)
+{
+    // note that this loop (as well as the aging loop) is kept free of
+    // branches and aliasing so that the compiler can vectorize it
+    for (uint32_t i = 0; i < count; i++) {
+        position_prev[i] = position[i];
+        velocity[i] += acceleration * step;
+        position[i] += velocity[i] * step;
+    }
+}
+
+static
+void
+z_particles__age(float * restrict const life,
+                 float const step,
+                 uint32_t const count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        life[i] -= step;
+    }
+}
+
+static
+void
+z_particles__compact(SHIZParticlePool * const pool)
+{
+    uint32_t i = 0;
+    
+    while (i < pool->count) {
+        if (pool->life[i] > 0) {
+            i++;
+            
+            continue;
+        }
+        
+        // replace the dead particle with the last one; order is not
+        // important, but keeping the pool dense is
+        uint32_t const last = pool->count - 1;
+        
+        pool->x[i] = pool->x[last];
+        pool->y[i] = pool->y[last];
+        pool->x_prev[i] = pool->x_prev[last];
+        pool->y_prev[i] = pool->y_prev[last];
+        pool->vx[i] = pool->vx[last];
+        pool->vy[i] = pool->vy[last];
+        pool->life[i] = pool->life[last];
+        
+        pool->count -= 1;
+    }
+}
+
+static
+void
+z_particles__draw(SHIZParticleEmitter const * const emitter,
+                  float const t)
+{
+    SHIZSprite const sprite = emitter->sprite;
+    SHIZResourceImage const * const image = z_res__use_image(sprite.resource_id);
+    
+    if (image == NULL ||
+        (sprite.source.size.width <= 0 ||
+         sprite.source.size.height <= 0)) {
+        return;
+    }
+    
+    SHIZParticlePool const * const pool = &emitter->pool;
+    
+    SHIZInstance * const instances = z_gfx__reserve_instances(pool->count);
+    
+    if (instances == NULL) {
+        return;
+    }
+    
+    SHIZVector2 uv_min;
+    SHIZVector2 uv_max;
+    
+    z_sprite__source_uv(sprite.source,
+                        SHIZSizeMake(image->width, image->height),
+                        &uv_min, &uv_max);
+    
+    // particles are always centered on their position
+    SHIZRect const quad =
+        SHIZRectMake(SHIZVector2Make(-sprite.source.size.width / 2,
+                                     -sprite.source.size.height / 2),
+                     sprite.source.size);
+    
+    SHIZColor const tint = emitter->params.tint;
+    
+    float const z = z_layer__get_z(emitter->params.layer);
+    float const fade = emitter->params.fade && emitter->params.lifetime > 0 ?
+        1.0f / emitter->params.lifetime : 0;
+    
+    for (uint32_t i = 0; i < pool->count; i++) {
+        float const x = pool->x_prev[i] + ((pool->x[i] - pool->x_prev[i]) * t);
+        float const y = pool->y_prev[i] + ((pool->y[i] - pool->y_prev[i]) * t);
+        float const alpha = fade > 0 ? pool->life[i] * fade : 1;
+        
+        instances[i].position = SHIZVector3Make(PIXEL(x), PIXEL(y), z);
+        instances[i].quad = quad;
+        instances[i].texture_coord_min = uv_min;
+        instances[i].texture_coord_max = uv_max;
+        instances[i].tint = SHIZColorMake(tint.r, tint.g, tint.b,
+                                          tint.alpha * alpha);
+    }
+    
+    // drawn once flushed; along with any other emitter in the same texture
+    z_gfx__queue_instances(pool->count, z, image->texture_id);
+}
@@ -16,13 +16,60 @@
 #include "mixer.h" // z_mixer_*
 
 void
-z_sound_play(uint8_t const sound_resource_id)
+z_sound_play(uint32_t const sound_resource_id)
 {
-    z_mixer__play_sound(sound_resource_id);
+    z_mixer__play_sound(sound_resource_id, 1, 1, 0, 0);
+}
+
+bool
+z_sound_play_ex(uint32_t const sound_resource_id,
+                float const gain,
+                float const pitch,
+                float const pan,
+                uint8_t const priority)
+{
+    return z_mixer__play_sound(sound_resource_id, gain, pitch, pan, priority);
+}
+
+bool
+z_sound_play_at(uint32_t const sound_resource_id,
+                double const time,
+                float const gain,
+                float const pitch,
+                float const pan,
+                uint8_t const priority)
+{
+    return z_mixer__schedule_sound(sound_resource_id, time,
+                                   gain, pitch, pan, priority);
 }
 
 void
-z_sound_stop(uint8_t const sound_resource_id)
+z_sound_stop(uint32_t const sound_resource_id)
 {
     z_mixer__stop_sound(sound_resource_id);
 }
+
+bool
+z_sound_loop(uint32_t const sound_resource_id,
+             bool const loop)
+{
+    return z_mixer__loop_sound(sound_resource_id, loop);
+}
+
+bool
+z_sound_mix(bool const enabled)
+{
+    return z_mixer__set_mixing(enabled);
+}
+
+void
+z_sound_compress(bool const enabled)
+{
+    z_mixer__set_compressing(enabled);
+}
+
+SHIZSoundUsage
+z_get_sound_usage()
+{
+    return z_mixer__usage();
+}
@@ -37,12 +37,17 @@ static SHIZTimelineState _timeline_state = {
 
 static bool _is_ticking = false;
 
+// the duration of every tick so far, regardless of scale or direction
+static double _time_ticked = 0;
+
 void
 z_time_reset()
 {
     _timeline = SHIZTimelineDefault;
     _timeline_state.time_previous = _timeline.time;
     
+    _time_ticked = 0;
+    
     glfwSetTime(_timeline.time);
 }
 
@@ -76,6 +81,8 @@ z_time_tick(uint8_t const frequency)
         
         _timeline.time += _timeline.time_step * z_time_get_direction();
         
+        _time_ticked += _timeline.time_step;
+        
         return true;
     }
     
@@ -311,6 +318,12 @@ z_animate_vec2_blend(SHIZAnimatableVector2 * const animatable,
     return SHIZVector2Make(x, y);
 }
 
+double
+z_time__get_ticked()
+{
+    return _time_ticked;
+}
+
 #ifdef SHIZ_DEBUG
 double
 z_time__get_lag()
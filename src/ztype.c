@@ -89,7 +89,13 @@ SHIZSpriteFont const SHIZSpriteFontEmpty = {
         .rows = 0,
         .codepage = NULL
     },
-    .includes_whitespace = false
+    .includes_whitespace = false,
+    .table_lookup_id = 0
+};
+
+SHIZTrueTypeFont const SHIZTrueTypeFontEmpty = {
+    .resource_id = 0,
+    .size = 0
 };
 
 SHIZSpriteSize const SHIZSpriteSizeIntrinsic = {
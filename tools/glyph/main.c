@@ -0,0 +1,353 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+// Fuzzes the glyph rasterizer with a TrueType font and corrupted copies of
+// it; e.g.:
+//
+//   glyph assets/font.ttf 10000
+//
+// Each run first rasterizes random glyphs of the font as it is, at random
+// sizes, and then does the same with a copy that has a few random bytes
+// overwritten (mostly within the outlines, where it matters the most).
+// Glyphs are rasterized exactly like the glyph cache does; any glyph whose
+// bitmap is larger than the cache would accept is skipped.
+//
+// Each run also rasterizes random lines and curves (many of them along, or
+// past, the edges) into a raster surrounded by guard cells. A write into the
+// neighbouring row of a raster stays within its memory, so no sanitizer can
+// tell; instead, any guard cell that is written to is reported.
+//
+// Otherwise nothing is checked besides every access staying within bounds,
+// so build it with sanitizers enabled; e.g.:
+//
+//   cc -std=c99 -g -fsanitize=address,undefined tools/glyph/main.c -lm
+//
+// A seed can be given as well, so that a failing run can be repeated:
+//
+//   glyph assets/font.ttf 10000 42
+
+#include <stdlib.h> // EXIT_SUCCESS, EXIT_FAILURE, malloc, free, srand, rand, strtoul
+#include <stdio.h> // FILE, fopen, fread, fprintf, printf
+#include <stdint.h> // uint8_t, uint32_t
+#include <stdbool.h> // bool
+#include <string.h> // memcpy
+#include <math.h> // INFINITY, NAN
+
+#include "../../src/ttf.c"
+
+/**
+ * The largest size (in pixels) that glyphs are rasterized at; the same as
+ * `SHIZTrueTypeFontSizeMax`.
+ */
+#define SHIZGlyphFuzzSizeMax 128
+/**
+ * The largest bitmap (in pixels, along either side) that is rasterized; the
+ * same as the glyph cache.
+ */
+#define SHIZGlyphFuzzBitmapMax (SHIZGlyphFuzzSizeMax * 2)
+/**
+ * The number of glyphs rasterized in each run.
+ */
+#define SHIZGlyphFuzzGlyphs 64
+/**
+ * The max number of bytes overwritten in each run.
+ */
+#define SHIZGlyphFuzzCorruptions 8
+/**
+ * The number of lines and curves rasterized in each run.
+ */
+#define SHIZGlyphFuzzLines 8
+/**
+ * The number of guard cells around each side of a raster.
+ */
+#define SHIZGlyphFuzzGuard 2
+
+static uint32_t glyph__rasterize(uint8_t const * data, uint32_t length);
+static void glyph__corrupt(uint8_t * data, uint32_t length);
+
+static bool glyph__rasterize_lines(void);
+static float glyph__coordinate(int size);
+
+static uint8_t * glyph__read(char const * filename, uint32_t * length);
+
+int
+main(int const argc, char const * const argv[])
+{
+    if (argc != 3 && argc != 4) {
+        fprintf(stderr, "usage: %s <font> <count> [<seed>]\n", argv[0]);
+        
+        return EXIT_FAILURE;
+    }
+    
+    uint32_t const count = (uint32_t)strtoul(argv[2], NULL, 10);
+    uint32_t const seed = argc == 4 ? (uint32_t)strtoul(argv[3], NULL, 10) : 1;
+    
+    uint32_t length;
+    
+    uint8_t * const data = glyph__read(argv[1], &length);
+    
+    if (data == NULL) {
+        fprintf(stderr, "could not read '%s'\n", argv[1]);
+        
+        return EXIT_FAILURE;
+    }
+    
+    uint8_t * const corrupted = malloc(length);
+    
+    if (corrupted == NULL) {
+        free(data);
+        
+        return EXIT_FAILURE;
+    }
+    
+    srand(seed);
+    
+    uint32_t glyphs = 0;
+    uint32_t corrupted_glyphs = 0;
+    uint32_t failures = 0;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (!glyph__rasterize_lines()) {
+            failures += 1;
+        }
+        
+        glyphs += glyph__rasterize(data, length);
+        
+        memcpy(corrupted, data, length);
+        
+        glyph__corrupt(corrupted, length);
+        
+        corrupted_glyphs += glyph__rasterize(corrupted, length);
+    }
+    
+    printf("%u glyphs rasterized (%u corrupted) in %u runs\n",
+           glyphs + corrupted_glyphs, corrupted_glyphs, count);
+    printf("%u of %u rasters were written outside of their bounds\n",
+           failures, count);
+    
+    free(corrupted);
+    free(data);
+    
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static
+uint32_t
+glyph__rasterize(uint8_t const * const data,
+                 uint32_t const length)
+{
+    SHIZTrueTypeInfo font;
+    
+    if (!z_ttf__init(&font, data, length)) {
+        return 0;
+    }
+    
+    uint32_t rasterized = 0;
+    
+    for (uint32_t i = 0; i < SHIZGlyphFuzzGlyphs; i++) {
+        // mostly glyphs by codepoint (as drawn), but any glyph at all too
+        int const glyph = rand() % 2 == 0 ?
+            z_ttf__find_glyph(&font, (uint32_t)(rand() % 0x3000)) :
+            rand() % (font.num_glyphs > 0 ? font.num_glyphs : 1);
+        
+        float const size = (float)(1 + rand() % SHIZGlyphFuzzSizeMax);
+        float const scale = z_ttf__scale_for_pixel_height(&font, size);
+        
+        int advance;
+        int bearing;
+        
+        z_ttf__get_hmetrics(&font, glyph, &advance, &bearing);
+        z_ttf__get_kerning(&font, glyph, rand() % (font.num_glyphs + 1));
+        
+        int x0, y0, x1, y1;
+        
+        if (!z_ttf__get_glyph_box(&font, glyph, scale, &x0, &y0, &x1, &y1) ||
+            (x1 - x0) > SHIZGlyphFuzzBitmapMax ||
+            (y1 - y0) > SHIZGlyphFuzzBitmapMax) {
+            continue;
+        }
+        
+        int const width = x1 - x0;
+        int const height = y1 - y0;
+        
+        // exactly the size of the bitmap, so that any stray write is caught
+        unsigned char * const bitmap = malloc((size_t)(width * height));
+        
+        if (bitmap == NULL) {
+            continue;
+        }
+        
+        if (z_ttf__render_glyph(&font, glyph, scale,
+                                bitmap, width, height, width)) {
+            rasterized += 1;
+        }
+        
+        free(bitmap);
+    }
+    
+    return rasterized;
+}
+
+static
+void
+glyph__corrupt(uint8_t * const data,
+               uint32_t const length)
+{
+    SHIZTrueTypeInfo font;
+    
+    // outlines (and where they are) are the most likely to break the
+    // rasterizer; anything else is mostly rejected by the parser
+    bool const has_outlines = z_ttf__init(&font, data, length) &&
+        font.glyf < font.size;
+    
+    uint32_t const corruptions = 1 + (uint32_t)(rand() % SHIZGlyphFuzzCorruptions);
+    
+    for (uint32_t i = 0; i < corruptions; i++) {
+        uint32_t offset = (uint32_t)rand() % length;
+        
+        if (has_outlines && rand() % 4 != 0) {
+            uint32_t const start = rand() % 2 == 0 ? font.glyf : font.loca;
+            
+            offset = start + ((uint32_t)rand() % (length - start));
+        }
+        
+        data[offset] = (uint8_t)(rand() % 256);
+    }
+}
+
+static
+bool
+glyph__rasterize_lines()
+{
+    int const width = 1 + rand() % SHIZGlyphFuzzSizeMax;
+    int const height = 1 + rand() % SHIZGlyphFuzzSizeMax;
+    
+    // the same stride as a glyph; lines touching the right edge accumulate
+    // one pixel past it
+    int const stride = width + 2 + (SHIZGlyphFuzzGuard * 2);
+    int const rows = height + (SHIZGlyphFuzzGuard * 2);
+    
+    float * const cells = calloc((size_t)(stride * rows), sizeof(float));
+    
+    if (cells == NULL) {
+        return true;
+    }
+    
+    SHIZTrueTypeRaster raster;
+    
+    raster.accumulation = cells +
+        (SHIZGlyphFuzzGuard * stride) + SHIZGlyphFuzzGuard;
+    raster.width = width;
+    raster.height = height;
+    raster.stride = stride;
+    
+    for (uint32_t i = 0; i < SHIZGlyphFuzzLines; i++) {
+        float const x0 = glyph__coordinate(width);
+        float const y0 = glyph__coordinate(height);
+        float const x1 = glyph__coordinate(width);
+        float const y1 = glyph__coordinate(height);
+        
+        if (rand() % 2 == 0) {
+            z_ttf__line(&raster, x0, y0, x1, y1);
+        } else {
+            z_ttf__quad(&raster, x0, y0,
+                        glyph__coordinate(width), glyph__coordinate(height),
+                        x1, y1);
+        }
+    }
+    
+    bool is_within = true;
+    
+    for (int y = 0; y < rows && is_within; y++) {
+        for (int x = 0; x < stride; x++) {
+            int const raster_x = x - SHIZGlyphFuzzGuard;
+            int const raster_y = y - SHIZGlyphFuzzGuard;
+            
+            bool const is_guard =
+                raster_y < 0 || raster_y >= height ||
+                raster_x < 0 || raster_x > width + 1;
+            
+            if (is_guard && cells[(y * stride) + x] != 0) {
+                printf("stray write at (%d, %d) of a %dx%d raster\n",
+                       raster_x, raster_y, width, height);
+                
+                is_within = false;
+                
+                break;
+            }
+        }
+    }
+    
+    free(cells);
+    
+    return is_within;
+}
+
+static
+float
+glyph__coordinate(int const size)
+{
+    int const kind = rand() % 16;
+    
+    // on the edges, just past them, or anywhere within
+    if (kind < 3) {
+        return 0;
+    } else if (kind < 6) {
+        return (float)size;
+    } else if (kind < 8) {
+        return -(float)(rand() % 1000) / 100;
+    } else if (kind < 10) {
+        return (float)size + (float)(rand() % 1000) / 100;
+    } else if (kind == 10) {
+        // as a corrupted transform could
+        return rand() % 2 == 0 ? INFINITY : NAN;
+    }
+    
+    return (float)(rand() % ((size * 1000) + 1)) / 1000;
+}
+
+static
+uint8_t *
+glyph__read(char const * const filename,
+            uint32_t * const length)
+{
+    FILE * const file = fopen(filename, "rb");
+    
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    uint8_t * data = NULL;
+    long size = -1;
+    
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    
+    if (size > 0 && size <= INT32_MAX && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)size);
+        
+        if (data != NULL &&
+            fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            
+            data = NULL;
+        }
+    }
+    
+    fclose(file);
+    
+    if (data != NULL) {
+        *length = (uint32_t)size;
+    }
+    
+    return data;
+}
@@ -0,0 +1,266 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+// Packs any number of files into a single file that can be loaded with
+// `z_load_pack`; e.g.:
+//
+//   pack assets.pack assets/hero.png assets/jump.ogg
+//
+// Each file is packed by the name it is given as, so a resource is loaded
+// from the pack by the same name it would otherwise be loaded from disk.
+
+#include <stdlib.h> // EXIT_SUCCESS, EXIT_FAILURE, malloc, calloc, free, qsort
+#include <stdio.h> // FILE, fopen, fread, fwrite, fprintf
+#include <stdint.h> // uint8_t, uint32_t
+#include <stdbool.h> // bool
+#include <string.h> // strcmp, strlen, memcpy
+
+#include "../../src/pack.h" // SHIZPack*
+
+typedef struct SHIZPackFile {
+    char const * path;
+    /** The name that the file is packed as */
+    char const * name;
+    uint8_t * data;
+    uint32_t length;
+} SHIZPackFile;
+
+static bool pack__read(SHIZPackFile * file);
+static bool pack__write(FILE * output, SHIZPackFile const * files, uint32_t count);
+static void pack__write_u32(uint8_t * buffer, uint32_t value);
+static int pack__compare(void const * a, void const * b);
+
+int
+main(int const argc, char const * const argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <output> <file> [<file> ...]\n", argv[0]);
+        
+        return EXIT_FAILURE;
+    }
+    
+    uint32_t const count = (uint32_t)(argc - 2);
+    
+    SHIZPackFile * const files = calloc(count, sizeof(SHIZPackFile));
+    
+    if (files == NULL) {
+        return EXIT_FAILURE;
+    }
+    
+    int result = EXIT_FAILURE;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        char const * name = argv[i + 2];
+        
+        // names are stored without any leading "./"
+        while (name[0] == '.' && name[1] == '/') {
+            name += 2;
+        }
+        
+        files[i].path = argv[i + 2];
+        files[i].name = name;
+        
+        if (!pack__read(&files[i])) {
+            fprintf(stderr, "could not read '%s'\n", files[i].path);
+            
+            goto cleanup;
+        }
+    }
+    
+    // entries are looked up by binary search, so they must be sorted by name
+    qsort(files, count, sizeof(SHIZPackFile), pack__compare);
+    
+    for (uint32_t i = 1; i < count; i++) {
+        if (strcmp(files[i - 1].name, files[i].name) == 0) {
+            fprintf(stderr, "'%s' is packed more than once\n", files[i].name);
+            
+            goto cleanup;
+        }
+    }
+    
+    FILE * const output = fopen(argv[1], "wb");
+    
+    if (output == NULL) {
+        fprintf(stderr, "could not write '%s'\n", argv[1]);
+        
+        goto cleanup;
+    }
+    
+    bool const written = pack__write(output, files, count);
+    
+    if (fclose(output) != 0 || !written) {
+        fprintf(stderr, "could not write '%s'\n", argv[1]);
+        
+        remove(argv[1]);
+        
+        goto cleanup;
+    }
+    
+    result = EXIT_SUCCESS;
+
+cleanup:
+    for (uint32_t i = 0; i < count; i++) {
+        free(files[i].data);
+    }
+    
+    free(files);
+    
+    return result;
+}
+
+static
+bool
+pack__read(SHIZPackFile * const file)
+{
+    FILE * const input = fopen(file->path, "rb");
+    
+    if (input == NULL) {
+        return false;
+    }
+    
+    long length = -1;
+    
+    if (fseek(input, 0, SEEK_END) == 0) {
+        length = ftell(input);
+    }
+    
+    bool read = false;
+    
+    if (length >= 0 && (unsigned long)length <= UINT32_MAX &&
+        fseek(input, 0, SEEK_SET) == 0) {
+        // allocate at least a byte, so that empty files are packed too
+        file->data = malloc(length > 0 ? (size_t)length : 1);
+        file->length = (uint32_t)length;
+        
+        read = file->data != NULL &&
+            fread(file->data, 1, (size_t)length, input) == (size_t)length;
+    }
+    
+    fclose(input);
+    
+    return read;
+}
+
+static
+bool
+pack__write(FILE * const output,
+            SHIZPackFile const * const files,
+            uint32_t const count)
+{
+    uint64_t const names_offset = SHIZPackHeaderSize +
+        ((uint64_t)count * SHIZPackEntrySize);
+    
+    uint64_t offset = names_offset;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        offset += strlen(files[i].name);
+    }
+    
+    uint64_t const header_length = offset;
+    
+    // lay out the data of every file, aligned, after all of the names
+    uint32_t * const data_offsets = calloc(count > 0 ? count : 1, sizeof(uint32_t));
+    
+    if (data_offsets == NULL) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        offset = (offset + SHIZPackAlignment - 1) & ~(uint64_t)(SHIZPackAlignment - 1);
+        
+        data_offsets[i] = (uint32_t)offset;
+        
+        offset += files[i].length;
+        
+        if (offset > UINT32_MAX) {
+            fprintf(stderr, "pack would be too large (max 4GB)\n");
+            
+            free(data_offsets);
+            
+            return false;
+        }
+    }
+    
+    uint8_t * const header = malloc((size_t)header_length);
+    
+    if (header == NULL) {
+        free(data_offsets);
+        
+        return false;
+    }
+    
+    memcpy(header, SHIZPackMagic, 4);
+    
+    pack__write_u32(header + 4, SHIZPackVersion);
+    pack__write_u32(header + 8, count);
+    pack__write_u32(header + 12, (uint32_t)names_offset);
+    
+    uint32_t name_offset = (uint32_t)names_offset;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t * const entry = header + SHIZPackHeaderSize +
+            (i * SHIZPackEntrySize);
+        
+        uint32_t const name_length = (uint32_t)strlen(files[i].name);
+        
+        pack__write_u32(entry, name_offset);
+        pack__write_u32(entry + 4, name_length);
+        pack__write_u32(entry + 8, data_offsets[i]);
+        pack__write_u32(entry + 12, files[i].length);
+        
+        memcpy(header + name_offset, files[i].name, name_length);
+        
+        name_offset += name_length;
+    }
+    
+    bool written = fwrite(header, 1, (size_t)header_length, output) == header_length;
+    
+    free(header);
+    
+    uint8_t const padding[SHIZPackAlignment] = { 0 };
+    
+    uint64_t position = header_length;
+    
+    for (uint32_t i = 0; i < count && written; i++) {
+        size_t const padding_length = (size_t)(data_offsets[i] - position);
+        
+        written = fwrite(padding, 1, padding_length, output) == padding_length &&
+            fwrite(files[i].data, 1, files[i].length, output) == files[i].length;
+        
+        position = (uint64_t)data_offsets[i] + files[i].length;
+    }
+    
+    free(data_offsets);
+    
+    return written;
+}
+
+static
+void
+pack__write_u32(uint8_t * const buffer,
+                uint32_t const value)
+{
+    buffer[0] = (uint8_t)(value & 0xff);
+    buffer[1] = (uint8_t)((value >> 8) & 0xff);
+    buffer[2] = (uint8_t)((value >> 16) & 0xff);
+    buffer[3] = (uint8_t)((value >> 24) & 0xff);
+}
+
+static
+int
+pack__compare(void const * const a,
+              void const * const b)
+{
+    SHIZPackFile const * const file_a = a;
+    SHIZPackFile const * const file_b = b;
+    
+    return strcmp(file_a->name, file_b->name);
+}
@@ -0,0 +1,353 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+// Measures what any number of Ogg Vorbis sounds cost per second of sound;
+// e.g.:
+//
+//   sound -b assets/*.ogg
+//
+// Each sound is measured by how long it takes to decode (as when streamed),
+// and how long it takes to mix with many voices playing it at once; both as
+// decoded samples and as compressed samples (see `z_sound_compress`). Every
+// time is in milliseconds per second of sound, so the cost of decoding is
+// comparable however long the sound, and the cost of mixing is the share of
+// the audio thread that the voices take up.
+//
+// The bus is mixed exactly like the engine mixes it, only on this thread,
+// and nothing is played.
+
+// before any system header; the bus (included below) needs it as well
+#if defined(__linux__) && !defined(_XOPEN_SOURCE)
+ #define _XOPEN_SOURCE 700 // clock_gettime, M_PI
+#endif
+
+#include <stdlib.h> // EXIT_SUCCESS, EXIT_FAILURE, malloc, free
+#include <stdio.h> // FILE, fopen, fread, fprintf, printf
+#include <stdint.h> // uint8_t, int16_t, uint32_t, int32_t
+#include <stdbool.h> // bool
+#include <string.h> // strcmp
+#include <time.h> // clock, CLOCKS_PER_SEC
+
+#include "../../src/adpcm.c"
+#include "../../src/bus.c"
+#include "../../src/stream.h" // SHIZStreamBufferSamples
+
+// after the engine; the decoder leaves macros defined that clash with it
+#include "../../external/stb/stb_vorbis.c" // stb_vorbis_*
+
+/**
+ * The least amount of time (in seconds) that each sound is measured for.
+ */
+#define SHIZSoundBenchmarkDuration 0.25
+/**
+ * The number of voices playing a sound at once while mixing.
+ */
+#define SHIZSoundBenchmarkVoices 64
+
+static bool sound__benchmark(char const * const * filenames, uint32_t count);
+
+static double sound__measure_decode(uint8_t const * data, uint32_t length, double duration);
+static double sound__measure_mix(int16_t const * samples, uint8_t const * blocks, uint32_t frames, uint8_t channels, int32_t sample_rate);
+
+static uint8_t * sound__read(char const * filename, uint32_t * length);
+static int16_t * sound__decode(uint8_t const * data, uint32_t length, uint8_t * channels, int32_t * sample_rate, uint32_t * frames);
+
+int
+main(int const argc, char const * const argv[])
+{
+    if (argc < 3 || strcmp(argv[1], "-b") != 0) {
+        fprintf(stderr, "usage: %s -b <sound> [<sound> ...]\n", argv[0]);
+        
+        return EXIT_FAILURE;
+    }
+    
+    uint32_t const count = (uint32_t)(argc - 2);
+    
+    return sound__benchmark(argv + 2, count) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static
+bool
+sound__benchmark(char const * const * const filenames,
+                 uint32_t const count)
+{
+    double decode_total = 0;
+    double mix_total = 0;
+    double compressed_total = 0;
+    
+    printf("%-32s %9s %10s %10s %10s\n",
+           "SOUND", "LENGTH", "DECODE", "MIX", "MIX ADPCM");
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t length;
+        
+        uint8_t * const data = sound__read(filenames[i], &length);
+        
+        if (data == NULL) {
+            fprintf(stderr, "could not read '%s'\n", filenames[i]);
+            
+            return false;
+        }
+        
+        uint8_t channels;
+        int32_t sample_rate;
+        uint32_t frames;
+        
+        int16_t * const samples = sound__decode(data, length,
+                                                &channels, &sample_rate,
+                                                &frames);
+        
+        if (samples == NULL) {
+            fprintf(stderr, "could not decode '%s'\n", filenames[i]);
+            
+            free(data);
+            
+            return false;
+        }
+        
+        size_t const blocks_size = (size_t)z_adpcm__blocks(frames) *
+            SHIZADPCMBlockSize * channels;
+        
+        uint8_t * const blocks = malloc(blocks_size);
+        
+        if (blocks == NULL) {
+            free(samples);
+            free(data);
+            
+            return false;
+        }
+        
+        z_adpcm__encode(samples, frames, channels, blocks);
+        
+        double const duration = (double)frames / sample_rate;
+        
+        double const decode_time =
+            sound__measure_decode(data, length, duration);
+        double const mix_time =
+            sound__measure_mix(samples, NULL, frames, channels, sample_rate);
+        double const compressed_time =
+            sound__measure_mix(NULL, blocks, frames, channels, sample_rate);
+        
+        decode_total += decode_time;
+        mix_total += mix_time;
+        compressed_total += compressed_time;
+        
+        printf("%-32s %8.2fs %8.3fms %8.3fms %8.3fms\n",
+               filenames[i], duration,
+               decode_time * 1000, mix_time * 1000, compressed_time * 1000);
+        
+        free(blocks);
+        free(samples);
+        free(data);
+    }
+    
+    printf("%-32s %9s %8.3fms %8.3fms %8.3fms\n",
+           "(average)", "",
+           decode_total / count * 1000,
+           mix_total / count * 1000,
+           compressed_total / count * 1000);
+    
+    return true;
+}
+
+static
+double
+sound__measure_decode(uint8_t const * const data,
+                      uint32_t const length,
+                      double const duration)
+{
+    uint32_t decodes = 0;
+    
+    clock_t const start = clock();
+    
+    do {
+        // the same as decoding a stream; a buffer at a time
+        uint8_t channels;
+        int32_t sample_rate;
+        uint32_t frames;
+        
+        int16_t * const samples = sound__decode(data, length,
+                                                &channels, &sample_rate,
+                                                &frames);
+        
+        free(samples);
+        
+        decodes += 1;
+    } while ((double)(clock() - start) / CLOCKS_PER_SEC <
+             SHIZSoundBenchmarkDuration);
+    
+    double const decode_time =
+        (double)(clock() - start) / CLOCKS_PER_SEC / decodes;
+    
+    return decode_time / duration;
+}
+
+static
+double
+sound__measure_mix(int16_t const * const samples,
+                   uint8_t const * const blocks,
+                   uint32_t const frames,
+                   uint8_t const channels,
+                   int32_t const sample_rate)
+{
+    int16_t mixed[SHIZBusBlockFrames * 2];
+    
+    uint64_t mixed_frames = 0;
+    
+    clock_t const start = clock();
+    
+    do {
+        for (uint16_t voice = 0; voice < SHIZSoundBenchmarkVoices; voice++) {
+            if (z_bus__is_playing(voice)) {
+                continue;
+            }
+            
+            // spread the voices out across pitches and positions, so that
+            // they resample (and pan) differently; as a game would
+            float const pitch = 0.75f + (voice % 8) * 0.0625f;
+            float const pan = (voice % 5) * 0.5f - 1;
+            
+            if (blocks != NULL) {
+                z_bus__play_compressed(voice, blocks, frames,
+                                       channels, sample_rate,
+                                       0.25f, pitch, pan, 0);
+            } else {
+                z_bus__play(voice, samples, frames,
+                            channels, sample_rate,
+                            0.25f, pitch, pan, 0);
+            }
+        }
+        
+        z_bus__mix(mixed, SHIZBusBlockFrames);
+        
+        mixed_frames += SHIZBusBlockFrames;
+    } while ((double)(clock() - start) / CLOCKS_PER_SEC <
+             SHIZSoundBenchmarkDuration);
+    
+    double const mix_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    for (uint16_t voice = 0; voice < SHIZSoundBenchmarkVoices; voice++) {
+        z_bus__stop(voice);
+    }
+    
+    return mix_time / ((double)mixed_frames / SHIZBusSampleRate);
+}
+
+static
+uint8_t *
+sound__read(char const * const filename,
+            uint32_t * const length)
+{
+    FILE * const file = fopen(filename, "rb");
+    
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    uint8_t * data = NULL;
+    long size = -1;
+    
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    
+    if (size > 0 && size <= INT32_MAX && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)size);
+        
+        if (data != NULL &&
+            fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            
+            data = NULL;
+        }
+    }
+    
+    fclose(file);
+    
+    if (data != NULL) {
+        *length = (uint32_t)size;
+    }
+    
+    return data;
+}
+
+static
+int16_t *
+sound__decode(uint8_t const * const data,
+              uint32_t const length,
+              uint8_t * const channels,
+              int32_t * const sample_rate,
+              uint32_t * const frames)
+{
+    int error = 0;
+    
+    stb_vorbis * const vorbis =
+        stb_vorbis_open_memory(data, (int32_t)length, &error, NULL);
+    
+    if (vorbis == NULL) {
+        return NULL;
+    }
+    
+    stb_vorbis_info const info = stb_vorbis_get_info(vorbis);
+    
+    // any more than two channels are mixed down, exactly like a stream
+    *channels = info.channels > 1 ? 2 : 1;
+    *sample_rate = (int32_t)info.sample_rate;
+    
+    uint32_t const total = stb_vorbis_stream_length_in_samples(vorbis);
+    uint32_t count = 0;
+    
+    int16_t * const samples = total > 0 ?
+        malloc((size_t)total * *channels * sizeof(int16_t)) : NULL;
+    
+    while (samples != NULL && count < total) {
+        uint32_t const remaining = total - count;
+        uint32_t const capacity = remaining < SHIZStreamBufferSamples ?
+            remaining : SHIZStreamBufferSamples;
+        
+        int32_t const decoded =
+            stb_vorbis_get_samples_short_interleaved(vorbis, *channels,
+                                                     samples + count * *channels,
+                                                     (int32_t)(capacity * *channels));
+        
+        if (decoded <= 0) {
+            break;
+        }
+        
+        count += (uint32_t)decoded;
+    }
+    
+    stb_vorbis_close(vorbis);
+    
+    if (samples != NULL && count == 0) {
+        free(samples);
+        
+        return NULL;
+    }
+    
+    *frames = count;
+    
+    return samples;
+}
+
+// nothing is played; these only satisfy the parts of the bus that are not
+// measured here (and the time it keeps itself, which is not used)
+double
+glfwGetTime()
+{
+    return 0;
+}
+
+void
+z_io__error(char const * const format, ...)
+{
+    (void)format;
+}
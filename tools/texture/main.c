@@ -0,0 +1,409 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+// Converts a PNG image into a texture, which loads without being decoded;
+// e.g.:
+//
+//   texture assets/hero.png assets/hero.tex
+//
+// A texture is loaded like any other image (and can be packed), so only the
+// filename given to `z_load` changes.
+//
+// Given `-b`, any number of PNG images are instead measured by how long each
+// takes to load as a PNG compared to as a texture; e.g.:
+//
+//   texture -b assets/*.png
+
+#include <stdlib.h> // EXIT_SUCCESS, EXIT_FAILURE, malloc, free
+#include <stdio.h> // FILE, fopen, fread, fwrite, fprintf, printf
+#include <stdint.h> // uint8_t, uint32_t, int32_t
+#include <stdbool.h> // bool
+#include <string.h> // strcmp, memcpy, memcmp
+#include <time.h> // clock, CLOCKS_PER_SEC
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+
+#include "../../external/stb/stb_image.h" // stbi_*
+
+#include "../../src/io.h" // SHIZTexture*
+
+/**
+ * The least amount of time (in seconds) that each format is measured for.
+ */
+#define SHIZTextureBenchmarkDuration 0.25
+
+static bool texture__convert(char const * input, char const * output);
+static bool texture__benchmark(char const * const * filenames, uint32_t count);
+
+static uint8_t * texture__read(char const * filename, uint32_t * length);
+static uint8_t * texture__decode(uint8_t const * data, uint32_t length, int32_t * width, int32_t * height);
+static uint8_t * texture__encode(uint8_t const * pixels, int32_t width, int32_t height, uint32_t * length);
+static uint8_t const * texture__pixels(uint8_t const * texture, uint32_t length, int32_t * width, int32_t * height);
+
+static void texture__write_u32(uint8_t * buffer, uint32_t value);
+static uint32_t texture__read_u32(uint8_t const * buffer);
+
+int
+main(int const argc, char const * const argv[])
+{
+    if (argc >= 3 && strcmp(argv[1], "-b") == 0) {
+        uint32_t const count = (uint32_t)(argc - 2);
+        
+        return texture__benchmark(argv + 2, count) ?
+            EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <image> <output>\n", argv[0]);
+        fprintf(stderr, "       %s -b <image> [<image> ...]\n", argv[0]);
+        
+        return EXIT_FAILURE;
+    }
+    
+    return texture__convert(argv[1], argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static
+bool
+texture__convert(char const * const input,
+                 char const * const output)
+{
+    uint32_t length;
+    
+    uint8_t * const data = texture__read(input, &length);
+    
+    if (data == NULL) {
+        fprintf(stderr, "could not read '%s'\n", input);
+        
+        return false;
+    }
+    
+    int32_t width, height;
+    
+    uint8_t * const pixels = texture__decode(data, length, &width, &height);
+    
+    free(data);
+    
+    if (pixels == NULL) {
+        fprintf(stderr, "could not decode '%s'\n", input);
+        
+        return false;
+    }
+    
+    uint32_t texture_length;
+    
+    uint8_t * const texture =
+        texture__encode(pixels, width, height, &texture_length);
+    
+    stbi_image_free(pixels);
+    
+    if (texture == NULL) {
+        fprintf(stderr, "could not convert '%s'\n", input);
+        
+        return false;
+    }
+    
+    FILE * const file = fopen(output, "wb");
+    
+    bool written = false;
+    
+    if (file != NULL) {
+        written = fwrite(texture, 1, texture_length, file) == texture_length;
+        
+        if (fclose(file) != 0 || !written) {
+            written = false;
+            
+            remove(output);
+        }
+    }
+    
+    free(texture);
+    
+    if (!written) {
+        fprintf(stderr, "could not write '%s'\n", output);
+    }
+    
+    return written;
+}
+
+static
+bool
+texture__benchmark(char const * const * const filenames,
+                   uint32_t const count)
+{
+    double png_total = 0;
+    double texture_total = 0;
+    
+    printf("%-32s %11s %10s %10s %8s\n",
+           "IMAGE", "SIZE", "PNG", "TEXTURE", "SPEEDUP");
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t length;
+        
+        uint8_t * const data = texture__read(filenames[i], &length);
+        
+        if (data == NULL) {
+            fprintf(stderr, "could not read '%s'\n", filenames[i]);
+            
+            return false;
+        }
+        
+        int32_t width, height;
+        
+        uint8_t * const pixels = texture__decode(data, length, &width, &height);
+        
+        if (pixels == NULL) {
+            fprintf(stderr, "could not decode '%s'\n", filenames[i]);
+            
+            free(data);
+            
+            return false;
+        }
+        
+        uint32_t texture_length;
+        
+        uint8_t * const texture =
+            texture__encode(pixels, width, height, &texture_length);
+        
+        stbi_image_free(pixels);
+        
+        if (texture == NULL) {
+            free(data);
+            
+            return false;
+        }
+        
+        // keep a byte of every load, so that none of them can be skipped
+        volatile uint8_t sink = 0;
+        
+        uint32_t png_loads = 0;
+        
+        clock_t start = clock();
+        
+        do {
+            int32_t png_width, png_height;
+            
+            uint8_t * const loaded =
+                texture__decode(data, length, &png_width, &png_height);
+            
+            sink ^= loaded[0];
+            
+            stbi_image_free(loaded);
+            
+            png_loads += 1;
+        } while ((double)(clock() - start) / CLOCKS_PER_SEC <
+                 SHIZTextureBenchmarkDuration);
+        
+        double const png_time =
+            (double)(clock() - start) / CLOCKS_PER_SEC / png_loads;
+        
+        uint32_t texture_loads = 0;
+        
+        start = clock();
+        
+        do {
+            // the same as loading a texture on a worker thread; on the main
+            // thread, the pixels are not even copied
+            int32_t texture_width = 0;
+            int32_t texture_height = 0;
+            
+            uint8_t const * const texture_pixels =
+                texture__pixels(texture, texture_length,
+                                &texture_width, &texture_height);
+            
+            size_t const size = (size_t)texture_width *
+                (size_t)texture_height * SHIZTextureComponents;
+            
+            uint8_t * const loaded = malloc(size);
+            
+            memcpy(loaded, texture_pixels, size);
+            
+            sink ^= loaded[0];
+            
+            free(loaded);
+            
+            texture_loads += 1;
+        } while ((double)(clock() - start) / CLOCKS_PER_SEC <
+                 SHIZTextureBenchmarkDuration);
+        
+        double const texture_time =
+            (double)(clock() - start) / CLOCKS_PER_SEC / texture_loads;
+        
+        png_total += png_time;
+        texture_total += texture_time;
+        
+        printf("%-32s %5dx%-5d %8.3fms %8.3fms %7.1fx\n",
+               filenames[i], width, height,
+               png_time * 1000, texture_time * 1000,
+               png_time / texture_time);
+        
+        free(texture);
+        free(data);
+    }
+    
+    printf("%-32s %11s %8.3fms %8.3fms %7.1fx\n",
+           "(total)", "",
+           png_total * 1000, texture_total * 1000,
+           png_total / texture_total);
+    
+    return true;
+}
+
+static
+uint8_t *
+texture__read(char const * const filename,
+              uint32_t * const length)
+{
+    FILE * const file = fopen(filename, "rb");
+    
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    uint8_t * data = NULL;
+    long size = -1;
+    
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    
+    if (size > 0 && size <= INT32_MAX && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)size);
+        
+        if (data != NULL &&
+            fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            
+            data = NULL;
+        }
+    }
+    
+    fclose(file);
+    
+    if (data != NULL) {
+        *length = (uint32_t)size;
+    }
+    
+    return data;
+}
+
+static
+uint8_t *
+texture__decode(uint8_t const * const data,
+                uint32_t const length,
+                int32_t * const width,
+                int32_t * const height)
+{
+    int32_t components;
+    
+    uint8_t * const pixels =
+        stbi_load_from_memory(data, (int32_t)length, width, height,
+                              &components, SHIZTextureComponents);
+    
+    if (pixels == NULL) {
+        return NULL;
+    }
+    
+    // flip the image, exactly like the engine does when loading a PNG, so
+    // that the first row is at the bottom
+    size_t const stride = (size_t)*width * SHIZTextureComponents;
+    
+    uint8_t * top = pixels;
+    uint8_t * bottom = pixels + (size_t)(*height - 1) * stride;
+    
+    while (top < bottom) {
+        for (size_t i = 0; i < stride; i++) {
+            uint8_t const pixel = top[i];
+            
+            top[i] = bottom[i];
+            bottom[i] = pixel;
+        }
+        
+        top += stride;
+        bottom -= stride;
+    }
+    
+    return pixels;
+}
+
+static
+uint8_t *
+texture__encode(uint8_t const * const pixels,
+                int32_t const width,
+                int32_t const height,
+                uint32_t * const length)
+{
+    uint64_t const size = (uint64_t)width * (uint64_t)height *
+        SHIZTextureComponents;
+    
+    if (size > UINT32_MAX - SHIZTextureHeaderSize) {
+        return NULL;
+    }
+    
+    *length = SHIZTextureHeaderSize + (uint32_t)size;
+    
+    uint8_t * const texture = malloc(*length);
+    
+    if (texture == NULL) {
+        return NULL;
+    }
+    
+    memcpy(texture, SHIZTextureMagic, 4);
+    
+    texture__write_u32(texture + 4, SHIZTextureVersion);
+    texture__write_u32(texture + 8, (uint32_t)width);
+    texture__write_u32(texture + 12, (uint32_t)height);
+    
+    memcpy(texture + SHIZTextureHeaderSize, pixels, (size_t)size);
+    
+    return texture;
+}
+
+static
+uint8_t const *
+texture__pixels(uint8_t const * const texture,
+                uint32_t const length,
+                int32_t * const width,
+                int32_t * const height)
+{
+    if (length < SHIZTextureHeaderSize ||
+        memcmp(texture, SHIZTextureMagic, 4) != 0 ||
+        texture__read_u32(texture + 4) != SHIZTextureVersion) {
+        return NULL;
+    }
+    
+    *width = (int32_t)texture__read_u32(texture + 8);
+    *height = (int32_t)texture__read_u32(texture + 12);
+    
+    return texture + SHIZTextureHeaderSize;
+}
+
+static
+void
+texture__write_u32(uint8_t * const buffer,
+                   uint32_t const value)
+{
+    buffer[0] = (uint8_t)(value & 0xff);
+    buffer[1] = (uint8_t)((value >> 8) & 0xff);
+    buffer[2] = (uint8_t)((value >> 16) & 0xff);
+    buffer[3] = (uint8_t)((value >> 24) & 0xff);
+}
+
+static
+uint32_t
+texture__read_u32(uint8_t const * const buffer)
+{
+    return (uint32_t)buffer[0] |
+        ((uint32_t)buffer[1] << 8) |
+        ((uint32_t)buffer[2] << 16) |
+        ((uint32_t)buffer[3] << 24);
+}
@@ -0,0 +1,819 @@
+////
+//    __|  |  | _ _| __  /  __|   \ |
+//  \__ \  __ |   |     /   _|   .  |
+//  ____/ _| _| ___| ____| ___| _|\_|
+//
+// Copyright (c) 2017 Jacob Hauberg Hansen
+//
+// This library is free software; you can redistribute and modify it
+// under the terms of the MIT license. See LICENSE for details.
+//
+
+// Checks `z_spritefont__measure_text` in two ways; e.g.:
+//
+//   wrap 1000000
+//
+// First, a fixed set of texts is measured, covering each way that wrapping
+// words was changed on purpose when it became a single forward pass:
+//
+//   - a word that does not fit on a line by itself is broken where it
+//     overflows, and a character that does not fit at all is still kept
+//   - an explicit linebreak that coincides with a full line ends that line
+//   - a whitespace that begins a line is not a place to break it
+//   - multibyte characters are stepped over whole
+//
+// Then, random single-byte text is measured both with it and with a copy
+// of the implementation it replaced (kept verbatim below), and any
+// measurement that differs is reported. Every line (its size and number of
+// characters), the truncation and the size of the text as a whole must be
+// exactly the same. As the above changes are left out, text wrapped by
+// words within bounds is made of words that each fit on a line, with single
+// whitespaces and no explicit linebreaks; text wrapped by characters, or not
+// bounded horizontally, can be anything.
+//
+// A seed can be given as well, so that a failing run can be repeated:
+//
+//   wrap 1000000 42
+//
+// Given `-b`, finding the characters of a font with a custom codepage is
+// instead measured, by how long it takes to lay out paragraphs of 1000
+// characters with the lookup built for the codepage compared to scanning
+// through the codepage for every character; e.g.:
+//
+//   wrap -b
+
+#include <stdlib.h> // EXIT_SUCCESS, EXIT_FAILURE, srand, rand, strtoul
+#include <stdio.h> // fprintf, printf
+#include <stdint.h> // uint8_t, uint16_t, uint32_t, int32_t
+#include <stdbool.h> // bool
+#include <string.h> // memset, strcmp
+#include <time.h> // clock, CLOCKS_PER_SEC
+
+#include "../../src/ztype.c"
+#include "../../src/zlayer.c"
+#include "../../src/spritefont.c"
+
+/**
+ * The max number of characters in a random text.
+ */
+#define SHIZWrapMaxCharacters 80
+/**
+ * The max number of lines that a case is expected to measure.
+ */
+#define SHIZWrapCaseMaxLines 4
+/**
+ * The least amount of time (in seconds) that each way of finding characters
+ * is measured for.
+ */
+#define SHIZWrapBenchmarkDuration 0.25
+/**
+ * The number of characters in each paragraph laid out while measuring.
+ */
+#define SHIZWrapBenchmarkCharacters 1000
+/**
+ * The number of different paragraphs laid out while measuring.
+ */
+#define SHIZWrapBenchmarkParagraphs 16
+
+/**
+ * @brief Represents a text, how it is expected to be measured, and the
+ *        change that it covers.
+ */
+typedef struct SHIZWrapCase {
+    char const * change;
+    char const * text;
+    /** The width of the bounds, in characters; 0 is less than a character */
+    uint8_t columns;
+    /** The height of the bounds, in lines; 0 is unbounded */
+    uint8_t rows;
+    uint32_t line_count;
+    uint16_t characters[SHIZWrapCaseMaxLines];
+    int32_t max_characters;
+} SHIZWrapCase;
+
+static SHIZWrapCase const SHIZWrapCases[] = {
+    { "overlong word", "abcdefg hi", 4, 0,
+      3, { 4, 3, 3 }, -1 },
+    { "overlong word after another", "ab\n abcdef gh", 4, 0,
+      4, { 2, 4, 3, 3 }, -1 },
+    { "no character fits", "abc", 0, 2,
+      2, { 1, 1 }, 2 },
+    { "linebreak at a full line", "abcd\nef", 4, 0,
+      2, { 4, 2 }, -1 },
+    { "leading whitespace", " abcdef gh", 4, 0,
+      3, { 4, 3, 3 }, -1 },
+    { "multibyte characters", "\xe2\x82\xac \xc3\xa9\xc3\xa9 a", 2, 0,
+      3, { 1, 3, 2 }, -1 },
+    { "multibyte word", "a \xc3\xa9\xc3\xa9 bc", 3, 0,
+      3, { 1, 3, 3 }, -1 }
+};
+
+static SHIZSpriteFontMeasurement const wrap__measure_baseline(SHIZSpriteFont font, char const * text, SHIZSize bounds, SHIZSpriteFontAttributes attribs);
+
+static uint32_t wrap__check_cases(SHIZSpriteFontAttributes attribs);
+static bool wrap__check_case(SHIZWrapCase const * wrap_case, SHIZSpriteFontMeasurement const * measurement);
+
+static bool wrap__compare(SHIZSpriteFontMeasurement const * measurement, SHIZSpriteFontMeasurement const * reference);
+static void wrap__print(char const * text);
+
+static uint32_t wrap__random_text(char * text);
+static uint32_t wrap__random_words(char * text, uint16_t max_word_length);
+
+static bool wrap__benchmark(void);
+static double wrap__measure_layout(SHIZSpriteFont font, char const * const * paragraphs);
+static void wrap__random_paragraph(char * text, uint32_t const * codepage, uint32_t codepage_size);
+static uint8_t wrap__encode(uint32_t character_decimal, char * text);
+
+int
+main(int const argc, char const * const argv[])
+{
+    if (argc == 2 && strcmp(argv[1], "-b") == 0) {
+        return wrap__benchmark() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "usage: %s <count> [<seed>]\n", argv[0]);
+        fprintf(stderr, "       %s -b\n", argv[0]);
+        
+        return EXIT_FAILURE;
+    }
+    
+    uint32_t const count = (uint32_t)strtoul(argv[1], NULL, 10);
+    uint32_t const seed = argc == 3 ? (uint32_t)strtoul(argv[2], NULL, 10) : 1;
+    
+    srand(seed);
+    
+    char text[SHIZWrapMaxCharacters * 2 + 1];
+    
+    SHIZColor colors[SHIZSpriteFontMaxColors];
+    
+    for (uint8_t i = 0; i < SHIZSpriteFontMaxColors; i++) {
+        colors[i] = SHIZColorWhite;
+    }
+    
+    SHIZSpriteFontAttributes attribs = SHIZSpriteFontAttributesDefault;
+    
+    attribs.colors = colors;
+    attribs.colors_count = SHIZSpriteFontMaxColors;
+    
+    uint32_t const case_failures = wrap__check_cases(attribs);
+    
+    uint32_t failures = 0;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        SHIZSpriteFont font;
+        
+        memset(&font, 0, sizeof(SHIZSpriteFont));
+        
+        font.character = SHIZSizeMake(8, 8);
+        font.includes_whitespace = rand() % 4 == 0;
+        
+        attribs.wrap = rand() % 2 == 0 ?
+            SHIZSpriteFontWrapModeWord : SHIZSpriteFontWrapModeCharacter;
+        
+        // at least 2 characters to a line, so that a word can fit
+        uint16_t const columns = rand() % 4 != 0 ? (uint16_t)(2 + rand() % 11) : 0;
+        
+        SHIZSize const bounds =
+            SHIZSizeMake((float)(8 * columns),
+                         rand() % 3 == 0 ? (float)(8 * (1 + rand() % 10)) : 0);
+        
+        if (attribs.wrap == SHIZSpriteFontWrapModeWord && columns > 0) {
+            wrap__random_words(text, columns - 1);
+        } else {
+            wrap__random_text(text);
+        }
+        
+        SHIZSpriteFontMeasurement const measurement =
+            z_spritefont__measure_text(font, text, bounds, attribs);
+        SHIZSpriteFontMeasurement const reference =
+            wrap__measure_baseline(font, text, bounds, attribs);
+        
+        if (!wrap__compare(&measurement, &reference)) {
+            failures += 1;
+            
+            printf("mismatch (%s, %gx%g): ",
+                   attribs.wrap == SHIZSpriteFontWrapModeWord ?
+                   "word" : "character",
+                   bounds.width, bounds.height);
+            
+            wrap__print(text);
+        }
+        
+        // release the lines of both measurements
+        z_spritefont__reset();
+    }
+    
+    z_spritefont__kill();
+    
+    printf("%u of %u cases fail\n", case_failures,
+           (uint32_t)(sizeof(SHIZWrapCases) / sizeof(SHIZWrapCases[0])));
+    printf("%u of %u measurements differ\n", failures, count);
+    
+    return case_failures == 0 && failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static
+uint32_t
+wrap__check_cases(SHIZSpriteFontAttributes attribs)
+{
+    uint32_t const case_count = sizeof(SHIZWrapCases) / sizeof(SHIZWrapCases[0]);
+    uint32_t failures = 0;
+    
+    SHIZSpriteFont font;
+    
+    memset(&font, 0, sizeof(SHIZSpriteFont));
+    
+    font.character = SHIZSizeMake(8, 8);
+    
+    attribs.wrap = SHIZSpriteFontWrapModeWord;
+    
+    for (uint32_t i = 0; i < case_count; i++) {
+        SHIZWrapCase const * const wrap_case = &SHIZWrapCases[i];
+        
+        // less than a character wide, if no columns
+        SHIZSize const bounds =
+            SHIZSizeMake(wrap_case->columns > 0 ? 8.0f * wrap_case->columns : 4,
+                         8.0f * wrap_case->rows);
+        
+        SHIZSpriteFontMeasurement const measurement =
+            z_spritefont__measure_text(font, wrap_case->text, bounds, attribs);
+        
+        if (!wrap__check_case(wrap_case, &measurement)) {
+            failures += 1;
+            
+            printf("case failed (%s): ", wrap_case->change);
+            
+            wrap__print(wrap_case->text);
+        }
+        
+        z_spritefont__reset();
+    }
+    
+    return failures;
+}
+
+static
+bool
+wrap__check_case(SHIZWrapCase const * const wrap_case,
+                 SHIZSpriteFontMeasurement const * const measurement)
+{
+    if (measurement->line_count != wrap_case->line_count ||
+        measurement->max_characters != wrap_case->max_characters) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < measurement->line_count; i++) {
+        if (measurement->lines[i].character_count !=
+            wrap_case->characters[i]) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+static
+bool
+wrap__compare(SHIZSpriteFontMeasurement const * const measurement,
+              SHIZSpriteFontMeasurement const * const reference)
+{
+    if (measurement->line_count != reference->line_count ||
+        measurement->max_characters != reference->max_characters ||
+        measurement->size.width != reference->size.width ||
+        measurement->size.height != reference->size.height) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < measurement->line_count; i++) {
+        SHIZSpriteFontLine const line = measurement->lines[i];
+        SHIZSpriteFontLine const reference_line = reference->lines[i];
+        
+        if (line.character_count != reference_line.character_count ||
+            line.size.width != reference_line.size.width ||
+            line.size.height != reference_line.size.height) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+static
+void
+wrap__print(char const * const text)
+{
+    printf("\"");
+    
+    for (char const * character = text; *character; character++) {
+        unsigned char const byte = (unsigned char)*character;
+        
+        if (byte < ' ' || byte > '~') {
+            printf("\\x%02x", byte);
+        } else {
+            printf("%c", byte);
+        }
+    }
+    
+    printf("\"\n");
+}
+
+static
+uint32_t
+wrap__random_text(char * const text)
+{
+    // mostly short words, so that lines are broken in every possible way
+    static char const pieces[] = {
+        'a', 'a', 'a', 'a', 'b', 'b', 'c', 'd',
+        ' ', ' ', ' ', ' ', ' ',
+        '\n',
+        '\1', '\2', '\7'
+    };
+    
+    uint32_t const piece_count = sizeof(pieces) / sizeof(pieces[0]);
+    uint32_t const length = (uint32_t)(rand() % SHIZWrapMaxCharacters);
+    
+    for (uint32_t i = 0; i < length; i++) {
+        text[i] = pieces[rand() % piece_count];
+    }
+    
+    text[length] = '\0';
+    
+    return length;
+}
+
+static
+uint32_t
+wrap__random_words(char * const text,
+                   uint16_t const max_word_length)
+{
+    // tint specifiers take up no room, but do count towards the length of a
+    // word; a word as long as a line already overflows it when followed
+    static char const pieces[] = {
+        'a', 'a', 'a', 'a', 'b', 'b', 'c', 'd',
+        '\1', '\2', '\7'
+    };
+    
+    uint32_t const piece_count = sizeof(pieces) / sizeof(pieces[0]);
+    uint32_t const character_count = (uint32_t)(rand() % SHIZWrapMaxCharacters);
+    
+    uint32_t length = 0;
+    uint16_t word_length = 0;
+    
+    for (uint32_t i = 0; i < character_count; i++) {
+        if (word_length > 0 &&
+            (word_length >= max_word_length || rand() % 4 == 0)) {
+            text[length++] = ' ';
+            
+            word_length = 0;
+        }
+        
+        text[length++] = pieces[rand() % piece_count];
+        
+        word_length += 1;
+    }
+    
+    text[length] = '\0';
+    
+    return length;
+}
+
+static
+bool
+wrap__benchmark()
+{
+    // printable ASCII first, then Latin-1 and box drawing characters; as in
+    // most custom codepages, many characters are far into it when scanning
+    static uint32_t codepage[16 * 16];
+    
+    uint32_t const codepage_size = sizeof(codepage) / sizeof(codepage[0]);
+    uint32_t count = 0;
+    
+    for (uint32_t character = ' '; character <= '~'; character++) {
+        codepage[count++] = character;
+    }
+    
+    for (uint32_t character = 0xa0; character <= 0xff; character++) {
+        codepage[count++] = character;
+    }
+    
+    for (uint32_t character = 0x2500; count < codepage_size; character++) {
+        codepage[count++] = character;
+    }
+    
+    SHIZSpriteFont font = SHIZSpriteFontEmpty;
+    
+    font.character = SHIZSizeMake(8, 8);
+    font.sprite.resource_id = 1;
+    font.table.codepage = codepage;
+    font.table.columns = 16;
+    font.table.rows = 16;
+    
+    SHIZSpriteFont font_scanned = font;
+    
+    font.table_lookup_id = z_spritefont__build_lookup(font.table,
+                                                      font.sprite.resource_id);
+    font_scanned.table_lookup_id = 0;
+    
+    if (font.table_lookup_id == 0) {
+        fprintf(stderr, "could not build lookup\n");
+        
+        return false;
+    }
+    
+    // every character could take up to 3 bytes
+    static char paragraph_texts[SHIZWrapBenchmarkParagraphs]
+                               [(SHIZWrapBenchmarkCharacters * 3) + 1];
+    
+    char const * paragraphs[SHIZWrapBenchmarkParagraphs];
+    
+    for (uint32_t i = 0; i < SHIZWrapBenchmarkParagraphs; i++) {
+        wrap__random_paragraph(paragraph_texts[i], codepage, codepage_size);
+        
+        paragraphs[i] = paragraph_texts[i];
+    }
+    
+    double const scan_time = wrap__measure_layout(font_scanned, paragraphs);
+    double const lookup_time = wrap__measure_layout(font, paragraphs);
+    
+    printf("%-8s %12s\n", "FIND", "PARAGRAPH");
+    printf("%-8s %10.2fus\n", "scan", scan_time * 1000000);
+    printf("%-8s %10.2fus (%.1fx)\n", "lookup", lookup_time * 1000000,
+           scan_time / lookup_time);
+    
+    z_spritefont__release_lookups(font.sprite.resource_id);
+    z_spritefont__kill();
+    
+    return true;
+}
+
+static
+double
+wrap__measure_layout(SHIZSpriteFont const font,
+                     char const * const * const paragraphs)
+{
+    SHIZSpriteFontAttributes const attribs = SHIZSpriteFontAttributesDefault;
+    
+    // 40 characters to a line
+    SHIZSize const bounds = SHIZSizeMake(font.character.width * 40, 0);
+    
+    uint32_t layouts = 0;
+    
+    clock_t const start = clock();
+    
+    do {
+        for (uint32_t i = 0; i < SHIZWrapBenchmarkParagraphs; i++) {
+            // laid out like any drawn text (without the layout cache), but
+            // nothing is drawn
+            z_spritefont__layout_text(font, paragraphs[i], SHIZVector2Zero,
+                                      SHIZSpriteFontAlignmentDefault, bounds,
+                                      attribs, SHIZColorWhite,
+                                      SHIZLayerDefault, NULL, false);
+            
+            layouts += 1;
+        }
+        
+        // release the lines of every measurement
+        z_spritefont__reset();
+    } while ((double)(clock() - start) / CLOCKS_PER_SEC <
+             SHIZWrapBenchmarkDuration);
+    
+    return (double)(clock() - start) / CLOCKS_PER_SEC / layouts;
+}
+
+static
+void
+wrap__random_paragraph(char * const text,
+                       uint32_t const * const codepage,
+                       uint32_t const codepage_size)
+{
+    uint32_t length = 0;
+    uint8_t word_length = 0;
+    
+    for (uint32_t i = 0; i < SHIZWrapBenchmarkCharacters; i++) {
+        if (word_length > 0 && rand() % 6 == 0) {
+            text[length++] = ' ';
+            
+            word_length = 0;
+            
+            continue;
+        }
+        
+        // anything but the whitespace at the beginning of the codepage
+        uint32_t const character_decimal =
+            codepage[1 + (uint32_t)rand() % (codepage_size - 1)];
+        
+        length += wrap__encode(character_decimal, text + length);
+        
+        word_length += 1;
+    }
+    
+    text[length] = '\0';
+}
+
+static
+uint8_t
+wrap__encode(uint32_t const character_decimal,
+             char * const text)
+{
+    if (character_decimal < 0x80) {
+        text[0] = (char)character_decimal;
+        
+        return 1;
+    } else if (character_decimal < 0x800) {
+        text[0] = (char)(0xc0 | (character_decimal >> 6));
+        text[1] = (char)(0x80 | (character_decimal & 0x3f));
+        
+        return 2;
+    }
+    
+    text[0] = (char)(0xe0 | (character_decimal >> 12));
+    text[1] = (char)(0x80 | ((character_decimal >> 6) & 0x3f));
+    text[2] = (char)(0x80 | (character_decimal & 0x3f));
+    
+    return 3;
+}
+
+// the implementation that was replaced, as it was; note that it only ever
+// steps back a single byte at a time, so it is only compared on single-byte
+// text
+
+static
+SHIZSpriteFontMeasurement const
+wrap__measure_baseline(SHIZSpriteFont const font,
+                       char const * const text,
+                       SHIZSize const bounds,
+                       SHIZSpriteFontAttributes const attribs)
+{
+    SHIZSpriteFontMeasurement measurement;
+
+    measurement.size = SHIZSizeZero;
+    measurement.max_characters = -1; // no truncation
+    measurement.lines = NULL;
+    measurement.line_count = 0;
+
+    measurement.character_size = SHIZSizeMake(font.character.width * attribs.scale.x,
+                                              font.character.height * attribs.scale.y);
+    
+    measurement.character_size_perceived =
+        SHIZSizeMake((measurement.character_size.width * attribs.character_spread) + attribs.character_padding,
+                     measurement.character_size.height);
+
+    measurement.constrain_horizontally = bounds.width > 0;
+    measurement.constrain_vertically = bounds.height > 0;
+
+    if (measurement.constrain_horizontally) {
+        float const max_characters_per_line =
+            floorf(bounds.width / measurement.character_size_perceived.width);
+        
+        if (max_characters_per_line > UINT16_MAX) {
+            measurement.max_characters_per_line = UINT16_MAX;
+        } else {
+            measurement.max_characters_per_line = (uint16_t)max_characters_per_line;
+        }
+    } else {
+        measurement.max_characters_per_line = UINT16_MAX;
+    }
+
+    float const line_height =
+        measurement.character_size_perceived.height + attribs.line_padding;
+    
+    if (measurement.constrain_vertically) {
+        float const max_lines_in_bounds =
+            floorf(bounds.height / line_height);
+        
+        if (max_lines_in_bounds > UINT32_MAX) {
+            measurement.max_lines_in_bounds = UINT32_MAX;
+        } else {
+            measurement.max_lines_in_bounds =
+                (uint32_t)max_lines_in_bounds;
+        }
+    } else {
+        measurement.max_lines_in_bounds = UINT32_MAX;
+    }
+
+    uint32_t character_count = 0;
+    uint32_t line_index = 0;
+    uint16_t line_character_count = 0;
+    uint16_t line_character_ignored_count = 0;
+
+    char const whitespace_character = ' ';
+    char const newline_character = '\n';
+
+    bool const skip_leading_whitespace = !font.includes_whitespace;
+
+    bool current_line_has_leading_whitespace = false;
+    bool next_line_has_leading_whitespace = false;
+
+    const char * text_ptr = text;
+
+    if (!text_ptr) {
+        return measurement;
+    }
+    
+    if (z_spritefont__push_line(&measurement) == NULL) {
+        return measurement;
+    }
+    
+    char const * line_ptr = text_ptr;
+
+    while (*text_ptr) {
+        char character = *text_ptr;
+        unsigned int character_size = 0;
+
+        utf8_decode(text_ptr, &character_size);
+
+        text_ptr += character_size;
+
+        bool const break_line_explicit = character == newline_character;
+        // don't skip leading whitespace on the first line or if intentionally breaking
+        bool const can_skip_leading_whitespace = (line_index > 0 &&
+                                                  !break_line_explicit);
+        
+        bool should_skip_leading_whitespace = can_skip_leading_whitespace &&
+            (skip_leading_whitespace &&
+             current_line_has_leading_whitespace);
+
+        uint16_t const line_character_count_perceived =
+            z_spritefont__perceived_count(line_character_count,
+                                          line_character_ignored_count,
+                                          should_skip_leading_whitespace);
+
+        bool const break_line_required =
+            (measurement.constrain_horizontally &&
+             line_character_count_perceived >= measurement.max_characters_per_line);
+
+        if (break_line_explicit || break_line_required) {
+            next_line_has_leading_whitespace = false;
+
+            if (break_line_required) {
+                if (attribs.wrap == SHIZSpriteFontWrapModeWord) {
+                    // backtrack until finding a whitespace
+                    while (*text_ptr) {
+                        text_ptr -= character_size;
+                        
+                        character_count -= 1;
+
+                        utf8_decode(text_ptr, &character_size);
+
+                        character = *text_ptr;
+
+                        if (character == whitespace_character &&
+                            !break_line_explicit) {
+                            next_line_has_leading_whitespace = true;
+
+                            break;
+                        }
+
+                        if (line_character_count > 0) {
+                            line_character_count -= 1;
+                        } else {
+                            break;
+                        }
+                        
+                        if (character_count == 0) {
+                            // additional safety measure
+                            break;
+                        }
+                    }
+                } else {
+                    text_ptr -= character_size;
+                    
+                    char const breaking_character = *text_ptr;
+                    
+                    next_line_has_leading_whitespace =
+                        breaking_character == whitespace_character;
+                    
+                    if (next_line_has_leading_whitespace) {
+                        text_ptr -= character_size;
+                    }
+                }
+            }
+            
+            bool const is_repeating_line =
+                text_ptr < line_ptr ||
+                (text_ptr == line_ptr &&
+                 (skip_leading_whitespace && next_line_has_leading_whitespace) ==
+                 (skip_leading_whitespace && current_line_has_leading_whitespace &&
+                  line_index > 0));
+            
+            if (is_repeating_line) {
+                // the next line would be measured exactly like this one,
+                // and so on; the rest of the text can never fit, so stop here
+                break;
+            }
+            
+            z_spritefont__set_line(&measurement.lines[line_index],
+                                   &measurement,
+                                   line_height,
+                                   line_character_count,
+                                   line_character_ignored_count,
+                                   should_skip_leading_whitespace);
+            
+            line_ptr = text_ptr;
+            
+            line_character_ignored_count = 0;
+            line_character_count = 0;
+
+            current_line_has_leading_whitespace = next_line_has_leading_whitespace;
+
+            if (measurement.constrain_vertically) {
+                if (line_index + 1 >= measurement.max_lines_in_bounds) {
+                    measurement.max_characters = (int32_t)character_count;
+
+                    break;
+                }
+            }
+
+            if (z_spritefont__push_line(&measurement) == NULL) {
+                // out of memory; keep what was measured so far
+                break;
+            }
+
+            line_index += 1;
+
+            continue;
+        }
+
+        if (z_spritefont__is_tint_character(character)) {
+            // increment ignored characters, but otherwise proceed as usual
+            line_character_ignored_count += 1;
+        }
+
+        line_character_count += 1;
+        character_count += 1;
+        
+        z_spritefont__set_line(&measurement.lines[line_index],
+                               &measurement,
+                               line_height,
+                               line_character_count,
+                               line_character_ignored_count,
+                               should_skip_leading_whitespace);
+    }
+
+    measurement.size.height = measurement.line_count * line_height;
+
+    for (line_index = 0; line_index < measurement.line_count; line_index++) {
+        SHIZSpriteFontLine const line = measurement.lines[line_index];
+        
+        if (line.size.width > measurement.size.width) {
+            // use the widest occurring line width
+            measurement.size.width = line.size.width;
+        }
+    }
+    
+    return measurement;
+}
+
+// nothing is drawn; these only satisfy the parts of the sprite font module
+// that are not measured here
+
+SHIZResourceImage const *
+z_res__image(uint32_t const resource_id)
+{
+    (void)resource_id;
+    
+    return NULL;
+}
+
+void
+z_sprite__source_uv(SHIZRect const source,
+                    SHIZSize const texture_size,
+                    SHIZVector2 * const uv_min,
+                    SHIZVector2 * const uv_max)
+{
+    (void)source;
+    (void)texture_size;
+    (void)uv_min;
+    (void)uv_max;
+}
+
+bool
+z_sprite__begin_run(SHIZSpriteRun * const run,
+                    uint32_t const resource_id,
+                    SHIZSize const size,
+                    SHIZVector2 const anchor,
+                    bool const opaque,
+                    SHIZLayer const layer)
+{
+    (void)run;
+    (void)resource_id;
+    (void)size;
+    (void)anchor;
+    (void)opaque;
+    (void)layer;
+    
+    return false;
+}
+
+void
+z_sprite__draw_run(SHIZSpriteRun const * const run,
+                   SHIZRect const source,
+                   SHIZVector2 const origin,
+                   SHIZColor const tint)
+{
+    (void)run;
+    (void)source;
+    (void)origin;
+    (void)tint;
+}